@@ -0,0 +1,36 @@
+//=====================================================================
+//Bare-metal support of microbenchmarks (startup, semihosting output)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdint.h>
+
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#ifndef BENCH_CLOCK_FREQ
+#define BENCH_CLOCK_FREQ			168000000		//SYSCLK of QEMU netduinoplus2 (STM32F405), only used to convert ticks to instructions
+#endif
+
+#ifdef BENCH_ICOUNT_SHIFT
+#define BENCH_UNIT						"instructions"
+#else
+#define BENCH_UNIT						"cycles"
+#endif
+
+/**
+* @brief - send string to debugger console (semihosting SYS_WRITE0)
+* @param string - string terminated by '\0'
+* @returns - nothing
+*/
+void Bench_Print(uint8_t *string);
+
+/**
+* @brief - end program (semihosting SYS_EXIT), QEMU exits with given status
+* @param status - 0 = success
+* @returns - nothing
+*/
+void Bench_Exit(uint32_t status);
+
+#endif
@@ -0,0 +1,218 @@
+//=====================================================================
+//Microbenchmarks of firmware hot paths (DAC code, hex conversion,
+//command parsing and formatting of answers)
+//runs bare-metal on QEMU (netduinoplus2, Cortex-M4F) or on Nucleo board,
+//cost of each function is measured by SysTick counting core clock,
+//with QEMU -icount the clock is derived from executed instructions
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "stm32f429xx.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "CLVB.h"
+#include "CCB.h"
+#include "Calibrator_utils.h"
+#include "Bench.h"
+
+
+#define BENCH_REPEATS				1000		//calls of function in one measurement
+#define BENCH_RUNS					5				//measurements of every function, minimum is reported
+
+typedef struct
+{
+	const char *name;
+	void (*function)(uint32_t i);
+	uint8_t range;			//range of CLVB and CCB during measurement
+} Bench_function;
+
+extern CLVB_module_state CLVB_state;
+extern CCB_module_state CCB_state;
+
+static const double bench_voltages[8] = {0.0, 0.1234567, -0.2, 1.5, -1.999999, 9.87654, -15.0, 21.5};
+static const double bench_currents[8] = {0.0, 0.0012345, -0.001, 0.015, -0.0199999, 0.1, -0.15, 0.2};
+static const char *bench_hex_strings[4] = {"0000", "7FFFF0", "00ABCDEF", "FFFFFFFF"};
+static const char *bench_commands[4] = {"VOLT 1.234567", "VOLT -0.5", "VOLT:RANG 2", "VOLT?"};
+
+static volatile uint32_t bench_sink;						//results are stored here, so calls are not removed by compiler
+static volatile uint32_t bench_overflows = 0;
+static uint8_t bench_string[64];
+
+
+void SysTick_Handler(void)
+{
+	bench_overflows++;
+}
+
+
+static void Bench_InitTimer(void)
+{
+	SysTick->LOAD = 0x00FFFFFF;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;		//core clock, interrupt at overflow
+}
+
+
+/**
+* @brief - read 24-bit SysTick counter extended by number of overflows
+* @returns - ticks of core clock since Bench_InitTimer
+*/
+static uint64_t Bench_GetTicks(void)
+{
+	uint32_t overflows, value;
+	
+	do
+	{
+		overflows = bench_overflows;
+		value = SysTick->VAL;
+	} while (overflows != bench_overflows);		//overflow between both reads
+	
+	return ((uint64_t) overflows << 24) + (0x00FFFFFF - value);
+}
+
+
+/**
+* @brief - convert ticks of SysTick to reported unit (instructions on QEMU with -icount, cycles on hardware)
+* @returns - converted number of ticks
+*/
+static uint64_t Bench_ConvertTicks(uint64_t ticks)
+{
+#ifdef BENCH_ICOUNT_SHIFT
+	//virtual time advances 2^shift ns per instruction, SysTick counts BENCH_CLOCK_FREQ per second of virtual time
+	return (ticks * 1000000000ULL) / ((uint64_t) BENCH_CLOCK_FREQ << BENCH_ICOUNT_SHIFT);
+#else
+	return ticks;
+#endif
+}
+
+
+static uint64_t Bench_Measure(void (*function)(uint32_t i))
+{
+	uint64_t best = UINT64_MAX;
+	
+	for (uint8_t run = 0; run < BENCH_RUNS; run++)
+	{
+		uint64_t start = Bench_GetTicks();
+		for (uint32_t i = 0; i < BENCH_REPEATS; i++) {function(i);}
+		uint64_t ticks = Bench_GetTicks() - start;
+		if (ticks < best) {best = ticks;}
+	}
+	
+	return best;
+}
+
+
+//===================================== benchmarked paths ========================================
+static void Bench_Empty(uint32_t i)
+{
+	bench_sink = i;
+}
+
+
+static void Bench_CLVBCodeR1(uint32_t i)
+{
+	bench_sink = CLVB_GetVoltageCode(bench_voltages[i & 7] * 0.01);
+}
+
+
+static void Bench_CLVBCodeR2(uint32_t i)
+{
+	bench_sink = CLVB_GetVoltageCode(bench_voltages[i & 7] * 0.1);
+}
+
+
+static void Bench_CLVBCodeR3(uint32_t i)
+{
+	bench_sink = CLVB_GetVoltageCode(bench_voltages[i & 7]);
+}
+
+
+static void Bench_CCBCode(uint32_t i)
+{
+	bench_sink = CCB_GetVoltageCode(bench_currents[i & 7]);
+}
+
+
+static void Bench_HexStringToInt(uint32_t i)
+{
+	bench_sink = Utils_HexStringToInt((uint8_t *) bench_hex_strings[i & 3]);
+}
+
+
+static void Bench_IntToHexString(uint32_t i)
+{
+	Utils_IntToHexString(i * 0x9E3779B1, bench_string, 8);
+	bench_sink = bench_string[0];
+}
+
+
+//selection of handler and reading of number, same as Calibrator_HandleRemoteControl and Calibrator_HandleCommandVOLT
+static void Bench_ParseCommand(uint32_t i)
+{
+	uint8_t *command = (uint8_t *) bench_commands[i & 3];
+	double voltage = 0.0;
+	int range = 0;
+	
+	if (Utils_CheckForSubstring(command, "FUNC")) {bench_sink = 1;}
+	else if (Utils_CheckForSubstring(command, "VOLT"))
+	{
+		if (Utils_CheckForSubstring(command, "VOLT ")) {bench_sink = sscanf(command, "VOLT %lf", &voltage);}
+		else if (Utils_CheckForSubstring(command, "VOLT?")) {bench_sink = 2;}
+		else if (Utils_CheckForSubstring(command, "VOLT:RANG ")) {bench_sink = sscanf(command, "VOLT:RANG %d", &range);}
+	}
+}
+
+
+//answer of VOLT? in range 2
+static void Bench_FormatVoltage(uint32_t i)
+{
+	sprintf(bench_string, "%.6f V\n\r", bench_voltages[i & 7] * 0.1);
+	bench_sink = bench_string[0];
+}
+
+
+static const Bench_function bench_functions[] = {
+	{"CLVB_GetVoltageCode R1", Bench_CLVBCodeR1, 1},
+	{"CLVB_GetVoltageCode R2", Bench_CLVBCodeR2, 2},
+	{"CLVB_GetVoltageCode R3", Bench_CLVBCodeR3, 3},
+	{"CCB_GetVoltageCode R2", Bench_CCBCode, 2},
+	{"Utils_HexStringToInt", Bench_HexStringToInt, 2},
+	{"Utils_IntToHexString", Bench_IntToHexString, 2},
+	{"parser (VOLT commands)", Bench_ParseCommand, 2},
+	{"formatter (VOLT?)", Bench_FormatVoltage, 2}
+};
+
+
+int main(void)
+{
+	uint8_t line[100];
+	
+	SCB->CPACR |= (0xF << 20);		//enable FPU (CP10, CP11), not used with FLOAT=soft
+	Bench_InitTimer();
+	
+	CLVB_state.mode = CLVB_MODE_DC;
+	CLVB_state.dithering_state = CLVB_DITHERING_OFF;
+	CCB_state.dithering_state = CCB_DITHERING_OFF;
+	
+	uint64_t overhead = Bench_Measure(Bench_Empty);		//loop and call, subtracted from every function
+	
+	sprintf(line, "# %s per call, %u calls, overhead %lu\n", BENCH_UNIT, BENCH_REPEATS, (unsigned long) (Bench_ConvertTicks(overhead) / BENCH_REPEATS));
+	Bench_Print(line);
+	
+	for (uint8_t f = 0; f < (sizeof(bench_functions) / sizeof(bench_functions[0])); f++)
+	{
+		CLVB_state.range = bench_functions[f].range;
+		CCB_state.range = bench_functions[f].range;
+	
+		uint64_t ticks = Bench_Measure(bench_functions[f].function);
+		ticks = (ticks > overhead) ? (ticks - overhead) : 0;
+	
+		sprintf(line, "%s,%lu\n", bench_functions[f].name, (unsigned long) (Bench_ConvertTicks(ticks) / BENCH_REPEATS));
+		Bench_Print(line);
+	}
+	
+	Bench_Exit(0);
+	
+	while (1);
+}
@@ -0,0 +1,75 @@
+#include "Bench.h"
+
+
+//symbols of linker script Bench.ld
+extern uint32_t _estack;
+extern uint32_t _sidata, _sdata, _edata, _sbss, _ebss;
+
+int main(void);
+void Reset_Handler(void);
+void Default_Handler(void);
+void SysTick_Handler(void);
+
+//only core exceptions are used, interrupts of peripherals stay disabled
+__attribute__((section(".isr_vector"), used))
+static void (* const vector_table[16])(void) = {
+	(void (*)(void)) &_estack,
+	Reset_Handler,
+	Default_Handler,		//NMI
+	Default_Handler,		//HardFault
+	Default_Handler,		//MemManage
+	Default_Handler,		//BusFault
+	Default_Handler,		//UsageFault
+	0, 0, 0, 0,
+	Default_Handler,		//SVCall
+	Default_Handler,		//DebugMon
+	0,
+	Default_Handler,		//PendSV
+	SysTick_Handler
+};
+
+
+void Reset_Handler(void)
+{
+	uint32_t *source = &_sidata;
+	uint32_t *destination = &_sdata;
+	
+	while (destination < &_edata) {*destination++ = *source++;}		//copy initialized data from flash
+	for (destination = &_sbss; destination < &_ebss; destination++) {*destination = 0;}		//clear bss
+	
+	main();
+	Bench_Exit(1);
+}
+
+
+void Default_Handler(void)
+{
+	Bench_Print("fault\n");
+	Bench_Exit(2);
+}
+
+
+static uint32_t Bench_Semihosting(uint32_t operation, void *argument)
+{
+	register uint32_t r0 __asm__("r0") = operation;
+	register void *r1 __asm__("r1") = argument;
+	
+	__asm__ volatile ("bkpt 0xAB" : "+r" (r0) : "r" (r1) : "memory");
+	
+	return r0;
+}
+
+
+void Bench_Print(uint8_t *string)
+{
+	Bench_Semihosting(0x04, string);		//SYS_WRITE0
+}
+
+
+void Bench_Exit(uint32_t status)
+{
+	uint32_t argument[2] = {0x20026, status};		//ADP_Stopped_ApplicationExit, exit code
+	
+	Bench_Semihosting(0x20, argument);		//SYS_EXIT_EXTENDED
+	while (1);
+}
@@ -0,0 +1,48 @@
+#include "STM32F429ZI_UART.h"
+#include "STM32F429ZI_Delay.h"
+
+//UART and delay are not used by benchmarked functions, but CLVB.c, CCB.c and Calibrator_module.c reference them
+//modules never answer, so every write into register ends with ERROR_COMMUNICATION
+
+
+void UART_SendByte(UART *UARTx, uint8_t byte)
+{
+}
+
+
+void UART_SendString(UART *UARTx, uint8_t *string)
+{
+}
+
+
+uint8_t UART_ReadByte(UART *UARTx)
+{
+	return 0;
+}
+
+
+void UART_ReadLine(UART *UARTx, uint8_t *string)
+{
+	string[0] = '\0';
+}
+
+
+uint8_t UART_AvailableBytes(UART *UARTx)
+{
+	return 0;
+}
+
+
+void UART_ClearRXBuffer(UART *UARTx)
+{
+}
+
+
+void delay_us(uint16_t us)
+{
+}
+
+
+void delay_ms(uint16_t ms)
+{
+}
@@ -8,6 +8,7 @@
 #define REG_H_SIZE		4
 #define REG_I_SIZE		8
 
+#define TRG						15
 #define LED_4R 				14
 #define LED_4G 				13
 #define LED_3R 				12
@@ -50,6 +51,10 @@ volatile static uint32_t register_I = 0x00000000;
 UART* UART_CCB;
 CCB_module_state CCB_state;
 
+static CCB_module_state CCB_state_saved;		//state before batch of commands (CCB_SaveState)
+static uint16_t register_H_saved = 0x0000;
+static uint32_t register_I_saved = 0x00000000;
+
 uint8_t CCB_Init(UART *UART_handle)
 {
 	uint8_t error = NO_ERROR;
@@ -88,6 +93,7 @@ uint8_t CCB_Init(UART *UART_handle)
 	CCB_state.output_state = CCB_OUTPUT_OFF;
 	CCB_state.autorange_state = CCB_AUTORANGE_OFF;
 	CCB_state.dithering_state = CCB_DITHERING_OFF;
+	CCB_state.trigger_state = CCB_TRIGGER_OFF;
 	
 	return error;
 }
@@ -156,6 +162,15 @@ uint8_t CCB_Autorange(double current)
 }
 
 
+uint8_t CCB_CheckCurrent(double current)
+{
+	//same check as CCB_SetCurrent does before any write into module
+	if (CCB_state.autorange_state == CCB_AUTORANGE_OFF) {return CCB_CheckRange(current);}
+	
+	return CCB_Autorange(current);
+}
+
+
 void CCB_AutorangeON(void)
 {
 	CCB_state.autorange_state = CCB_AUTORANGE_ON;
@@ -216,6 +231,30 @@ uint8_t CCB_DitheringOFF(void)
 }
 
 
+uint8_t CCB_TriggerON(void)
+{
+	uint8_t error = NO_ERROR;
+	
+	register_H = Utils_SetBit(register_H, TRG);
+	error = Module_WriteToRegister(UART_CCB, H, register_H, REG_H_SIZE);
+	if (error == NO_ERROR) {CCB_state.trigger_state = CCB_TRIGGER_ON;}
+	
+	return error;
+}
+
+
+uint8_t CCB_TriggerOFF(void)
+{
+	uint8_t error = NO_ERROR;
+	
+	register_H = Utils_ClearBit(register_H, TRG);
+	error = Module_WriteToRegister(UART_CCB, H, register_H, REG_H_SIZE);
+	if (error == NO_ERROR) {CCB_state.trigger_state = CCB_TRIGGER_OFF;}
+	
+	return error;
+}
+
+
 uint8_t CCB_SetCurrent(double current)
 {
 	uint8_t error = NO_ERROR;
@@ -246,6 +285,8 @@ uint32_t CCB_GetVoltageCode(double current)
 {
 	uint32_t code = 0x00000000;
 	
+	PROFILER_START(PROFILER_CODE);
+		
 	if (CCB_state.dithering_state == 0)		//if dithering is off
 	{
 		if (CCB_state.range == 1)
@@ -277,6 +318,8 @@ uint32_t CCB_GetVoltageCode(double current)
 		}
 	}
 	
+	PROFILER_STOP(PROFILER_CODE);
+	
 	return code;
 }
 
@@ -323,6 +366,34 @@ uint8_t CCB_GetDitheringState(void)
 }
 
 
+uint8_t CCB_GetTriggerState(void)
+{
+	return CCB_state.trigger_state;
+}
+
+
+uint32_t CCB_GetCode(void)
+{
+	return register_I;		//code of DAC written with the last current
+}
+
+
+void CCB_SaveState(void)
+{
+	CCB_state_saved = CCB_state;
+	register_H_saved = register_H;
+	register_I_saved = register_I;
+}
+
+
+void CCB_RestoreState(void)
+{
+	CCB_state = CCB_state_saved;
+	register_H = register_H_saved;
+	register_I = register_I_saved;
+}
+
+
 uint8_t CCB_PrintRegisters(UART *UART_USB)
 {
 	uint8_t error = NO_ERROR;
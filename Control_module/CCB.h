@@ -22,6 +22,8 @@
 #define CCB_AUTORANGE_ON			1
 #define CCB_DITHERING_OFF			0
 #define CCB_DITHERING_ON			1
+#define CCB_TRIGGER_OFF				0
+#define CCB_TRIGGER_ON				1
 
 #define LED_4R 								14		//not active module
 #define LED_4G 								13		//active module
@@ -39,6 +41,7 @@ typedef struct
 	uint8_t output_state;
 	uint8_t autorange_state;
 	uint8_t dithering_state;
+	uint8_t trigger_state;
 } CCB_module_state;
 
 
@@ -52,6 +55,8 @@ uint8_t CCB_CheckRange(double current);
 
 uint8_t CCB_Autorange(double current);
 
+uint8_t CCB_CheckCurrent(double current);
+
 void CCB_AutorangeON(void);
 
 void CCB_AutorangeOFF(void);
@@ -64,6 +69,10 @@ uint8_t CCB_DitheringON(void);
 
 uint8_t CCB_DitheringOFF(void);
 
+uint8_t CCB_TriggerON(void);
+
+uint8_t CCB_TriggerOFF(void);
+
 uint8_t CCB_SetCurrent(double current);
 
 uint32_t CCB_GetVoltageCode(double current);
@@ -80,8 +89,17 @@ uint8_t CCB_GetOutputState(void);
 
 uint8_t CCB_GetDitheringState(void);
 
+uint8_t CCB_GetTriggerState(void);
+
 uint8_t CCB_GetMode(void);
 
+uint32_t CCB_GetCode(void);
+
+//state and copies of registers are restored after failed batch of commands
+void CCB_SaveState(void);
+
+void CCB_RestoreState(void);
+
 //debugging only
 uint8_t CCB_PrintRegisters(UART *UART_USB);
 
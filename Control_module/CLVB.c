@@ -5,11 +5,14 @@
 #define H							72
 #define I							73
 #define J							74
+#define K							75
 #define REG_G_SIZE		4
 #define REG_H_SIZE		4
 #define REG_I_SIZE		8
 #define REG_J_SIZE		8
+#define REG_K_SIZE		8
 
+#define TRG						15
 #define LED_4R 				14
 #define LED_4G 				13
 #define LED_3R 				12
@@ -51,10 +54,17 @@ volatile static uint16_t register_G = 0x0000;
 volatile static uint16_t register_H = 0x0000;
 volatile static uint32_t register_I = 0x00000000;
 volatile static uint32_t register_J = 0x00000000;
+volatile static uint32_t register_K = 0x00000000;
 
 UART* UART_CLVB;
 CLVB_module_state CLVB_state;
 
+static CLVB_module_state CLVB_state_saved;		//state before batch of commands (CLVB_SaveState)
+static uint16_t register_H_saved = 0x0000;
+static uint32_t register_I_saved = 0x00000000;
+static uint32_t register_J_saved = 0x00000000;
+static uint32_t register_K_saved = 0x00000000;
+
 
 uint8_t CLVB_Init(UART *UART_handle)
 {
@@ -96,6 +106,7 @@ uint8_t CLVB_Init(UART *UART_handle)
 	CLVB_state.output_state = CLVB_OUTPUT_OFF;
 	CLVB_state.autorange_state = CLVB_AUTORANGE_OFF;
 	CLVB_state.dithering_state = CLVB_DITHERING_OFF;
+	CLVB_state.trigger_state = CLVB_TRIGGER_OFF;
 	
 	return error;
 }
@@ -114,30 +125,18 @@ uint8_t CLVB_TurnOFFModule(void)
 
 uint8_t CLVB_SetRange(uint8_t range)
 {
-	uint8_t error = NO_ERROR;
+	//manual range change uses register K as autorange, DAC is parked at 0 V while relays switch
+	//set voltage is kept if it is within new range, otherwise output is set to 0 V
 	
-	if ((range < 1) || (range > 3)) {error = ERROR_NONEXISTENT_RANGE; return error;}
+	double voltage = CLVB_state.voltage;
 	
-	if (range == 1)
-	{
-		register_H = Utils_SetBit(register_H, K2);
-		register_H = Utils_SetBit(register_H, K3);
-	}
-	else if (range == 2)
-	{
-		register_H = Utils_ClearBit(register_H, K2);
-		register_H = Utils_SetBit(register_H, K3);
-	}
-	else if (range == 3)
-	{
-		register_H = Utils_ClearBit(register_H, K2);
-		register_H = Utils_ClearBit(register_H, K3);
-	}
+	if ((range < 1) || (range > 3)) {return ERROR_NONEXISTENT_RANGE;}
 	
-	error = Module_WriteToRegister(UART_CLVB, H, register_H, REG_H_SIZE);
-	if (error == NO_ERROR) {CLVB_state.range = range;}
+	if ((range == 1) && ((voltage > CLVB_R1_max) || (voltage < CLVB_R1_min))) {voltage = 0.0;}
+	else if ((range == 2) && ((voltage > CLVB_R2_max) || (voltage < CLVB_R2_min))) {voltage = 0.0;}
+	else if ((range == 3) && ((voltage > CLVB_R3_max) || (voltage < CLVB_R3_min))) {voltage = 0.0;}
 	
-	return error;
+	return CLVB_SetRangeAndVoltage(range, voltage);
 }
 
 
@@ -166,6 +165,77 @@ uint8_t CLVB_Autorange(double voltage)
 }
 
 
+uint8_t CLVB_CheckVoltage(double voltage)
+{
+	//same check as CLVB_SetVoltageDC/AC does before any write into module
+	uint8_t error = NO_ERROR;
+	
+	if (CLVB_state.autorange_state == CLVB_AUTORANGE_OFF) {error = CLVB_CheckRange(voltage);}
+	else if (CLVB_SelectRange(voltage) == 0) {error = ERROR_VOLT_RANGE;}
+	
+	return error;
+}
+
+
+uint8_t CLVB_SelectRange(double voltage)
+{
+	uint8_t range = 0;
+	
+	if ((voltage <= CLVB_R1_max) && (voltage >= CLVB_R1_min)) {range = 1;}
+	else if ((voltage <= CLVB_R2_max) && (voltage >= CLVB_R2_min)) {range = 2;}
+	else if ((voltage <= CLVB_R3_max) && (voltage >= CLVB_R3_min)) {range = 3;}
+	
+	return range;		//0 if voltage is out of all ranges
+}
+
+
+uint8_t CLVB_SetRangeAndVoltage(uint8_t range, double voltage)
+{
+	//range change is done by single write into register K
+	//FPGA parks DAC at 0 V, switches relays and after settling loads new code
+	
+	uint8_t error = NO_ERROR;
+	uint8_t range_last = CLVB_state.range;
+	uint16_t register_H_new = register_H;
+	uint32_t code = 0x00000000;
+	
+	if ((range < 1) || (range > 3)) {error = ERROR_NONEXISTENT_RANGE; return error;}
+	
+	if (range == 1)
+	{
+		register_H_new = Utils_SetBit(register_H_new, K2);
+		register_H_new = Utils_SetBit(register_H_new, K3);
+	}
+	else if (range == 2)
+	{
+		register_H_new = Utils_ClearBit(register_H_new, K2);
+		register_H_new = Utils_SetBit(register_H_new, K3);
+	}
+	else if (range == 3)
+	{
+		register_H_new = Utils_ClearBit(register_H_new, K2);
+		register_H_new = Utils_ClearBit(register_H_new, K3);
+	}
+	
+	CLVB_state.range = range;		//code is calculated for new range
+	if ((CLVB_state.dithering_state == CLVB_DITHERING_OFF) || (CLVB_state.mode == CLVB_MODE_AC))
+	{
+		code = (CLVB_GetVoltageCode(voltage) << 4);			//without dithering
+	}
+	else {code = CLVB_GetVoltageCode(voltage);}
+	
+	register_K = ((uint32_t) (register_H_new & 0x0007) << 24) | (code & 0x00FFFFFF);		//relays K3, K2, K1 + code
+	error = Module_WriteToRegister(UART_CLVB, K, register_K, REG_K_SIZE);					//update register K
+	if (error != NO_ERROR) {CLVB_state.range = range_last; return error;}				//in case of any problem, return error
+	
+	register_H = register_H_new;		//FPGA does not change registers H and I, copies are kept for next writes
+	register_I = code;
+	CLVB_state.voltage = voltage;
+	
+	return error;
+}
+
+
 void CLVB_AutorangeON(void)
 {
 	CLVB_state.autorange_state = CLVB_AUTORANGE_ON;
@@ -224,16 +294,45 @@ uint8_t CLVB_DitheringOFF(void)
 }
 
 
+uint8_t CLVB_TriggerON(void)
+{
+	uint8_t error = NO_ERROR;
+	
+	register_H = Utils_SetBit(register_H, TRG);
+	error = Module_WriteToRegister(UART_CLVB, H, register_H, REG_H_SIZE);
+	if (error == NO_ERROR) {CLVB_state.trigger_state = CLVB_TRIGGER_ON;}
+	
+	return error;
+}
+
+
+uint8_t CLVB_TriggerOFF(void)
+{
+	uint8_t error = NO_ERROR;
+	
+	register_H = Utils_ClearBit(register_H, TRG);
+	error = Module_WriteToRegister(UART_CLVB, H, register_H, REG_H_SIZE);
+	if (error == NO_ERROR) {CLVB_state.trigger_state = CLVB_TRIGGER_OFF;}
+	
+	return error;
+}
+
+
 uint8_t CLVB_SetVoltageDC(double voltage)
 {
 	uint8_t error = NO_ERROR;
+	uint8_t range = CLVB_state.range;
 	
 	//handle range
 	if (CLVB_state.autorange_state == CLVB_AUTORANGE_OFF)
 	{
 		error = CLVB_CheckRange(voltage);				//if autorange is OFF, check if voltage is within selected range
 	}
-	else {error = CLVB_Autorange(voltage);}		//if autorange is ON, find correct range and set it
+	else
+	{
+		range = CLVB_SelectRange(voltage);			//if autorange is ON, find correct range (set together with voltage)
+		if (range == 0) {error = ERROR_VOLT_RANGE;}
+	}
 	if (error != NO_ERROR) {return error;}		//in case of any problem, return error
 	
 	//handle mode
@@ -242,6 +341,13 @@ uint8_t CLVB_SetVoltageDC(double voltage)
 	if (error != NO_ERROR) {return error;}		//in case of any problem, return error
 	else {CLVB_state.mode = CLVB_MODE_DC;}
 	
+	//handle range change together with voltage
+	if (range != CLVB_state.range)
+	{
+		error = CLVB_SetRangeAndVoltage(range, voltage);
+		return error;
+	}
+	
 	//handle voltage
 	if (CLVB_state.dithering_state == CLVB_DITHERING_OFF)
 	{
@@ -259,13 +365,18 @@ uint8_t CLVB_SetVoltageDC(double voltage)
 uint8_t CLVB_SetVoltageAC(double voltage, double frequency)
 {
 	uint8_t error = NO_ERROR;
+	uint8_t range = CLVB_state.range;
 	
 	//handle range
 	if (CLVB_state.autorange_state == CLVB_AUTORANGE_OFF)
 	{
 		error = CLVB_CheckRange(voltage);				//if autorange is OFF, check if voltage is within selected range
 	}
-	else {error = CLVB_Autorange(voltage);}		//if autorange is ON, find correct range and set it
+	else
+	{
+		range = CLVB_SelectRange(voltage);			//if autorange is ON, find correct range (set together with voltage)
+		if (range == 0) {error = ERROR_VOLT_RANGE;}
+	}
 	if (error != NO_ERROR) {return error;}		//in case of any problem, return error
 	
 	//handle frequency
@@ -278,6 +389,13 @@ uint8_t CLVB_SetVoltageAC(double voltage, double frequency)
 	if (error != NO_ERROR) {return error;}		//in case of any problem, return error
 	else {CLVB_state.mode = CLVB_MODE_AC;}
 	
+	//handle range change together with voltage
+	if (range != CLVB_state.range)
+	{
+		error = CLVB_SetRangeAndVoltage(range, voltage);
+		return error;
+	}
+	
 	//handle voltage
 	register_I = (CLVB_GetVoltageCode(voltage) << 4);			//when generating AC voltage, no dithering is applied
 	error = Module_WriteToRegister(UART_CLVB, I, register_I, REG_I_SIZE);		//update register I
@@ -292,6 +410,8 @@ uint32_t CLVB_GetVoltageCode(double voltage)
 {
 	uint32_t code = 0x00000000;
 	
+	PROFILER_START(PROFILER_CODE);
+		
 	if ((CLVB_state.dithering_state == 0) || (CLVB_state.mode == CLVB_MODE_AC))		//if dithering is off or when generating AC signal
 	{
 		if (CLVB_state.range == 1)
@@ -323,6 +443,8 @@ uint32_t CLVB_GetVoltageCode(double voltage)
 		}
 	}
 	
+	PROFILER_STOP(PROFILER_CODE);
+	
 	return code;
 }
 
@@ -404,12 +526,44 @@ uint8_t CLVB_GetDitheringState(void)
 }
 
 
+uint8_t CLVB_GetTriggerState(void)
+{
+	return CLVB_state.trigger_state;
+}
+
+
 uint8_t CLVB_GetMode(void)
 {
 	return CLVB_state.mode;
 }
 
 
+uint32_t CLVB_GetCode(void)
+{
+	return register_I;		//code of DAC written with the last voltage
+}
+
+
+void CLVB_SaveState(void)
+{
+	CLVB_state_saved = CLVB_state;
+	register_H_saved = register_H;
+	register_I_saved = register_I;
+	register_J_saved = register_J;
+	register_K_saved = register_K;
+}
+
+
+void CLVB_RestoreState(void)
+{
+	CLVB_state = CLVB_state_saved;
+	register_H = register_H_saved;
+	register_I = register_I_saved;
+	register_J = register_J_saved;
+	register_K = register_K_saved;
+}
+
+
 uint8_t CLVB_PrintRegisters(UART *UART_USB)
 {
 	uint8_t error = NO_ERROR;
@@ -24,6 +24,8 @@
 #define CLVB_AUTORANGE_ON			1
 #define CLVB_DITHERING_OFF		0
 #define CLVB_DITHERING_ON			1
+#define CLVB_TRIGGER_OFF			0
+#define CLVB_TRIGGER_ON				1
 
 
 typedef struct
@@ -35,6 +37,7 @@ typedef struct
 	uint8_t output_state;
 	uint8_t autorange_state;
 	uint8_t dithering_state;
+	uint8_t trigger_state;
 } CLVB_module_state;
 
 
@@ -48,6 +51,12 @@ uint8_t CLVB_CheckRange(double voltage);
 
 uint8_t CLVB_Autorange(double voltage);
 
+uint8_t CLVB_CheckVoltage(double voltage);
+
+uint8_t CLVB_SelectRange(double voltage);
+
+uint8_t CLVB_SetRangeAndVoltage(uint8_t range, double voltage);
+
 void CLVB_AutorangeON(void);
 
 void CLVB_AutorangeOFF(void);
@@ -60,6 +69,10 @@ uint8_t CLVB_DitheringON(void);
 
 uint8_t CLVB_DitheringOFF(void);
 
+uint8_t CLVB_TriggerON(void);
+
+uint8_t CLVB_TriggerOFF(void);
+
 uint8_t CLVB_SetVoltageDC(double voltage);
 
 uint8_t CLVB_SetVoltageAC(double voltage, double frequency);
@@ -84,8 +97,17 @@ uint8_t CLVB_GetOutputState(void);
 
 uint8_t CLVB_GetDitheringState(void);
 
+uint8_t CLVB_GetTriggerState(void);
+
 uint8_t CLVB_GetMode(void);
 
+uint32_t CLVB_GetCode(void);
+
+//state and copies of registers are restored after failed batch of commands
+void CLVB_SaveState(void);
+
+void CLVB_RestoreState(void);
+
 //debugging only
 uint8_t CLVB_PrintRegisters(UART *UART_USB);
 
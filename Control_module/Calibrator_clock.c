@@ -0,0 +1,32 @@
+#include "Calibrator_clock.h"
+
+
+static uint64_t clock_cycles = 0;				//DWT->CYCCNT extended to 64 bits
+static uint32_t clock_last_cycles = 0;
+
+
+void Clock_Init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;		//enable trace and debug blocks (DWT)
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;							//start cycle counter
+	
+	clock_last_cycles = DWT->CYCCNT;
+	clock_cycles = 0;
+}
+
+
+uint32_t Clock_GetCycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+
+uint64_t Clock_Tick(void)
+{
+	uint32_t now = DWT->CYCCNT;
+	
+	clock_cycles += (uint32_t) (now - clock_last_cycles);		//correct after overflow of counter
+	clock_last_cycles = now;
+	
+	return clock_cycles;
+}
@@ -0,0 +1,37 @@
+//=====================================================================
+//Time base of firmware - DWT cycle counter of Cortex-M4, shared by
+//profiler, trace, status events and telemetry stream, 32-bit counter
+//is extended to 64 bits (overflow of CYCCNT every 23 s at 180 MHz)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "stm32f429xx.h"
+#include <stdint.h>
+
+
+#ifndef CALIBRATOR_CLOCK_H_
+#define CALIBRATOR_CLOCK_H_
+
+#define CLOCK_CPU_FREQ				180000000		//HCLK, DWT counts core clock cycles
+#define CLOCK_CYCLES_PER_MS		(CLOCK_CPU_FREQ / 1000)
+#define CLOCK_CYCLES_PER_US		(CLOCK_CPU_FREQ / 1000000)
+
+/**
+* @brief - enable DWT cycle counter, time since reset starts from 0, called once before other modules which use time
+* @returns - nothing
+*/
+void Clock_Init(void);
+
+/**
+* @brief - get value of DWT cycle counter, difference of two values is correct after overflow (intervals up to 23 s)
+* @returns - number of cycles (32 bits)
+*/
+uint32_t Clock_GetCycles(void);
+
+/**
+* @brief - extend DWT cycle counter to 64 bits, must be called more often than every 23 s (main loop)
+* @returns - number of cycles since Clock_Init
+*/
+uint64_t Clock_Tick(void);
+
+#endif
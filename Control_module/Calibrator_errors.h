@@ -12,5 +12,8 @@
 #define ERROR_CURR_RANGE					8		//specified current is out of selected range
 #define ERROR_FREQ_RANGE					9		//specified frequency is out of range
 #define ERROR_NONEXISTENT_RANGE		10	//specified range does not exist
+#define ERROR_MODULE_NOT_SELECTED	11	//command needs selected module, but no module is selected
+#define ERROR_SYNC_NOT_ARMED			12	//synchronized value is sent, but modules are not armed (SYNC:ARM)
+#define ERROR_LOCKED							13	//command changes outputs, but other session owns lock (SYST:LOCK ON)
 
 #endif
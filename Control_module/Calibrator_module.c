@@ -8,6 +8,57 @@ volatile static uint32_t reg_J;
 volatile static uint32_t reg_K;
 volatile static uint32_t reg_L;
 
+typedef struct
+{
+	UART *UART_handle;
+	uint8_t reg_name;
+	uint32_t data;
+	uint8_t tag;				//command which wrote the data
+} Module_write;
+
+static uint8_t transaction_open = 0;
+static Module_write transaction_writes[MODULE_TRANSACTION_SIZE];
+static uint8_t transaction_count = 0;
+static uint8_t transaction_tag = 0;
+
+
+static uint32_t Module_GetRegister(uint8_t reg_name)
+{
+	if (reg_name == 'G') {return reg_G;}
+	else if (reg_name == 'H') {return reg_H;}
+	else if (reg_name == 'I') {return reg_I;}
+	else if (reg_name == 'J') {return reg_J;}
+	else if (reg_name == 'K') {return reg_K;}
+	else if (reg_name == 'L') {return reg_L;}
+	
+	return 0x00000000;
+}
+
+
+static uint8_t Module_AddToTransaction(UART* UART_handle, uint8_t reg_name, uint32_t data)
+{
+	//register written more times is checked only with the last data
+	for (uint8_t i = 0; i < transaction_count; i++)
+	{
+		if ((transaction_writes[i].UART_handle == UART_handle) && (transaction_writes[i].reg_name == reg_name))
+		{
+			transaction_writes[i].data = data;
+			transaction_writes[i].tag = transaction_tag;
+			return 1;
+		}
+	}
+	
+	if (transaction_count >= MODULE_TRANSACTION_SIZE) {return 0;}
+	
+	transaction_writes[transaction_count].UART_handle = UART_handle;
+	transaction_writes[transaction_count].reg_name = reg_name;
+	transaction_writes[transaction_count].data = data;
+	transaction_writes[transaction_count].tag = transaction_tag;
+	transaction_count++;
+	
+	return 1;
+}
+
 
 uint8_t Module_WriteToRegister(UART* UART_handle, uint8_t reg_name, uint32_t data, uint8_t hex_size)
 {
@@ -15,6 +66,7 @@ uint8_t Module_WriteToRegister(UART* UART_handle, uint8_t reg_name, uint32_t dat
 	uint8_t string[50];
 	uint32_t reg = 0x00000000;
 	
+	PROFILER_START(PROFILER_TRANSFER);
 	Utils_IntToHexString(data, string, hex_size);
 	
 	UART_SendByte(UART_handle, reg_name);		//send first letter (name of register)
@@ -23,8 +75,13 @@ uint8_t Module_WriteToRegister(UART* UART_handle, uint8_t reg_name, uint32_t dat
 	UART_SendByte(UART_handle, '\r');				//send end of message
 	
 	delay_ms(10);
+	PROFILER_STOP(PROFILER_TRANSFER);
+	
+	if ((transaction_open == 1) && (Module_AddToTransaction(UART_handle, reg_name, data) == 1)) {return error;}		//checked at commit
 	
+	PROFILER_START(PROFILER_VERIFY);
 	error = Module_ReadRegister(UART_handle, reg_name, &reg);						//get content of register
+	PROFILER_STOP(PROFILER_VERIFY);
 	if (error != NO_ERROR) {return error;}
 	else if (reg != data) {error = ERROR_COMMUNICATION; return error;}	//check if register was written correctly
 	
@@ -32,6 +89,51 @@ uint8_t Module_WriteToRegister(UART* UART_handle, uint8_t reg_name, uint32_t dat
 }
 
 
+void Module_BeginTransaction(void)
+{
+	transaction_open = 1;
+	transaction_count = 0;
+	transaction_tag = 0;
+}
+
+
+void Module_SetTransactionTag(uint8_t tag)
+{
+	transaction_tag = tag;
+}
+
+
+uint8_t Module_CommitTransaction(uint8_t *tag)
+{
+	uint8_t error = NO_ERROR;
+	uint8_t checked[MODULE_TRANSACTION_SIZE] = {0};
+	
+	transaction_open = 0;
+	*tag = 0;
+	
+	PROFILER_START(PROFILER_VERIFY);
+	for (uint8_t i = 0; (i < transaction_count) && (error == NO_ERROR); i++)
+	{
+		if (checked[i] == 1) {continue;}
+		
+		//one reading of all registers checks all writes into this module
+		error = Module_ReadAllRegisters(transaction_writes[i].UART_handle);
+		if (error != NO_ERROR) {*tag = transaction_writes[i].tag;}		//module does not answer, first write into it failed
+		for (uint8_t j = i; (j < transaction_count) && (error == NO_ERROR); j++)
+		{
+			if (transaction_writes[j].UART_handle != transaction_writes[i].UART_handle) {continue;}
+			if (Module_GetRegister(transaction_writes[j].reg_name) != transaction_writes[j].data) {error = ERROR_COMMUNICATION; *tag = transaction_writes[j].tag;}
+			checked[j] = 1;
+		}
+	}
+	PROFILER_STOP(PROFILER_VERIFY);
+	
+	transaction_count = 0;
+	
+	return error;
+}
+
+
 uint8_t Module_ReadAllRegisters(UART* UART_handle)
 {
 	uint8_t error = NO_ERROR;
@@ -89,7 +191,7 @@ uint8_t Module_ReadAllRegisters(UART* UART_handle)
 uint8_t Module_ReadRegister(UART* UART_handle, uint8_t reg_name, uint32_t *data)
 {
 	uint8_t error = NO_ERROR;
-	data = 0x00000000;
+	*data = 0x00000000;
 	
 	error = Module_ReadAllRegisters(UART_handle);
 	if (error != NO_ERROR) {return error;}
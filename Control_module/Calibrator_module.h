@@ -10,11 +10,14 @@
 #include "STM32F429ZI_Delay.h"
 #include "Calibrator_utils.h"
 #include "Calibrator_errors.h"
+#include "Calibrator_profiler.h"
 
 
 #ifndef CALIBRATOR_MODULE_H_
 #define CALIBRATOR_MODULE_H_
 
+#define MODULE_TRANSACTION_SIZE		12		//registers G-L of two modules, when full, writes are verified immediately
+
 /**
 * @brief - write data into register and check if data were written correctly
 * @param UART_handle - UART type handle of UART line to which is module connected
@@ -25,6 +28,26 @@
 */
 uint8_t Module_WriteToRegister(UART* UART_handle, uint8_t reg_name, uint32_t data, uint8_t hex_size);
 
+/**
+* @brief - start transaction, Module_WriteToRegister only sends data and their check is postponed to Module_CommitTransaction
+* @returns - nothing
+*/
+void Module_BeginTransaction(void);
+
+/**
+* @brief - mark next writes of transaction, so failed write can be assigned to command which made it
+* @param tag - number of command (e.g. index of command in line)
+* @returns - nothing
+*/
+void Module_SetTransactionTag(uint8_t tag);
+
+/**
+* @brief - finish transaction, registers of every module are read once and compared with the last data written into them
+* @param tag - tag of the first failed write (Module_SetTransactionTag), 0 if all writes were correct
+* @returns - NO_ERROR if all registers were written correctly, error if not
+*/
+uint8_t Module_CommitTransaction(uint8_t *tag);
+
 /**
 * @brief - read all registers from device and save them to defined variables
 * @param UART_handle - UART type handle of UART line to which is module connected
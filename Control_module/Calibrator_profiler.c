@@ -0,0 +1,79 @@
+#include "Calibrator_profiler.h"
+
+
+#ifdef CALIBRATOR_PROFILING
+
+#include <stdio.h>
+
+static const char *profiler_stage_names[PROFILER_STAGES] = {"COMMAND", "PARSE", "DISPATCH", "CODE", "TRANSFER", "VERIFY"};
+static const uint32_t profiler_bucket_limits[PROFILER_BUCKETS - 1] = {
+	CLOCK_CPU_FREQ / 100000, CLOCK_CPU_FREQ / 10000, CLOCK_CPU_FREQ / 1000,
+	CLOCK_CPU_FREQ / 100, CLOCK_CPU_FREQ / 10, CLOCK_CPU_FREQ
+};
+
+static Profiler_stage profiler_stages[PROFILER_STAGES];
+static uint32_t profiler_start[PROFILER_STAGES];
+
+
+void Profiler_Init(void)
+{
+	Profiler_Reset();
+}
+
+
+void Profiler_Start(uint8_t stage)
+{
+	profiler_start[stage] = Clock_GetCycles();
+}
+
+
+void Profiler_Stop(uint8_t stage)
+{
+	uint32_t cycles = Clock_GetCycles() - profiler_start[stage];		//correct after overflow of counter (max. 23 s at 180 MHz)
+	Profiler_stage *statistics = &profiler_stages[stage];
+	uint8_t bucket = 0;
+	
+	if ((statistics->count == 0) || (cycles < statistics->min)) {statistics->min = cycles;}
+	if (cycles > statistics->max) {statistics->max = cycles;}
+	statistics->sum += cycles;
+	statistics->count++;
+	
+	while ((bucket < (PROFILER_BUCKETS - 1)) && (cycles >= profiler_bucket_limits[bucket])) {bucket++;}
+	statistics->histogram[bucket]++;
+}
+
+
+void Profiler_Reset(void)
+{
+	for (uint8_t i = 0; i < PROFILER_STAGES; i++)
+	{
+		profiler_stages[i].count = 0;
+		profiler_stages[i].min = 0;
+		profiler_stages[i].max = 0;
+		profiler_stages[i].sum = 0;
+		for (uint8_t j = 0; j < PROFILER_BUCKETS; j++) {profiler_stages[i].histogram[j] = 0;}
+	}
+}
+
+
+void Profiler_SendReport(UART *UART_handle)
+{
+	uint8_t string[200];
+	
+	for (uint8_t i = 0; i < PROFILER_STAGES; i++)
+	{
+		Profiler_stage *statistics = &profiler_stages[i];
+		uint32_t average = (statistics->count > 0) ? (uint32_t) (statistics->sum / statistics->count) : 0;
+	
+		sprintf(string, "%s: N %lu, MIN %lu, AVG %lu, MAX %lu cycles (%.1f/%.1f/%.1f us), HIST %lu,%lu,%lu,%lu,%lu,%lu,%lu\n\r",
+			profiler_stage_names[i], (unsigned long) statistics->count,
+			(unsigned long) statistics->min, (unsigned long) average, (unsigned long) statistics->max,
+			statistics->min * 1e6 / CLOCK_CPU_FREQ, average * 1e6 / CLOCK_CPU_FREQ, statistics->max * 1e6 / CLOCK_CPU_FREQ,
+			(unsigned long) statistics->histogram[0], (unsigned long) statistics->histogram[1], (unsigned long) statistics->histogram[2],
+			(unsigned long) statistics->histogram[3], (unsigned long) statistics->histogram[4], (unsigned long) statistics->histogram[5],
+			(unsigned long) statistics->histogram[6]);
+		UART_SendString(UART_handle, string);
+	}
+}
+
+#endif
@@ -0,0 +1,84 @@
+//=====================================================================
+//Profiling of command handling with DWT cycle counter of Cortex-M4
+//compiled only with CALIBRATOR_PROFILING defined (-DCALIBRATOR_PROFILING),
+//in production build all PROFILER_ macros are empty
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "stm32f429xx.h"
+#include <stdint.h>
+#include "STM32F429ZI_UART.h"
+#include "Calibrator_clock.h"
+
+
+#ifndef CALIBRATOR_PROFILER_H_
+#define CALIBRATOR_PROFILER_H_
+
+#define PROFILER_BUCKETS			7						//<10 us, <100 us, <1 ms, <10 ms, <100 ms, <1 s, >=1 s
+
+//stages of command handling
+#define PROFILER_COMMAND			0		//whole Calibrator_HandleRemoteControl
+#define PROFILER_PARSE				1		//reading of command from USB/Ethernet (Session_ReadCommand which completes line)
+#define PROFILER_DISPATCH			2		//selection and execution of handler (includes stages below)
+#define PROFILER_CODE					3		//calculation of DAC code (CLVB_GetVoltageCode, CCB_GetVoltageCode)
+#define PROFILER_TRANSFER			4		//sending of register to module (Module_WriteToRegister)
+#define PROFILER_VERIFY				5		//read back and check of register (Module_WriteToRegister)
+#define PROFILER_STAGES				6
+
+#ifdef CALIBRATOR_PROFILING
+
+#define PROFILER_INIT()				Profiler_Init()
+#define PROFILER_START(stage)	Profiler_Start(stage)
+#define PROFILER_STOP(stage)	Profiler_Stop(stage)
+
+typedef struct
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t histogram[PROFILER_BUCKETS];
+} Profiler_stage;
+
+/**
+* @brief - clear statistics of all stages (DWT cycle counter is started by Clock_Init)
+* @returns - nothing
+*/
+void Profiler_Init(void);
+
+/**
+* @brief - save start of stage (Clock_GetCycles)
+* @param stage - stage of command handling (PROFILER_COMMAND, PROFILER_PARSE...)
+* @returns - nothing
+*/
+void Profiler_Start(uint8_t stage);
+
+/**
+* @brief - add cycles since Profiler_Start to statistics of stage (min, max, average, histogram)
+* @param stage - stage of command handling
+* @returns - nothing
+*/
+void Profiler_Stop(uint8_t stage);
+
+/**
+* @brief - clear statistics of all stages
+* @returns - nothing
+*/
+void Profiler_Reset(void);
+
+/**
+* @brief - send statistics of all stages, one line per stage (count, min/avg/max in cycles and us, histogram)
+* @param UART_handle - UART where statistics are sent
+* @returns - nothing
+*/
+void Profiler_SendReport(UART *UART_handle);
+
+#else
+
+#define PROFILER_INIT()
+#define PROFILER_START(stage)
+#define PROFILER_STOP(stage)
+
+#endif
+
+#endif
@@ -0,0 +1,266 @@
+#include "Calibrator_session.h"
+#include "Calibrator_utils.h"
+#include "Calibrator_errors.h"
+#include <stdio.h>
+#include <string.h>
+
+
+static uint8_t session_lock_owner = SESSION_NONE;
+
+typedef struct
+{
+	int16_t code;				//SCPI error number
+	uint8_t esr;				//bit of standard event status register
+	const char *text;
+} Session_error_code;
+
+//SCPI numbers of firmware errors, index is error code of Calibrator_errors.h
+static const Session_error_code session_error_codes[] = {
+	{0, 0, "No error"},																		//NO_ERROR
+	{-102, SESSION_ESR_CME, "Syntax error"},								//ERROR_USER_INPUT
+	{-113, SESSION_ESR_CME, "Undefined header"},						//ERROR_UNKNOWN_COMMAND
+	{-240, SESSION_ESR_DDE, "Hardware error"},							//ERROR_COMMUNICATION
+	{-241, SESSION_ESR_DDE, "Hardware missing"},						//ERROR_WRONG_MODULE
+	{-221, SESSION_ESR_EXE, "Settings conflict"},					//ERROR_VOLT_NOT_SELECTED
+	{-221, SESSION_ESR_EXE, "Settings conflict"},					//ERROR_CURR_NOT_SELECTED
+	{-222, SESSION_ESR_EXE, "Data out of range"},					//ERROR_VOLT_RANGE
+	{-222, SESSION_ESR_EXE, "Data out of range"},					//ERROR_CURR_RANGE
+	{-222, SESSION_ESR_EXE, "Data out of range"},					//ERROR_FREQ_RANGE
+	{-224, SESSION_ESR_EXE, "Illegal parameter value"},		//ERROR_NONEXISTENT_RANGE
+	{-221, SESSION_ESR_EXE, "Settings conflict"},					//ERROR_MODULE_NOT_SELECTED
+	{-221, SESSION_ESR_EXE, "Settings conflict"},					//ERROR_SYNC_NOT_ARMED
+	{-203, SESSION_ESR_EXE, "Command protected"},					//ERROR_LOCKED
+};
+
+static const Session_error_code session_error_overflow = {-350, SESSION_ESR_DDE, "Queue overflow"};
+
+
+static const Session_error_code *Session_GetErrorCode(uint8_t error)
+{
+	if (error < (sizeof(session_error_codes) / sizeof(session_error_codes[0]))) {return &session_error_codes[error];}
+	
+	return &session_error_overflow;
+}
+
+
+void Session_Init(Session *session, UART *UART_handle, uint8_t id)
+{
+	memset(session, 0, sizeof(Session));
+	session->UART_handle = UART_handle;
+	session->id = id;
+	session->error = NO_ERROR;
+	session->module_selected = 0;		//MODULE_NONE
+	session->verbose = 1;						//long error messages as before, for terminal and older clients
+}
+
+
+uint8_t Session_ReadCommand(Session *session)
+{
+	uint8_t c = 0;
+	uint8_t received = 0;
+	
+	while (UART_AvailableBytes(session->UART_handle) > 0)
+	{
+		c = UART_ReadByte(session->UART_handle);
+		received = 1;
+		if ((c >= 'a') && (c <= 'z')) {c -= 32;}		//convert lowercase letters to capital letters
+	
+		if ((c == '\n') || (c == '\r'))							//finish string, '\n' is not part of command
+		{
+			session->line[session->length] = '\0';
+			session->error = (session->overflow == 1) ? ERROR_USER_INPUT : NO_ERROR;
+			session->length = 0;
+			session->overflow = 0;
+			session->wait_counter = 0;
+			return 1;
+		}
+	
+		if (session->length < (SESSION_LINE_SIZE - 1)) {session->line[session->length++] = c;}
+		else {session->overflow = 1;}		//rest of line is read and dropped
+	}
+	
+	if ((session->length == 0) && (session->overflow == 0)) {return 0;}		//nothing was received
+	
+	//timeout in case user did not send '\n' at the end of string
+	if (received == 1) {session->wait_counter = 0;}
+	else if (++session->wait_counter > SESSION_TIMEOUT)
+	{
+		session->line[session->length] = '\0';
+		session->error = ERROR_USER_INPUT;
+		session->length = 0;
+		session->overflow = 0;
+		session->wait_counter = 0;
+		return 1;
+	}
+	
+	return 0;
+}
+
+
+uint8_t Session_SplitLine(Session *session, uint8_t **commands, uint8_t max_count)
+{
+	uint8_t count = 0;
+	uint8_t length = 0;
+	uint8_t *command = session->line;
+	uint8_t *end;
+	
+	//check of whole line first, line with error stays unchanged for error queue and trace
+	for (uint8_t i = 0; ; i++)
+	{
+		if ((session->line[i] == ';') || (session->line[i] == '\0'))
+		{
+			if (length >= SESSION_COMMAND_SIZE) {session->error = ERROR_USER_INPUT;}
+			if (length > 0) {count++;}
+			if (session->line[i] == '\0') {break;}
+			length = 0;
+		}
+		else if ((session->line[i] != ' ') || (length > 0)) {length++;}		//spaces after ';' are not part of command
+	}
+	
+	if (count > max_count) {session->error = ERROR_USER_INPUT;}
+	if (session->error != NO_ERROR) {commands[0] = session->line; return 1;}
+	if (count == 0) {commands[0] = &session->line[strlen(session->line)]; return 1;}		//empty command, nothing is executed
+	
+	//';' are replaced by '\0', commands point into line
+	count = 0;
+	while (command != NULL)
+	{
+		while (*command == ' ') {command++;}
+		end = strchr(command, ';');
+		if (end != NULL) {*end++ = '\0';}
+		if (command[0] != '\0') {commands[count++] = command;}
+		command = end;
+	}
+	
+	return count;
+}
+
+
+uint8_t Session_IsReceiving(Session *session)
+{
+	return (session->length > 0) || (session->overflow == 1);
+}
+
+
+static uint8_t Session_IsQuery(uint8_t *command)
+{
+	uint8_t i = 0;
+	
+	//header must end with '?' ("VOLT?"), "VOLT 0.5?" is set-point with ignored '?'
+	while ((command[i] != '\0') && (command[i] != ' ') && (command[i] != '?')) {i++;}
+	if (command[i] != '?') {return 0;}
+	
+	for (i++; command[i] != '\0'; i++)
+	{
+		if (command[i] != ' ') {return 0;}
+	}
+	
+	return 1;
+}
+
+
+uint8_t Session_IsAllowed(Session *session, uint8_t *command)
+{
+	if ((session_lock_owner == SESSION_NONE) || (session_lock_owner == session->id)) {return 1;}
+	if (Session_IsQuery(command) == 1) {return 1;}					//queries do not change outputs (monitoring session)
+	if (Utils_CheckForSubstring(command, "FUNC")) {return 1;}			//module is selected only for this session
+	if (Utils_CheckForSubstring(command, "STAT")) {return 1;}			//events and their notifications of this session
+	if (Utils_CheckForSubstring(command, "SYST:LOCK")) {return 1;}
+	if (Utils_CheckForSubstring(command, "SYST:ERR")) {return 1;}				//error queue and status of this session
+	if (Utils_CheckForSubstring(command, "SYST:STREAM ON")) {return 1;}	//frames to own port, port and period of owner are changed only by owner
+	if (Utils_CheckForSubstring(command, "*CLS") || Utils_CheckForSubstring(command, "*OPC")) {return 1;}
+	
+	return 0;
+}
+
+
+void Session_PushError(Session *session, uint8_t *command)
+{
+	Session_error *entry;
+	const Session_error_code *code = Session_GetErrorCode(session->error);
+	
+	session->esr |= code->esr;
+	
+	//full queue, the newest error is replaced and the oldest ones are kept (as in SCPI)
+	if (session->error_count >= SESSION_ERROR_QUEUE_SIZE)
+	{
+		entry = &session->errors[(session->error_first + SESSION_ERROR_QUEUE_SIZE - 1) % SESSION_ERROR_QUEUE_SIZE];
+		entry->error = SESSION_ERROR_OVERFLOW;
+		entry->command[0] = '\0';
+		session->esr |= session_error_overflow.esr;
+		return;
+	}
+	
+	entry = &session->errors[(session->error_first + session->error_count) % SESSION_ERROR_QUEUE_SIZE];
+	entry->error = session->error;
+	snprintf(entry->command, SESSION_COMMAND_SIZE, "%s", command);
+	session->error_count++;
+}
+
+
+void Session_SendError(Session *session)
+{
+	Session_error *entry = &session->errors[session->error_first];
+	const Session_error_code *code;
+	
+	if (session->error_count == 0)
+	{
+		UART_SendString(session->UART_handle, "0,\"No error\"\n\r");
+		return;
+	}
+	
+	//command is added as device specific information, client sees which of pipelined commands failed
+	code = Session_GetErrorCode(entry->error);
+	if (entry->command[0] == '\0') {sprintf(session->response, "%d,\"%s\"\n\r", code->code, code->text);}
+	else {sprintf(session->response, "%d,\"%s;%s\"\n\r", code->code, code->text, entry->command);}
+	UART_SendString(session->UART_handle, session->response);
+	
+	session->error_first = (session->error_first + 1) % SESSION_ERROR_QUEUE_SIZE;
+	session->error_count--;
+}
+
+
+void Session_ClearStatus(Session *session)
+{
+	session->error_first = 0;
+	session->error_count = 0;
+	session->esr = 0;
+	session->event_register = 0;
+}
+
+
+uint8_t Session_ReadEventStatus(Session *session)
+{
+	uint8_t esr = session->esr;
+	
+	session->esr = 0;
+	
+	return esr;
+}
+
+
+uint8_t Session_Lock(Session *session)
+{
+	if ((session_lock_owner != SESSION_NONE) && (session_lock_owner != session->id)) {return ERROR_LOCKED;}
+	
+	session_lock_owner = session->id;
+	
+	return NO_ERROR;
+}
+
+
+uint8_t Session_Unlock(Session *session)
+{
+	if (session_lock_owner == SESSION_NONE) {return NO_ERROR;}
+	if (session_lock_owner != session->id) {return ERROR_LOCKED;}
+	
+	session_lock_owner = SESSION_NONE;
+	
+	return NO_ERROR;
+}
+
+
+uint8_t Session_GetLockOwner(void)
+{
+	return session_lock_owner;
+}
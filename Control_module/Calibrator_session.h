@@ -0,0 +1,161 @@
+//=====================================================================
+//Sessions of remote control (USB and Ethernet) - every session has its
+//own command reader, error, answer buffer and selected module, commands
+//which change outputs can be reserved for one session (SYST:LOCK)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "stm32f429xx.h"
+#include <stdint.h>
+#include "STM32F429ZI_UART.h"
+
+
+#ifndef CALIBRATOR_SESSION_H_
+#define CALIBRATOR_SESSION_H_
+
+#define SESSION_USB						0
+#define SESSION_ETHERNET			1
+#define SESSION_COUNT					2
+#define SESSION_NONE					0xFF		//nobody owns lock
+
+#define SESSION_LINE_SIZE			128			//line with more commands separated by ';', longer lines end with ERROR_USER_INPUT
+#define SESSION_COMMAND_SIZE	50			//longer commands end with ERROR_USER_INPUT
+#define SESSION_BATCH_SIZE		16			//maximum number of commands in one line
+#define SESSION_RESPONSE_SIZE	400			//TRIG:LIST? with TRIGGER_LIST_SIZE values (12 characters each)
+#define SESSION_TIMEOUT				100			//unfinished line is dropped after 100 calls without new byte (main loop waits 10 ms)
+#define SESSION_ERROR_QUEUE_SIZE	10		//when queue is full, the newest error is replaced by "Queue overflow"
+#define SESSION_ERROR_OVERFLOW		0xFF
+
+//bits of standard event status register (*ESR?)
+#define SESSION_ESR_OPC				0x01		//operation complete (*OPC)
+#define SESSION_ESR_QYE				0x04		//query error
+#define SESSION_ESR_DDE				0x08		//device dependent error (module communication, queue overflow)
+#define SESSION_ESR_EXE				0x10		//execution error (value out of range, module not selected, lock)
+#define SESSION_ESR_CME				0x20		//command error (syntax, unknown command)
+
+typedef struct
+{
+	uint8_t error;												//error code of firmware (Calibrator_errors.h) or SESSION_ERROR_OVERFLOW
+	uint8_t command[SESSION_COMMAND_SIZE];	//command which caused error
+} Session_error;
+
+typedef struct
+{
+	UART *UART_handle;
+	uint8_t id;														//SESSION_USB or SESSION_ETHERNET
+	
+	//command reader, line is collected over more calls, other session is not blocked
+	uint8_t line[SESSION_LINE_SIZE];
+	uint8_t length;
+	uint8_t overflow;											//1 = line is longer than line buffer
+	uint8_t wait_counter;
+	
+	uint8_t error;												//error of current command
+	uint8_t module_selected;							//MODULE_NONE, MODULE_CLVB or MODULE_CCB (FUNC)
+	uint8_t response[SESSION_RESPONSE_SIZE];		//answer of query
+	
+	//error queue (SYST:ERR?) and status, error message is sent immediately only in verbose mode (default)
+	Session_error errors[SESSION_ERROR_QUEUE_SIZE];
+	uint8_t error_first;
+	uint8_t error_count;
+	uint8_t esr;
+	uint8_t verbose;
+	
+	//operation events (Calibrator_status.c), enabled events are sent as notifications
+	uint8_t event_register;
+	uint8_t event_enable;
+} Session;
+
+/**
+* @brief - init session on USB or Ethernet UART, no module is selected
+* @param session - session to be initialized
+* @param UART_handle - UART of session
+* @param id - SESSION_USB or SESSION_ETHERNET
+* @returns - nothing
+*/
+void Session_Init(Session *session, UART *UART_handle, uint8_t id);
+
+/**
+* @brief - read received bytes into line of session (lowercase letters are converted to capital), returns after end of line
+*          or when there are no more bytes, so unfinished line of one session does not block other session
+* @param session - session which reads
+* @returns - 1 if line is complete (or ERROR_USER_INPUT after timeout or too long line), 0 if not
+*/
+uint8_t Session_ReadCommand(Session *session);
+
+/**
+* @brief - split complete line into commands separated by ';' (spaces after ';' and empty commands are skipped),
+*          line is not changed and ERROR_USER_INPUT is set when command is too long or there are too many commands
+* @param session - session with complete line
+* @param commands - array of pointers into line, filled with commands
+* @param max_count - size of array (SESSION_BATCH_SIZE)
+* @returns - number of commands (empty line is one empty command)
+*/
+uint8_t Session_SplitLine(Session *session, uint8_t **commands, uint8_t max_count);
+
+/**
+* @brief - check if session has unfinished line (main loop waits for rest of line)
+* @param session - session to be checked
+* @returns - 1 if line is unfinished, 0 if not
+*/
+uint8_t Session_IsReceiving(Session *session);
+
+/**
+* @brief - check if session can execute command, queries (header ends with '?', nothing follows), FUNC, STAT, SYST:LOCK, SYST:ERR, SYST:STREAM ON, *CLS and *OPC are allowed for every session,
+*          other commands only for owner of lock or when nobody owns lock
+* @param session - session which received command
+* @param command - received command
+* @returns - 1 if command is allowed, 0 if not
+*/
+uint8_t Session_IsAllowed(Session *session, uint8_t *command);
+
+/**
+* @brief - save error of command into error queue and set bit of standard event status register
+* @param session - session where error occurred
+* @param command - command which caused error
+* @returns - nothing
+*/
+void Session_PushError(Session *session, uint8_t *command);
+
+/**
+* @brief - send and remove the oldest error in SCPI format, e.g. "-222,\"Data out of range;VOLT 50\"" or "0,\"No error\""
+* @param session - session which sends error
+* @returns - nothing
+*/
+void Session_SendError(Session *session);
+
+/**
+* @brief - remove all errors from queue and clear standard event status register and operation event register (*CLS)
+* @param session - session to be cleared
+* @returns - nothing
+*/
+void Session_ClearStatus(Session *session);
+
+/**
+* @brief - read and clear standard event status register (*ESR?)
+* @param session - session which reads register
+* @returns - value of register
+*/
+uint8_t Session_ReadEventStatus(Session *session);
+
+/**
+* @brief - get ownership of outputs (SYST:LOCK ON)
+* @param session - session which requests lock
+* @returns - NO_ERROR, or ERROR_LOCKED if other session owns lock
+*/
+uint8_t Session_Lock(Session *session);
+
+/**
+* @brief - release ownership of outputs (SYST:LOCK OFF)
+* @param session - session which releases lock
+* @returns - NO_ERROR, or ERROR_LOCKED if other session owns lock
+*/
+uint8_t Session_Unlock(Session *session);
+
+/**
+* @brief - get owner of lock
+* @returns - SESSION_USB, SESSION_ETHERNET or SESSION_NONE
+*/
+uint8_t Session_GetLockOwner(void);
+
+#endif
@@ -0,0 +1,83 @@
+#include "Calibrator_status.h"
+#include <stdio.h>
+
+
+static Session *status_sessions = 0;
+static uint8_t status_session_count = 0;
+
+static uint8_t status_settling[STATUS_MODULES];
+static uint32_t status_settle_start[STATUS_MODULES];
+
+static const uint16_t status_settle_ms[STATUS_MODULES] = {STATUS_SETTLE_CLVB_MS, STATUS_SETTLE_CCB_MS};
+static const char *status_module_names[STATUS_MODULES] = {"VOLT", "CURR"};
+
+
+void Status_Init(Session *sessions, uint8_t count)
+{
+	status_sessions = sessions;
+	status_session_count = count;
+	
+	for (uint8_t i = 0; i < STATUS_MODULES; i++) {status_settling[i] = 0;}
+}
+
+
+static void Status_Notify(Session *session, uint8_t event, const char *source)
+{
+	uint8_t string[24];
+	const char *name;
+	
+	session->event_register |= event;
+	if ((session->event_enable & event) == 0) {return;}
+	
+	if (event == STATUS_EVENT_OPC) {name = "OPC";}
+	else if (event == STATUS_EVENT_SETTLED) {name = "SETTLED";}
+	else if (event == STATUS_EVENT_FAULT) {name = "FAULT";}
+	else {name = "LIST";}
+	
+	//'!' is never first character of answer, client can separate notifications from answers
+	if (source[0] == '\0') {sprintf(string, "!%s\n\r", name);}
+	else {sprintf(string, "!%s %s\n\r", name, source);}
+	UART_SendString(session->UART_handle, string);
+}
+
+
+void Status_Post(Session *session, uint8_t event, const char *source)
+{
+	if (session != 0) {Status_Notify(session, event, source); return;}
+	
+	for (uint8_t i = 0; i < status_session_count; i++) {Status_Notify(&status_sessions[i], event, source);}
+}
+
+
+void Status_StartSettling(uint8_t module)
+{
+	status_settling[module] = 1;
+	status_settle_start[module] = Clock_GetCycles();		//next switching of relays extends settling
+}
+
+
+void Status_Tick(void)
+{
+	for (uint8_t i = 0; i < STATUS_MODULES; i++)
+	{
+		if (status_settling[i] == 0) {continue;}
+	
+		//correct after overflow of counter (max. 23 s at 180 MHz)
+		if ((uint32_t) (Clock_GetCycles() - status_settle_start[i]) >= (status_settle_ms[i] * CLOCK_CYCLES_PER_MS))
+		{
+			status_settling[i] = 0;
+			Status_Post(0, STATUS_EVENT_SETTLED, status_module_names[i]);
+		}
+	}
+}
+
+
+uint8_t Status_GetCondition(void)
+{
+	for (uint8_t i = 0; i < STATUS_MODULES; i++)
+	{
+		if (status_settling[i] == 1) {return STATUS_EVENT_SETTLED;}
+	}
+	
+	return 0;
+}
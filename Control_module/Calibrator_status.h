@@ -0,0 +1,67 @@
+//=====================================================================
+//Status subsystem - operation events (operation complete, relays
+//settled, module fault, trigger list finished) are latched in every
+//session and pushed as unsolicited "!" lines when enabled by session
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "stm32f429xx.h"
+#include <stdint.h>
+#include "Calibrator_session.h"
+#include "Calibrator_clock.h"
+
+
+#ifndef CALIBRATOR_STATUS_H_
+#define CALIBRATOR_STATUS_H_
+
+//bits of operation event register (STAT:OPER?, STAT:OPER:ENAB)
+#define STATUS_EVENT_OPC			0x01		//all previous commands of session are complete (*OPC)
+#define STATUS_EVENT_SETTLED	0x02		//relays of module are settled after range change or output ON/OFF
+#define STATUS_EVENT_FAULT		0x04		//communication with module failed
+#define STATUS_EVENT_LIST			0x08		//last value of trigger list was applied
+
+//modules with relays
+#define STATUS_CLVB						0
+#define STATUS_CCB						1
+#define STATUS_MODULES				2
+
+#define STATUS_SETTLE_CLVB_MS	17			//range sequence of CLVB: 2 ms park, 10 ms relays, 5 ms settle
+#define STATUS_SETTLE_CCB_MS	15			//range sequence of CCB: 10 ms relay pulse, 5 ms settle
+
+/**
+* @brief - no module is settling after reset (time base of settling is Calibrator_clock)
+* @param sessions - sessions which receive events
+* @param count - number of sessions
+* @returns - nothing
+*/
+void Status_Init(Session *sessions, uint8_t count);
+
+/**
+* @brief - latch event in event register of session and send notification "!<event> <source>" if event is enabled
+* @param session - session which receives event, NULL = all sessions
+* @param event - STATUS_EVENT_OPC, STATUS_EVENT_SETTLED...
+* @param source - "VOLT", "CURR" or "" (module which caused event)
+* @returns - nothing
+*/
+void Status_Post(Session *session, uint8_t event, const char *source);
+
+/**
+* @brief - relays of module were switched, STATUS_EVENT_SETTLED is posted after settling time
+* @param module - STATUS_CLVB or STATUS_CCB
+* @returns - nothing
+*/
+void Status_StartSettling(uint8_t module);
+
+/**
+* @brief - post STATUS_EVENT_SETTLED for modules whose settling time elapsed, called in main loop
+* @returns - nothing
+*/
+void Status_Tick(void);
+
+/**
+* @brief - get operation condition (STAT:OPER:COND?)
+* @returns - STATUS_EVENT_SETTLED while relays of any module are settling, 0 if not
+*/
+uint8_t Status_GetCondition(void);
+
+#endif
@@ -0,0 +1,81 @@
+#include "Calibrator_stream.h"
+
+
+static Session *stream_session = 0;
+static uint32_t stream_period_ms = STREAM_PERIOD_DEFAULT_MS;
+static uint32_t stream_dropped = 0;
+
+static uint64_t stream_next_frame = 0;		//cycles since Clock_Init
+
+
+void Stream_Init(void)
+{
+	stream_session = 0;
+}
+
+
+void Stream_Start(Session *session)
+{
+	stream_session = session;
+	stream_next_frame = Clock_Tick();
+	stream_dropped = 0;
+}
+
+
+void Stream_Stop(void)
+{
+	stream_session = 0;
+}
+
+
+void Stream_SetPeriod(uint32_t period_ms)
+{
+	stream_period_ms = period_ms;
+	stream_next_frame = Clock_Tick() + (uint64_t) period_ms * CLOCK_CYCLES_PER_MS;		//next frame after new period
+}
+
+
+uint32_t Stream_GetPeriod(void)
+{
+	return stream_period_ms;
+}
+
+
+Session *Stream_GetSession(void)
+{
+	return stream_session;
+}
+
+
+uint8_t Stream_IsDue(void)
+{
+	uint64_t now = Clock_Tick();
+	
+	if ((stream_session == 0) || (now < stream_next_frame)) {return 0;}
+	
+	//frames keep their period, frames missed during long command are not sent later
+	stream_next_frame += (uint64_t) stream_period_ms * CLOCK_CYCLES_PER_MS;
+	if (stream_next_frame <= now) {stream_next_frame = now + (uint64_t) stream_period_ms * CLOCK_CYCLES_PER_MS;}
+	
+	return 1;
+}
+
+
+uint32_t Stream_GetTime_ms(void)
+{
+	return (uint32_t) (Clock_Tick() / CLOCK_CYCLES_PER_MS);
+}
+
+
+void Stream_Send(uint8_t *frame)
+{
+	if (stream_session == 0) {return;}
+	
+	if (UART_QueueString(stream_session->UART_handle, frame) == 0) {stream_dropped++;}
+}
+
+
+uint32_t Stream_GetDropped(void)
+{
+	return stream_dropped;
+}
@@ -0,0 +1,84 @@
+//=====================================================================
+//Telemetry stream (SYST:STREAM) - state frames are sent periodically
+//to one port through TX buffer of UART, command handling is not
+//blocked, frame which does not fit into TX buffer is dropped
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "stm32f429xx.h"
+#include <stdint.h>
+#include "Calibrator_session.h"
+#include "Calibrator_clock.h"
+
+
+#ifndef CALIBRATOR_STREAM_H_
+#define CALIBRATOR_STREAM_H_
+
+#define STREAM_PERIOD_MIN_MS	200					//frame has about 150 characters, it takes 160 ms at 9600 Bd
+#define STREAM_PERIOD_MAX_MS	3600000
+#define STREAM_PERIOD_DEFAULT_MS	1000
+
+/**
+* @brief - stream is OFF after reset (time base is Calibrator_clock)
+* @returns - nothing
+*/
+void Stream_Init(void);
+
+/**
+* @brief - start stream on port of session, the first frame is sent immediately
+* @param session - session whose UART receives frames
+* @returns - nothing
+*/
+void Stream_Start(Session *session);
+
+/**
+* @brief - stop stream, frames in TX buffer are still sent
+* @returns - nothing
+*/
+void Stream_Stop(void);
+
+/**
+* @brief - set period of frames
+* @param period_ms - period from STREAM_PERIOD_MIN_MS to STREAM_PERIOD_MAX_MS
+* @returns - nothing
+*/
+void Stream_SetPeriod(uint32_t period_ms);
+
+/**
+* @brief - get period of frames
+* @returns - period in milliseconds
+*/
+uint32_t Stream_GetPeriod(void);
+
+/**
+* @brief - get session which receives frames
+* @returns - session, NULL if stream is OFF
+*/
+Session *Stream_GetSession(void);
+
+/**
+* @brief - check if next frame should be sent, called in main loop (more often than every 23 s, it extends Calibrator_clock)
+* @returns - 1 if stream is ON and period elapsed, 0 if not
+*/
+uint8_t Stream_IsDue(void);
+
+/**
+* @brief - get time since reset (timestamp of frame)
+* @returns - time in milliseconds
+*/
+uint32_t Stream_GetTime_ms(void);
+
+/**
+* @brief - queue frame into TX buffer of stream port, frame is dropped if TX buffer is full (slow line or no reader)
+* @param frame - frame finished with '\0'
+* @returns - nothing
+*/
+void Stream_Send(uint8_t *frame);
+
+/**
+* @brief - get number of frames dropped since SYST:STREAM ON
+* @returns - number of dropped frames
+*/
+uint32_t Stream_GetDropped(void);
+
+#endif
@@ -0,0 +1,88 @@
+#include "Calibrator_trace.h"
+
+
+#ifdef CALIBRATOR_TRACE
+
+#include <stdio.h>
+#include <string.h>
+
+static Trace_entry trace_entries[TRACE_SIZE];
+static uint32_t trace_write_pos = 0;
+static uint32_t trace_count = 0;
+static uint32_t trace_overwritten = 0;
+static uint8_t trace_enabled = 0;
+
+static uint64_t trace_start = 0;				//cycles since Clock_Init
+
+
+void Trace_Init(void)
+{
+	trace_enabled = 0;
+	Trace_Clear();
+}
+
+
+void Trace_Start(void)
+{
+	trace_start = Clock_Tick();
+}
+
+
+void Trace_Stop(UART *UART_handle, uint8_t *command, uint8_t error)
+{
+	Trace_entry *entry;
+	uint8_t i = 0;
+	
+	if (trace_enabled == 0) {return;}
+	if ((error == 0) && (command[0] == '\0')) {return;}											//empty line ("\n" after "\r")
+	if (strncmp((char *) command, "SYST:TRAC", 9) == 0) {return;}					//dump of trace is not part of trace
+	
+	entry = &trace_entries[trace_write_pos];
+	entry->time_us = trace_start / CLOCK_CYCLES_PER_US;
+	entry->duration_us = (uint32_t) ((Clock_Tick() - trace_start) / CLOCK_CYCLES_PER_US);
+	entry->port = (UART_handle->UARTx == USART2) ? TRACE_PORT_USB : TRACE_PORT_ETHERNET;
+	entry->error = error;
+	
+	//command is not terminated after timeout of Calibrator_ReadCommand
+	while ((i < (TRACE_COMMAND_SIZE - 1)) && (command[i] != '\0')) {entry->command[i] = command[i]; i++;}
+	entry->command[i] = '\0';
+	
+	trace_write_pos = (trace_write_pos + 1) % TRACE_SIZE;
+	if (trace_count < TRACE_SIZE) {trace_count++;}
+	else {trace_overwritten++;}
+}
+
+
+void Trace_Enable(uint8_t enable)
+{
+	trace_enabled = enable;
+}
+
+
+void Trace_Clear(void)
+{
+	trace_write_pos = 0;
+	trace_count = 0;
+	trace_overwritten = 0;
+}
+
+
+void Trace_SendReport(UART *UART_handle)
+{
+	uint8_t string[120];
+	uint32_t position = (trace_write_pos + TRACE_SIZE - trace_count) % TRACE_SIZE;		//oldest command
+	
+	sprintf(string, "TRACE,%lu,%lu\n\r", (unsigned long) trace_count, (unsigned long) trace_overwritten);
+	UART_SendString(UART_handle, string);
+	
+	for (uint32_t i = 0; i < trace_count; i++)
+	{
+		Trace_entry *entry = &trace_entries[(position + i) % TRACE_SIZE];
+	
+		sprintf(string, "%lu.%06lu,%lu,%s,%u,%s\n\r", (unsigned long) (entry->time_us / 1000000), (unsigned long) (entry->time_us % 1000000),
+			(unsigned long) entry->duration_us, (entry->port == TRACE_PORT_USB) ? "USB" : "ETH", entry->error, entry->command);
+		UART_SendString(UART_handle, string);
+	}
+}
+
+#endif
@@ -0,0 +1,89 @@
+//=====================================================================
+//Trace of remote commands (time, duration, port, error, command) in RAM
+//ring buffer, dumped by SYST:TRAC? and replayed by Host/calibrator_replay
+//compiled only with CALIBRATOR_TRACE defined (-DCALIBRATOR_TRACE),
+//in production build all TRACE_ macros are empty
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "stm32f429xx.h"
+#include <stdint.h>
+#include "STM32F429ZI_UART.h"
+#include "Calibrator_clock.h"
+
+
+#ifndef CALIBRATOR_TRACE_H_
+#define CALIBRATOR_TRACE_H_
+
+#define TRACE_SIZE						128					//number of commands in ring buffer, oldest are overwritten
+#define TRACE_COMMAND_SIZE		50					//command[50] in Calibrator_HandleRemoteControl
+
+#define TRACE_PORT_USB				0
+#define TRACE_PORT_ETHERNET		1
+
+#ifdef CALIBRATOR_TRACE
+
+#define TRACE_INIT()													Trace_Init()
+#define TRACE_START()													Trace_Start()
+#define TRACE_STOP(UART_handle, command, error)	Trace_Stop(UART_handle, command, error)
+
+typedef struct
+{
+	uint64_t time_us;								//start of handling since reset (Clock_Init)
+	uint32_t duration_us;						//whole Calibrator_HandleRemoteControl (including answer)
+	uint8_t port;										//TRACE_PORT_USB or TRACE_PORT_ETHERNET
+	uint8_t error;									//error of command (NO_ERROR, ERROR_USER_INPUT...)
+	uint8_t command[TRACE_COMMAND_SIZE];
+} Trace_entry;
+
+/**
+* @brief - clear trace, tracing is OFF until SYST:TRAC ON (time base is Calibrator_clock)
+* @returns - nothing
+*/
+void Trace_Init(void);
+
+/**
+* @brief - save start of command handling
+* @returns - nothing
+*/
+void Trace_Start(void);
+
+/**
+* @brief - save command into ring buffer (only if tracing is ON, SYST:TRAC commands and empty lines are not saved)
+* @param UART_handle - UART where command was received (USB or Ethernet)
+* @param command - received command
+* @param error - error of command
+* @returns - nothing
+*/
+void Trace_Stop(UART *UART_handle, uint8_t *command, uint8_t error);
+
+/**
+* @brief - turn tracing ON or OFF, content of ring buffer is kept
+* @param enable - 1 = ON, 0 = OFF
+* @returns - nothing
+*/
+void Trace_Enable(uint8_t enable);
+
+/**
+* @brief - remove all commands from ring buffer
+* @returns - nothing
+*/
+void Trace_Clear(void);
+
+/**
+* @brief - send header "TRACE,<count>,<overwritten>" and one line per command from the oldest one:
+*          "<time_s>,<duration_us>,<USB|ETH>,<error>,<command>"
+* @param UART_handle - UART where trace is sent
+* @returns - nothing
+*/
+void Trace_SendReport(UART *UART_handle);
+
+#else
+
+#define TRACE_INIT()
+#define TRACE_START()
+#define TRACE_STOP(UART_handle, command, error)
+
+#endif
+
+#endif
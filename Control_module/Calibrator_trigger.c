@@ -0,0 +1,148 @@
+#include "Calibrator_trigger.h"
+
+
+volatile static uint8_t trigger_event = 0;
+volatile static uint32_t trigger_count = 0;
+
+static double trigger_list[TRIGGER_LIST_SIZE];
+static uint8_t trigger_list_size = 0;
+static uint8_t trigger_list_index = 0;
+
+
+void EXTI15_10_IRQHandler(void)
+{
+	if (EXTI->PR & (1 << TRIGGER_IN_PIN))
+	{
+		EXTI->PR = (1 << TRIGGER_IN_PIN);			//clear pending interrupt (write 1)
+		Trigger_Pulse();											//forward edge to modules immediately, loading of next value is done in main loop
+		trigger_count++;
+		trigger_event = 1;
+	}
+}
+
+
+void Trigger_Init(void)
+{
+	GPIO_InitPin(TRIGGER_OUT_PORT, TRIGGER_OUT_PIN, OUTPUT, PUSH_PULL, VERY_HIGH_SPEED, NO_PULL);
+	GPIO_WritePin(TRIGGER_OUT_PORT, TRIGGER_OUT_PIN, LOW);
+	
+	GPIO_ConfigureExternalInterrupt(TRIGGER_IN_PORT, TRIGGER_IN_PIN, PULL_DOWN, RISING_EDGE, TRIGGER_PRIORITY);
+	Trigger_Disable();		//trigger input is enabled by TRIG ON
+}
+
+
+void Trigger_Enable(void)
+{
+	trigger_event = 0;
+	trigger_count = 0;
+	EXTI->PR = (1 << TRIGGER_IN_PIN);			//edges before enabling are ignored
+	EXTI->IMR |= (1 << TRIGGER_IN_PIN);
+}
+
+
+void Trigger_Disable(void)
+{
+	EXTI->IMR &= ~(1 << TRIGGER_IN_PIN);
+}
+
+
+void Trigger_Pulse(void)
+{
+	volatile uint32_t i;
+	
+	//delay_us is not used, function is called from interrupt and TIM7 delay is not reentrant
+	TRIGGER_OUT_PORT->BSRR = (1 << TRIGGER_OUT_PIN);
+	for (i = 0; i < TRIGGER_PULSE_LENGTH; i++);
+	TRIGGER_OUT_PORT->BSRR = (1 << (TRIGGER_OUT_PIN + 16));
+}
+
+
+void Trigger_Software(void)
+{
+	Trigger_Pulse();
+	trigger_count++;
+	trigger_event = 1;
+}
+
+
+uint8_t Trigger_CheckEvent(void)
+{
+	uint8_t event = trigger_event;
+	
+	trigger_event = 0;
+	
+	return event;
+}
+
+
+uint32_t Trigger_GetCount(void)
+{
+	return trigger_count;
+}
+
+
+void Trigger_ListClear(void)
+{
+	trigger_list_size = 0;
+	trigger_list_index = 0;
+}
+
+
+uint8_t Trigger_ListAdd(double value)
+{
+	if (trigger_list_size >= TRIGGER_LIST_SIZE) {return 0;}
+	
+	trigger_list[trigger_list_size] = value;
+	trigger_list_size++;
+	
+	return 1;
+}
+
+
+void Trigger_ListTruncate(uint8_t size)
+{
+	if (size >= trigger_list_size) {return;}
+	
+	trigger_list_size = size;
+	if (trigger_list_index >= trigger_list_size) {trigger_list_index = 0;}
+}
+
+
+uint8_t Trigger_ListGetSize(void)
+{
+	return trigger_list_size;
+}
+
+
+double Trigger_ListGetValue(uint8_t index)
+{
+	if (index >= trigger_list_size) {return 0.0;}
+	
+	return trigger_list[index];
+}
+
+
+double Trigger_ListNext(void)
+{
+	double value;
+	
+	if (trigger_list_size == 0) {return 0.0;}
+	
+	value = trigger_list[trigger_list_index];
+	trigger_list_index++;
+	if (trigger_list_index >= trigger_list_size) {trigger_list_index = 0;}
+	
+	return value;
+}
+
+
+uint8_t Trigger_ListGetPosition(void)
+{
+	return trigger_list_index;
+}
+
+
+void Trigger_ListRestart(void)
+{
+	trigger_list_index = 0;
+}
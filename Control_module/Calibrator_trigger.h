@@ -0,0 +1,116 @@
+//==================================================
+//Library for hardware trigger of calibrator modules
+//by Martin Praznovsky, 2025
+//==================================================
+
+#include "stm32f429xx.h"
+#include <stdint.h>
+#include "STM32F429ZI_GPIOPins.h"
+
+
+#ifndef CALIBRATOR_TRIGGER_H_
+#define CALIBRATOR_TRIGGER_H_
+
+#define TRIGGER_IN_PORT				GPIOF
+#define TRIGGER_IN_PIN				13			//external trigger input (EXTI15_10)
+#define TRIGGER_OUT_PORT			GPIOF
+#define TRIGGER_OUT_PIN				14			//trigger line to all modules (CLVB FPGA, CCB ADC7)
+#define TRIGGER_PRIORITY			1				//higher priority than UART interrupts
+#define TRIGGER_PULSE_LENGTH	100			//length of trigger pulse in loop cycles (approx. 2 us at 180 MHz)
+
+#define TRIGGER_LIST_SIZE			32			//maximum number of preloaded values
+
+/**
+* @brief - init trigger input (rising edge) and trigger output to modules, trigger input stays disabled
+* @returns - nothing
+*/
+void Trigger_Init(void);
+
+/**
+* @brief - enable interrupt from trigger input, every rising edge is forwarded to modules
+* @returns - nothing
+*/
+void Trigger_Enable(void);
+
+/**
+* @brief - disable interrupt from trigger input
+* @returns - nothing
+*/
+void Trigger_Disable(void);
+
+/**
+* @brief - send pulse on trigger line to modules (software trigger)
+* @returns - nothing
+*/
+void Trigger_Pulse(void);
+
+/**
+* @brief - software trigger, pulse is sent to modules and handled as edge on trigger input
+* @returns - nothing
+*/
+void Trigger_Software(void);
+
+/**
+* @brief - check if trigger occurred since last call, flag is cleared
+* @returns - 1 if trigger occurred, 0 if not
+*/
+uint8_t Trigger_CheckEvent(void);
+
+/**
+* @brief - get number of triggers since last Trigger_Enable
+* @returns - number of triggers
+*/
+uint32_t Trigger_GetCount(void);
+
+/**
+* @brief - remove all values from list of preloaded values
+* @returns - nothing
+*/
+void Trigger_ListClear(void);
+
+/**
+* @brief - add value at the end of list of preloaded values
+* @param value - voltage or current
+* @returns - 1 if value was added, 0 if list is full
+*/
+uint8_t Trigger_ListAdd(double value);
+
+/**
+* @brief - remove values from the end of list of preloaded values
+* @param size - number of values which are kept
+* @returns - nothing
+*/
+void Trigger_ListTruncate(uint8_t size);
+
+/**
+* @brief - get number of values in list of preloaded values
+* @returns - number of values
+*/
+uint8_t Trigger_ListGetSize(void);
+
+/**
+* @brief - get value from list of preloaded values
+* @param index - position in list
+* @returns - value on specified position
+*/
+double Trigger_ListGetValue(uint8_t index);
+
+/**
+* @brief - get next value from list of preloaded values, list is repeated from the beginning after last value
+* @returns - next value
+*/
+double Trigger_ListNext(void);
+
+/**
+* @brief - get position of value which will be loaded by next Trigger_ListNext
+* @returns - position in list (0 = last value of list was loaded, list starts again)
+*/
+uint8_t Trigger_ListGetPosition(void);
+
+/**
+* @brief - start list of preloaded values from the beginning
+* @returns - nothing
+*/
+void Trigger_ListRestart(void);
+
+#endif
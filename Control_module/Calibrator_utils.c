@@ -49,7 +49,7 @@ void Utils_RemoveCharFromString(uint8_t *string, uint8_t index)
 
 void Utils_ClearString(uint8_t *string)
 {
-	uint8_t i = 0;
+	uint16_t i = 0;
 	
 	while(string[i] != '\0')
 	{
@@ -61,8 +61,8 @@ void Utils_ClearString(uint8_t *string)
 
 void Utils_AppendString(uint8_t *string_1, uint8_t *string_2)
 {
-	uint8_t i = 0;
-	uint8_t j = 0;
+	uint16_t i = 0;
+	uint16_t j = 0;
 	
 	while (string_1[i] != '\0') {i++;}		//get to last index of string_1
 	while (string_2[j] != '\0')
@@ -0,0 +1,550 @@
+//=====================================================================
+//Host client library for remote control of calibrator (serial or TCP)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "Calibrator_client.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+
+#define CLIENT_POLL_MS						10			//maximal sleep of I/O thread (check of timeouts)
+#define CLIENT_DISCARD_MS					200			//input is discarded after timeout, late answers must not shift replies
+
+static const char *client_function_names[] = {"NONE", "VOLT", "CURR"};
+
+
+static uint64_t Client_GetTime_us(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return ((uint64_t) now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+
+static speed_t Client_GetSpeed(uint32_t baud_rate)
+{
+	switch (baud_rate)
+	{
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+		case 460800: return B460800;
+		case 921600: return B921600;
+		default: return B0;			//unsupported rate, OpenSerial fails
+	}
+}
+
+
+//answer of fence query (FUNC?)
+static bool Client_IsFenceAnswer(const char *line)
+{
+	return (strcmp(line, "VOLT") == 0) || (strcmp(line, "CURR") == 0) || (strcmp(line, "NONE") == 0);
+}
+
+
+Calibrator_client::Calibrator_client() : fd(-1), running(false), window_commands(8), window_bytes(CLIENT_RX_BUFFER_SIZE - 8),
+	bytes_in_flight(0), timeout_ms(5000), line_length(0), line_overflow(0), discard_until_us(0)
+{
+	wake_pipe[0] = wake_pipe[1] = -1;
+}
+
+
+Calibrator_client::~Calibrator_client()
+{
+	Close();
+}
+
+
+int Calibrator_client::OpenSerial(const char *device, uint32_t baud_rate)
+{
+	struct termios tio;
+	
+	if (Client_GetSpeed(baud_rate) == B0) {fprintf(stderr, "unsupported baud rate %u\n", baud_rate); return 1;}
+	
+	fd = open(device, O_RDWR | O_NOCTTY);
+	if (fd < 0) {fprintf(stderr, "cannot open %s (%s)\n", device, strerror(errno)); return 1;}
+	
+	if (tcgetattr(fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, Client_GetSpeed(baud_rate));
+		cfsetospeed(&tio, Client_GetSpeed(baud_rate));
+		tcsetattr(fd, TCSANOW, &tio);
+		tcflush(fd, TCIOFLUSH);
+	}
+	
+	return Start();
+}
+
+
+int Calibrator_client::OpenTCP(const char *address)
+{
+	char host[256];
+	const char *port;
+	struct addrinfo hints, *info;
+	int flag = 1;
+	
+	port = strrchr(address, ':');
+	if (port == NULL) {fprintf(stderr, "TCP endpoint must be host:port\n"); return 1;}
+	snprintf(host, sizeof(host), "%.*s", (int) (port - address), address);
+	
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(host, port + 1, &hints, &info) != 0) {fprintf(stderr, "cannot resolve %s\n", address); return 1;}
+	
+	fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+	if ((fd < 0) || (connect(fd, info->ai_addr, info->ai_addrlen) != 0))
+	{
+		fprintf(stderr, "cannot connect to %s (%s)\n", address, strerror(errno));
+		freeaddrinfo(info);
+		if (fd >= 0) {close(fd); fd = -1;}
+		return 1;
+	}
+	freeaddrinfo(info);
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));		//short commands must not wait for Nagle
+	
+	return Start();
+}
+
+
+int Calibrator_client::Start(void)
+{
+	if (pipe(wake_pipe) != 0) {close(fd); fd = -1; return 1;}
+	fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+	fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+	
+	running = true;
+	io_thread = std::thread(&Calibrator_client::Run, this);
+	
+	return 0;
+}
+
+
+void Calibrator_client::Close(void)
+{
+	//I/O thread stops also by itself when connection is closed, it must be joined anyway
+	running = false;
+	if (io_thread.joinable())
+	{
+		if (write(wake_pipe[1], "x", 1) < 0) {}
+		io_thread.join();
+	}
+	
+	std::lock_guard<std::mutex> guard(lock);
+	FailAll(CLIENT_ERROR_CLOSED);
+	for (int i = 0; i < 2; i++)
+	{
+		if (wake_pipe[i] >= 0) {close(wake_pipe[i]); wake_pipe[i] = -1;}
+	}
+	if (fd >= 0) {close(fd); fd = -1;}
+}
+
+
+void Calibrator_client::SetWindow(unsigned int commands, unsigned int bytes)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	
+	window_commands = (commands > 0) ? commands : 1;
+	window_bytes = bytes;
+}
+
+
+void Calibrator_client::SetTimeout(unsigned int timeout_ms)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	
+	this->timeout_ms = timeout_ms;
+}
+
+
+std::future<Client_reply> Calibrator_client::Submit(const char *text, uint8_t query)
+{
+	Request request;
+	size_t length = strlen(text);
+	std::future<Client_reply> future = request.promise.get_future();
+	
+	memset(&request.reply, 0, sizeof(request.reply));
+	if ((length == 0) || (length > CLIENT_COMMAND_SIZE) || (fd < 0))
+	{
+		request.reply.status = (fd < 0) ? CLIENT_ERROR_CLOSED : CLIENT_ERROR_COMMAND;
+		request.promise.set_value(request.reply);
+		return future;
+	}
+	
+	memcpy(request.text, text, length + 1);
+	request.query = query;
+	request.bytes = length + 1 + (query ? 0 : (sizeof(CLIENT_FENCE) - 1 + 1));
+	request.sent_us = 0;
+	
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (!running)
+		{
+			//I/O thread has stopped (connection closed), nobody would answer the request
+			request.reply.status = CLIENT_ERROR_CLOSED;
+			request.promise.set_value(request.reply);
+			return future;
+		}
+		queued.push_back(std::move(request));
+	}
+	if (write(wake_pipe[1], "x", 1) < 0) {}		//pipe is full = thread is already woken
+	
+	return future;
+}
+
+
+std::future<Client_reply> Calibrator_client::Command(const char *command)
+{
+	return Submit(command, 0);
+}
+
+
+std::future<Client_reply> Calibrator_client::Query(const char *query)
+{
+	return Submit(query, 1);
+}
+
+
+std::future<Client_reply> Calibrator_client::SelectFunction(Client_function function)
+{
+	char command[16];
+	
+	snprintf(command, sizeof(command), "FUNC %s", client_function_names[function]);
+	
+	return Command(command);
+}
+
+
+std::future<Client_reply> Calibrator_client::SetValue(Client_function function, double value)
+{
+	char command[CLIENT_COMMAND_SIZE + 1];
+	
+	snprintf(command, sizeof(command), "%s %.7f", client_function_names[function], value);
+	
+	return Command(command);
+}
+
+
+std::future<Client_reply> Calibrator_client::SetRange(Client_function function, int range)
+{
+	char command[CLIENT_COMMAND_SIZE + 1];
+	
+	snprintf(command, sizeof(command), "%s:RANG %d", client_function_names[function], range);
+	
+	return Command(command);
+}
+
+
+std::future<Client_reply> Calibrator_client::SetAutorange(Client_function function, bool on)
+{
+	char command[CLIENT_COMMAND_SIZE + 1];
+	
+	snprintf(command, sizeof(command), "%s:RANG:AUTO %s", client_function_names[function], on ? "ON" : "OFF");
+	
+	return Command(command);
+}
+
+
+std::future<Client_reply> Calibrator_client::SetOutput(Client_function function, bool on)
+{
+	char command[CLIENT_COMMAND_SIZE + 1];
+	
+	snprintf(command, sizeof(command), "%s:OUTP %s", client_function_names[function], on ? "ON" : "OFF");
+	
+	return Command(command);
+}
+
+
+std::future<Client_reply> Calibrator_client::SetModeAC(bool AC)
+{
+	return Command(AC ? "VOLT:MODE AC" : "VOLT:MODE DC");
+}
+
+
+std::future<Client_reply> Calibrator_client::SetFrequency(double frequency)
+{
+	char command[CLIENT_COMMAND_SIZE + 1];
+	
+	snprintf(command, sizeof(command), "VOLT:FREQ %.7f", frequency);
+	
+	return Command(command);
+}
+
+
+std::future<Client_state> Calibrator_client::QueryState(Client_function function)
+{
+	const char *name = client_function_names[function];
+	bool voltage = (function == CLIENT_FUNCTION_VOLT);
+	char query[32];
+	
+	std::future<Client_reply> selected = Query("FUNC?");
+	snprintf(query, sizeof(query), "%s?", name);
+	std::future<Client_reply> value = Query(query);
+	snprintf(query, sizeof(query), "%s:RANG?", name);
+	std::future<Client_reply> range = Query(query);
+	snprintf(query, sizeof(query), "%s:OUTP?", name);
+	std::future<Client_reply> output = Query(query);
+	snprintf(query, sizeof(query), "%s:RANG:AUTO?", name);
+	std::future<Client_reply> autorange = Query(query);
+	std::future<Client_reply> mode, frequency;
+	if (voltage)
+	{
+		mode = Query("VOLT:MODE?");
+		frequency = Query("VOLT:FREQ?");
+	}
+	
+	//all queries are already in flight, state is assembled when caller waits for it
+	return std::async(std::launch::deferred, [=](std::future<Client_reply> selected, std::future<Client_reply> value,
+		std::future<Client_reply> range, std::future<Client_reply> output, std::future<Client_reply> autorange,
+		std::future<Client_reply> mode, std::future<Client_reply> frequency)
+	{
+		Client_state state;
+		Client_reply replies[7];
+	
+		memset(&state, 0, sizeof(state));
+		replies[0] = selected.get();
+		replies[1] = value.get();
+		replies[2] = range.get();
+		replies[3] = output.get();
+		replies[4] = autorange.get();
+		if (voltage)
+		{
+			replies[5] = mode.get();
+			replies[6] = frequency.get();
+		}
+	
+		state.status = CLIENT_OK;
+		for (int i = 0; i < (voltage ? 7 : 5); i++)
+		{
+			if (replies[i].status != CLIENT_OK) {state.status = replies[i].status;}
+		}
+	
+		if (strcmp(replies[0].text, "VOLT") == 0) {state.function = CLIENT_FUNCTION_VOLT;}
+		else if (strcmp(replies[0].text, "CURR") == 0) {state.function = CLIENT_FUNCTION_CURR;}
+		else {state.function = CLIENT_FUNCTION_NONE;}
+		state.value = replies[1].value;
+		state.range = (int) replies[2].value;
+		state.output_on = (strstr(replies[3].text, " ON") != NULL);		//"Output ON."
+		state.autorange = (strstr(replies[4].text, " ON") != NULL);		//"Autorange is ON."
+		if (voltage)
+		{
+			state.AC_mode = (strncmp(replies[5].text, "AC", 2) == 0);		//"AC mode."
+			state.frequency = replies[6].value;
+		}
+	
+		return state;
+	}, std::move(selected), std::move(value), std::move(range), std::move(output), std::move(autorange), std::move(mode),
+		std::move(frequency));
+}
+
+
+std::vector<Client_reply> Calibrator_client::Batch(const std::vector<std::string> &commands)
+{
+	std::vector<std::future<Client_reply>> futures;
+	std::vector<Client_reply> replies;
+	
+	futures.reserve(commands.size());
+	replies.reserve(commands.size());
+	
+	for (const std::string &command : commands)
+	{
+		bool query = (!command.empty()) && (command.back() == '?');
+		futures.push_back(Submit(command.c_str(), query));
+	}
+	for (std::future<Client_reply> &future : futures) {replies.push_back(future.get());}
+	
+	return replies;
+}
+
+
+void Calibrator_client::Finish(Request &request, Client_status status)
+{
+	if ((request.reply.status == CLIENT_OK) || (status != CLIENT_OK)) {request.reply.status = status;}
+	request.reply.latency_ms = (request.sent_us > 0) ? ((Client_GetTime_us() - request.sent_us) / 1000.0) : 0.0;
+	request.promise.set_value(request.reply);
+}
+
+
+void Calibrator_client::FailAll(Client_status status)
+{
+	while (!in_flight.empty())
+	{
+		Finish(in_flight.front(), status);
+		in_flight.pop_front();
+	}
+	while (!queued.empty())
+	{
+		Finish(queued.front(), status);
+		queued.pop_front();
+	}
+	bytes_in_flight = 0;
+}
+
+
+//write queued requests while window allows, called with lock
+void Calibrator_client::WriteQueued(void)
+{
+	while ((!queued.empty()) && (in_flight.size() < window_commands)
+		&& ((in_flight.empty()) || ((bytes_in_flight + queued.front().bytes) <= window_bytes)))
+	{
+		Request &request = queued.front();
+		char data[CLIENT_COMMAND_SIZE + sizeof(CLIENT_FENCE) + 2];
+		int length;
+	
+		//fence query after command, its answer comes after possible error message of command
+		if (request.query) {length = snprintf(data, sizeof(data), "%s\n", request.text);}
+		else {length = snprintf(data, sizeof(data), "%s\n" CLIENT_FENCE "\n", request.text);}
+	
+		for (int written = 0; written < length; )
+		{
+			ssize_t result = write(fd, data + written, length - written);
+			if (result <= 0)
+			{
+				if ((result < 0) && (errno == EINTR)) {continue;}
+				FailAll(CLIENT_ERROR_CLOSED);
+				return;
+			}
+			written += result;
+		}
+	
+		request.sent_us = Client_GetTime_us();
+		bytes_in_flight += request.bytes;
+		in_flight.push_back(std::move(request));
+		queued.pop_front();
+	}
+}
+
+
+//line of answer is matched with oldest request in flight, called with lock
+void Calibrator_client::HandleLine(void)
+{
+	if (in_flight.empty() || (Client_GetTime_us() < discard_until_us)) {return;}
+	if ((line[0] == '!') || (line[0] == '#')) {return;}		//notification (STAT:OPER:ENAB) or frame of SYST:STREAM, not an answer
+	
+	Request &request = in_flight.front();
+	bool error = (strncmp(line, "ERROR", 5) == 0);
+	
+	if (request.query)
+	{
+		memcpy(request.reply.text, line, sizeof(request.reply.text));
+		request.reply.truncated = line_overflow;
+		request.reply.value = strtod(line, NULL);
+		Finish(request, error ? CLIENT_ERROR_REPLY : CLIENT_OK);
+	}
+	else if (error)
+	{
+		//error message of command, fence answer follows
+		memcpy(request.reply.text, line, sizeof(request.reply.text));
+		request.reply.truncated = line_overflow;
+		request.reply.status = CLIENT_ERROR_REPLY;
+		return;
+	}
+	else if (Client_IsFenceAnswer(line)) {Finish(request, CLIENT_OK);}
+	else
+	{
+		//unexpected answer (query sent as command), it is kept as text, fence answer still follows
+		memcpy(request.reply.text, line, sizeof(request.reply.text));
+		request.reply.truncated = line_overflow;
+		return;
+	}
+	
+	bytes_in_flight -= request.bytes;
+	in_flight.pop_front();
+}
+
+
+//parse received bytes into lines in fixed buffer, firmware ends answers with "\n\r" (empty lines are skipped)
+void Calibrator_client::ReadInput(void)
+{
+	char data[256];
+	ssize_t length = read(fd, data, sizeof(data));
+	
+	std::lock_guard<std::mutex> guard(lock);
+	
+	if (length <= 0)
+	{
+		if ((length < 0) && ((errno == EINTR) || (errno == EAGAIN))) {return;}
+		FailAll(CLIENT_ERROR_CLOSED);
+		running = false;
+		return;
+	}
+	
+	for (ssize_t i = 0; i < length; i++)
+	{
+		if ((data[i] == '\n') || (data[i] == '\r'))
+		{
+			if (line_length > 0)
+			{
+				line[line_length] = '\0';
+				HandleLine();
+			}
+			line_length = 0;
+			line_overflow = 0;
+		}
+		else if (line_length < (CLIENT_LINE_SIZE - 1)) {line[line_length++] = data[i];}
+		else {line_overflow = 1;}
+	}
+}
+
+
+//after timeout, all requests in flight fail (position of their answers is unknown), called with lock
+void Calibrator_client::CheckTimeout(void)
+{
+	if (in_flight.empty()) {return;}
+	
+	if ((Client_GetTime_us() - in_flight.front().sent_us) > ((uint64_t) timeout_ms * 1000))
+	{
+		while (!in_flight.empty())
+		{
+			Finish(in_flight.front(), CLIENT_ERROR_TIMEOUT);
+			in_flight.pop_front();
+		}
+		bytes_in_flight = 0;
+		line_length = 0;
+		line_overflow = 0;
+		discard_until_us = Client_GetTime_us() + (CLIENT_DISCARD_MS * 1000);
+	}
+}
+
+
+void Calibrator_client::Run(void)
+{
+	while (running)
+	{
+		struct pollfd fds[2] = {{fd, POLLIN, 0}, {wake_pipe[0], POLLIN, 0}};
+	
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			CheckTimeout();
+			//nothing is written while old answers are discarded
+			if (Client_GetTime_us() >= discard_until_us) {WriteQueued();}
+		}
+	
+		if (poll(fds, 2, CLIENT_POLL_MS) <= 0) {continue;}
+	
+		if (fds[1].revents & POLLIN)
+		{
+			char data[64];
+			while (read(wake_pipe[0], data, sizeof(data)) > 0);
+		}
+		if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {ReadInput();}
+	}
+}
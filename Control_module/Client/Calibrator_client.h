@@ -0,0 +1,183 @@
+//=====================================================================
+//Host client library for remote control of calibrator (serial or TCP)
+//commands are pipelined (several commands in flight), every call
+//returns std::future with parsed reply of firmware
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+
+
+#ifndef CALIBRATOR_CLIENT_H_
+#define CALIBRATOR_CLIENT_H_
+
+#define CLIENT_LINE_SIZE					64			//longer answers are truncated (TRIG:LIST?)
+#define CLIENT_COMMAND_SIZE				49			//command[50] in Calibrator_HandleRemoteControl
+#define CLIENT_RX_BUFFER_SIZE			128			//UART2_RX_BUFFER_SIZE of firmware, limit of bytes in flight
+#define CLIENT_FENCE							"FUNC?"	//query sent after every command without answer, its answer ends the command
+
+typedef enum
+{
+	CLIENT_OK,
+	CLIENT_ERROR_REPLY,				//firmware answered "ERROR: ..."
+	CLIENT_ERROR_TIMEOUT,			//no answer within timeout
+	CLIENT_ERROR_CLOSED,			//connection is closed
+	CLIENT_ERROR_COMMAND			//command is too long or empty, it was not sent
+} Client_status;
+
+typedef enum
+{
+	CLIENT_FUNCTION_NONE,
+	CLIENT_FUNCTION_VOLT,			//CLVB
+	CLIENT_FUNCTION_CURR			//CCB
+} Client_function;
+
+typedef struct
+{
+	Client_status status;
+	char text[CLIENT_LINE_SIZE];	//answer of query or error message, empty for successful command
+	uint8_t truncated;						//1 = answer was longer than text and its end is missing (TRIG:LIST?)
+	double value;									//number at the beginning of answer (VOLT?, VOLT:RANG?, ...), 0 if there is no number
+	double latency_ms;						//time from writing of command to its reply
+} Client_reply;
+
+typedef struct
+{
+	Client_status status;					//CLIENT_OK if all queries were answered
+	Client_function function;
+	double value;									//V (VOLT?) or value of CURR?
+	double frequency;							//Hz, only for voltage
+	int range;
+	uint8_t output_on;
+	uint8_t AC_mode;							//only for voltage
+	uint8_t autorange;
+} Client_state;
+
+class Calibrator_client
+{
+public:
+	Calibrator_client();
+	~Calibrator_client();
+	
+	/**
+	* @brief - open serial port (USB or pty of calibrator_host), I/O thread is started
+	* @param device - path of device
+	* @param baud_rate - line rate (9600 as UART of firmware)
+	* @returns - 0 if successful, 1 if not (also unsupported baud_rate)
+	*/
+	int OpenSerial(const char *device, uint32_t baud_rate = 9600);
+	
+	/**
+	* @brief - connect to XPort (TCP), I/O thread is started
+	* @param address - "host:port"
+	* @returns - 0 if successful, 1 if not
+	*/
+	int OpenTCP(const char *address);
+	
+	/**
+	* @brief - stop I/O thread and close connection, pending commands are finished with CLIENT_ERROR_CLOSED
+	* @returns - nothing
+	*/
+	void Close(void);
+	
+	/**
+	* @brief - limits of pipelining, window 1 = every command waits for reply of previous one
+	* @param commands - maximal number of commands in flight
+	* @param bytes - maximal number of bytes in flight (RX buffer of firmware must not overflow)
+	* @returns - nothing
+	*/
+	void SetWindow(unsigned int commands, unsigned int bytes = CLIENT_RX_BUFFER_SIZE - 8);
+	
+	/**
+	* @brief - maximal time between writing of command and its reply
+	* @param timeout_ms - timeout in milliseconds
+	* @returns - nothing
+	*/
+	void SetTimeout(unsigned int timeout_ms);
+	
+	/**
+	* @brief - command without answer (VOLT 1.5, VOLT:OUTP ON, ...), fence query is sent after it
+	* @param command - SCPI command without terminator
+	* @returns - future with CLIENT_OK or error message of firmware
+	*/
+	std::future<Client_reply> Command(const char *command);
+	
+	/**
+	* @brief - query with one line answer (VOLT?, VOLT:RANG?, ...)
+	* @param query - SCPI query without terminator
+	* @returns - future with answer, value contains number from answer
+	*/
+	std::future<Client_reply> Query(const char *query);
+	
+	//typed commands, function is CLIENT_FUNCTION_VOLT or CLIENT_FUNCTION_CURR
+	std::future<Client_reply> SelectFunction(Client_function function);
+	std::future<Client_reply> SetValue(Client_function function, double value);
+	std::future<Client_reply> SetVoltage(double voltage) {return SetValue(CLIENT_FUNCTION_VOLT, voltage);}
+	std::future<Client_reply> SetCurrent(double current) {return SetValue(CLIENT_FUNCTION_CURR, current);}
+	std::future<Client_reply> SetRange(Client_function function, int range);
+	std::future<Client_reply> SetAutorange(Client_function function, bool on);
+	std::future<Client_reply> SetOutput(Client_function function, bool on);
+	std::future<Client_reply> SetModeAC(bool AC);
+	std::future<Client_reply> SetFrequency(double frequency);
+	
+	/**
+	* @brief - state of selected function, all queries are sent at once
+	* @param function - CLIENT_FUNCTION_VOLT or CLIENT_FUNCTION_CURR
+	* @returns - future with state (deferred, queries are already in flight)
+	*/
+	std::future<Client_state> QueryState(Client_function function);
+	
+	/**
+	* @brief - send all commands pipelined and wait for all replies (commands ending with '?' are queries)
+	* @param commands - SCPI commands
+	* @returns - replies in the same order as commands
+	*/
+	std::vector<Client_reply> Batch(const std::vector<std::string> &commands);
+	
+private:
+	struct Request
+	{
+		char text[CLIENT_COMMAND_SIZE + 1];
+		uint8_t query;								//1 = answer is expected, 0 = command followed by fence
+		size_t bytes;									//bytes on the line (command, fence, terminators)
+		uint64_t sent_us;
+		Client_reply reply;
+		std::promise<Client_reply> promise;
+	};
+	
+	int fd;
+	int wake_pipe[2];							//new request wakes I/O thread from poll()
+	std::atomic<bool> running;		//cleared by Close (user thread) and by closed connection (I/O thread)
+	std::thread io_thread;
+	std::mutex lock;
+	std::deque<Request> queued;		//waiting for window
+	std::deque<Request> in_flight;	//written, waiting for reply
+	unsigned int window_commands;
+	unsigned int window_bytes;
+	unsigned int bytes_in_flight;
+	unsigned int timeout_ms;
+	char line[CLIENT_LINE_SIZE];
+	size_t line_length;
+	uint8_t line_overflow;				//line is longer than line buffer, reply is marked as truncated
+	uint64_t discard_until_us;		//input is discarded after timeout, until old answers are gone
+	
+	std::future<Client_reply> Submit(const char *text, uint8_t query);
+	int Start(void);
+	void Run(void);
+	void WriteQueued(void);
+	void ReadInput(void);
+	void HandleLine(void);
+	void CheckTimeout(void);
+	void Finish(Request &request, Client_status status);
+	void FailAll(Client_status status);
+};
+
+#endif
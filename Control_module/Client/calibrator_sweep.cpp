@@ -0,0 +1,154 @@
+//=====================================================================
+//Example of Calibrator_client - sweep of calibration points
+//all setpoints are streamed pipelined (batch), optionally compared
+//with stop-and-wait sending (window 1) of the same points
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <vector>
+#include <string>
+#include "Calibrator_client.h"
+
+
+static double Sweep_GetTime_s(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+
+static void Sweep_PrintUsage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s -d device | -t host:port [-b baud] [-F VOLT|CURR] [-r range] [-s start] [-e stop] [-n points]\n"
+		"       [-w window] [-T timeout_ms] [-c] [-v]\n"
+		"-b baud         line rate of serial port (default 9600)\n"
+		"-F function     VOLT (default) or CURR\n"
+		"-r range        range of sweep (default 2)\n"
+		"-s, -e          first and last value of sweep (default -1 and 1)\n"
+		"-n points       number of calibration points (default 100)\n"
+		"-w window       commands in flight (default 8, 1 = stop-and-wait)\n"
+		"-c              compare with stop-and-wait sending of the same points\n"
+		"-v              print reply of every point (\"value,status,latency_ms\" to stdout)\n",
+		name);
+}
+
+
+/**
+* @brief - send all points and wait for all replies
+* @returns - number of failed points
+*/
+static unsigned int Sweep_Run(Calibrator_client &client, Client_function function, const std::vector<double> &points,
+	unsigned int window, uint8_t verbose, double *elapsed_s)
+{
+	std::vector<std::future<Client_reply>> futures;
+	unsigned int errors = 0;
+	double start = Sweep_GetTime_s();
+	
+	client.SetWindow(window);
+	futures.reserve(points.size());
+	for (double value : points) {futures.push_back(client.SetValue(function, value));}
+	
+	for (size_t i = 0; i < futures.size(); i++)
+	{
+		Client_reply reply = futures[i].get();
+		if (reply.status != CLIENT_OK)
+		{
+			errors++;
+			if (errors <= 5) {fprintf(stderr, "point %zu (%.7f): %s\n", i, points[i], (reply.text[0] != '\0') ? reply.text : "timeout");}
+		}
+		if (verbose) {printf("%.7f,%d,%.3f\n", points[i], reply.status, reply.latency_ms);}
+	}
+	
+	*elapsed_s = Sweep_GetTime_s() - start;
+	
+	return errors;
+}
+
+
+int main(int argc, char **argv)
+{
+	const char *device = NULL, *address = NULL;
+	uint32_t baud_rate = 9600;
+	Client_function function = CLIENT_FUNCTION_VOLT;
+	int range = 2;
+	double start = -1.0, stop = 1.0;
+	unsigned int count = 100, window = 8, timeout_ms = 5000;
+	uint8_t compare = 0, verbose = 0;
+	int option;
+	
+	while ((option = getopt(argc, argv, "d:t:b:F:r:s:e:n:w:T:cvh")) != -1)
+	{
+		switch (option)
+		{
+			case 'd': device = optarg; break;
+			case 't': address = optarg; break;
+			case 'b': baud_rate = strtoul(optarg, NULL, 10); break;
+			case 'F': function = (strcmp(optarg, "CURR") == 0) ? CLIENT_FUNCTION_CURR : CLIENT_FUNCTION_VOLT; break;
+			case 'r': range = atoi(optarg); break;
+			case 's': start = atof(optarg); break;
+			case 'e': stop = atof(optarg); break;
+			case 'n': count = strtoul(optarg, NULL, 10); break;
+			case 'w': window = strtoul(optarg, NULL, 10); break;
+			case 'T': timeout_ms = strtoul(optarg, NULL, 10); break;
+			case 'c': compare = 1; break;
+			case 'v': verbose = 1; break;
+			default: Sweep_PrintUsage(argv[0]); return 1;
+		}
+	}
+	
+	if (((device == NULL) && (address == NULL)) || (count < 2))
+	{
+		Sweep_PrintUsage(argv[0]);
+		return 1;
+	}
+	
+	Calibrator_client client;
+	if ((device != NULL) ? client.OpenSerial(device, baud_rate) : client.OpenTCP(address)) {return 1;}
+	client.SetTimeout(timeout_ms);
+	
+	//setup, replies of all commands are checked at once
+	char range_text[8];
+	snprintf(range_text, sizeof(range_text), "%d", range);
+	std::vector<std::string> setup = {(function == CLIENT_FUNCTION_VOLT) ? "FUNC VOLT" : "FUNC CURR",
+		std::string((function == CLIENT_FUNCTION_VOLT) ? "VOLT:RANG " : "CURR:RANG ") + range_text};
+	std::vector<Client_reply> replies = client.Batch(setup);
+	for (size_t i = 0; i < replies.size(); i++)
+	{
+		if (replies[i].status != CLIENT_OK) {fprintf(stderr, "setup \"%s\" failed: %s\n", setup[i].c_str(), replies[i].text);}
+	}
+	
+	std::vector<double> points(count);
+	for (unsigned int i = 0; i < count; i++) {points[i] = start + ((stop - start) * i / (count - 1));}
+	
+	double elapsed, elapsed_single;
+	unsigned int errors = Sweep_Run(client, function, points, window, verbose, &elapsed);
+	fprintf(stderr, "window %u: %u points, %u errors, %.3f s, %.1f points/s\n", window, count, errors, elapsed, count / elapsed);
+	
+	if (compare)
+	{
+		errors += Sweep_Run(client, function, points, 1, 0, &elapsed_single);
+		fprintf(stderr, "window 1: %u points, %.3f s, %.1f points/s (pipelining %.2fx faster)\n", count, elapsed_single,
+			count / elapsed_single, elapsed_single / elapsed);
+	}
+	
+	Client_state state = client.QueryState(function).get();
+	if (state.status == CLIENT_OK)
+	{
+		fprintf(stderr, "state: %s, value %.7f, range %d, output %s, autorange %s\n",
+			(state.function == CLIENT_FUNCTION_VOLT) ? "VOLT" : ((state.function == CLIENT_FUNCTION_CURR) ? "CURR" : "NONE"),
+			state.value, state.range, state.output_on ? "ON" : "OFF", state.autorange ? "ON" : "OFF");
+	}
+	
+	client.Close();
+	
+	return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+//=====================================================
+//Host (Linux) side of hardware abstraction for firmware
+//by Martin Praznovsky, 2025
+//=====================================================
+
+#include <stdint.h>
+#include "stm32f429xx.h"
+
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#define HOST_UART_COUNT				8
+#define HOST_IDLE_POLLS				1000		//number of empty polls of UARTs before process sleeps (main loop is busy loop)
+#define HOST_IDLE_TIMEOUT_MS	1				//maximum sleep time when no data are received
+
+/**
+* @brief - read all available data from files of opened UARTs into RX buffers, nothing is blocked
+* @returns - number of received bytes
+*/
+uint32_t Host_PollUARTs(void);
+
+/**
+* @brief - wait until data are received on any opened UART or timeout occurs
+* @param timeout_ms - maximum time of waiting
+* @returns - nothing
+*/
+void Host_WaitForInput(uint32_t timeout_ms);
+
+/**
+* @brief - get virtual time of firmware (sum of all delays since InitDelayTimer)
+* @returns - virtual time in microseconds
+*/
+uint64_t Host_GetVirtualTime_us(void);
+
+/**
+* @brief - get real (monotonic) time of host
+* @returns - time in microseconds
+*/
+uint64_t Host_GetRealTime_us(void);
+
+#endif
@@ -0,0 +1,429 @@
+//==================================================================
+//Behavioral emulator of Calibrator Current Board (CCB) firmware
+//main loop, sortReceivedData() and range sequences are the same as
+//in Current_module/main.c, UART has 128 byte RX buffer as ATmega328P
+//by Martin Praznovsky, 2025
+//==================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include "Host_emulator.h"
+
+
+#define CCB_RX_BUFFER_SIZE		128				//RX_BUFFER_SIZE of ATmega328P_UART.c
+#define CCB_RECEIVE_DELAY_US	50000			//_delay_ms(50) in sortReceivedData()
+#define CCB_RELAY_PULSE_US		10000			//RELAY_PULSE_MS
+#define CCB_RELAY_SETTLE_US		5000			//RELAY_SETTLE_MS
+#define CCB_IDLE_POLL_US			100000
+
+//register H
+#define TRG		15
+#define DIT		4
+#define K4		3
+#define K3		2
+#define K2		1
+#define K1		0
+
+#define DAC_HOLD	0
+#define DAC_ZERO	1
+
+typedef struct
+{
+	uint8_t DAC_action;
+	uint8_t steps;
+	uint8_t relays[2];
+} range_sequence;
+
+//same table as range_sequences in Current_module/main.c
+static const range_sequence range_sequences[3][3] = {
+	{{DAC_HOLD, 0, {0b00, 0b00}}, {DAC_ZERO, 1, {0b01, 0b01}}, {DAC_ZERO, 2, {0b01, 0b11}}},
+	{{DAC_HOLD, 1, {0b00, 0b00}}, {DAC_HOLD, 0, {0b01, 0b01}}, {DAC_ZERO, 1, {0b11, 0b11}}},
+	{{DAC_HOLD, 2, {0b01, 0b00}}, {DAC_HOLD, 1, {0b01, 0b01}}, {DAC_HOLD, 0, {0b11, 0b11}}}
+};
+
+static const double CCB_gain[4] = {0.0, 10.0, 100.0, 1000.0};
+static const double CCB_RREF = 2256.25;
+
+static Emulator CCB = {"CCB", NULL, NULL, 9600, 0, 0.0, 0.0, 0.0, 0, -1, -1, 0};
+
+//UART RX buffer of ATmega328P (overflow overwrites oldest data)
+static uint8_t RX_buffer[CCB_RX_BUFFER_SIZE];
+static uint8_t RX_counter = 0;
+static uint8_t RX_write_position = 0;
+static uint8_t RX_read_position = 0;
+
+static uint16_t reg_G = 0x0000;
+static uint16_t reg_H = 0x0000;
+static uint32_t reg_I = 0x00000000;
+static uint8_t reg_G_update = 0;
+static uint8_t reg_H_update = 0;
+static uint8_t reg_I_update = 0;
+
+static uint8_t relays_state = 0x00;				//position of relays in firmware
+static uint8_t relays_position = 0x00;		//real position of relays (after pulse)
+static uint64_t relays_pulse_end_us = 0;
+static uint64_t relays_busy_end_us = 0;
+static uint8_t range_sequence_active = 0;
+static uint8_t range_from = 0;
+static uint8_t range_to = 0;
+static uint8_t range_step = 0;
+static uint8_t dithering_mode = 0;
+static uint8_t trigger_mode = 0;
+static uint8_t trigger_pending = 0;
+
+static uint32_t DAC_code_loaded = 0x00000000;		//20-bit code in input register of DAC
+static uint32_t DAC_code_output = 0x00000000;		//24-bit code at output of DAC (mean value in dithering mode)
+
+
+void pollUART(uint64_t timeout_us);
+uint8_t readLine(uint8_t *string, uint8_t size);
+uint32_t hexStringToInt(uint8_t *string);
+void sortReceivedData(void);
+void sendAllRegisters(void);
+void updateRelays(uint8_t relays);
+uint8_t relaysBusy(void);
+uint8_t getRange(uint8_t relays);
+void startRangeSequence(void);
+void nextRangeStep(void);
+void updateDACCode(void);
+void updateTrigger(void);
+void setDACVoltage(uint32_t code);
+void updateDithering(void);
+void printOutput(void);
+
+
+int main(int argc, char **argv)
+{
+	if (Emulator_ParseOptions(&CCB, argc, argv) != 0) {return 1;}
+	if (Emulator_Open(&CCB) != 0) {return 1;}
+	
+	printOutput();
+	
+	while (1)
+	{
+		uint64_t now = Emulator_GetTime_us();
+		uint64_t timeout = CCB_IDLE_POLL_US;
+	
+		if ((relays_busy_end_us > now) && ((relays_busy_end_us - now) < timeout)) {timeout = relays_busy_end_us - now;}
+		if ((relays_pulse_end_us > now) && ((relays_pulse_end_us - now) < timeout)) {timeout = relays_pulse_end_us - now;}
+		if ((reg_G_update == 1) || (reg_H_update == 1) || (reg_I_update == 1) || (range_sequence_active == 1)) {timeout = 0;}
+		pollUART(timeout);
+	
+		if (RX_counter > 0)
+		{
+			sortReceivedData();
+		}
+	
+		if (reg_G_update == 1)
+		{
+			if (reg_G == 0x003F)
+			{
+				if (Emulator_Fault(CCB.no_reply)) {Emulator_Log(&CCB, "fault: request ignored");}
+				else {sendAllRegisters();}
+			}
+	
+			reg_G_update = 0;
+		}
+	
+		if ((reg_H_update == 1) && (relaysBusy() == 0) && (range_sequence_active == 0))
+		{
+			range_from = getRange(relays_state);
+			range_to = getRange(reg_H);
+	
+			if ((range_from != 0) && (range_to != 0) && (range_from != range_to))
+			{
+				startRangeSequence();
+			}
+			else
+			{
+				updateRelays(reg_H & 0x000F);
+				updateTrigger();
+				dithering_mode = (reg_H >> DIT) & 0x0001;
+				if (dithering_mode == 1) {updateDithering();}
+				else {DAC_code_output &= 0x00FFFFF0;}		//dithering timer stops at one of codes
+			}
+	
+			reg_H_update = 0;
+		}
+	
+		if ((range_sequence_active == 1) && (relaysBusy() == 0))
+		{
+			nextRangeStep();
+		}
+	
+		if ((reg_I_update == 1) && (reg_H_update == 0) && (range_sequence_active == 0))
+		{
+			updateDACCode();
+			reg_I_update = 0;
+		}
+	
+		//rising edge on trigger input (ANALOG_COMP_vect)
+		if (Emulator_CheckTrigger() == 1)
+		{
+			Emulator_Log(&CCB, "trigger");
+			if ((trigger_mode == 1) && (trigger_pending == 1))
+			{
+				DAC_code_output = DAC_code_loaded << 4;
+				trigger_pending = 0;
+			}
+		}
+	
+		printOutput();
+	}
+	
+	return 0;
+}
+
+
+void pollUART(uint64_t timeout_us)
+{
+	uint8_t byte;
+	
+	//bytes are stored as by USART_RX_vect, without check of overflow
+	while (Emulator_ReadByte(&CCB, &byte, timeout_us) == 1)
+	{
+		RX_buffer[RX_write_position] = byte;
+		RX_write_position = (RX_write_position + 1) % CCB_RX_BUFFER_SIZE;
+		RX_counter++;
+		timeout_us = 0;
+	}
+}
+
+
+uint8_t readLine(uint8_t *string, uint8_t size)
+{
+	uint8_t byte;
+	uint8_t i = 0;
+	
+	//as UART_ReadLine, waits until '\n' or '\r' is received
+	do
+	{
+		while (RX_counter == 0) {pollUART(CCB_IDLE_POLL_US);}
+		byte = RX_buffer[RX_read_position];
+		RX_read_position = (RX_read_position + 1) % CCB_RX_BUFFER_SIZE;
+		RX_counter--;
+		if (i < (size - 1)) {string[i++] = byte;}
+	} while ((byte != '\n') && (byte != '\r'));
+	
+	if ((i > 0) && ((string[i - 1] == '\n') || (string[i - 1] == '\r'))) {i--;}		//remove '\n' from string
+	string[i] = '\0';
+	
+	return i;
+}
+
+
+uint32_t hexStringToInt(uint8_t *string)
+{
+	uint32_t number = 0;
+	uint8_t byte = 0;
+	
+	//as Utils_HexStringToInt, invalid character repeats previous digit
+	for (uint8_t i = 0; string[i] != '\0'; i++)
+	{
+		if ((string[i] >= '0') && (string[i] <= '9')) {byte = (string[i] - '0');}
+		else if ((string[i] >= 'A') && (string[i] <= 'F')) {byte = (string[i] - 'A' + 10);}
+	
+		number = (number << 4) | (byte & 0x0F);
+	}
+	
+	return number;
+}
+
+
+void sortReceivedData(void)
+{
+	uint8_t string[35];
+	uint64_t end = Emulator_GetTime_us() + CCB_RECEIVE_DELAY_US;
+	uint64_t now;
+	
+	//wait for reception of all data
+	while ((now = Emulator_GetTime_us()) < end) {pollUART(end - now);}
+	
+	while (RX_counter > 0)
+	{
+		readLine(string, sizeof(string));
+	
+		if (string[0] == 'G')
+		{
+			reg_G = hexStringToInt(string + 1);
+			reg_G_update = 1;
+			Emulator_Log(&CCB, "G%04X", reg_G);
+		}
+		else if (string[0] == 'H')
+		{
+			reg_H = hexStringToInt(string + 1);
+			reg_H_update = 1;
+			Emulator_Log(&CCB, "H%04X", reg_H);
+		}
+		else if (string[0] == 'I')
+		{
+			reg_I = hexStringToInt(string + 1);
+			reg_I_update = 1;
+			Emulator_Log(&CCB, "I%08X", reg_I);
+		}
+	}
+}
+
+
+void sendAllRegisters(void)
+{
+	char string[40];
+	int length;
+	
+	length = snprintf(string, sizeof(string), "@CCB\nG%04X\nH%04X\nI%08X\n\r", reg_G, reg_H, reg_I);
+	Emulator_Send(&CCB, (uint8_t *) string, length);
+}
+
+
+void updateRelays(uint8_t relays)
+{
+	uint64_t now = Emulator_GetTime_us();
+	
+	if ((relays & 0x0F) != relays_state)
+	{
+		relays_pulse_end_us = now + CCB_RELAY_PULSE_US;
+		relays_busy_end_us = relays_pulse_end_us + CCB_RELAY_SETTLE_US;
+	}
+	
+	relays_state = relays & 0x0F;
+}
+
+
+uint8_t relaysBusy(void)
+{
+	uint64_t now = Emulator_GetTime_us();
+	
+	if ((relays_pulse_end_us != 0) && (now >= relays_pulse_end_us))
+	{
+		relays_position = relays_state;		//coils are released
+		relays_pulse_end_us = 0;
+	}
+	
+	return now < relays_busy_end_us;
+}
+
+
+uint8_t getRange(uint8_t relays)
+{
+	uint8_t range = 0;
+	
+	if (((relays >> K2) & 0x01) == 0)
+	{
+		if (((relays >> K1) & 0x01) == 0) {range = 1;}
+		else {range = 2;}
+	}
+	else
+	{
+		if (((relays >> K1) & 0x01) == 1) {range = 3;}
+	}
+	
+	return range;
+}
+
+
+void startRangeSequence(void)
+{
+	if (range_sequences[range_from - 1][range_to - 1].DAC_action == DAC_ZERO)
+	{
+		dithering_mode = 0;
+		trigger_pending = 0;
+		setDACVoltage(0x00000000);
+	}
+	
+	range_step = 0;
+	range_sequence_active = 1;
+	nextRangeStep();
+}
+
+
+void nextRangeStep(void)
+{
+	const range_sequence *sequence = &range_sequences[range_from - 1][range_to - 1];
+	
+	if (range_step < sequence->steps)
+	{
+		updateRelays((relays_state & ((1 << K4) | (1 << K3))) | sequence->relays[range_step]);
+		range_step++;
+	}
+	else
+	{
+		updateRelays((reg_H & ((1 << K4) | (1 << K3))) | (relays_state & ((1 << K2) | (1 << K1))));
+		updateTrigger();
+		dithering_mode = (reg_H >> DIT) & 0x0001;
+		updateDACCode();
+	
+		reg_I_update = 0;
+		range_sequence_active = 0;
+	}
+}
+
+
+void updateDACCode(void)
+{
+	uint32_t code = (reg_I >> 4) & 0x000FFFFF;
+	
+	if (dithering_mode == 0)
+	{
+		if (trigger_mode == 1)
+		{
+			DAC_code_loaded = code;
+			trigger_pending = 1;
+		}
+		else
+		{
+			setDACVoltage(code);
+		}
+	}
+	else
+	{
+		updateDithering();
+	}
+}
+
+
+void updateTrigger(void)
+{
+	trigger_mode = (reg_H >> TRG) & 0x0001;
+	
+	if ((trigger_mode == 0) && (trigger_pending == 1))
+	{
+		trigger_pending = 0;
+		DAC_code_output = DAC_code_loaded << 4;
+	}
+}
+
+
+void setDACVoltage(uint32_t code)
+{
+	DAC_code_loaded = code;
+	DAC_code_output = code << 4;
+}
+
+
+void updateDithering(void)
+{
+	uint32_t code = (reg_I >> 4) & 0x000FFFFF;
+	
+	//mean value of dithering, code + 1 is not used for maximum code
+	DAC_code_loaded = code;
+	if (code == 0x000FFFFF) {DAC_code_output = code << 4;}
+	else {DAC_code_output = reg_I & 0x00FFFFFF;}
+}
+
+
+void printOutput(void)
+{
+	static uint32_t last_code = 0xFFFFFFFF;
+	static uint8_t last_relays = 0xFF;
+	uint8_t range;
+	double current;
+	
+	relaysBusy();
+	if ((DAC_code_output == last_code) && (relays_position == last_relays)) {return;}
+	last_code = DAC_code_output;
+	last_relays = relays_position;
+	
+	range = getRange(relays_position);
+	current = (DAC_code_output * 5.0 / 16777216.0) * CCB_gain[range] / CCB_RREF;
+	Emulator_Log(&CCB, "output %s, range %u, DC %.9f A%s", ((relays_position >> K4) & 0x01) ? "ON" : "OFF", range, current, (dithering_mode == 1) ? " (dithering)" : "");
+}
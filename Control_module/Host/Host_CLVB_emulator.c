@@ -0,0 +1,321 @@
+//=====================================================================
+//Behavioral emulator of Calibrator Low Voltage Board (CLVB) gateware
+//receiver is the same state machine as UART_RX_memory_map.vhd,
+//relays, range change sequencer, trigger and DAC modes follow main.vhd
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include "Host_emulator.h"
+
+
+#define CLVB_CLOCK_FREQ				12000000ULL
+#define CLVB_RX_TIMEOUT_US		((0xFFFFFFULL * 1000000ULL) / CLVB_CLOCK_FREQ)		//C_TIMER_FULL of UART_RX_memory_map
+#define CLVB_RELAYS_US				10000		//C_TIME_DELAY_RELAYS
+#define CLVB_DAC_PARK_US			2000		//C_TIME_DAC_PARK
+#define CLVB_RANGE_SETTLE_US	5000		//C_TIME_RANGE_SETTLE
+#define CLVB_DAC_SAFE_CODE		0x800000	//C_DAC_SAFE_CODE
+#define CLVB_AC_SAMPLING_FREQ	100000.0	//G_AC_GEN_FREQ
+#define CLVB_IDLE_POLL_US			100000
+
+//register H
+#define TRG										15
+#define AC										4
+#define DIT										3
+#define K3										2
+#define K2										1
+#define K1										0
+
+typedef enum {RX_IDLE, RX_DIGIT_7, RX_DIGIT_6, RX_DIGIT_5, RX_DIGIT_4, RX_DIGIT_3, RX_DIGIT_2, RX_DIGIT_1, RX_DIGIT_0, RX_LF, RX_CR} CLVB_RX_state;
+typedef enum {SEQUENCER_IDLE, SEQUENCER_PARK_WAIT, SEQUENCER_RELAYS_WAIT} CLVB_sequencer_state;
+
+static const double CLVB_gain[4] = {0.0, 1.125 * 2.0 / 100.0, 1.125 * 2.0 / 10.0, 1.125 * 2.0 / 1.0};
+
+static Emulator CLVB = {"CLVB", NULL, NULL, 9600, 0, 0.0, 0.0, 0.0, 0, -1, -1, 0};
+
+//registers
+static uint16_t reg_G = 0x0000;
+static uint16_t reg_H = 0x0000;
+static uint32_t reg_I = 0x00000000;
+static uint32_t reg_J = 0x00000000;
+static uint32_t reg_K = 0x00000000;
+
+//receiver
+static CLVB_RX_state RX_state = RX_IDLE;
+static uint8_t RX_register = 0;
+static uint32_t RX_digits = 0;
+static uint64_t RX_timeout_us = 0;
+
+//relays
+static uint8_t relays_target = 0x00;
+static uint8_t relays_position = 0x00;
+static uint64_t relays_time_us = 0;			//time when relays are in target position, 0 = relays are not moving
+
+//range change sequencer
+static CLVB_sequencer_state sequencer_state = SEQUENCER_IDLE;
+static uint64_t sequencer_time_us = 0;
+static uint8_t sequencer_relays = 0x00;
+static uint32_t sequencer_code = 0x00000000;
+
+//DAC
+static uint32_t voltage_code = 0x00000000;		//24-bit code requested by register I or by sequencer
+static uint32_t DAC_code = 0x00000000;				//24-bit code at DAC output (mean value in dithering mode)
+static uint8_t trigger_armed = 0;						//1 = voltage_code waits for rising edge on trigger input
+
+
+void CLVB_ReceiveByte(uint8_t byte);
+void CLVB_WriteRegister(uint8_t name, uint32_t value);
+void CLVB_SendAllRegisters(void);
+void CLVB_SetRelays(uint8_t relays);
+void CLVB_SetVoltageCode(uint32_t code, uint8_t triggered);
+void CLVB_UpdateDAC(void);
+void CLVB_UpdateTimers(void);
+uint64_t CLVB_GetNextEvent(void);
+void CLVB_PrintOutput(void);
+
+
+int main(int argc, char **argv)
+{
+	uint8_t byte;
+	
+	if (Emulator_ParseOptions(&CLVB, argc, argv) != 0) {return 1;}
+	if (Emulator_Open(&CLVB) != 0) {return 1;}
+	
+	CLVB_PrintOutput();
+	
+	while (1)
+	{
+		uint64_t now = Emulator_GetTime_us();
+		uint64_t next = CLVB_GetNextEvent();
+		uint64_t timeout = (next > now) ? (next - now) : 0;
+	
+		if (Emulator_ReadByte(&CLVB, &byte, timeout) == 1)
+		{
+			if ((RX_state != RX_IDLE) && (Emulator_GetTime_us() >= RX_timeout_us))
+			{
+				RX_state = RX_IDLE;		//timeout timer of receiver reached 0
+			}
+			CLVB_ReceiveByte(byte);
+		}
+	
+		if (Emulator_CheckTrigger() == 1)
+		{
+			Emulator_Log(&CLVB, "trigger");
+			if ((trigger_armed == 1) && (((reg_H >> TRG) & 0x0001) == 1))
+			{
+				trigger_armed = 0;
+				CLVB_UpdateDAC();
+			}
+		}
+	
+		CLVB_UpdateTimers();
+		CLVB_PrintOutput();
+	}
+	
+	return 0;
+}
+
+
+void CLVB_ReceiveByte(uint8_t byte)
+{
+	uint8_t hex = ((byte >= '0') && (byte <= '9')) || ((byte >= 'A') && (byte <= 'F'));
+	uint8_t digit = (byte >= 'A') ? (byte - 'A' + 10) : (byte - '0');
+	
+	switch (RX_state)
+	{
+		case RX_IDLE:
+			RX_timeout_us = Emulator_GetTime_us() + CLVB_RX_TIMEOUT_US;
+			RX_digits = 0;
+			if ((byte == 'G') || (byte == 'H')) {RX_register = byte; RX_state = RX_DIGIT_3;}
+			else if ((byte == 'I') || (byte == 'J') || (byte == 'K')) {RX_register = byte; RX_state = RX_DIGIT_7;}
+			break;
+	
+		case RX_DIGIT_7: case RX_DIGIT_6: case RX_DIGIT_5: case RX_DIGIT_4:
+		case RX_DIGIT_3: case RX_DIGIT_2: case RX_DIGIT_1: case RX_DIGIT_0:
+			if (hex)
+			{
+				RX_digits = (RX_digits << 4) | digit;
+				RX_state++;
+			}
+			else {RX_state = RX_IDLE;}		//anything else than 0 - F is error
+			break;
+	
+		case RX_LF:
+			if ((byte == '\n') || (byte == '\r')) {RX_state = RX_CR;}
+			else {RX_state = RX_IDLE;}
+			break;
+	
+		case RX_CR:
+			if ((byte == '\n') || (byte == '\r')) {CLVB_WriteRegister(RX_register, RX_digits);}
+			RX_state = RX_IDLE;
+			break;
+	}
+}
+
+
+void CLVB_WriteRegister(uint8_t name, uint32_t value)
+{
+	Emulator_Log(&CLVB, "%c%0*X", name, ((name == 'G') || (name == 'H')) ? 4 : 8, value);
+	
+	switch (name)
+	{
+		case 'G':
+			reg_G = value;
+			if ((reg_G & 0x00FF) == 0x003F)
+			{
+				if (Emulator_Fault(CLVB.no_reply)) {Emulator_Log(&CLVB, "fault: request ignored");}
+				else {CLVB_SendAllRegisters();}
+			}
+			break;
+	
+		case 'H':
+			reg_H = value;
+			CLVB_SetRelays(reg_H & 0x0007);
+			if (((reg_H >> TRG) & 0x0001) == 0) {trigger_armed = 0;}		//code waiting for trigger is set immediately
+			CLVB_UpdateDAC();
+			break;
+	
+		case 'I':
+			reg_I = value;
+			CLVB_SetVoltageCode(reg_I & 0x00FFFFFF, (reg_H >> TRG) & 0x0001);
+			break;
+	
+		case 'J':
+			reg_J = value;		//DDS uses most recent FTW
+			break;
+	
+		case 'K':
+			reg_K = value;
+			sequencer_relays = (reg_K >> 24) & 0x07;
+			sequencer_code = reg_K & 0x00FFFFFF;
+			if ((sequencer_state == SEQUENCER_IDLE) && (sequencer_relays == relays_target))
+			{
+				CLVB_SetVoltageCode(sequencer_code, 0);		//relays are already in position, only load new code
+			}
+			else
+			{
+				CLVB_SetVoltageCode((((reg_H >> AC) & 0x0001) == 1) ? 0x00000000 : CLVB_DAC_SAFE_CODE, 0);
+				sequencer_state = SEQUENCER_PARK_WAIT;
+				sequencer_time_us = Emulator_GetTime_us() + CLVB_DAC_PARK_US;
+			}
+			break;
+	}
+}
+
+
+void CLVB_SendAllRegisters(void)
+{
+	char string[64];
+	int length;
+	
+	length = snprintf(string, sizeof(string), "@CLVB\nG%04X\nH%04X\nI%08X\nJ%08X\nK%08X\n\n\r", reg_G, reg_H, reg_I, reg_J, reg_K);
+	Emulator_Send(&CLVB, (uint8_t *) string, length);
+}
+
+
+void CLVB_SetRelays(uint8_t relays)
+{
+	relays_target = relays;
+	
+	if (relays_target != relays_position)
+	{
+		relays_time_us = Emulator_GetTime_us() + CLVB_RELAYS_US;		//coils are driven for 10 ms
+	}
+}
+
+
+void CLVB_SetVoltageCode(uint32_t code, uint8_t triggered)
+{
+	voltage_code = code;
+	trigger_armed = triggered;		//code from range change sequencer is never triggered
+	CLVB_UpdateDAC();
+}
+
+
+void CLVB_UpdateDAC(void)
+{
+	uint8_t AC_mode = (reg_H >> AC) & 0x0001;
+	uint8_t dith_mode = (reg_H >> DIT) & 0x0001;
+	
+	if ((AC_mode == 0) && (dith_mode == 0))
+	{
+		if (trigger_armed == 0) {DAC_code = voltage_code & 0x00FFFFF0;}		//20-bit code
+	}
+	else
+	{
+		trigger_armed = 0;				//trigger is used only in DC mode without dithering
+		DAC_code = voltage_code;	//mean value of dithering, amplitude in AC mode
+	}
+}
+
+
+void CLVB_UpdateTimers(void)
+{
+	uint64_t now = Emulator_GetTime_us();
+	
+	if ((relays_time_us != 0) && (now >= relays_time_us))
+	{
+		relays_position = relays_target;
+		relays_time_us = 0;
+	}
+	
+	if ((sequencer_state == SEQUENCER_PARK_WAIT) && (now >= sequencer_time_us))
+	{
+		CLVB_SetRelays(sequencer_relays);
+		sequencer_state = SEQUENCER_RELAYS_WAIT;
+		sequencer_time_us += CLVB_RELAYS_US + CLVB_RANGE_SETTLE_US;
+	}
+	
+	if ((sequencer_state == SEQUENCER_RELAYS_WAIT) && (now >= sequencer_time_us))
+	{
+		if ((relays_time_us != 0) && (now >= relays_time_us)) {relays_position = relays_target; relays_time_us = 0;}
+		CLVB_SetVoltageCode(sequencer_code, 0);
+		sequencer_state = SEQUENCER_IDLE;
+	}
+}
+
+
+uint64_t CLVB_GetNextEvent(void)
+{
+	uint64_t next = Emulator_GetTime_us() + CLVB_IDLE_POLL_US;
+	
+	if ((relays_time_us != 0) && (relays_time_us < next)) {next = relays_time_us;}
+	if ((sequencer_state != SEQUENCER_IDLE) && (sequencer_time_us < next)) {next = sequencer_time_us;}
+	
+	return next;
+}
+
+
+void CLVB_PrintOutput(void)
+{
+	static uint32_t last_DAC_code = 0xFFFFFFFF;
+	static uint8_t last_relays = 0xFF;
+	static uint16_t last_mode = 0xFFFF;
+	static uint32_t last_FTW = 0xFFFFFFFF;
+	uint16_t mode = reg_H & ((1 << AC) | (1 << DIT));
+	uint8_t range = 0;
+	double voltage;
+	
+	if ((DAC_code == last_DAC_code) && (relays_position == last_relays) && (mode == last_mode) && (reg_J == last_FTW)) {return;}
+	last_DAC_code = DAC_code;
+	last_relays = relays_position;
+	last_mode = mode;
+	last_FTW = reg_J;
+	
+	//range 1: K2 = 1, K3 = 1, range 2: K2 = 0, K3 = 1, range 3: K2 = 0, K3 = 0
+	if ((relays_position & ((1 << K3) | (1 << K2))) == ((1 << K3) | (1 << K2))) {range = 1;}
+	else if ((relays_position & ((1 << K3) | (1 << K2))) == (1 << K3)) {range = 2;}
+	else if ((relays_position & ((1 << K3) | (1 << K2))) == 0) {range = 3;}
+	
+	if (((reg_H >> AC) & 0x0001) == 1)
+	{
+		voltage = (DAC_code >> 4) * 20.0 / 1048576.0 * CLVB_gain[range];
+		Emulator_Log(&CLVB, "output %s, range %u, AC %.6f V peak, %.3f Hz", ((relays_position >> K1) & 0x01) ? "ON" : "OFF", range, voltage, reg_J * CLVB_AC_SAMPLING_FREQ / 4294967296.0);
+	}
+	else
+	{
+		voltage = (DAC_code * 20.0 / 16777216.0 - 10.0) * CLVB_gain[range];
+		Emulator_Log(&CLVB, "output %s, range %u, DC %.7f V%s", ((relays_position >> K1) & 0x01) ? "ON" : "OFF", range, voltage, (((reg_H >> DIT) & 0x0001) == 1) ? " (dithering)" : "");
+	}
+}
@@ -0,0 +1,72 @@
+#include <stdlib.h>
+#include <time.h>
+#include "STM32F429ZI_Delay.h"
+#include "Host.h"
+
+//TIM7 is replaced by virtual clock, every delay advances virtual time of firmware by exact value
+//real waiting is scaled by CALIBRATOR_TIME_SCALE (1.0 = real time, 0.1 = 10x faster, 0 = no waiting)
+//UARTs are polled during waiting, as RX interrupts would receive data on real hardware
+
+#define HOST_DELAY_STEP_US		500		//maximum sleep between two polls of UARTs
+
+static uint64_t virtual_time_us = 0;
+static double time_scale = 1.0;
+
+
+uint64_t Host_GetRealTime_us(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return ((uint64_t) now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+
+uint64_t Host_GetVirtualTime_us(void)
+{
+	return virtual_time_us;
+}
+
+
+void InitDelayTimer(void)
+{
+	const char *scale = getenv("CALIBRATOR_TIME_SCALE");
+	
+	if (scale != NULL) {time_scale = atof(scale);}
+	if (time_scale < 0.0) {time_scale = 0.0;}
+	virtual_time_us = 0;
+}
+
+
+void delay_us(uint16_t us)
+{
+	uint64_t end;
+	uint64_t now;
+	struct timespec step;
+	
+	virtual_time_us += us;
+	
+	Host_PollUARTs();
+	if (time_scale == 0.0) {return;}
+	
+	end = Host_GetRealTime_us() + (uint64_t) (us * time_scale);
+	while ((now = Host_GetRealTime_us()) < end)
+	{
+		uint64_t remaining = end - now;
+		if (remaining > HOST_DELAY_STEP_US) {remaining = HOST_DELAY_STEP_US;}
+		step.tv_sec = 0;
+		step.tv_nsec = remaining * 1000;
+		nanosleep(&step, NULL);
+		Host_PollUARTs();
+	}
+}
+
+
+void delay_ms(uint16_t ms)
+{
+	for (uint16_t i = 0; i < ms; i++)
+	{
+		delay_us(1000);
+	}
+}
@@ -0,0 +1,48 @@
+#include "STM32F429ZI_GPIOPins.h"
+
+//GPIO registers are only stored in memory of host, pins have no function
+
+
+void GPIO_InitPin(GPIO_TypeDef *GPIOx, uint8_t pin, uint8_t mode, uint8_t type, uint8_t speed, uint8_t pull)
+{
+	GPIOx->MODER &= ~(0x03 << (pin << 1));
+	GPIOx->MODER |= (mode << (pin << 1));
+	GPIOx->OTYPER &= ~(1 << pin);
+	GPIOx->OTYPER |= (type << pin);
+	GPIOx->OSPEEDR &= ~(0x03 << (pin << 1));
+	GPIOx->OSPEEDR |= (speed << (pin << 1));
+	GPIOx->PUPDR &= ~(0x03 << (pin << 1));
+	GPIOx->PUPDR |= (pull << (pin << 1));
+}
+
+
+void GPIO_WritePin(GPIO_TypeDef *GPIOx, uint8_t pin, uint8_t value)
+{
+	if (value == LOW) {GPIOx->ODR &= ~(1 << pin);}		//BSRR has no effect on host, output register is written directly
+	else {GPIOx->ODR |= (1 << pin);}
+}
+
+
+uint8_t GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint8_t pin)
+{
+	return (GPIOx->IDR >> pin) & 0x0001;
+}
+
+
+void GPIO_AlternateFunction(GPIO_TypeDef *GPIOx, uint8_t pin, uint8_t function)
+{
+	GPIOx->AFR[pin >> 3] &= ~(0x0F << ((pin & 0x07) << 2));
+	GPIOx->AFR[pin >> 3] |= (function << ((pin & 0x07) << 2));
+}
+
+
+void GPIO_ConfigureExternalInterrupt(GPIO_TypeDef *GPIOx, uint8_t pin, uint8_t pull, uint8_t edge, uint8_t priority)
+{
+	GPIO_InitPin(GPIOx, pin, INPUT, PUSH_PULL, LOW_SPEED, pull);
+	
+	EXTI->IMR |= (1 << pin);
+	if (edge != FALLING_EDGE) {EXTI->RTSR |= (1 << pin);}
+	else {EXTI->RTSR &= ~(1 << pin);}
+	if (edge != RISING_EDGE) {EXTI->FTSR |= (1 << pin);}
+	else {EXTI->FTSR &= ~(1 << pin);}
+}
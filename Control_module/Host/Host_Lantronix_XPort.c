@@ -0,0 +1,29 @@
+#include "Lantronix_XPort.h"
+
+//on host, Ethernet UART is pty (or TCP bridge connected to it), there is no XPort to be configured
+
+
+UART* UART_LANTRONIX;
+
+
+void Lantronix_XPort_Init(UART *UART_handle, uint32_t speed, GPIO_TypeDef *reset_port, uint8_t reset_pin)
+{
+	UART_LANTRONIX = UART_handle;
+	
+	GPIO_InitPin(reset_port, reset_pin, OUTPUT, PUSH_PULL, HIGH_SPEED, 0);
+	GPIO_WritePin(reset_port, reset_pin, HIGH);
+}
+
+
+void Lantronix_XPort_Reset(void)
+{
+}
+
+
+void Lantronix_XPort_GetIPAddress(uint8_t *string_IP, uint8_t *string_gateway, uint8_t *string_mask, uint8_t *string_DNS)
+{
+	strcpy(string_IP, "127.0.0.1");
+	strcpy(string_gateway, "0.0.0.0");
+	strcpy(string_mask, "255.0.0.0");
+	strcpy(string_DNS, "0.0.0.0");
+}
@@ -0,0 +1,7 @@
+#include "STM32F429ZI_SystemClock.h"
+
+
+void SystemClockConfig(uint32_t HSE_freq, uint8_t HSE_source)
+{
+	//clock of host is used, nothing to configure
+}
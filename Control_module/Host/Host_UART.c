@@ -0,0 +1,317 @@
+#include "STM32F429ZI_UART.h"
+#include "Host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>					//after CMSIS structures, termios defines CR1, CR2, CR3
+
+//UART lines of STM32 are replaced by pseudo terminals (pty) or by any existing device (emulator, real serial port)
+//environment variable CALIBRATOR_<UART name> (e.g. CALIBRATOR_USART6=/dev/pts/7) selects device to be opened,
+//otherwise new pty is created and its name is printed to stderr (with CALIBRATOR_PTY_DIR, symlink <dir>/<UART name> is created)
+
+typedef struct
+{
+	USART_TypeDef *UARTx;
+	const char *name;
+	uint8_t buffer_size;
+	uint8_t tx_buffer_size;
+	int fd;							//pty master or opened device, -1 = UART is not initialized
+	int fd_slave;				//slave side of created pty is kept open, master does not get EIO after client disconnects
+	uint8_t buffer[256];
+	uint8_t counter;
+	uint8_t write_pos;
+	uint8_t read_pos;
+	uint8_t tx_buffer[256];		//TX buffer of UART_QueueString, sent in Host_PollUARTs (instead of TX interrupt)
+	volatile uint8_t tx_counter;
+	volatile uint8_t tx_write_pos;
+	volatile uint8_t tx_read_pos;
+	UART handle;
+} Host_UART;
+
+static Host_UART host_UARTs[HOST_UART_COUNT] = {
+	{USART1, "USART1", UART1_RX_BUFFER_SIZE, UART1_TX_BUFFER_SIZE, -1, -1},
+	{USART2, "USART2", UART2_RX_BUFFER_SIZE, UART2_TX_BUFFER_SIZE, -1, -1},
+	{USART3, "USART3", UART3_RX_BUFFER_SIZE, UART3_TX_BUFFER_SIZE, -1, -1},
+	{UART4, "UART4", UART4_RX_BUFFER_SIZE, UART4_TX_BUFFER_SIZE, -1, -1},
+	{UART5, "UART5", UART5_RX_BUFFER_SIZE, UART5_TX_BUFFER_SIZE, -1, -1},
+	{USART6, "USART6", UART6_RX_BUFFER_SIZE, UART6_TX_BUFFER_SIZE, -1, -1},
+	{UART7, "UART7", UART7_RX_BUFFER_SIZE, UART7_TX_BUFFER_SIZE, -1, -1},
+	{UART8, "UART8", UART8_RX_BUFFER_SIZE, UART8_TX_BUFFER_SIZE, -1, -1}
+};
+
+static uint32_t idle_polls = 0;
+
+
+static void Host_SetRawMode(int fd)
+{
+	struct termios tio;
+	
+	if (tcgetattr(fd, &tio) != 0) {return;}		//not a terminal (e.g. FIFO)
+	cfmakeraw(&tio);
+	tcsetattr(fd, TCSANOW, &tio);
+}
+
+
+static int Host_OpenUART(Host_UART *host_UART)
+{
+	char variable[40];
+	char path[256];
+	const char *device;
+	int fd_master;
+	int fd_slave;
+	
+	sprintf(variable, "CALIBRATOR_%s", host_UART->name);
+	device = getenv(variable);
+	
+	if ((device != NULL) && (device[0] != '\0'))
+	{
+		fd_master = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		if (fd_master < 0) {fprintf(stderr, "[HOST] %s: cannot open %s (%s)\n", host_UART->name, device, strerror(errno)); return -1;}
+		Host_SetRawMode(fd_master);
+		fprintf(stderr, "[HOST] %s -> %s\n", host_UART->name, device);
+		return fd_master;
+	}
+	
+	if (openpty(&fd_master, &fd_slave, path, NULL, NULL) != 0) {fprintf(stderr, "[HOST] %s: openpty failed\n", host_UART->name); return -1;}
+	Host_SetRawMode(fd_slave);
+	fcntl(fd_master, F_SETFL, fcntl(fd_master, F_GETFL) | O_NONBLOCK);
+	host_UART->fd_slave = fd_slave;
+	fprintf(stderr, "[HOST] %s -> %s\n", host_UART->name, path);
+	
+	device = getenv("CALIBRATOR_PTY_DIR");
+	if ((device != NULL) && (device[0] != '\0'))
+	{
+		char link_path[512];
+		snprintf(link_path, sizeof(link_path), "%s/%s", device, host_UART->name);
+		unlink(link_path);
+		if (symlink(path, link_path) != 0) {fprintf(stderr, "[HOST] %s: cannot create %s\n", host_UART->name, link_path);}
+	}
+	
+	return fd_master;
+}
+
+
+UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uint8_t priority, GPIO_TypeDef *TX_port, uint8_t TX_pin, GPIO_TypeDef *RX_port, uint8_t RX_pin)
+{
+	Host_UART *host_UART = &host_UARTs[HOST_UART_COUNT - 1];
+	
+	for (uint8_t i = 0; i < HOST_UART_COUNT; i++)
+	{
+		if (host_UARTs[i].UARTx == UARTx) {host_UART = &host_UARTs[i]; break;}
+	}
+	
+	if (host_UART->fd < 0) {host_UART->fd = Host_OpenUART(host_UART);}		//line rate is given by device, baud_rate is not used
+	host_UART->counter = 0;
+	host_UART->write_pos = 0;
+	host_UART->read_pos = 0;
+	host_UART->tx_counter = 0;
+	host_UART->tx_write_pos = 0;
+	host_UART->tx_read_pos = 0;
+	
+	host_UART->handle.UARTx = UARTx;
+	host_UART->handle.UART_RX_buffer = host_UART->buffer;
+	host_UART->handle.UART_RX_buffer_size = host_UART->buffer_size;
+	host_UART->handle.UART_RX_counter = &host_UART->counter;
+	host_UART->handle.UART_RX_write_pos = &host_UART->write_pos;
+	host_UART->handle.UART_RX_read_pos = &host_UART->read_pos;
+	host_UART->handle.UART_TX_buffer = host_UART->tx_buffer;
+	host_UART->handle.UART_TX_buffer_size = host_UART->tx_buffer_size;
+	host_UART->handle.UART_TX_counter = &host_UART->tx_counter;
+	host_UART->handle.UART_TX_write_pos = &host_UART->tx_write_pos;
+	host_UART->handle.UART_TX_read_pos = &host_UART->tx_read_pos;
+	
+	return &host_UART->handle;
+}
+
+
+static void Host_WriteByte(Host_UART *host_UART, uint8_t byte)
+{
+	while (write(host_UART->fd, &byte, 1) != 1)
+	{
+		struct pollfd fd = {host_UART->fd, POLLOUT, 0};
+		if (errno != EAGAIN) {break;}
+		if (poll(&fd, 1, 100) <= 0)
+		{
+			//nobody reads the line, old data are dropped as on real UART without receiver
+			if (host_UART->fd_slave >= 0) {tcflush(host_UART->fd_slave, TCIFLUSH);}
+			else {break;}
+		}
+	}
+}
+
+
+static void Host_SendQueued(Host_UART *host_UART, uint8_t blocking)
+{
+	uint8_t byte;
+	
+	while (host_UART->tx_counter > 0)
+	{
+		byte = host_UART->tx_buffer[host_UART->tx_read_pos];
+		if (blocking == 1) {Host_WriteByte(host_UART, byte);}
+		else if (write(host_UART->fd, &byte, 1) != 1) {return;}		//line is busy, rest is sent in next poll
+		
+		host_UART->tx_read_pos++;
+		host_UART->tx_counter--;
+		if (host_UART->tx_read_pos >= host_UART->tx_buffer_size) {host_UART->tx_read_pos = 0;}
+	}
+}
+
+
+uint32_t Host_PollUARTs(void)
+{
+	uint8_t data[256];
+	uint32_t received = 0;
+	
+	for (uint8_t i = 0; i < HOST_UART_COUNT; i++)
+	{
+		Host_UART *host_UART = &host_UARTs[i];
+		if (host_UART->fd < 0) {continue;}
+	
+		Host_SendQueued(host_UART, 0);		//TX buffer is sent as by TX interrupt, firmware is not blocked
+	
+		//read only as many bytes as fits into RX buffer, rest stays in kernel (no overflow of buffer)
+		int free_space = host_UART->buffer_size - host_UART->counter;
+		if (free_space <= 0) {continue;}
+	
+		ssize_t length = read(host_UART->fd, data, free_space);
+		for (ssize_t j = 0; j < length; j++)
+		{
+			host_UART->buffer[host_UART->write_pos++] = data[j];
+			host_UART->counter++;
+			if (host_UART->write_pos >= host_UART->buffer_size) {host_UART->write_pos = 0;}
+		}
+		if (length > 0) {received += length;}
+	}
+	
+	return received;
+}
+
+
+void Host_WaitForInput(uint32_t timeout_ms)
+{
+	struct pollfd fds[HOST_UART_COUNT];
+	int count = 0;
+	
+	for (uint8_t i = 0; i < HOST_UART_COUNT; i++)
+	{
+		if (host_UARTs[i].fd < 0) {continue;}
+		if (host_UARTs[i].counter >= host_UARTs[i].buffer_size) {continue;}		//full buffer, data stay in kernel
+		fds[count].fd = host_UARTs[i].fd;
+		fds[count].events = POLLIN;
+		count++;
+	}
+	
+	poll(fds, count, timeout_ms);
+}
+
+
+void UART_SendByte(UART *UARTx, uint8_t byte)
+{
+	for (uint8_t i = 0; i < HOST_UART_COUNT; i++)
+	{
+		if ((host_UARTs[i].UARTx != UARTx->UARTx) || (host_UARTs[i].fd < 0)) {continue;}
+	
+		Host_SendQueued(&host_UARTs[i], 1);		//queued bytes are sent first, order of bytes is kept
+		Host_WriteByte(&host_UARTs[i], byte);
+		break;
+	}
+}
+
+
+void UART_SendString(UART *UARTx, uint8_t *string)
+{
+	uint16_t i = 0;
+	
+	while(string[i] != '\0')
+	{
+		UART_SendByte(UARTx, string[i++]);
+	}
+}
+
+
+uint8_t UART_QueueString(UART *UARTx, uint8_t *string)
+{
+	uint16_t length = 0;
+	
+	while (string[length] != '\0') {length++;}
+	if (length > (UARTx->UART_TX_buffer_size - *(UARTx->UART_TX_counter))) {return 0;}		//string does not fit, nothing is queued
+	
+	for (uint16_t i = 0; i < length; i++)
+	{
+		UARTx->UART_TX_buffer[*(UARTx->UART_TX_write_pos)] = string[i];
+		*(UARTx->UART_TX_write_pos) += 1;
+		
+		if (*(UARTx->UART_TX_write_pos) >= UARTx->UART_TX_buffer_size)		{*(UARTx->UART_TX_write_pos) = 0;}
+	}
+	
+	*(UARTx->UART_TX_counter) += length;
+	Host_PollUARTs();		//start of transmission (TX interrupt)
+	
+	return 1;
+}
+
+
+uint8_t UART_ReadByte(UART *UARTx)
+{
+	uint8_t data = 0;
+	
+	data = UARTx->UART_RX_buffer[*(UARTx->UART_RX_read_pos)];
+	*(UARTx->UART_RX_read_pos) += 1;
+	*(UARTx->UART_RX_counter) -= 1;
+	
+	if (*(UARTx->UART_RX_read_pos) >= UARTx->UART_RX_buffer_size)		{*(UARTx->UART_RX_read_pos) = 0;}
+	
+	return data;
+}
+
+
+void UART_ReadLine(UART *UARTx, uint8_t *string)
+{
+	uint8_t byte;
+	uint8_t i = 0;
+	
+	do
+	{
+		while (UART_AvailableBytes(UARTx) == 0);	//wait until something is available in RX buffer
+		byte = UART_ReadByte(UARTx);
+		string[i++] = byte;
+	} while ((byte != '\n') && (byte != '\r'));
+	
+	string[i-1] = '\0';		//i-1 to remove '\n' from string
+}
+
+
+uint8_t UART_AvailableBytes(UART *UARTx)
+{
+	//there is no RX interrupt, buffers are filled here (firmware always polls this function while waiting for data)
+	if (Host_PollUARTs() > 0) {idle_polls = 0;}
+	else if (*(UARTx->UART_RX_counter) == 0)
+	{
+		idle_polls++;
+		if (idle_polls >= HOST_IDLE_POLLS)			//main loop is busy loop, process sleeps until data arrive
+		{
+			idle_polls = 0;
+			Host_WaitForInput(HOST_IDLE_TIMEOUT_MS);
+		}
+	}
+	
+	return *(UARTx->UART_RX_counter);
+}
+
+
+void UART_ClearRXBuffer(UART *UARTx)
+{
+	for (uint8_t i = 0; i < UARTx->UART_RX_buffer_size; i++)
+	{
+		UARTx->UART_RX_buffer[i] = 0;
+	}
+	
+	*(UARTx->UART_RX_counter) = 0;
+	*(UARTx->UART_RX_write_pos) = 0;
+	*(UARTx->UART_RX_read_pos) = 0;
+}
@@ -0,0 +1,374 @@
+//=====================================================================
+//Benchmark of remote control of calibrator (latency and throughput)
+//endpoint is serial port (USB, pty of host build) or TCP (XPort)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "Host_link.h"
+
+
+#define BENCHMARK_MAX_SAMPLES		10000
+#define BENCHMARK_LINE_SIZE			512
+#define BENCHMARK_FENCE					"FUNC?"		//every command is followed by query, its answer marks end of command
+#define BENCHMARK_LIST_SIZE			32				//TRIGGER_LIST_SIZE of firmware
+#define BENCHMARK_COMMAND_SIZE	49				//command[50] in Calibrator_HandleRemoteControl, longer lines are not sent
+
+typedef struct
+{
+	const char *name;
+	uint32_t commands;
+	uint32_t errors;
+	uint32_t timeouts;
+	double elapsed_s;
+	uint32_t samples;
+	double latency_ms[BENCHMARK_MAX_SAMPLES];
+} Benchmark_result;
+
+typedef struct
+{
+	const char *name;
+	void (*run)(Benchmark_result *result);
+	const char *description;
+} Benchmark_mix;
+
+static Link link;
+static uint32_t iterations = 20;
+static uint32_t timeout_ms = 5000;
+static uint8_t verbose = 0;
+
+
+void Benchmark_AddSample(Benchmark_result *result, double latency_ms)
+{
+	if (result->samples < BENCHMARK_MAX_SAMPLES) {result->latency_ms[result->samples++] = latency_ms;}
+}
+
+
+/**
+* @brief - send command followed by fence query and wait for answer of fence, errors of firmware are counted
+* @returns - latency in milliseconds, negative after timeout
+*/
+double Benchmark_Execute(Benchmark_result *result, const char *command)
+{
+	char line[BENCHMARK_LINE_SIZE];
+	double start = Link_GetTime_ms();
+	
+	Link_Send(&link, command);
+	Link_Send(&link, BENCHMARK_FENCE);
+	result->commands++;
+	
+	while (Link_ReadLine(&link, line, sizeof(line), start + timeout_ms))
+	{
+		if (strncmp(line, "ERROR", 5) == 0) {result->errors++;}
+		else if (Link_IsFenceAnswer(line))
+		{
+			double latency = Link_GetTime_ms() - start;
+			Benchmark_AddSample(result, latency);
+			return latency;
+		}
+	}
+	
+	result->timeouts++;
+	return -1.0;
+}
+
+
+/**
+* @brief - execute command outside of measurement (selection of module, setup of mix), waits until endpoint is idle
+* @returns - nothing
+*/
+void Benchmark_Setup(const char *command)
+{
+	static Benchmark_result dummy;
+	
+	dummy.commands = dummy.errors = dummy.timeouts = dummy.samples = 0;
+	Benchmark_Execute(&dummy, command);
+	if ((dummy.errors > 0) || (dummy.timeouts > 0)) {fprintf(stderr, "setup command \"%s\" failed\n", command);}
+}
+
+
+//single set-points in one range
+void Benchmark_MixSetpoint(Benchmark_result *result)
+{
+	char command[64];
+	
+	Benchmark_Setup("FUNC VOLT");
+	Benchmark_Setup("VOLT:RANG 2");
+	
+	double start = Link_GetTime_ms();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		snprintf(command, sizeof(command), "VOLT %.6f", 0.5 + (i % 10) * 0.1);
+		Benchmark_Execute(result, command);
+	}
+	result->elapsed_s = (Link_GetTime_ms() - start) / 1000.0;
+}
+
+
+//range change with new value after each command (relays, DAC parking)
+void Benchmark_MixRange(Benchmark_result *result)
+{
+	static const char *commands[] = {"VOLT:RANG 1", "VOLT 0.1", "VOLT:RANG 3", "VOLT 10.0", "VOLT:RANG 2", "VOLT 1.0"};
+	
+	Benchmark_Setup("FUNC VOLT");
+	
+	double start = Link_GetTime_ms();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		Benchmark_Execute(result, commands[i % (sizeof(commands) / sizeof(commands[0]))]);
+	}
+	result->elapsed_s = (Link_GetTime_ms() - start) / 1000.0;
+}
+
+
+//queries sent at once without waiting for answers, latency of each answer from start of burst
+void Benchmark_MixQuery(Benchmark_result *result)
+{
+	static const char *commands[] = {"VOLT?", "VOLT:RANG?", "VOLT:MODE?", "VOLT:OUTP?", "TRIG?"};
+	char line[BENCHMARK_LINE_SIZE];
+	uint32_t answers = 0;
+	
+	Benchmark_Setup("FUNC VOLT");
+	
+	double start = Link_GetTime_ms();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		Link_Send(&link, commands[i % (sizeof(commands) / sizeof(commands[0]))]);
+		result->commands++;
+	}
+	Link_Send(&link, BENCHMARK_FENCE);
+	
+	while (Link_ReadLine(&link, line, sizeof(line), start + timeout_ms + (iterations * 100.0)))
+	{
+		if (Link_IsFenceAnswer(line)) {break;}
+		if (strncmp(line, "ERROR", 5) == 0) {result->errors++;}
+		if (answers < iterations) {Benchmark_AddSample(result, Link_GetTime_ms() - start);}
+		answers++;
+	}
+	if (answers < iterations) {result->timeouts += iterations - answers;}
+	result->elapsed_s = (Link_GetTime_ms() - start) / 1000.0;
+}
+
+
+//whole state of CLVB by separate queries (as dashboard without STAT:ALL?), one sample per snapshot
+void Benchmark_MixPoll(Benchmark_result *result)
+{
+	static const char *commands[] = {"VOLT?", "VOLT:FREQ?", "VOLT:RANG?", "VOLT:MODE?", "VOLT:OUTP?", "VOLT:RANG:AUTO?", "TRIG?"};
+	char line[BENCHMARK_LINE_SIZE];
+	
+	Benchmark_Setup("FUNC VOLT");
+	
+	double start = Link_GetTime_ms();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		double snapshot_start = Link_GetTime_ms();
+		uint8_t fence = 0;
+	
+		for (uint32_t j = 0; j < (sizeof(commands) / sizeof(commands[0])); j++) {Link_Send(&link, commands[j]); result->commands++;}
+		Link_Send(&link, BENCHMARK_FENCE);
+	
+		while ((fence == 0) && Link_ReadLine(&link, line, sizeof(line), snapshot_start + timeout_ms))
+		{
+			if (strncmp(line, "ERROR", 5) == 0) {result->errors++;}
+			else if (Link_IsFenceAnswer(line)) {fence = 1;}
+		}
+		if (fence == 1) {Benchmark_AddSample(result, Link_GetTime_ms() - snapshot_start);}
+		else {result->timeouts++;}
+	}
+	result->elapsed_s = (Link_GetTime_ms() - start) / 1000.0;
+}
+
+
+//whole state of all modules by one query (STAT:ALL?)
+void Benchmark_MixState(Benchmark_result *result)
+{
+	double start = Link_GetTime_ms();
+	
+	for (uint32_t i = 0; i < iterations; i++) {Benchmark_Execute(result, "STAT:ALL?");}
+	result->elapsed_s = (Link_GetTime_ms() - start) / 1000.0;
+}
+
+
+//upload of trigger list (as many values as fits into one command) and read back
+void Benchmark_MixList(Benchmark_result *result)
+{
+	char command[BENCHMARK_LINE_SIZE];
+	char value[16];
+	int length;
+	
+	Benchmark_Setup("FUNC VOLT");
+	
+	double start = Link_GetTime_ms();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		length = snprintf(command, sizeof(command), "TRIG:LIST ");
+		for (uint32_t j = 0; j < BENCHMARK_LIST_SIZE; j++)
+		{
+			int value_length = snprintf(value, sizeof(value), "%s%.2f", (j > 0) ? "," : "", 0.5 + ((i + j) % 50) * 0.01);
+			if ((length + value_length) > BENCHMARK_COMMAND_SIZE) {break;}
+			strcpy(command + length, value);
+			length += value_length;
+		}
+		Benchmark_Execute(result, command);
+		Benchmark_Execute(result, "TRIG:LIST?");
+	}
+	result->elapsed_s = (Link_GetTime_ms() - start) / 1000.0;
+	Benchmark_Setup("TRIG:LIST:CLR");
+}
+
+
+double Benchmark_GetPercentile(Benchmark_result *result, double percentile)
+{
+	return Link_GetPercentile(result->latency_ms, result->samples, percentile);
+}
+
+
+void Benchmark_PrintResults(FILE *file, Benchmark_result *results, uint32_t count, const char *format, const char *endpoint, uint32_t baud_rate)
+{
+	if (strcmp(format, "json") == 0)
+	{
+		fprintf(file, "{\"endpoint\": \"%s\", \"baud_rate\": %u, \"iterations\": %u, \"mixes\": [\n", endpoint, baud_rate, iterations);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Benchmark_result *r = &results[i];
+			fprintf(file, "  {\"mix\": \"%s\", \"commands\": %u, \"errors\": %u, \"timeouts\": %u, \"p50_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f, \"commands_per_s\": %.3f}%s\n",
+				r->name, r->commands, r->errors, r->timeouts, Benchmark_GetPercentile(r, 50.0), Benchmark_GetPercentile(r, 99.0),
+				Benchmark_GetPercentile(r, 100.0), (r->elapsed_s > 0.0) ? (r->commands / r->elapsed_s) : 0.0, (i < (count - 1)) ? "," : "");
+		}
+		fprintf(file, "]}\n");
+	}
+	else
+	{
+		fprintf(file, "mix,commands,errors,timeouts,p50_ms,p99_ms,max_ms,commands_per_s\n");
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Benchmark_result *r = &results[i];
+			fprintf(file, "%s,%u,%u,%u,%.3f,%.3f,%.3f,%.3f\n", r->name, r->commands, r->errors, r->timeouts,
+				Benchmark_GetPercentile(r, 50.0), Benchmark_GetPercentile(r, 99.0), Benchmark_GetPercentile(r, 100.0),
+				(r->elapsed_s > 0.0) ? (r->commands / r->elapsed_s) : 0.0);
+		}
+	}
+}
+
+
+/**
+* @brief - compare results with baseline in CSV format (output of previous run with -f csv)
+* @returns - nothing
+*/
+void Benchmark_CompareBaseline(const char *path, Benchmark_result *results, uint32_t count)
+{
+	FILE *file = fopen(path, "r");
+	char line[BENCHMARK_LINE_SIZE];
+	char name[64];
+	unsigned commands, errors, timeouts;
+	double p50, p99, max, throughput;
+	
+	if (file == NULL) {fprintf(stderr, "cannot open baseline %s\n", path); return;}
+	
+	fprintf(stderr, "\n%-10s %18s %18s %22s\n", "vs. base", "p50 [ms]", "p99 [ms]", "commands/s");
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		if (sscanf(line, "%63[^,],%u,%u,%u,%lf,%lf,%lf,%lf", name, &commands, &errors, &timeouts, &p50, &p99, &max, &throughput) != 8) {continue;}
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Benchmark_result *r = &results[i];
+			if (strcmp(r->name, name) != 0) {continue;}
+			double new_p50 = Benchmark_GetPercentile(r, 50.0);
+			double new_p99 = Benchmark_GetPercentile(r, 99.0);
+			double new_throughput = (r->elapsed_s > 0.0) ? (r->commands / r->elapsed_s) : 0.0;
+			fprintf(stderr, "%-10s %8.1f (%+6.1f%%) %8.1f (%+6.1f%%) %10.2f (%+6.1f%%)\n", name,
+				new_p50, (p50 > 0.0) ? (100.0 * (new_p50 - p50) / p50) : 0.0,
+				new_p99, (p99 > 0.0) ? (100.0 * (new_p99 - p99) / p99) : 0.0,
+				new_throughput, (throughput > 0.0) ? (100.0 * (new_throughput - throughput) / throughput) : 0.0);
+		}
+	}
+	
+	fclose(file);
+}
+
+
+static const Benchmark_mix mixes[] = {
+	{"setpoint", Benchmark_MixSetpoint, "VOLT x in range 2, one command at a time"},
+	{"range", Benchmark_MixRange, "VOLT:RANG 1/3/2 with VOLT after each change"},
+	{"query", Benchmark_MixQuery, "burst of queries without waiting for answers"},
+	{"list", Benchmark_MixList, "TRIG:LIST (longest command accepted by firmware) and TRIG:LIST?"},
+	{"poll", Benchmark_MixPoll, "state of CLVB by 7 separate queries"},
+	{"state", Benchmark_MixState, "state of all modules by STAT:ALL?"}
+};
+
+static Benchmark_result results[sizeof(mixes) / sizeof(mixes[0])];
+
+
+int main(int argc, char **argv)
+{
+	const char *device = NULL;
+	const char *address = NULL;
+	const char *selection = "setpoint,range,query,list";
+	const char *format = "json";
+	const char *output = NULL;
+	const char *baseline = NULL;
+	uint32_t baud_rate = 9600;
+	uint32_t count = 0;
+	int option;
+	
+	while ((option = getopt(argc, argv, "d:t:b:m:n:T:f:o:B:v")) != -1)
+	{
+		switch (option)
+		{
+			case 'd': device = optarg; break;
+			case 't': address = optarg; break;
+			case 'b': baud_rate = strtoul(optarg, NULL, 10); break;
+			case 'm': selection = optarg; break;
+			case 'n': iterations = strtoul(optarg, NULL, 10); break;
+			case 'T': timeout_ms = strtoul(optarg, NULL, 10); break;
+			case 'f': format = optarg; break;
+			case 'o': output = optarg; break;
+			case 'B': baseline = optarg; break;
+			case 'v': verbose = 1; break;
+			default:
+				fprintf(stderr, "usage: %s -d device | -t host:port [-b baud] [-m mixes] [-n iterations] [-T timeout_ms] [-f json|csv] [-o file] [-B baseline.csv] [-v]\n", argv[0]);
+				for (uint32_t i = 0; i < (sizeof(mixes) / sizeof(mixes[0])); i++) {fprintf(stderr, "  %-10s %s\n", mixes[i].name, mixes[i].description);}
+				return 1;
+		}
+	}
+	
+	if ((device == NULL) == (address == NULL)) {fprintf(stderr, "select one endpoint: -d device or -t host:port\n"); return 1;}
+	if (iterations > BENCHMARK_MAX_SAMPLES / 2) {iterations = BENCHMARK_MAX_SAMPLES / 2;}
+	Link_Init(&link, NULL, verbose);
+	if ((device != NULL) && (Link_OpenSerial(&link, device, baud_rate) != 0)) {return 1;}
+	if ((address != NULL) && (Link_OpenTCP(&link, address) != 0)) {return 1;}
+	
+	for (uint32_t i = 0; i < (sizeof(mixes) / sizeof(mixes[0])); i++)
+	{
+		if (strstr(selection, mixes[i].name) == NULL) {continue;}
+	
+		Benchmark_result *result = &results[count++];
+		memset(result, 0, sizeof(*result));
+		result->name = mixes[i].name;
+		mixes[i].run(result);
+		Link_SortValues(result->latency_ms, result->samples);
+	
+		fprintf(stderr, "%-10s %4u commands, %u errors, %u timeouts, p50 %.1f ms, p99 %.1f ms, %.2f commands/s\n",
+			result->name, result->commands, result->errors, result->timeouts, Benchmark_GetPercentile(result, 50.0),
+			Benchmark_GetPercentile(result, 99.0), (result->elapsed_s > 0.0) ? (result->commands / result->elapsed_s) : 0.0);
+	}
+	
+	if (output != NULL)
+	{
+		FILE *file = fopen(output, "w");
+		if (file == NULL) {fprintf(stderr, "cannot create %s\n", output); return 1;}
+		Benchmark_PrintResults(file, results, count, format, (device != NULL) ? device : address, baud_rate);
+		fclose(file);
+	}
+	else {Benchmark_PrintResults(stdout, results, count, format, (device != NULL) ? device : address, baud_rate);}
+	
+	if (baseline != NULL) {Benchmark_CompareBaseline(baseline, results, count);}
+	
+	Link_Close(&link);
+	
+	return 0;
+}
@@ -0,0 +1,921 @@
+//=====================================================================
+//Emulator of whole calibrator for remote control over TCP (XPort)
+//command set, replies and range limits are the same as in main.c,
+//CLVB.c and CCB.c, time of commands is given by timing model
+//(line rates, register writes, verification, relays), one process
+//serves several virtual calibrators on consecutive ports
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "../Calibrator_errors.h"
+
+
+#define EMULATOR_MAX_INSTANCES		256
+#define EMULATOR_RX_BUFFER_SIZE		128				//UART5_RX_BUFFER_SIZE of firmware
+#define EMULATOR_PENDING_SIZE			4096			//bytes received from TCP, waiting for line rate (XPort buffer)
+#define EMULATOR_COMMAND_SIZE			49				//command[50] in Calibrator_HandleRemoteControl
+#define EMULATOR_READ_RETRIES			100				//Calibrator_ReadCommand waits 100x 10 ms for end of line
+#define EMULATOR_IDLE_POLL_MS			100
+
+#define MODULE_NONE		0
+#define MODULE_CLVB		1
+#define MODULE_CCB		2
+
+#define MODE_DC				0
+#define MODE_AC				1
+
+#define STATE_IDLE		0				//main loop polls RX buffer
+#define STATE_READ		1				//delay_ms(10) in main loop or in Calibrator_ReadCommand is running
+#define STATE_EXECUTE	2				//command is executed, reply is sent when time of command elapses
+
+//number of register lines in dump after G003F, every line is read with delay_ms(10) in Module_ReadAllRegisters
+#define CLVB_DUMP_LINES		5
+#define CCB_DUMP_LINES		3
+
+typedef struct
+{
+	uint32_t host_baud;					//USB/Ethernet line, 0 = no limit
+	uint32_t module_baud;				//UART of CLVB and CCB, 0 = no limit
+	uint32_t loop_delay_us;			//delay_ms(10) before Calibrator_HandleRemoteControl
+	uint32_t write_delay_us;		//delay_ms(10) after write into register
+	uint32_t verify_delay_us;		//delay_ms(100) before reading of dump (G003F)
+	uint32_t line_delay_us;			//delay_ms(10) after every line of dump
+	uint32_t relay_settle_us;		//added to commands which switch relays (output is settled when reply is sent)
+	double time_scale;					//1.0 = real time, 0.1 = 10x faster
+	double fault;								//probability of unsuccessful write into register (ERROR_COMMUNICATION)
+} Emulator_timing;
+
+typedef struct
+{
+	double voltage;
+	double frequency;
+	uint8_t range;
+	uint8_t mode;
+	uint8_t output_state;
+	uint8_t autorange_state;
+} CLVB_state;
+
+typedef struct
+{
+	double current;
+	uint8_t range;
+	uint8_t output_state;
+	uint8_t autorange_state;
+} CCB_state;
+
+typedef struct
+{
+	int listen_fd;
+	int fd;
+	uint16_t port;
+	
+	//bytes on the line between XPort and UART of firmware
+	uint8_t pending[EMULATOR_PENDING_SIZE];
+	uint32_t pending_length;
+	uint64_t pending_time_us;				//time when last pending byte is complete on the line
+	uint64_t pending_first_us;			//time when first pending byte is complete
+	
+	//UART RX buffer of firmware
+	uint8_t RX_buffer[EMULATOR_RX_BUFFER_SIZE];
+	uint32_t RX_count;
+	uint32_t RX_read_position;
+	uint32_t overruns;
+	
+	//main loop
+	uint8_t state;
+	uint64_t busy_until_us;
+	uint8_t command[EMULATOR_COMMAND_SIZE + 2];
+	uint32_t command_length;
+	uint8_t command_overflow;
+	uint32_t read_retries;
+	char reply[320];
+	uint32_t reply_length;
+	
+	//state of firmware (module_selected, desired values, CLVB_state, CCB_state and their copies in main.c)
+	uint8_t module_selected;
+	double CLVB_voltage;
+	double CLVB_frequency;
+	double CCB_current;
+	CLVB_state CLVB;
+	CCB_state CCB;
+	CLVB_state CLVB_main;						//CLVB_state_main, updated by GetStateCLVB() after VOLT commands
+	CCB_state CCB_main;							//CCB_state_main, updated by GetStateCCB() after CURR commands
+	char string[300];								//global string of main.c, formats which do not match range send old content
+	
+	//statistics
+	uint32_t commands;
+	uint32_t errors;
+	uint64_t busy_us;
+} Emulator_instance;
+
+static Emulator_timing timing = {9600, 9600, 10000, 10000, 100000, 10000, 0, 1.0, 0.0};
+static Emulator_instance *instances = NULL;
+static uint32_t instance_count = 1;
+static uint8_t verbose = 0;
+static uint64_t start_time_us = 0;
+static volatile sig_atomic_t stop_requested = 0;
+
+//the same limits as in CLVB.c and CCB.c
+static const double CLVB_max[4] = {0.0, 0.22, 2.2, 22.0};
+static const double CLVB_min[4] = {0.0, -0.22, -2.2, -22.0};
+static const double CLVB_freq_max = 10000.0;
+static const double CLVB_freq_min = 0.0;
+static const double CCB_max[4] = {0.0, 0.022, 0.22, 2.2};
+static const double CCB_min[4] = {0.0, 0.0, 0.0, 0.0};
+
+static const char *error_messages[] = {
+	"",
+	"ERROR: Wrong input.\n\r",
+	"ERROR: Unknown command.\n\r",
+	"ERROR: Unsuccessful communication with module (internal problem).\n\r",
+	"ERROR: Wrong module is connected to UART line (internal problem).\n\r",
+	"ERROR: Voltage module is not selected.\n\r",
+	"ERROR: Current module is not selected.\n\r",
+	"ERROR: Voltage is out of range.\n\r",
+	"ERROR: Current is out of range.\n\r",
+	"ERROR: Frequency is out of range.\n\r",
+	"ERROR: Requested range does not exist.\n\r",
+	"ERROR: No module is selected.\n\r",
+	"ERROR: Modules are not armed.\n\r"
+};
+
+
+static uint64_t Emulator_GetTime_us(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return ((uint64_t) now.tv_sec * 1000000) + (now.tv_nsec / 1000) - start_time_us;
+}
+
+
+static uint64_t Emulator_Scale(uint64_t time_us)
+{
+	return (uint64_t) (time_us * timing.time_scale);
+}
+
+
+static uint64_t Emulator_GetByteTime_us(uint32_t baud_rate)
+{
+	if (baud_rate == 0) {return 0;}
+	
+	return (10 * 1000000ULL) / baud_rate;		//start bit, 8 data bits, stop bit
+}
+
+
+static void Emulator_StopHandler(int signal_number)
+{
+	stop_requested = 1;
+}
+
+
+static uint8_t Emulator_CheckForSubstring(const uint8_t *string, const char *substring)
+{
+	return strncmp((const char *) string, substring, strlen(substring)) == 0;		//Utils_CheckForSubstring
+}
+
+
+static void Emulator_Log(Emulator_instance *instance, const char *format, ...)
+{
+	va_list arguments;
+	
+	if (verbose == 0) {return;}
+	
+	fprintf(stderr, "[%10.3f ms] [%u] ", Emulator_GetTime_us() / 1000.0, instance->port);
+	va_start(arguments, format);
+	vfprintf(stderr, format, arguments);
+	va_end(arguments);
+	fprintf(stderr, "\n");
+}
+
+
+//===================================== timing model of modules =====================================
+
+/**
+* @brief - time of Module_WriteToRegister (write, delay, G003F, dump with delay after every line), fault of verification
+* @param instance - virtual calibrator
+* @param hex_size - number of hex digits of register
+* @param dump_lines - register lines in dump of module
+* @param time_us - time of command, time of write is added
+* @returns - NO_ERROR or ERROR_COMMUNICATION
+*/
+static uint8_t Emulator_WriteRegister(Emulator_instance *instance, uint8_t hex_size, uint8_t dump_lines, uint64_t *time_us)
+{
+	uint64_t byte_time = Emulator_GetByteTime_us(timing.module_baud);
+	
+	*time_us += ((1 + hex_size + 2) * byte_time) + timing.write_delay_us;		//"<reg><hex>\n\r" and delay_ms(10)
+	*time_us += (7 * byte_time) + timing.verify_delay_us;									//"G003F\n\r" and delay_ms(100)
+	
+	if ((timing.fault > 0.0) && ((double) rand() / RAND_MAX < timing.fault)) {return ERROR_COMMUNICATION;}		//no dump
+	
+	*time_us += dump_lines * timing.line_delay_us;
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CLVB_CheckRange(Emulator_instance *instance, double voltage)
+{
+	uint8_t range = instance->CLVB.range;
+	
+	if ((range >= 1) && (range <= 3) && ((voltage > CLVB_max[range]) || (voltage < CLVB_min[range]))) {return ERROR_VOLT_RANGE;}
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CLVB_SelectRange(double voltage)
+{
+	for (uint8_t range = 1; range <= 3; range++)
+	{
+		if ((voltage <= CLVB_max[range]) && (voltage >= CLVB_min[range])) {return range;}
+	}
+	
+	return 0;		//voltage is out of all ranges
+}
+
+
+static uint8_t CLVB_SetRange(Emulator_instance *instance, uint8_t range, uint64_t *time_us)
+{
+	uint8_t error;
+	
+	if ((range < 1) || (range > 3)) {return ERROR_NONEXISTENT_RANGE;}
+	
+	error = Emulator_WriteRegister(instance, 4, CLVB_DUMP_LINES, time_us);		//register H (K2, K3)
+	if (error != NO_ERROR) {return error;}
+	
+	if (range != instance->CLVB.range) {*time_us += timing.relay_settle_us;}
+	instance->CLVB.range = range;
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CLVB_SetFrequency(Emulator_instance *instance, double frequency, uint64_t *time_us)
+{
+	uint8_t error;
+	
+	if ((frequency > CLVB_freq_max) || (frequency < CLVB_freq_min)) {return ERROR_FREQ_RANGE;}
+	
+	error = Emulator_WriteRegister(instance, 8, CLVB_DUMP_LINES, time_us);		//register J (FTW)
+	if (error != NO_ERROR) {return error;}
+	
+	instance->CLVB.frequency = frequency;
+	
+	return NO_ERROR;
+}
+
+
+//CLVB_SetVoltageDC and CLVB_SetVoltageAC, range change is one write into register K
+static uint8_t CLVB_SetVoltage(Emulator_instance *instance, double voltage, uint8_t mode, double frequency, uint64_t *time_us)
+{
+	uint8_t error = NO_ERROR;
+	uint8_t range = instance->CLVB.range;
+	
+	if (instance->CLVB.autorange_state == 0) {error = CLVB_CheckRange(instance, voltage);}
+	else
+	{
+		range = CLVB_SelectRange(voltage);
+		if (range == 0) {error = ERROR_VOLT_RANGE;}
+	}
+	if (error != NO_ERROR) {return error;}
+	
+	if (mode == MODE_AC)
+	{
+		error = CLVB_SetFrequency(instance, frequency, time_us);
+		if (error != NO_ERROR) {return error;}
+	}
+	
+	error = Emulator_WriteRegister(instance, 4, CLVB_DUMP_LINES, time_us);		//register H (AC bit)
+	if (error != NO_ERROR) {return error;}
+	instance->CLVB.mode = mode;
+	
+	if (range != instance->CLVB.range)
+	{
+		error = Emulator_WriteRegister(instance, 8, CLVB_DUMP_LINES, time_us);		//register K (relays + code)
+		if (error != NO_ERROR) {return error;}
+		*time_us += timing.relay_settle_us;
+		instance->CLVB.range = range;
+	}
+	else
+	{
+		error = Emulator_WriteRegister(instance, 8, CLVB_DUMP_LINES, time_us);		//register I (code)
+		if (error != NO_ERROR) {return error;}
+	}
+	instance->CLVB.voltage = voltage;
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CLVB_SetOutput(Emulator_instance *instance, uint8_t on, uint64_t *time_us)
+{
+	uint8_t error;
+	
+	error = Emulator_WriteRegister(instance, 4, CLVB_DUMP_LINES, time_us);		//register H (K1)
+	if (error != NO_ERROR) {return error;}
+	
+	if (on != instance->CLVB.output_state) {*time_us += timing.relay_settle_us;}
+	instance->CLVB.output_state = on;
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CCB_CheckRange(Emulator_instance *instance, double current)
+{
+	uint8_t range = instance->CCB.range;
+	
+	//CCB.c returns ERROR_VOLT_RANGE also for current
+	if ((range >= 1) && (range <= 3) && ((current > CCB_max[range]) || (current < CCB_min[range]))) {return ERROR_VOLT_RANGE;}
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CCB_SetRange(Emulator_instance *instance, uint8_t range, uint64_t *time_us)
+{
+	uint8_t error;
+	
+	//CCB_SetRange does not check range, nonexistent range is stored and current is then not limited
+	error = Emulator_WriteRegister(instance, 4, CCB_DUMP_LINES, time_us);		//register H (K1, K2)
+	if (error != NO_ERROR) {return error;}
+	
+	if (range != instance->CCB.range) {*time_us += timing.relay_settle_us;}
+	instance->CCB.range = range;
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CCB_SetCurrent(Emulator_instance *instance, double current, uint64_t *time_us)
+{
+	uint8_t error = NO_ERROR;
+	
+	if (instance->CCB.autorange_state == 0) {error = CCB_CheckRange(instance, current);}
+	else
+	{
+		//CCB_Autorange checks range number (1, 2, 3) instead of current and does not switch range
+		if ((current <= CCB_max[1]) && (current >= CCB_min[1])) {error = CCB_CheckRange(instance, 1);}
+		else if ((current <= CCB_max[2]) && (current >= CCB_min[2])) {error = CCB_CheckRange(instance, 2);}
+		else if ((current <= CCB_max[3]) && (current >= CCB_min[3])) {error = CCB_CheckRange(instance, 3);}
+		else {error = ERROR_VOLT_RANGE;}
+	}
+	if (error != NO_ERROR) {return error;}
+	
+	error = Emulator_WriteRegister(instance, 8, CCB_DUMP_LINES, time_us);		//register I (code)
+	if (error != NO_ERROR) {return error;}
+	instance->CCB.current = current;
+	
+	return NO_ERROR;
+}
+
+
+static uint8_t CCB_SetOutput(Emulator_instance *instance, uint8_t on, uint64_t *time_us)
+{
+	uint8_t error;
+	
+	error = Emulator_WriteRegister(instance, 4, CCB_DUMP_LINES, time_us);		//register H (K4)
+	if (error != NO_ERROR) {return error;}
+	
+	if (on != instance->CCB.output_state) {*time_us += timing.relay_settle_us;}
+	instance->CCB.output_state = on;
+	
+	return NO_ERROR;
+}
+
+
+//===================================== command handling (main.c) =====================================
+
+static void Emulator_Send(Emulator_instance *instance, const char *string)
+{
+	size_t length = strlen(string);
+	
+	if (instance->reply_length + length >= sizeof(instance->reply)) {return;}
+	memcpy(instance->reply + instance->reply_length, string, length + 1);
+	instance->reply_length += length;
+}
+
+
+static uint8_t Emulator_HandleVOLT(Emulator_instance *instance, const uint8_t *command, uint64_t *time_us)
+{
+	uint8_t error = NO_ERROR;
+	int range = 0;
+	
+	if (instance->module_selected != MODULE_CLVB) {return ERROR_VOLT_NOT_SELECTED;}
+	
+	if (Emulator_CheckForSubstring(command, "VOLT "))
+	{
+		if (sscanf((const char *) command, "VOLT %lf", &instance->CLVB_voltage) != 1) {error = ERROR_USER_INPUT;}
+		else {error = CLVB_SetVoltage(instance, instance->CLVB_voltage, instance->CLVB_main.mode, instance->CLVB_frequency, time_us);}
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT?"))
+	{
+		if (instance->CLVB_main.range == 1) {sprintf(instance->string, "%.7f V\n\r", instance->CLVB_main.voltage);}
+		else if (instance->CLVB_main.range == 2) {sprintf(instance->string, "%.6f V\n\r", instance->CLVB_main.voltage);}
+		else if (instance->CLVB_main.range == 3) {sprintf(instance->string, "%.5f V\n\r", instance->CLVB_main.voltage);}
+		Emulator_Send(instance, instance->string);
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:FREQ "))
+	{
+		if (sscanf((const char *) command, "VOLT:FREQ %lf", &instance->CLVB_frequency) != 1) {error = ERROR_USER_INPUT;}
+		else {error = CLVB_SetFrequency(instance, instance->CLVB_frequency, time_us);}
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:FREQ?"))
+	{
+		sprintf(instance->string, "%.7f Hz\n\r", instance->CLVB_main.frequency);
+		Emulator_Send(instance, instance->string);
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:RANG "))
+	{
+		if (sscanf((const char *) command, "VOLT:RANG %d", &range) != 1) {error = ERROR_USER_INPUT;}
+		else {error = CLVB_SetRange(instance, (uint8_t) range, time_us);}
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:RANG?"))
+	{
+		sprintf(instance->string, "%d\n\r", instance->CLVB_main.range);
+		Emulator_Send(instance, instance->string);
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:RANG:AUTO ON")) {instance->CLVB.autorange_state = 1;}
+	else if (Emulator_CheckForSubstring(command, "VOLT:RANG:AUTO OFF")) {instance->CLVB.autorange_state = 0;}
+	else if (Emulator_CheckForSubstring(command, "VOLT:RANG:AUTO?"))
+	{
+		Emulator_Send(instance, (instance->CLVB_main.autorange_state == 1) ? "Autorange is ON.\n\r" : "Autorange is OFF.\n\r");
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:MODE DC"))
+	{
+		error = CLVB_SetVoltage(instance, instance->CLVB_main.voltage, MODE_DC, instance->CLVB_main.frequency, time_us);
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:MODE AC"))
+	{
+		error = CLVB_SetVoltage(instance, instance->CLVB_main.voltage, MODE_AC, instance->CLVB_main.frequency, time_us);
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:MODE?"))
+	{
+		Emulator_Send(instance, (instance->CLVB_main.mode == MODE_DC) ? "DC mode.\n\r" : "AC mode.\n\r");
+	}
+	else if (Emulator_CheckForSubstring(command, "VOLT:OUTP ON")) {error = CLVB_SetOutput(instance, 1, time_us);}
+	else if (Emulator_CheckForSubstring(command, "VOLT:OUTP OFF")) {error = CLVB_SetOutput(instance, 0, time_us);}
+	else if (Emulator_CheckForSubstring(command, "VOLT:OUTP?"))
+	{
+		Emulator_Send(instance, (instance->CLVB_main.output_state == 1) ? "Output ON.\n\r" : "Output OFF.\n\r");
+	}
+	else {error = ERROR_UNKNOWN_COMMAND;}
+	
+	instance->CLVB_main = instance->CLVB;		//GetStateCLVB()
+	
+	return error;
+}
+
+
+static uint8_t Emulator_HandleCURR(Emulator_instance *instance, const uint8_t *command, uint64_t *time_us)
+{
+	uint8_t error = NO_ERROR;
+	int range = 0;
+	
+	if (instance->module_selected != MODULE_CCB) {return ERROR_CURR_NOT_SELECTED;}
+	
+	if (Emulator_CheckForSubstring(command, "CURR "))
+	{
+		if (sscanf((const char *) command, "CURR %lf", &instance->CCB_current) != 1) {error = ERROR_USER_INPUT;}
+		else {error = CCB_SetCurrent(instance, instance->CCB_current, time_us);}
+	}
+	else if (Emulator_CheckForSubstring(command, "CURR?"))
+	{
+		//main.c formats current by range of CLVB and with unit V
+		if (instance->CLVB_main.range == 1) {sprintf(instance->string, "%.7f V\n\r", instance->CCB_main.current);}
+		else if (instance->CLVB_main.range == 2) {sprintf(instance->string, "%.6f V\n\r", instance->CCB_main.current);}
+		else if (instance->CLVB_main.range == 3) {sprintf(instance->string, "%.5f V\n\r", instance->CCB_main.current);}
+		Emulator_Send(instance, instance->string);
+	}
+	else if (Emulator_CheckForSubstring(command, "CURR:RANG "))
+	{
+		if (sscanf((const char *) command, "CURR:RANG %d", &range) != 1) {error = ERROR_USER_INPUT;}
+		else {error = CCB_SetRange(instance, (uint8_t) range, time_us);}
+	}
+	else if (Emulator_CheckForSubstring(command, "CURR:RANG?"))
+	{
+		sprintf(instance->string, "%d\n\r", instance->CCB_main.range);
+		Emulator_Send(instance, instance->string);
+	}
+	else if (Emulator_CheckForSubstring(command, "CURR:RANG:AUTO ON")) {instance->CCB.autorange_state = 1;}
+	else if (Emulator_CheckForSubstring(command, "CURR:RANG:AUTO OFF")) {instance->CCB.autorange_state = 0;}
+	else if (Emulator_CheckForSubstring(command, "CURR:RANG:AUTO?"))
+	{
+		//main.c answers autorange state of CLVB
+		Emulator_Send(instance, (instance->CLVB_main.autorange_state == 1) ? "Autorange is ON.\n\r" : "Autorange is OFF.\n\r");
+	}
+	else if (Emulator_CheckForSubstring(command, "CURR:OUTP ON")) {error = CCB_SetOutput(instance, 1, time_us);}
+	else if (Emulator_CheckForSubstring(command, "CURR:OUTP OFF")) {error = CCB_SetOutput(instance, 0, time_us);}
+	else if (Emulator_CheckForSubstring(command, "CURR:OUTP?"))
+	{
+		Emulator_Send(instance, (instance->CCB_main.output_state == 1) ? "Output ON.\n\r" : "Output OFF.\n\r");
+	}
+	else {error = ERROR_UNKNOWN_COMMAND;}
+	
+	instance->CCB_main = instance->CCB;		//GetStateCCB()
+	
+	return error;
+}
+
+
+/**
+* @brief - execute command as Calibrator_HandleRemoteControl, reply is prepared in instance
+* @param instance - virtual calibrator
+* @param error - error of Calibrator_ReadCommand
+* @returns - time of command in microseconds (without time scale)
+*/
+static uint64_t Emulator_HandleCommand(Emulator_instance *instance, uint8_t error)
+{
+	const uint8_t *command = instance->command;
+	uint64_t time_us = 0;
+	
+	instance->reply_length = 0;
+	instance->reply[0] = '\0';
+	
+	if ((error == NO_ERROR) && (strlen((const char *) command) > 0))
+	{
+		if (Emulator_CheckForSubstring(command, "FUNC"))
+		{
+			if (Emulator_CheckForSubstring(command, "FUNC VOLT")) {instance->module_selected = MODULE_CLVB;}
+			else if (Emulator_CheckForSubstring(command, "FUNC CURR")) {instance->module_selected = MODULE_CCB;}
+			else if (Emulator_CheckForSubstring(command, "FUNC?"))
+			{
+				if (instance->module_selected == MODULE_NONE) {Emulator_Send(instance, "NONE\n\r");}
+				else if (instance->module_selected == MODULE_CLVB) {Emulator_Send(instance, "VOLT\n\r");}
+				else {Emulator_Send(instance, "CURR\n\r");}
+			}
+			else {error = ERROR_USER_INPUT;}
+		}
+		else if (Emulator_CheckForSubstring(command, "VOLT")) {error = Emulator_HandleVOLT(instance, command, &time_us);}
+		else if (Emulator_CheckForSubstring(command, "CURR")) {error = Emulator_HandleCURR(instance, command, &time_us);}
+		else {error = ERROR_UNKNOWN_COMMAND;}		//TRIG, SYNC, *TRG and SYST are not emulated
+	
+		instance->commands++;
+	}
+	
+	if (error != NO_ERROR)
+	{
+		Emulator_Send(instance, error_messages[error]);
+		instance->errors++;
+	}
+	
+	time_us += instance->reply_length * Emulator_GetByteTime_us(timing.host_baud);		//UART_SendString waits for every byte
+	
+	if ((command[0] != '\0') || (error != NO_ERROR))
+	{
+		Emulator_Log(instance, "%-30s %7.1f ms %.*s", command, time_us / 1000.0, (int) strcspn(error_messages[error], "\n"), error_messages[error]);
+	}
+	
+	return time_us;
+}
+
+
+//===================================== line and main loop =====================================
+
+static void Emulator_Reset(Emulator_instance *instance)
+{
+	int listen_fd = instance->listen_fd;
+	uint16_t port = instance->port;
+	
+	memset(instance, 0, sizeof(*instance));
+	instance->listen_fd = listen_fd;
+	instance->port = port;
+	instance->fd = -1;
+	
+	//state after CLVB_Init and CCB_Init
+	instance->CLVB.range = 3;
+	instance->CLVB.mode = MODE_DC;
+	instance->CCB.range = 3;
+}
+
+
+static uint8_t Emulator_OpenPort(Emulator_instance *instance, uint16_t port)
+{
+	struct sockaddr_in address;
+	int flag = 1;
+	
+	instance->port = port;
+	instance->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (instance->listen_fd < 0) {return 1;}
+	setsockopt(instance->listen_fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+	
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if ((bind(instance->listen_fd, (struct sockaddr *) &address, sizeof(address)) != 0) || (listen(instance->listen_fd, 4) != 0))
+	{
+		fprintf(stderr, "cannot listen on port %u (%s)\n", port, strerror(errno));
+		close(instance->listen_fd);
+		return 1;
+	}
+	fcntl(instance->listen_fd, F_SETFL, O_NONBLOCK);
+	
+	Emulator_Reset(instance);
+	
+	return 0;
+}
+
+
+static void Emulator_Accept(Emulator_instance *instance)
+{
+	int fd = accept(instance->listen_fd, NULL, NULL);
+	int flag = 1;
+	
+	if (fd < 0) {return;}
+	
+	//XPort accepts only one connection, state of calibrator is kept between connections
+	if (instance->fd >= 0) {close(fd); return;}
+	
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+	instance->fd = fd;
+	Emulator_Log(instance, "connected");
+}
+
+
+static void Emulator_Disconnect(Emulator_instance *instance)
+{
+	close(instance->fd);
+	instance->fd = -1;
+	instance->pending_length = 0;
+	Emulator_Log(instance, "disconnected (%u commands, %u errors, %u overruns)", instance->commands, instance->errors, instance->overruns);
+}
+
+
+static void Emulator_Receive(Emulator_instance *instance, uint64_t now)
+{
+	uint8_t buffer[512];
+	uint64_t byte_time = Emulator_Scale(Emulator_GetByteTime_us(timing.host_baud));
+	ssize_t length = read(instance->fd, buffer, sizeof(buffer));
+	
+	if (length == 0) {Emulator_Disconnect(instance); return;}
+	if (length < 0) {if ((errno != EAGAIN) && (errno != EINTR)) {Emulator_Disconnect(instance);} return;}
+	
+	for (ssize_t i = 0; i < length; i++)
+	{
+		if (instance->pending_length >= EMULATOR_PENDING_SIZE) {instance->overruns++; continue;}
+		if (instance->pending_length == 0) {instance->pending_time_us = now;}
+		instance->pending_time_us = ((instance->pending_time_us > now) ? instance->pending_time_us : now) + byte_time;
+		if (instance->pending_length == 0) {instance->pending_first_us = instance->pending_time_us;}
+		instance->pending[instance->pending_length++] = buffer[i];
+	}
+}
+
+
+//bytes complete on the line are moved into RX buffer of firmware, full buffer loses bytes
+static void Emulator_UpdateLine(Emulator_instance *instance, uint64_t now)
+{
+	uint64_t byte_time = Emulator_Scale(Emulator_GetByteTime_us(timing.host_baud));
+	uint32_t count = 0;
+	
+	if (instance->pending_length == 0) {return;}
+	
+	if (byte_time == 0) {count = instance->pending_length;}
+	else if (now >= instance->pending_first_us) {count = ((now - instance->pending_first_us) / byte_time) + 1;}
+	if (count > instance->pending_length) {count = instance->pending_length;}
+	
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (instance->RX_count < EMULATOR_RX_BUFFER_SIZE)
+		{
+			instance->RX_buffer[(instance->RX_read_position + instance->RX_count) % EMULATOR_RX_BUFFER_SIZE] = instance->pending[i];
+			instance->RX_count++;
+		}
+		else {instance->overruns++;}
+	}
+	
+	memmove(instance->pending, instance->pending + count, instance->pending_length - count);
+	instance->pending_length -= count;
+	instance->pending_first_us += count * byte_time;
+}
+
+
+/**
+* @brief - read bytes from RX buffer into command as Calibrator_ReadCommand
+* @param instance - virtual calibrator
+* @returns - 1 if end of line was received, 0 if not
+*/
+static uint8_t Emulator_ReadCommand(Emulator_instance *instance)
+{
+	while (instance->RX_count > 0)
+	{
+		uint8_t c = instance->RX_buffer[instance->RX_read_position];
+	
+		instance->RX_read_position = (instance->RX_read_position + 1) % EMULATOR_RX_BUFFER_SIZE;
+		instance->RX_count--;
+	
+		if ((c >= 'a') && (c <= 'z')) {c -= 32;}
+		if ((c == '\n') || (c == '\r'))
+		{
+			instance->command[instance->command_length] = '\0';
+			return 1;
+		}
+		if (instance->command_length < EMULATOR_COMMAND_SIZE) {instance->command[instance->command_length++] = c;}
+		else {instance->command_overflow = 1;}		//firmware would write behind command[50]
+	}
+	
+	return 0;
+}
+
+
+static void Emulator_Step(Emulator_instance *instance, uint64_t now)
+{
+	Emulator_UpdateLine(instance, now);
+	
+	if (instance->state == STATE_IDLE)
+	{
+		if (instance->RX_count == 0) {return;}
+		instance->state = STATE_READ;
+		instance->busy_until_us = now + Emulator_Scale(timing.loop_delay_us);		//delay_ms(10) in main loop
+		instance->command_length = 0;
+		instance->command_overflow = 0;
+		instance->read_retries = 0;
+	}
+	
+	if (now < instance->busy_until_us) {return;}
+	
+	if (instance->state == STATE_READ)
+	{
+		uint8_t error = NO_ERROR;
+		uint64_t time_us;
+	
+		if (Emulator_ReadCommand(instance) == 0)
+		{
+			instance->read_retries++;
+			if (instance->read_retries <= EMULATOR_READ_RETRIES)
+			{
+				instance->busy_until_us = now + Emulator_Scale(timing.loop_delay_us);		//delay_ms(10) in Calibrator_ReadCommand
+				return;
+			}
+			instance->command[instance->command_length] = '\0';
+			error = ERROR_USER_INPUT;		//timeout, no end of line
+		}
+		if (instance->command_overflow) {error = ERROR_USER_INPUT;}
+	
+		time_us = Emulator_HandleCommand(instance, error);
+		instance->busy_us += time_us;
+		instance->state = STATE_EXECUTE;
+		instance->busy_until_us = now + Emulator_Scale(time_us);
+		if (now < instance->busy_until_us) {return;}
+	}
+	
+	if (instance->state == STATE_EXECUTE)
+	{
+		if ((instance->fd >= 0) && (instance->reply_length > 0))
+		{
+			if (write(instance->fd, instance->reply, instance->reply_length) < 0) {}		//lost like bytes of XPort without connection
+		}
+		instance->state = STATE_IDLE;
+	}
+}
+
+
+static uint64_t Emulator_GetNextEvent(Emulator_instance *instance)
+{
+	uint64_t next = UINT64_MAX;
+	
+	if (instance->state != STATE_IDLE) {next = instance->busy_until_us;}
+	else if (instance->RX_count > 0) {next = 0;}
+	if ((instance->pending_length > 0) && (instance->pending_first_us < next)) {next = instance->pending_first_us;}
+	
+	return next;
+}
+
+
+static void Emulator_PrintUsage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-p port] [-n instances] [-b baud] [-B module_baud] [-w write_ms] [-V verify_ms] [-l line_ms]\n"
+		"       [-r relay_ms] [-S time_scale] [-f fault] [-s seed] [-v]\n"
+		"-p port         TCP port of first calibrator (default 10001, as XPort)\n"
+		"-n instances    number of calibrators on consecutive ports (default 1)\n"
+		"-b baud         USB/Ethernet line rate, 0 = no limit (default 9600)\n"
+		"-B module_baud  line rate of CLVB and CCB, 0 = no limit (default 9600)\n"
+		"-w write_ms     delay after write into register (default 10)\n"
+		"-V verify_ms    delay before reading of register dump (default 100)\n"
+		"-l line_ms      delay after every line of register dump (default 10)\n"
+		"-r relay_ms     settling of relays added to commands which switch them (default 0)\n"
+		"-S time_scale   1.0 = real time (default), 0.1 = 10x faster, 0 = no waiting\n"
+		"-f fault        probability (0 - 1) of unsuccessful write into register\n"
+		"-s seed         seed of fault generator (repeatable faults)\n"
+		"-v              print every command with its time\n", name);
+}
+
+
+int main(int argc, char **argv)
+{
+	uint32_t port = 10001;
+	int option;
+	struct sigaction action;
+	
+	while ((option = getopt(argc, argv, "p:n:b:B:w:V:l:r:S:f:s:vh")) != -1)
+	{
+		switch (option)
+		{
+			case 'p': port = strtoul(optarg, NULL, 10); break;
+			case 'n': instance_count = strtoul(optarg, NULL, 10); break;
+			case 'b': timing.host_baud = strtoul(optarg, NULL, 10); break;
+			case 'B': timing.module_baud = strtoul(optarg, NULL, 10); break;
+			case 'w': timing.write_delay_us = atof(optarg) * 1000.0; break;
+			case 'V': timing.verify_delay_us = atof(optarg) * 1000.0; break;
+			case 'l': timing.line_delay_us = atof(optarg) * 1000.0; break;
+			case 'r': timing.relay_settle_us = atof(optarg) * 1000.0; break;
+			case 'S': timing.time_scale = atof(optarg); break;
+			case 'f': timing.fault = atof(optarg); break;
+			case 's': srand(strtoul(optarg, NULL, 10)); break;
+			case 'v': verbose = 1; break;
+			default: Emulator_PrintUsage(argv[0]); return 1;
+		}
+	}
+	
+	if ((instance_count == 0) || (instance_count > EMULATOR_MAX_INSTANCES) || (port + instance_count > 65536))
+	{
+		Emulator_PrintUsage(argv[0]);
+		return 1;
+	}
+	
+	start_time_us = Emulator_GetTime_us();
+	signal(SIGPIPE, SIG_IGN);
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = Emulator_StopHandler;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	
+	instances = calloc(instance_count, sizeof(Emulator_instance));
+	for (uint32_t i = 0; i < instance_count; i++)
+	{
+		if (Emulator_OpenPort(&instances[i], port + i) != 0) {return 1;}
+	}
+	fprintf(stderr, "calibrator emulator: %u instance(s) on ports %u-%u (pid %d, %u Bd, time scale %.3f)\n",
+		instance_count, port, port + instance_count - 1, (int) getpid(), timing.host_baud, timing.time_scale);
+	
+	struct pollfd *fds = calloc(2 * instance_count, sizeof(struct pollfd));
+	
+	while (stop_requested == 0)
+	{
+		uint64_t now = Emulator_GetTime_us();
+		uint64_t next = UINT64_MAX;
+		int timeout_ms;
+	
+		for (uint32_t i = 0; i < instance_count; i++)
+		{
+			uint64_t event = Emulator_GetNextEvent(&instances[i]);
+			if (event < next) {next = event;}
+	
+			fds[2 * i].fd = instances[i].listen_fd;
+			fds[2 * i].events = POLLIN;
+			fds[2 * i + 1].fd = instances[i].fd;			//negative fd is ignored by poll
+			fds[2 * i + 1].events = POLLIN;
+		}
+	
+		if (next == UINT64_MAX) {timeout_ms = EMULATOR_IDLE_POLL_MS;}
+		else if (next <= now) {timeout_ms = 0;}
+		else {timeout_ms = ((next - now) + 999) / 1000;}
+		if (timeout_ms > EMULATOR_IDLE_POLL_MS) {timeout_ms = EMULATOR_IDLE_POLL_MS;}
+	
+		if (poll(fds, 2 * instance_count, timeout_ms) < 0)
+		{
+			if (errno == EINTR) {continue;}
+			break;
+		}
+	
+		now = Emulator_GetTime_us();
+		for (uint32_t i = 0; i < instance_count; i++)
+		{
+			if (fds[2 * i].revents & POLLIN) {Emulator_Accept(&instances[i]);}
+			if ((instances[i].fd >= 0) && (fds[2 * i + 1].revents & (POLLIN | POLLHUP | POLLERR))) {Emulator_Receive(&instances[i], now);}
+			Emulator_Step(&instances[i], now);
+		}
+	}
+	
+	//statistics of all calibrators
+	for (uint32_t i = 0; i < instance_count; i++)
+	{
+		fprintf(stderr, "port %u: %u commands, %u errors, %u overruns, %.3f s busy\n", instances[i].port, instances[i].commands,
+			instances[i].errors, instances[i].overruns, instances[i].busy_us / 1e6);
+		if (instances[i].fd >= 0) {close(instances[i].fd);}
+		close(instances[i].listen_fd);
+	}
+	free(fds);
+	free(instances);
+	
+	return 0;
+}
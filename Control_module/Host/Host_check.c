@@ -0,0 +1,198 @@
+//=====================================================================
+//Regression checks of remote control - scripted lines are sent to
+//USB (and Ethernet) session of calibrator_host or real device and
+//answers are compared with expected ones, notifications are skipped
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "Host_link.h"
+
+
+#define CHECK_LINE_SIZE				512
+#define CHECK_FENCE						";*OPC?"		//appended to every line, its answer "1" marks end of line
+
+#define CHECK_USB							0
+#define CHECK_ETHERNET				1
+
+typedef struct
+{
+	const char *name;								//name of check, printed once before its first step
+	uint8_t session;								//CHECK_USB or CHECK_ETHERNET
+	const char *line;								//line sent to calibrator (without fence)
+	const char *answers;						//expected answers separated by '|', "" = no answer, '*' at end = prefix
+} Check_step;
+
+//every check starts from known state (first steps), steps of one check follow each other
+static const Check_step check_steps[] = {
+	//user-050: set-point is dropped only when next one is valid, one failure = one error, query sees checked writes
+	{"coalescing keeps last valid value", CHECK_USB, "SYST:ERR:VERB OFF;*CLS;FUNC VOLT;VOLT:RANG 2;VOLT 0.5", ""},
+	{NULL, CHECK_USB, "VOLT 1;VOLT 50;VOLT?", "1.000000 V"},
+	{NULL, CHECK_USB, "SYST:ERR?", "-222,\"Data out of range;VOLT 50\""},
+	{NULL, CHECK_USB, "VOLT 0.5;VOLT 1.5;VOLT ABC;VOLT?", "1.500000 V"},
+	{NULL, CHECK_USB, "SYST:ERR?;SYST:ERR?", "-102,\"Syntax error;VOLT ABC\"|0,\"No error\""},
+	{NULL, CHECK_USB, "VOLT 0.2;VOLT 0.3;VOLT 0.4;VOLT?", "0.400000 V"},
+	{NULL, CHECK_USB, "*CLS;VOLT 0.7;VOLT 50;VOLT 60;SYST:ERR:COUN?;VOLT?", "2|0.700000 V"},
+	{NULL, CHECK_USB, "*CLS;VOLT 0.5;VOLT 0.6;*OPC?;SYST:ERR:COUN?;VOLT?", "1|0|0.600000 V"},
+	
+	//user-029: list longer than one command is loaded by TRIG:LIST:APP, wrong command changes nothing
+	{"trigger list is appended", CHECK_USB, "SYST:ERR:VERB OFF;*CLS;FUNC VOLT;VOLT:RANG:AUTO OFF;VOLT:RANG 3", ""},
+	{NULL, CHECK_USB, "TRIG:LIST 0.1,0.2,0.3,0.4,0.5,0.6,0.7,0.8", ""},
+	{NULL, CHECK_USB, "TRIG:LIST:APP 0.9,1,1.1,1.2,1.3,1.4,1.5,1.6;TRIG:LIST:APP 1.7,1.8,1.9,2,2.1,2.2,2.3,2.4", ""},
+	{NULL, CHECK_USB, "TRIG:LIST:APP 2.5,2.6,2.7,ABC;TRIG:LIST:APP 2.5,2.6,2.7,2.8,2.9,3,3.1,3.2", ""},
+	{NULL, CHECK_USB, "TRIG:LIST:APP 3.3;TRIG:LIST:APP 1E30;TRIG:LIST:APP nan;SYST:ERR:COUN?", "4"},
+	{NULL, CHECK_USB, "SYST:ERR?;SYST:ERR?;SYST:ERR?;SYST:ERR?", "-102,*|-102,*|-222,\"Data out of range;TRIG:LIST:APP 1E30\"|-222,*"},
+	{NULL, CHECK_USB, "TRIG:LIST?", "0.1000000,0.2000000,0.3000000,0.4000000,0.5000000,0.6000000,0.7000000,0.8000000,0.9000000,1.0000000,1.1000000,1.2000000,1.3000000,1.4000000,1.5000000,1.6000000,1.7000000,1.8000000,1.9000000,2.0000000,2.1000000,2.2000000,2.3000000,2.4000000,2.5000000,2.6000000,2.7000000,2.8000000,2.9000000,3.0000000,3.1000000,3.2000000"},
+	{NULL, CHECK_USB, "TRIG:LIST:CLR;*CLS;VOLT:RANG 2;TRIG:LIST?", ""},
+	
+	//user-030: TRIG OFF of one module disarms synchronization of both
+	{"TRIG OFF disarms SYNC", CHECK_USB, "SYST:ERR:VERB OFF;*CLS;FUNC VOLT;SYNC:ARM;SYNC:ARM?", "Armed."},
+	{NULL, CHECK_USB, "TRIG OFF;SYNC:ARM?;SYNC:UPD;SYST:ERR:COUN?", "Not armed.|1"},
+	{NULL, CHECK_USB, "SYNC:DISARM;*CLS", ""},
+	
+	//user-045: set-point with '?' at the end is not query, lock is not bypassed
+	{"lock is not bypassed by '?'", CHECK_USB, "SYST:ERR:VERB OFF;*CLS;FUNC VOLT;VOLT 0.2;SYST:LOCK ON", ""},
+	{NULL, CHECK_ETHERNET, "SYST:ERR:VERB OFF;*CLS;FUNC VOLT;VOLT 0.5?;VOLT:OUTP ON?;VOLT?;VOLT:OUTP?", "0.200000 V|Output OFF."},
+	{NULL, CHECK_ETHERNET, "SYST:ERR:COUN?;SYST:LOCK?", "2|USB"},
+	{NULL, CHECK_USB, "SYST:LOCK OFF", ""},
+	
+	//user-049: session without lock can start stream only to its own port
+	{"stream of locked calibrator", CHECK_USB, "SYST:ERR:VERB OFF;*CLS;SYST:STREAM OFF;SYST:STREAM:PER 1000;SYST:LOCK ON", ""},
+	{NULL, CHECK_ETHERNET, "*CLS;SYST:STREAM USB;SYST:STREAM:PER 200;SYST:STREAM?;SYST:STREAM:PER?;SYST:ERR:COUN?", "OFF|1000|2"},
+	{NULL, CHECK_ETHERNET, "SYST:STREAM ON;SYST:STREAM?", "ETH"},
+	{NULL, CHECK_ETHERNET, "*CLS;SYST:STREAM OFF;SYST:ERR:COUN?", "1"},
+	{NULL, CHECK_USB, "SYST:STREAM OFF;SYST:LOCK OFF;SYST:STREAM?", "OFF"},
+};
+
+static Link links[2];
+static uint32_t timeout_ms = 5000;
+static uint8_t verbose = 0;
+
+
+void Check_Send(uint8_t session, const char *line)
+{
+	char string[CHECK_LINE_SIZE];
+	
+	snprintf(string, sizeof(string), "%s%s", line, CHECK_FENCE);
+	Link_Send(&links[session], string);
+}
+
+
+static uint8_t Check_Match(const char *answer, const char *expected, size_t length)
+{
+	if ((length > 0) && (expected[length - 1] == '*')) {return strncmp(answer, expected, length - 1) == 0;}
+	
+	return (strlen(answer) == length) && (strncmp(answer, expected, length) == 0);
+}
+
+
+uint8_t Check_RunStep(const Check_step *step)
+{
+	char answer[CHECK_LINE_SIZE];
+	const char *expected = step->answers;
+	uint8_t result = 0;
+	
+	Check_Send(step->session, step->line);
+	
+	//expected answers one by one, then answer of fence
+	while (expected[0] != '\0')
+	{
+		const char *end = strchr(expected, '|');
+		size_t length = (end != NULL) ? (size_t) (end - expected) : strlen(expected);
+	
+		if (Link_ReadLine(&links[step->session], answer, sizeof(answer), Link_GetTime_ms() + timeout_ms) == 0) {printf("    %s: no answer, expected %.*s\n", step->line, (int) length, expected); return 1;}
+		if (Check_Match(answer, expected, length) == 0) {printf("    %s: got %s, expected %.*s\n", step->line, answer, (int) length, expected); result = 1;}
+		expected = (end != NULL) ? (end + 1) : (expected + length);
+	}
+	
+	//unexpected answers before fence are errors too
+	while (1)
+	{
+		if (Link_ReadLine(&links[step->session], answer, sizeof(answer), Link_GetTime_ms() + timeout_ms) == 0) {printf("    %s: no answer of fence\n", step->line); return 1;}
+		if (strcmp(answer, "1") == 0) {break;}
+		printf("    %s: unexpected %s\n", step->line, answer);
+		result = 1;
+	}
+	
+	return result;
+}
+
+
+int main(int argc, char **argv)
+{
+	const char *devices[2] = {NULL, NULL};
+	uint32_t baud_rate = 9600;
+	uint32_t checks = 0;
+	uint32_t failed = 0;
+	uint32_t skipped = 0;
+	uint8_t check_failed = 0;
+	uint8_t check_skipped = 0;
+	int option;
+	
+	while ((option = getopt(argc, argv, "d:e:b:T:v")) != -1)
+	{
+		switch (option)
+		{
+			case 'd': devices[CHECK_USB] = optarg; break;
+			case 'e': devices[CHECK_ETHERNET] = optarg; break;
+			case 'b': baud_rate = strtoul(optarg, NULL, 10); break;
+			case 'T': timeout_ms = strtoul(optarg, NULL, 10); break;
+			case 'v': verbose = 1; break;
+			default:
+				fprintf(stderr, "usage: %s -d device [-e device] [-b baud] [-T timeout_ms] [-v]\n", argv[0]);
+				fprintf(stderr, "  -d device  USB session (serial port or pty of calibrator_host)\n");
+				fprintf(stderr, "  -e device  Ethernet session, checks with two sessions are skipped without it\n");
+				return 1;
+		}
+	}
+	
+	if (devices[CHECK_USB] == NULL) {fprintf(stderr, "select USB session: -d device\n"); return 1;}
+	Link_Init(&links[CHECK_USB], "USB", verbose);
+	Link_Init(&links[CHECK_ETHERNET], "ETH", verbose);
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if ((devices[i] != NULL) && (Link_OpenSerial(&links[i], devices[i], baud_rate) != 0)) {return 1;}
+	}
+	
+	//messages after reset ("[CLVB NO_ERROR]") are not answers of checks
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		char line[CHECK_LINE_SIZE];
+		while ((links[i].fd >= 0) && (Link_ReadLine(&links[i], line, sizeof(line), Link_GetTime_ms() + 500) == 1)) {}
+	}
+	
+	for (uint32_t i = 0; i < (sizeof(check_steps) / sizeof(check_steps[0])); i++)
+	{
+		const Check_step *step = &check_steps[i];
+	
+		if (step->name != NULL)
+		{
+			//result of previous check
+			if (checks > 0) {printf("%s\n", check_skipped ? "SKIP" : (check_failed ? "FAIL" : "OK"));}
+			if (check_failed) {failed++;}
+			if (check_skipped) {skipped++;}
+			printf("%-44s ", step->name);
+			fflush(stdout);
+			checks++;
+			check_failed = 0;
+			check_skipped = 0;
+		}
+	
+		if (check_failed || check_skipped) {continue;}		//rest of failed check is not run
+		if (links[step->session].fd < 0) {check_skipped = 1; continue;}
+		if (Check_RunStep(step) != 0) {check_failed = 1;}
+	}
+	
+	printf("%s\n", check_skipped ? "SKIP" : (check_failed ? "FAIL" : "OK"));
+	if (check_failed) {failed++;}
+	if (check_skipped) {skipped++;}
+	printf("%u checks, %u failed, %u skipped\n", checks, failed, skipped);
+	
+	for (uint8_t i = 0; i < 2; i++) {Link_Close(&links[i]);}
+	
+	return (failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,245 @@
+#include "Host_emulator.h"
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+
+#define EMULATOR_RX_BUFFER_SIZE		1024
+
+static uint8_t rx_buffer[EMULATOR_RX_BUFFER_SIZE];
+static uint64_t rx_buffer_time[EMULATOR_RX_BUFFER_SIZE];		//time when byte is complete on the line
+static uint32_t rx_read_pos = 0;
+static uint32_t rx_write_pos = 0;
+
+static uint64_t start_time_us = 0;
+static volatile sig_atomic_t trigger_received = 0;
+
+
+static uint64_t Emulator_GetMonotonicTime_us(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return ((uint64_t) now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+
+static void Emulator_Sleep_us(uint64_t us)
+{
+	struct timespec time;
+	
+	time.tv_sec = us / 1000000;
+	time.tv_nsec = (us % 1000000) * 1000;
+	while ((nanosleep(&time, &time) != 0) && (errno == EINTR));
+}
+
+
+static uint64_t Emulator_GetByteTime_us(Emulator *emulator)
+{
+	if (emulator->baud_rate == 0) {return 0;}
+	
+	return (10 * 1000000ULL) / emulator->baud_rate;		//start bit, 8 data bits, stop bit
+}
+
+
+static void Emulator_TriggerHandler(int signal_number)
+{
+	trigger_received = 1;
+}
+
+
+uint64_t Emulator_GetTime_us(void)
+{
+	return Emulator_GetMonotonicTime_us() - start_time_us;
+}
+
+
+uint8_t Emulator_ParseOptions(Emulator *emulator, int argc, char **argv)
+{
+	int option;
+	
+	while ((option = getopt(argc, argv, "l:D:b:L:d:c:n:s:vh")) != -1)
+	{
+		switch (option)
+		{
+			case 'l': emulator->link = optarg; break;
+			case 'D': emulator->device = optarg; break;
+			case 'b': emulator->baud_rate = strtoul(optarg, NULL, 10); break;
+			case 'L': emulator->latency_us = strtoul(optarg, NULL, 10); break;
+			case 'd': emulator->drop_rx = atof(optarg); break;
+			case 'c': emulator->corrupt_tx = atof(optarg); break;
+			case 'n': emulator->no_reply = atof(optarg); break;
+			case 's': srand(strtoul(optarg, NULL, 10)); break;
+			case 'v': emulator->verbose = 1; break;
+			default:
+				fprintf(stderr, "usage: %s [-l link] [-D device] [-b baud] [-L latency_us] [-d drop_rx] [-c corrupt_tx] [-n no_reply] [-s seed] [-v]\n", argv[0]);
+				fprintf(stderr, "  -l link        symlink to created pty (e.g. /tmp/cal/CLVB)\n");
+				fprintf(stderr, "  -D device      use existing device instead of new pty (e.g. pty of host firmware)\n");
+				fprintf(stderr, "  -b baud        line rate, 0 = no limit (default 9600)\n");
+				fprintf(stderr, "  -L latency_us  additional delay before response (default 0)\n");
+				fprintf(stderr, "  -d, -c, -n     probability (0 - 1) of lost received byte, corrupted transmitted byte, ignored request\n");
+				fprintf(stderr, "  -v             print writes into registers and changes of output\n");
+				fprintf(stderr, "rising edge on trigger input: kill -USR1 <pid>\n");
+				return 1;
+		}
+	}
+	
+	return 0;
+}
+
+
+uint8_t Emulator_Open(Emulator *emulator)
+{
+	char path[256];
+	struct termios tio;
+	struct sigaction action;
+	
+	start_time_us = Emulator_GetMonotonicTime_us();
+	emulator->fd_slave = -1;
+	emulator->rx_time_us = 0;
+	
+	if (emulator->device != NULL)
+	{
+		emulator->fd = open(emulator->device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		if (emulator->fd < 0) {fprintf(stderr, "[%s] cannot open %s (%s)\n", emulator->name, emulator->device, strerror(errno)); return 1;}
+		strncpy(path, emulator->device, sizeof(path) - 1);
+		path[sizeof(path) - 1] = '\0';
+	}
+	else
+	{
+		if (openpty(&emulator->fd, &emulator->fd_slave, path, NULL, NULL) != 0) {fprintf(stderr, "[%s] openpty failed\n", emulator->name); return 1;}
+		fcntl(emulator->fd, F_SETFL, fcntl(emulator->fd, F_GETFL) | O_NONBLOCK);
+	}
+	
+	if (tcgetattr((emulator->fd_slave >= 0) ? emulator->fd_slave : emulator->fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		tcsetattr((emulator->fd_slave >= 0) ? emulator->fd_slave : emulator->fd, TCSANOW, &tio);
+	}
+	
+	if ((emulator->link != NULL) && (emulator->device == NULL))
+	{
+		unlink(emulator->link);
+		if (symlink(path, emulator->link) != 0) {fprintf(stderr, "[%s] cannot create %s\n", emulator->name, emulator->link);}
+	}
+	
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = Emulator_TriggerHandler;
+	sigaction(SIGUSR1, &action, NULL);		//no SA_RESTART, waiting in poll is interrupted by trigger
+	
+	fprintf(stderr, "[%s] %s (pid %d, %u Bd)\n", emulator->name, path, (int) getpid(), emulator->baud_rate);
+	
+	return 0;
+}
+
+
+uint8_t Emulator_ReadByte(Emulator *emulator, uint8_t *byte, uint64_t timeout_us)
+{
+	uint64_t now = Emulator_GetTime_us();
+	uint64_t end = now + timeout_us;
+	
+	while (1)
+	{
+		//byte is returned when it is complete on the line (line rate model)
+		if (rx_read_pos != rx_write_pos)
+		{
+			uint64_t time = rx_buffer_time[rx_read_pos];
+			if (time > end) {if (end > now) {Emulator_Sleep_us(end - now);} return 0;}
+			if (time > now) {Emulator_Sleep_us(time - now);}
+			*byte = rx_buffer[rx_read_pos];
+			rx_read_pos = (rx_read_pos + 1) % EMULATOR_RX_BUFFER_SIZE;
+			return 1;
+		}
+	
+		struct pollfd fd = {emulator->fd, POLLIN, 0};
+		int timeout_ms = (end > now) ? (int) ((end - now + 999) / 1000) : 0;
+		if (poll(&fd, 1, timeout_ms) <= 0) {return 0;}		//timeout or trigger (EINTR)
+	
+		uint8_t data[256];
+		ssize_t length = read(emulator->fd, data, sizeof(data));
+		now = Emulator_GetTime_us();
+		for (ssize_t i = 0; i < length; i++)
+		{
+			if (emulator->rx_time_us < now) {emulator->rx_time_us = now;}
+			emulator->rx_time_us += Emulator_GetByteTime_us(emulator);
+			if (Emulator_Fault(emulator->drop_rx)) {Emulator_Log(emulator, "fault: received byte 0x%02X dropped", data[i]); continue;}
+			if (((rx_write_pos + 1) % EMULATOR_RX_BUFFER_SIZE) == rx_read_pos) {continue;}		//overflow
+			rx_buffer[rx_write_pos] = data[i];
+			rx_buffer_time[rx_write_pos] = emulator->rx_time_us;
+			rx_write_pos = (rx_write_pos + 1) % EMULATOR_RX_BUFFER_SIZE;
+		}
+		if (length <= 0) {return 0;}
+	}
+}
+
+
+void Emulator_Send(Emulator *emulator, const uint8_t *string, uint32_t length)
+{
+	uint64_t byte_time = Emulator_GetByteTime_us(emulator);
+	
+	if (emulator->latency_us > 0) {Emulator_Sleep_us(emulator->latency_us);}
+	
+	for (uint32_t i = 0; i < length; i++)
+	{
+		uint8_t byte = string[i];
+		if (Emulator_Fault(emulator->corrupt_tx))
+		{
+			byte ^= (1 << (rand() % 8));
+			Emulator_Log(emulator, "fault: transmitted byte 0x%02X corrupted to 0x%02X", string[i], byte);
+		}
+	
+		while (write(emulator->fd, &byte, 1) != 1)
+		{
+			struct pollfd fd = {emulator->fd, POLLOUT, 0};
+			if ((errno != EAGAIN) && (errno != EINTR)) {break;}
+			if (poll(&fd, 1, 100) == 0)
+			{
+				if (emulator->fd_slave >= 0) {tcflush(emulator->fd_slave, TCIFLUSH);}		//nobody reads the line
+				else {break;}
+			}
+		}
+		if (byte_time > 0) {Emulator_Sleep_us(byte_time);}
+	}
+}
+
+
+uint8_t Emulator_Fault(double probability)
+{
+	if (probability <= 0.0) {return 0;}
+	
+	return ((double) rand() / RAND_MAX) < probability;
+}
+
+
+uint8_t Emulator_CheckTrigger(void)
+{
+	uint8_t trigger = trigger_received;
+	
+	trigger_received = 0;
+	
+	return trigger;
+}
+
+
+void Emulator_Log(Emulator *emulator, const char *format, ...)
+{
+	va_list arguments;
+	
+	if (emulator->verbose == 0) {return;}
+	
+	va_start(arguments, format);
+	printf("[%s %10.3f ms] ", emulator->name, Emulator_GetTime_us() / 1000.0);
+	vprintf(format, arguments);
+	printf("\n");
+	fflush(stdout);
+	va_end(arguments);
+}
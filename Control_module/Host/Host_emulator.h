@@ -0,0 +1,90 @@
+//=============================================================
+//Common part of CLVB and CCB emulators (pty, line rate, faults)
+//by Martin Praznovsky, 2025
+//=============================================================
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+#ifndef HOST_EMULATOR_H_
+#define HOST_EMULATOR_H_
+
+typedef struct
+{
+	const char *name;						//name of module in messages ("CLVB", "CCB")
+	const char *link;						//path of symlink to created pty (NULL = no symlink)
+	const char *device;					//existing device used instead of new pty (NULL = new pty)
+	uint32_t baud_rate;					//line rate, 0 = no limit
+	uint32_t latency_us;				//additional delay before every response
+	double drop_rx;							//probability of loss of received byte
+	double corrupt_tx;					//probability of change of one bit in transmitted byte
+	double no_reply;						//probability that request for registers is ignored
+	uint8_t verbose;						//1 = print every write into register and change of output
+	int fd;
+	int fd_slave;
+	uint64_t rx_time_us;				//time when last received byte was complete (line rate model)
+} Emulator;
+
+/**
+* @brief - parse command line options (-l link, -D device, -b baud, -L latency, -d drop, -c corrupt, -n no reply, -s seed, -v)
+* @param emulator - emulator to be configured
+* @param argc - number of arguments
+* @param argv - arguments
+* @returns - 0 if options are correct, 1 if not (usage is printed)
+*/
+uint8_t Emulator_ParseOptions(Emulator *emulator, int argc, char **argv);
+
+/**
+* @brief - create pty (or open device) for communication with control module, trigger input is SIGUSR1
+* @param emulator - emulator
+* @returns - 0 if line is opened, 1 if not
+*/
+uint8_t Emulator_Open(Emulator *emulator);
+
+/**
+* @brief - get time since start of emulator
+* @returns - time in microseconds
+*/
+uint64_t Emulator_GetTime_us(void);
+
+/**
+* @brief - wait until received byte is available or timeout occurs, time of byte is given by line rate
+* @param emulator - emulator
+* @param byte - received byte
+* @param timeout_us - maximum time of waiting, 0 = no waiting
+* @returns - 1 if byte was received, 0 if not
+*/
+uint8_t Emulator_ReadByte(Emulator *emulator, uint8_t *byte, uint64_t timeout_us);
+
+/**
+* @brief - send string with line rate, latency and faults
+* @param emulator - emulator
+* @param string - string to be send
+* @param length - number of bytes
+* @returns - nothing
+*/
+void Emulator_Send(Emulator *emulator, const uint8_t *string, uint32_t length);
+
+/**
+* @brief - decide if fault with given probability occurs
+* @param probability - probability of fault (0 - 1)
+* @returns - 1 if fault occurs, 0 if not
+*/
+uint8_t Emulator_Fault(double probability);
+
+/**
+* @brief - check if rising edge on trigger input was received (SIGUSR1), flag is cleared
+* @returns - 1 if trigger was received, 0 if not
+*/
+uint8_t Emulator_CheckTrigger(void);
+
+/**
+* @brief - print message with time and name of module (only in verbose mode)
+* @param emulator - emulator
+* @param format - format as in printf
+* @returns - nothing
+*/
+void Emulator_Log(Emulator *emulator, const char *format, ...);
+
+#endif
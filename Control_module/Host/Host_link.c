@@ -0,0 +1,202 @@
+#include "Host_link.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <termios.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+
+static speed_t Link_GetSpeed(uint32_t baud_rate)
+{
+	switch (baud_rate)
+	{
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+		case 460800: return B460800;
+		case 921600: return B921600;
+		default: return B0;
+	}
+}
+
+
+static int Link_CompareDouble(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+	
+	return (x > y) - (x < y);
+}
+
+
+void Link_Init(Link *link, const char *name, uint8_t verbose)
+{
+	link->name = name;
+	link->verbose = verbose;
+	link->fd = -1;
+	link->rx_length = 0;
+}
+
+
+uint8_t Link_OpenSerial(Link *link, const char *device, uint32_t baud_rate)
+{
+	struct termios tio;
+	
+	if (Link_GetSpeed(baud_rate) == B0) {fprintf(stderr, "unsupported baud rate %u\n", baud_rate); return 1;}
+	
+	link->fd = open(device, O_RDWR | O_NOCTTY);
+	if (link->fd < 0) {fprintf(stderr, "cannot open %s (%s)\n", device, strerror(errno)); return 1;}
+	
+	if (tcgetattr(link->fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, Link_GetSpeed(baud_rate));
+		cfsetospeed(&tio, Link_GetSpeed(baud_rate));
+		tcsetattr(link->fd, TCSANOW, &tio);
+		tcflush(link->fd, TCIOFLUSH);
+	}
+	
+	return 0;
+}
+
+
+uint8_t Link_OpenTCP(Link *link, const char *address)
+{
+	char host[256];
+	const char *port;
+	struct addrinfo hints, *info;
+	int flag = 1;
+	
+	port = strrchr(address, ':');
+	if (port == NULL) {fprintf(stderr, "TCP endpoint must be host:port\n"); return 1;}
+	snprintf(host, sizeof(host), "%.*s", (int) (port - address), address);
+	
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(host, port + 1, &hints, &info) != 0) {fprintf(stderr, "cannot resolve %s\n", address); return 1;}
+	
+	link->fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+	if ((link->fd < 0) || (connect(link->fd, info->ai_addr, info->ai_addrlen) != 0))
+	{
+		fprintf(stderr, "cannot connect to %s (%s)\n", address, strerror(errno));
+		Link_Close(link);
+		freeaddrinfo(info);
+		return 1;
+	}
+	freeaddrinfo(info);
+	setsockopt(link->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));		//commands are short, do not wait for more data
+	
+	return 0;
+}
+
+
+void Link_Close(Link *link)
+{
+	if (link->fd >= 0) {close(link->fd);}
+	link->fd = -1;
+	link->rx_length = 0;
+}
+
+
+void Link_Send(Link *link, const char *command)
+{
+	size_t length = strlen(command);
+	
+	if (link->verbose) {fprintf(stderr, "%s> %s\n", (link->name != NULL) ? link->name : "", command);}
+	if ((write(link->fd, command, length) != (ssize_t) length) || (write(link->fd, "\n", 1) != 1))
+	{
+		fprintf(stderr, "write failed (%s)\n", strerror(errno));
+	}
+}
+
+
+int32_t Link_Receive(Link *link)
+{
+	if (link->rx_length >= sizeof(link->rx_buffer)) {link->rx_length = 0;}		//garbage without end of line
+	
+	ssize_t length = read(link->fd, link->rx_buffer + link->rx_length, sizeof(link->rx_buffer) - link->rx_length);
+	if (length > 0) {link->rx_length += length;}
+	
+	return (int32_t) length;
+}
+
+
+uint8_t Link_TakeLine(Link *link, char *line, uint32_t size)
+{
+	for (uint32_t i = 0; i < link->rx_length; i++)
+	{
+		if ((link->rx_buffer[i] != '\n') && (link->rx_buffer[i] != '\r')) {continue;}
+	
+		uint32_t length = (i < (size - 1)) ? i : (size - 1);
+		memcpy(line, link->rx_buffer, length);
+		line[length] = '\0';
+		memmove(link->rx_buffer, link->rx_buffer + i + 1, link->rx_length - i - 1);
+		link->rx_length -= i + 1;
+		i = (uint32_t) -1;		//searching starts again from beginning of buffer
+	
+		//"\n\r" of firmware gives empty lines, notifications ('!') and frames of SYST:STREAM ('#') are not answers
+		if ((line[0] == '\0') || (line[0] == '!') || (line[0] == '#')) {continue;}
+		if (link->verbose) {fprintf(stderr, "%s< %s\n", (link->name != NULL) ? link->name : "", line);}
+		return 1;
+	}
+	
+	return 0;
+}
+
+
+uint8_t Link_ReadLine(Link *link, char *line, uint32_t size, double deadline_ms)
+{
+	while (1)
+	{
+		if (Link_TakeLine(link, line, size) == 1) {return 1;}
+	
+		double now = Link_GetTime_ms();
+		if (now >= deadline_ms) {return 0;}
+	
+		struct pollfd poll_fd = {link->fd, POLLIN, 0};
+		if (poll(&poll_fd, 1, (int) (deadline_ms - now) + 1) <= 0) {continue;}
+		if (Link_Receive(link) <= 0) {fprintf(stderr, "%s%sendpoint closed\n", (link->name != NULL) ? link->name : "", (link->name != NULL) ? ": " : ""); exit(1);}
+	}
+}
+
+
+uint8_t Link_IsFenceAnswer(const char *line)
+{
+	return (strcmp(line, "NONE") == 0) || (strcmp(line, "VOLT") == 0) || (strcmp(line, "CURR") == 0);
+}
+
+
+double Link_GetTime_ms(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return (now.tv_sec * 1000.0) + (now.tv_nsec / 1000000.0);
+}
+
+
+void Link_SortValues(double *values, uint32_t count)
+{
+	qsort(values, count, sizeof(double), Link_CompareDouble);
+}
+
+
+double Link_GetPercentile(const double *values, uint32_t count, double percentile)
+{
+	if (count == 0) {return 0.0;}
+	
+	return values[(uint32_t) ((percentile / 100.0) * (count - 1) + 0.5)];		//nearest rank, values are sorted
+}
@@ -0,0 +1,124 @@
+//=============================================================
+//Common part of host tools (benchmark, replay, load, check) -
+//connection to calibrator (serial port, pty, TCP), reading of
+//answer lines and statistics of latencies
+//by Martin Praznovsky, 2025
+//=============================================================
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+#ifndef HOST_LINK_H_
+#define HOST_LINK_H_
+
+#define LINK_RX_BUFFER_SIZE		4096
+
+typedef struct
+{
+	const char *name;						//prefix of verbose output (e.g. "USB", endpoint), NULL = no prefix
+	uint8_t verbose;						//1 = print every sent command and received line
+	int fd;											//-1 = not opened
+	char rx_buffer[LINK_RX_BUFFER_SIZE];
+	uint32_t rx_length;
+} Link;
+
+/**
+* @brief - prepare link before opening (not opened, empty buffer)
+* @param link - link
+* @param name - prefix of verbose output, NULL = no prefix
+* @param verbose - 1 = print every sent command and received line
+* @returns - nothing
+*/
+void Link_Init(Link *link, const char *name, uint8_t verbose);
+
+/**
+* @brief - open serial port (USB, pty of calibrator_host) in raw mode
+* @param link - link
+* @param device - path of device
+* @param baud_rate - line rate, unsupported rate fails
+* @returns - 0 if port is opened, 1 if not
+*/
+uint8_t Link_OpenSerial(Link *link, const char *device, uint32_t baud_rate);
+
+/**
+* @brief - connect to TCP endpoint (XPort, calibrator_emulator), commands are sent without Nagle delay
+* @param link - link
+* @param address - host:port
+* @returns - 0 if connection is opened, 1 if not
+*/
+uint8_t Link_OpenTCP(Link *link, const char *address);
+
+/**
+* @brief - close link
+* @param link - link
+* @returns - nothing
+*/
+void Link_Close(Link *link);
+
+/**
+* @brief - send command followed by '\n'
+* @param link - link
+* @param command - command or several commands separated by '\n' (without the last '\n')
+* @returns - nothing
+*/
+void Link_Send(Link *link, const char *command);
+
+/**
+* @brief - read available bytes into RX buffer (without waiting), buffer full of garbage without end of line is cleared
+* @param link - link
+* @returns - number of received bytes, 0 or less if endpoint was closed
+*/
+int32_t Link_Receive(Link *link);
+
+/**
+* @brief - take one line (ends with '\n' or '\r') from RX buffer, empty lines, notifications ('!') and frames of
+*          SYST:STREAM ('#') are skipped, they are not answers of commands
+* @param link - link
+* @param line - received line without end of line
+* @param size - size of line, longer line is cut
+* @returns - 1 if line was taken, 0 if there is no complete line
+*/
+uint8_t Link_TakeLine(Link *link, char *line, uint32_t size);
+
+/**
+* @brief - wait for one line (Link_TakeLine), program ends when endpoint is closed
+* @param link - link
+* @param line - received line without end of line
+* @param size - size of line, longer line is cut
+* @param deadline_ms - time of end of waiting (Link_GetTime_ms)
+* @returns - 1 if line was received, 0 after deadline
+*/
+uint8_t Link_ReadLine(Link *link, char *line, uint32_t size, double deadline_ms);
+
+/**
+* @brief - check if line is answer of fence query FUNC? (end of command without answer)
+* @param line - received line
+* @returns - 1 if line is NONE, VOLT or CURR, 0 if not
+*/
+uint8_t Link_IsFenceAnswer(const char *line);
+
+/**
+* @brief - get monotonic time
+* @returns - time in milliseconds
+*/
+double Link_GetTime_ms(void);
+
+/**
+* @brief - sort latencies (qsort) before Link_GetPercentile
+* @param values - latencies
+* @param count - number of latencies
+* @returns - nothing
+*/
+void Link_SortValues(double *values, uint32_t count);
+
+/**
+* @brief - percentile of sorted values (nearest rank)
+* @param values - sorted values (Link_SortValues)
+* @param count - number of values
+* @param percentile - 0 - 100 (100 = maximum)
+* @returns - value, 0 if there are no values
+*/
+double Link_GetPercentile(const double *values, uint32_t count, double percentile);
+
+#endif
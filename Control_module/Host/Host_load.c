@@ -0,0 +1,500 @@
+//=====================================================================
+//Load generator for remote control - many concurrent sessions (USB and
+//Ethernet ptys of host build, calibrator_emulator ports, serial ports)
+//with mixed set/query traffic at given rate, latency of every session,
+//fairness between sessions and starvation of sessions are reported
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <math.h>
+#include "Host_link.h"
+
+
+#define LOAD_MAX_SESSIONS		64
+#define LOAD_MAX_OPERATIONS		256				//waiting and sent operations of one session, more arrivals are dropped
+#define LOAD_LINE_SIZE				256
+#define LOAD_TX_SIZE					1024
+#define LOAD_FENCE						"FUNC?"		//sent after every set command, its answer marks end of command
+
+typedef struct
+{
+	double arrival_ms;							//time when operation should be sent, latency is measured from it (open loop)
+	double sent_ms;
+	uint8_t query;									//1 = one answer line, 0 = set command followed by fence
+	uint8_t error;									//ERROR line was received
+} Load_operation;
+
+typedef struct
+{
+	char endpoint[128];
+	Link link;
+	char tx_buffer[LOAD_TX_SIZE];
+	uint32_t tx_length;
+	uint32_t tx_position;
+	double tx_next_ms;							//time of next byte of slow session
+	double byte_gap_ms;							//0 = whole command at once
+	
+	//operations are indexed by increasing counters, position in ring is index % LOAD_MAX_OPERATIONS
+	Load_operation operations[LOAD_MAX_OPERATIONS];
+	uint32_t oldest;								//oldest operation without answer
+	uint32_t next_to_send;
+	uint32_t next_free;
+	double next_arrival_ms;
+	
+	uint32_t offered;
+	uint32_t dropped;								//arrivals with full ring of operations
+	uint32_t completed;
+	uint32_t errors;
+	uint32_t timeouts;
+	uint32_t unexpected;						//answers without operation
+	double *latencies;
+	uint32_t latency_capacity;
+	double last_progress_ms;				//last answer or start of waiting of idle session
+	double max_gap_ms;							//longest time with waiting operations and without answer
+	uint32_t starvations;						//gaps longer than starvation limit
+	uint8_t starving;
+} Load_session;
+
+static Load_session sessions[LOAD_MAX_SESSIONS];
+static uint32_t session_count = 0;
+
+static double rate = 5.0;							//operations per second of every session
+static double query_fraction = 0.5;
+static uint8_t poisson = 0;
+static uint32_t window = 2;						//operations in flight per session
+static uint32_t timeout_ms = 5000;
+static uint32_t starvation_ms = 1000;
+static uint8_t verbose = 0;
+static volatile sig_atomic_t stop_requested = 0;
+
+
+static void Load_HandleSignal(int signal_number)
+{
+	stop_requested = 1;
+}
+
+
+Load_session *Load_AddSession(const char *endpoint)
+{
+	Load_session *session;
+	
+	if (session_count >= LOAD_MAX_SESSIONS) {fprintf(stderr, "too many sessions (max %d)\n", LOAD_MAX_SESSIONS); return NULL;}
+	
+	session = &sessions[session_count++];
+	memset(session, 0, sizeof(Load_session));
+	snprintf(session->endpoint, sizeof(session->endpoint), "%s", endpoint);
+	Link_Init(&session->link, session->endpoint, verbose);
+	
+	return session;
+}
+
+
+/**
+* @brief - open endpoint: device (serial port, pty of host build), host:port or host:first_port-last_port (one session per port)
+* @returns - 0 if all sessions were opened, 1 if not
+*/
+uint8_t Load_OpenEndpoint(const char *endpoint, uint32_t baud_rate)
+{
+	char host[128], name[160];
+	const char *colon = strrchr(endpoint, ':');
+	unsigned long first, last;
+	char *end;
+	Load_session *session;
+	
+	if ((endpoint[0] == '/') || (colon == NULL))
+	{
+		session = Load_AddSession(endpoint);
+		if ((session == NULL) || (Link_OpenSerial(&session->link, endpoint, baud_rate) != 0)) {session_count -= (session != NULL); return 1;}
+		return 0;
+	}
+	
+	snprintf(host, sizeof(host), "%.*s", (int) (colon - endpoint), endpoint);
+	first = strtoul(colon + 1, &end, 10);
+	last = (*end == '-') ? strtoul(end + 1, NULL, 10) : first;
+	if ((first == 0) || (last < first)) {fprintf(stderr, "wrong port in %s\n", endpoint); return 1;}
+	
+	for (unsigned long port = first; port <= last; port++)
+	{
+		snprintf(name, sizeof(name), "%s:%lu", host, port);
+		session = Load_AddSession(name);
+		if ((session == NULL) || (Link_OpenTCP(&session->link, name) != 0)) {session_count -= (session != NULL); return 1;}
+	}
+	
+	return 0;
+}
+
+
+/**
+* @brief - write waiting bytes of session, slow session writes one byte every byte_gap_ms (like typing on terminal)
+* @returns - nothing
+*/
+void Load_Flush(Load_session *session, double now)
+{
+	while (session->tx_position < session->tx_length)
+	{
+		uint32_t length = session->tx_length - session->tx_position;
+	
+		if (session->byte_gap_ms > 0.0)
+		{
+			if (now < session->tx_next_ms) {return;}
+			length = 1;
+			session->tx_next_ms = now + session->byte_gap_ms;
+		}
+	
+		ssize_t written = write(session->link.fd, session->tx_buffer + session->tx_position, length);
+		if (written <= 0) {fprintf(stderr, "%s: write failed (%s)\n", session->endpoint, strerror(errno)); exit(1);}
+		session->tx_position += written;
+	}
+	
+	session->tx_length = session->tx_position = 0;
+}
+
+
+void Load_Queue(Load_session *session, const char *text)
+{
+	uint32_t length = strlen(text);
+	
+	if (verbose) {fprintf(stderr, "%s > %s", session->endpoint, text);}
+	if ((session->tx_length + length) > LOAD_TX_SIZE) {fprintf(stderr, "%s: TX buffer is full\n", session->endpoint); return;}
+	memcpy(session->tx_buffer + session->tx_length, text, length);
+	session->tx_length += length;
+}
+
+
+/**
+* @brief - select FUNC VOLT and range 2 on every session, wait for fence answer (errors are ignored)
+* @returns - 0 if all sessions answered, 1 if not
+*/
+uint8_t Load_Setup(void)
+{
+	char line[LOAD_LINE_SIZE];
+	
+	for (uint32_t i = 0; i < session_count; i++)
+	{
+		Load_session *session = &sessions[i];
+		double deadline = Link_GetTime_ms() + timeout_ms;
+		uint8_t answered = 0;
+	
+		Load_Queue(session, "FUNC VOLT\nVOLT:RANG 2\n" LOAD_FENCE "\n");
+		while (session->tx_length > 0) {Load_Flush(session, Link_GetTime_ms()); usleep(1000);}
+	
+		while ((answered == 0) && (Link_ReadLine(&session->link, line, sizeof(line), deadline) == 1)) {answered = Link_IsFenceAnswer(line);}
+		if (answered == 0) {fprintf(stderr, "%s: no answer to setup\n", session->endpoint); return 1;}
+	}
+	
+	return 0;
+}
+
+
+void Load_AddLatency(Load_session *session, double latency_ms)
+{
+	if (session->completed >= session->latency_capacity)
+	{
+		session->latency_capacity = (session->latency_capacity == 0) ? 1024 : (2 * session->latency_capacity);
+		session->latencies = realloc(session->latencies, session->latency_capacity * sizeof(double));
+		if (session->latencies == NULL) {fprintf(stderr, "out of memory\n"); exit(1);}
+	}
+	
+	session->latencies[session->completed++] = latency_ms;
+}
+
+
+/**
+* @brief - new arrivals of session (fixed interval or Poisson process), operations are waiting in ring until window allows sending
+* @returns - nothing
+*/
+void Load_Arrive(Load_session *session, double now)
+{
+	while (now >= session->next_arrival_ms)
+	{
+		double interval_ms = 1000.0 / rate;
+	
+		session->offered++;
+		if ((session->next_free - session->oldest) < LOAD_MAX_OPERATIONS)
+		{
+			Load_operation *operation = &session->operations[session->next_free % LOAD_MAX_OPERATIONS];
+			operation->arrival_ms = session->next_arrival_ms;
+			operation->query = ((double) rand() / RAND_MAX) < query_fraction;
+			operation->error = 0;
+			if (session->oldest == session->next_free) {session->last_progress_ms = session->next_arrival_ms;}		//idle session starts waiting
+			session->next_free++;
+		}
+		else {session->dropped++;}
+	
+		if (poisson) {interval_ms = -log(1.0 - ((double) rand() / ((double) RAND_MAX + 1.0))) * interval_ms;}
+		session->next_arrival_ms += interval_ms;
+	}
+}
+
+
+void Load_Send(Load_session *session, double now)
+{
+	static const char *queries[] = {"VOLT?", "VOLT:RANG?", "FUNC?"};
+	char text[64];
+	
+	//slow session writes next command after the whole previous one
+	while (((session->next_to_send - session->oldest) < window) && (session->next_to_send != session->next_free) && (session->tx_length == 0))
+	{
+		Load_operation *operation = &session->operations[session->next_to_send % LOAD_MAX_OPERATIONS];
+	
+		if (operation->query) {snprintf(text, sizeof(text), "%s\n", queries[rand() % 3]);}
+		else {snprintf(text, sizeof(text), "VOLT %.4f\n" LOAD_FENCE "\n", (2.0 * rand() / RAND_MAX) - 1.0);}
+		operation->sent_ms = now;
+		Load_Queue(session, text);
+		Load_Flush(session, now);
+		session->next_to_send++;
+	}
+}
+
+
+void Load_Complete(Load_session *session, double now)
+{
+	Load_operation *operation = &session->operations[session->oldest % LOAD_MAX_OPERATIONS];
+	
+	Load_AddLatency(session, now - operation->arrival_ms);
+	if (operation->error) {session->errors++;}
+	session->oldest++;
+	session->last_progress_ms = now;
+	session->starving = 0;
+}
+
+
+/**
+* @brief - assign received line to the oldest sent operation, query ends with any line, set command with answer of fence
+* @returns - nothing
+*/
+void Load_HandleLine(Load_session *session, const char *line, double now)
+{
+	if (session->oldest == session->next_to_send) {session->unexpected++; return;}
+	
+	Load_operation *operation = &session->operations[session->oldest % LOAD_MAX_OPERATIONS];
+	
+	if (strncmp(line, "ERROR", 5) == 0) {operation->error = 1;}
+	if (operation->query || Link_IsFenceAnswer(line)) {Load_Complete(session, now);}
+}
+
+
+/**
+* @brief - timeouts of sent operations and gaps of sessions waiting for answer
+* @returns - nothing
+*/
+void Load_Check(Load_session *session, double now)
+{
+	//lost answer, late answer will be assigned to the next operation (counted as unexpected at the end)
+	while ((session->oldest != session->next_to_send) && ((now - session->operations[session->oldest % LOAD_MAX_OPERATIONS].sent_ms) > timeout_ms))
+	{
+		session->timeouts++;
+		session->oldest++;
+		session->last_progress_ms = now;
+	}
+	
+	if (session->oldest == session->next_free) {return;}		//idle
+	
+	double gap = now - session->last_progress_ms;
+	if (gap > session->max_gap_ms) {session->max_gap_ms = gap;}
+	if ((gap > starvation_ms) && (session->starving == 0)) {session->starvations++; session->starving = 1;}
+}
+
+
+/**
+* @brief - generate traffic of all sessions for given time, then wait for answers of sent operations
+* @returns - duration of load in seconds (without waiting for last answers)
+*/
+double Load_Run(double duration_s)
+{
+	static struct pollfd poll_fds[LOAD_MAX_SESSIONS];
+	char line[LOAD_LINE_SIZE];
+	double start = Link_GetTime_ms();
+	double end = start + (duration_s * 1000.0);
+	double stopped = 0.0;
+	
+	for (uint32_t i = 0; i < session_count; i++)
+	{
+		//arrivals of sessions are spread over one interval, all sessions do not send at the same time
+		sessions[i].next_arrival_ms = start + ((1000.0 / rate) * i / session_count);
+		sessions[i].last_progress_ms = start;
+	}
+	
+	while (1)
+	{
+		double now = Link_GetTime_ms();
+		double next_event = now + 10.0;
+		uint8_t busy = 0;
+	
+		if ((stopped == 0.0) && ((now >= end) || stop_requested)) {stopped = now;}
+	
+		for (uint32_t i = 0; i < session_count; i++)
+		{
+			Load_session *session = &sessions[i];
+	
+			if (stopped == 0.0) {Load_Arrive(session, now);}
+			Load_Flush(session, now);
+			Load_Send(session, now);
+			Load_Check(session, now);
+	
+			if (stopped == 0.0) {next_event = fmin(next_event, session->next_arrival_ms);}
+			if (session->tx_length > 0) {next_event = fmin(next_event, session->tx_next_ms);}
+			if ((session->oldest != session->next_free) || (session->tx_length > 0)) {busy = 1;}
+	
+			poll_fds[i].fd = session->link.fd;
+			poll_fds[i].events = POLLIN;
+			poll_fds[i].revents = 0;
+		}
+	
+		if ((stopped != 0.0) && (busy == 0)) {break;}
+		if ((stopped != 0.0) && ((now - stopped) > timeout_ms)) {break;}		//remaining operations were never sent
+	
+		int wait = (int) ceil(next_event - now);
+		if (poll(poll_fds, session_count, (wait > 0) ? wait : 0) <= 0) {continue;}
+	
+		now = Link_GetTime_ms();
+		for (uint32_t i = 0; i < session_count; i++)
+		{
+			Load_session *session = &sessions[i];
+	
+			if ((poll_fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {continue;}
+			if (Link_Receive(&session->link) <= 0) {fprintf(stderr, "%s: endpoint closed\n", session->endpoint); exit(1);}
+			while (Link_TakeLine(&session->link, line, sizeof(line))) {Load_HandleLine(session, line, now);}
+		}
+	}
+	
+	return ((stopped != 0.0) ? (stopped - start) : (Link_GetTime_ms() - start)) / 1000.0;
+}
+
+
+/**
+* @brief - Jain's fairness index, 1.0 = all values equal, 1/n = one session gets everything
+* @returns - index
+*/
+static double Load_GetJainIndex(const double *values, uint32_t count)
+{
+	double sum = 0.0, sum_squares = 0.0;
+	
+	for (uint32_t i = 0; i < count; i++) {sum += values[i]; sum_squares += values[i] * values[i];}
+	
+	return (sum_squares > 0.0) ? ((sum * sum) / (count * sum_squares)) : 1.0;
+}
+
+
+void Load_PrintResults(FILE *file, double duration_s)
+{
+	static double served[LOAD_MAX_SESSIONS], speed[LOAD_MAX_SESSIONS];
+	uint32_t offered = 0, completed = 0, errors = 0, timeouts = 0, starved = 0;
+	double worst_p99 = 0.0, best_p99 = -1.0;
+	
+	fprintf(file, "session,endpoint,offered,dropped,completed,errors,timeouts,unexpected,throughput_per_s,p50_ms,p99_ms,max_ms,max_gap_ms,starvations\n");
+	for (uint32_t i = 0; i < session_count; i++)
+	{
+		Load_session *session = &sessions[i];
+		double p50, p99, max;
+	
+		Link_SortValues(session->latencies, session->completed);
+		p50 = Link_GetPercentile(session->latencies, session->completed, 50.0);
+		p99 = Link_GetPercentile(session->latencies, session->completed, 99.0);
+		max = Link_GetPercentile(session->latencies, session->completed, 100.0);
+	
+		fprintf(file, "%u,%s,%u,%u,%u,%u,%u,%u,%.2f,%.1f,%.1f,%.1f,%.1f,%u\n", i, session->endpoint, session->offered, session->dropped,
+			session->completed, session->errors, session->timeouts, session->unexpected, session->completed / duration_s, p50, p99, max,
+			session->max_gap_ms, session->starvations);
+	
+		served[i] = (session->offered > 0) ? ((double) session->completed / session->offered) : 1.0;
+		speed[i] = (p50 > 0.0) ? (1.0 / p50) : 0.0;
+		if (p99 > worst_p99) {worst_p99 = p99;}
+		if ((best_p99 < 0.0) || (p99 < best_p99)) {best_p99 = p99;}
+		if (session->starvations > 0) {starved++;}
+		offered += session->offered;
+		completed += session->completed;
+		errors += session->errors;
+		timeouts += session->timeouts;
+	}
+	
+	fprintf(stderr, "%u sessions, %.1f s, offered %u, completed %u (%.1f operations/s), %u errors, %u timeouts\n", session_count,
+		duration_s, offered, completed, completed / duration_s, errors, timeouts);
+	fprintf(stderr, "fairness (Jain index, 1.000 = equal): served fraction %.3f, p50 latency %.3f, p99 spread %.1f-%.1f ms\n",
+		Load_GetJainIndex(served, session_count), Load_GetJainIndex(speed, session_count), best_p99, worst_p99);
+	fprintf(stderr, "%u starved sessions (waiting for answer longer than %u ms)", starved, starvation_ms);
+	for (uint32_t i = 0, printed = 0; i < session_count; i++)
+	{
+		if (sessions[i].starvations == 0) {continue;}
+		fprintf(stderr, "%s %s (%ux, max %.0f ms)", (printed++ == 0) ? ":" : ",", sessions[i].endpoint, sessions[i].starvations, sessions[i].max_gap_ms);
+	}
+	fprintf(stderr, "\n");
+}
+
+
+static void Load_PrintUsage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-b baud] [-D duration_s] [-r rate] [-q query_fraction] [-P] [-w window] [-k byte_gap_ms]\n"
+		"       [-g starvation_ms] [-T timeout_ms] [-s seed] [-o file] [-v] endpoint...\n"
+		"endpoint        device (serial port, /tmp/cal/USART2), host:port or host:first_port-last_port (one session per port)\n"
+		"-D duration_s   time of load (default 10), SIGINT stops load earlier\n"
+		"-r rate         operations per second of every session (default 5)\n"
+		"-q fraction     fraction of queries (VOLT?, VOLT:RANG?, FUNC?), others are VOLT <value> + FUNC? (default 0.5)\n"
+		"-P              Poisson arrivals (default fixed interval)\n"
+		"-w window       operations in flight per session (default 2)\n"
+		"-k byte_gap_ms  first session writes commands byte by byte (slow client which holds command reader of firmware)\n"
+		"-g ms           session waiting longer for answer is starved (default 1000)\n"
+		"-o file         CSV with every session (default stdout)\n",
+		name);
+}
+
+
+int main(int argc, char **argv)
+{
+	const char *output = NULL;
+	uint32_t baud_rate = 9600;
+	double duration_s = 10.0, byte_gap_ms = 0.0;
+	int option;
+	
+	while ((option = getopt(argc, argv, "b:D:r:q:Pw:k:g:T:s:o:vh")) != -1)
+	{
+		switch (option)
+		{
+			case 'b': baud_rate = strtoul(optarg, NULL, 10); break;
+			case 'D': duration_s = atof(optarg); break;
+			case 'r': rate = atof(optarg); break;
+			case 'q': query_fraction = atof(optarg); break;
+			case 'P': poisson = 1; break;
+			case 'w': window = strtoul(optarg, NULL, 10); break;
+			case 'k': byte_gap_ms = atof(optarg); break;
+			case 'g': starvation_ms = strtoul(optarg, NULL, 10); break;
+			case 'T': timeout_ms = strtoul(optarg, NULL, 10); break;
+			case 's': srand(strtoul(optarg, NULL, 10)); break;
+			case 'o': output = optarg; break;
+			case 'v': verbose = 1; break;
+			default: Load_PrintUsage(argv[0]); return 1;
+		}
+	}
+	
+	if ((optind >= argc) || (rate <= 0.0) || (window == 0)) {Load_PrintUsage(argv[0]); return 1;}
+	for (int i = optind; i < argc; i++)
+	{
+		if (Load_OpenEndpoint(argv[i], baud_rate) != 0) {return 1;}
+	}
+	sessions[0].byte_gap_ms = byte_gap_ms;
+	
+	signal(SIGINT, Load_HandleSignal);
+	signal(SIGTERM, Load_HandleSignal);
+	
+	if (Load_Setup() != 0) {return 1;}
+	double duration = Load_Run(duration_s);
+	
+	FILE *file = (output != NULL) ? fopen(output, "w") : stdout;
+	if (file == NULL) {fprintf(stderr, "cannot create %s\n", output); return 1;}
+	Load_PrintResults(file, duration);
+	if (file != stdout) {fclose(file);}
+	
+	for (uint32_t i = 0; i < session_count; i++) {Link_Close(&sessions[i].link); free(sessions[i].latencies);}
+	
+	return 0;
+}
@@ -0,0 +1,45 @@
+#include "stm32f429xx.h"
+#include "Host.h"
+
+
+//memory of peripherals used by drivers (registers without any side effect)
+GPIO_TypeDef Host_GPIOA, Host_GPIOB, Host_GPIOC, Host_GPIOD, Host_GPIOE, Host_GPIOF, Host_GPIOG, Host_GPIOH, Host_GPIOI, Host_GPIOJ, Host_GPIOK;
+USART_TypeDef Host_USART1, Host_USART2, Host_USART3, Host_UART4, Host_UART5, Host_USART6, Host_UART7, Host_UART8;
+EXTI_TypeDef Host_EXTI;
+DWT_Type Host_DWT;
+CoreDebug_Type Host_CoreDebug;
+
+
+DWT_Type *Host_GetDWT(void)
+{
+	//cycle counter of STM32F429 at 180 MHz, host has only real time with microsecond resolution
+	if (Host_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk) {Host_DWT.CYCCNT = (uint32_t) (Host_GetRealTime_us() * 180);}
+	
+	return &Host_DWT;
+}
+
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+	//interrupts do not exist on host, received data are read by polling (see Host_PollUARTs)
+}
+
+
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+}
+
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+}
+
+
+void __disable_irq(void)
+{
+}
+
+
+void __enable_irq(void)
+{
+}
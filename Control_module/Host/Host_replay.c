@@ -0,0 +1,301 @@
+//=====================================================================
+//Download of command trace (SYST:TRAC?) and its replay against any
+//endpoint (serial port, pty of host build, TCP) with original,
+//scaled or no timing, latencies and errors are compared with trace
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "Host_link.h"
+
+
+#define REPLAY_MAX_COMMANDS		10000
+#define REPLAY_LINE_SIZE			512
+#define REPLAY_COMMAND_SIZE		50				//TRACE_COMMAND_SIZE of firmware
+#define REPLAY_FENCE					"FUNC?"		//sent after every command, its answer marks end of command
+#define REPLAY_DRAIN_MS				1000			//waiting for late answers without fence
+
+typedef struct
+{
+	double time_s;									//start of handling in firmware (since Trace_Init)
+	uint32_t duration_us;						//time of handling in firmware
+	char port[4];										//USB or ETH
+	uint32_t error;									//error code of firmware, 0 = no error
+	char command[REPLAY_COMMAND_SIZE];
+	
+	//replay
+	double sent_ms;									//time of sending since start of replay
+	double latency_ms;							//time until answer of fence, negative = no answer
+	uint8_t fences;									//answers of FUNC? expected (2 when command itself is FUNC?)
+	uint8_t replay_error;						//1 = ERROR line was received
+	char reply[64];									//first answer line of command
+} Replay_command;
+
+static Link link;
+static uint32_t timeout_ms = 5000;
+static uint8_t verbose = 0;
+
+static Replay_command commands[REPLAY_MAX_COMMANDS];
+static uint32_t command_count = 0;
+static double replay_start = 0.0;
+
+
+/**
+* @brief - send SYST:TRAC? and save answer (header and all lines) into file
+* @returns - 0 if trace was received, 1 if not
+*/
+uint8_t Replay_Download(const char *path)
+{
+	char line[REPLAY_LINE_SIZE];
+	unsigned long count = 0, overwritten = 0;
+	FILE *file = (strcmp(path, "-") == 0) ? stdout : fopen(path, "w");
+	
+	if (file == NULL) {fprintf(stderr, "cannot create %s\n", path); return 1;}
+	
+	Link_Send(&link, "SYST:TRAC?");
+	if ((Link_ReadLine(&link, line, sizeof(line), Link_GetTime_ms() + timeout_ms) == 0) || (sscanf(line, "TRACE,%lu,%lu", &count, &overwritten) != 2))
+	{
+		fprintf(stderr, "no trace received (%s), firmware must be compiled with CALIBRATOR_TRACE\n", line);
+		if (file != stdout) {fclose(file);}
+		return 1;
+	}
+	fprintf(file, "%s\n", line);
+	
+	for (unsigned long i = 0; i < count; i++)
+	{
+		if (Link_ReadLine(&link, line, sizeof(line), Link_GetTime_ms() + timeout_ms) == 0) {fprintf(stderr, "trace is incomplete (%lu of %lu)\n", i, count); break;}
+		fprintf(file, "%s\n", line);
+	}
+	if (file != stdout) {fclose(file);}
+	
+	fprintf(stderr, "%lu commands downloaded, %lu older commands were overwritten in ring buffer\n", count, overwritten);
+	
+	return 0;
+}
+
+
+/**
+* @brief - read trace file, lines "<time_s>,<duration_us>,<USB|ETH>,<error>,<command>", other lines are skipped
+* @returns - number of commands
+*/
+uint32_t Replay_Load(const char *path, const char *port)
+{
+	char line[REPLAY_LINE_SIZE];
+	FILE *file = fopen(path, "r");
+	
+	if (file == NULL) {fprintf(stderr, "cannot open %s\n", path); return 0;}
+	
+	while ((fgets(line, sizeof(line), file) != NULL) && (command_count < REPLAY_MAX_COMMANDS))
+	{
+		Replay_command *command = &commands[command_count];
+		int offset = 0;
+	
+		line[strcspn(line, "\r\n")] = '\0';
+		if (sscanf(line, "%lf,%u,%3[^,],%u,%n", &command->time_s, &command->duration_us, command->port, &command->error, &offset) != 4) {continue;}
+		if (offset == 0) {continue;}
+		if ((port != NULL) && (strcmp(port, command->port) != 0)) {continue;}
+		snprintf(command->command, sizeof(command->command), "%s", line + offset);		//command may contain ',' (TRIG:LIST)
+		command_count++;
+	}
+	fclose(file);
+	
+	return command_count;
+}
+
+
+/**
+* @brief - assign received line to the oldest command waiting for answer
+* @returns - nothing
+*/
+void Replay_HandleLine(const char *line, uint32_t *oldest, uint32_t sent)
+{
+	while ((*oldest < sent) && (commands[*oldest].fences == 0)) {(*oldest)++;}
+	if (*oldest >= sent) {fprintf(stderr, "unexpected answer \"%s\"\n", line); return;}
+	
+	Replay_command *command = &commands[*oldest];
+	
+	if (Link_IsFenceAnswer(line))
+	{
+		command->fences--;
+		if ((command->fences > 0) && (command->reply[0] == '\0')) {snprintf(command->reply, sizeof(command->reply), "%s", line);}
+		if (command->fences == 0) {command->latency_ms = Link_GetTime_ms() - replay_start - command->sent_ms; (*oldest)++;}
+		return;
+	}
+	
+	if (strncmp(line, "ERROR", 5) == 0) {command->replay_error = 1;}
+	if (command->reply[0] == '\0') {snprintf(command->reply, sizeof(command->reply), "%s", line);}
+}
+
+
+/**
+* @brief - send commands at times of trace multiplied by scale, with fence every command has its latency and errors
+* @param scale - 1.0 = original timing, 0.5 = twice faster, 0 = next command after answer of previous one (needs fence)
+* @param fence - 1 = FUNC? after every command, 0 = only commands of trace
+* @returns - duration of replay in seconds
+*/
+double Replay_Run(double scale, uint8_t fence)
+{
+	char line[REPLAY_LINE_SIZE];
+	double start = replay_start = Link_GetTime_ms();
+	uint32_t sent = 0, oldest = 0;
+	
+	while (1)
+	{
+		while ((oldest < sent) && (commands[oldest].fences == 0)) {oldest++;}
+	
+		//all commands are sent, wait for remaining answers
+		if (sent == command_count)
+		{
+			double deadline = fence ? ((oldest < sent) ? (commands[oldest].sent_ms + start + timeout_ms) : 0.0) : (Link_GetTime_ms() + REPLAY_DRAIN_MS);
+			if ((fence && (oldest >= sent)) || (Link_ReadLine(&link, line, sizeof(line), deadline) == 0)) {break;}
+			if (fence) {Replay_HandleLine(line, &oldest, sent);}
+			else if (strncmp(line, "ERROR", 5) == 0) {commands[command_count - 1].replay_error = 1;}
+			continue;
+		}
+	
+		double send_at = start + (commands[sent].time_s - commands[0].time_s) * 1000.0 * scale;
+		if ((scale == 0.0) && (oldest < sent)) {send_at = commands[oldest].sent_ms + start + timeout_ms;}		//previous is running
+		double now = Link_GetTime_ms();
+	
+		if (now >= send_at)
+		{
+			if ((scale == 0.0) && (oldest < sent)) {commands[oldest].fences = 0; commands[oldest].latency_ms = -1.0;}		//timeout
+	
+			Replay_command *command = &commands[sent];
+			command->sent_ms = Link_GetTime_ms() - start;
+			command->latency_ms = -1.0;
+			command->replay_error = 0;
+			command->reply[0] = '\0';
+			command->fences = fence ? ((strncmp(command->command, "FUNC?", 5) == 0) ? 2 : 1) : 0;
+			Link_Send(&link, command->command);
+			if (fence) {Link_Send(&link, REPLAY_FENCE);}
+			sent++;
+			continue;
+		}
+	
+		if (Link_ReadLine(&link, line, sizeof(line), send_at) == 0) {continue;}
+		if (fence) {Replay_HandleLine(line, &oldest, sent);}
+		else if (strncmp(line, "ERROR", 5) == 0) {commands[sent - 1].replay_error = 1;}
+	
+		//commands without answer after timeout are finished (fence answer lost)
+		while (fence && (oldest < sent) && ((Link_GetTime_ms() - start - commands[oldest].sent_ms) > timeout_ms))
+		{
+			commands[oldest].fences = 0;
+			oldest++;
+		}
+	}
+	
+	return (Link_GetTime_ms() - start) / 1000.0;
+}
+
+
+void Replay_PrintResults(FILE *file, double duration_s, double scale, uint8_t fence)
+{
+	static double trace_ms[REPLAY_MAX_COMMANDS], replay_ms[REPLAY_MAX_COMMANDS];
+	uint32_t replay_count = 0, timeouts = 0, trace_errors = 0, replay_errors = 0, mismatches = 0;
+	
+	fprintf(file, "index,port,command,trace_time_s,trace_duration_ms,trace_error,sent_ms,latency_ms,replay_error,reply\n");
+	for (uint32_t i = 0; i < command_count; i++)
+	{
+		Replay_command *command = &commands[i];
+	
+		fprintf(file, "%u,%s,\"%s\",%.6f,%.3f,%u,%.3f,%.3f,%u,\"%s\"\n", i, command->port, command->command, command->time_s,
+			command->duration_us / 1000.0, command->error, command->sent_ms, command->latency_ms, command->replay_error, command->reply);
+	
+		trace_ms[i] = command->duration_us / 1000.0;
+		if (command->latency_ms >= 0.0) {replay_ms[replay_count++] = command->latency_ms;}
+		else if (fence) {timeouts++;}
+		if (command->error != 0) {trace_errors++;}
+		if (command->replay_error != 0) {replay_errors++;}
+		if ((command->error != 0) != (command->replay_error != 0)) {mismatches++;}
+	}
+	
+	Link_SortValues(trace_ms, command_count);
+	Link_SortValues(replay_ms, replay_count);
+	
+	fprintf(stderr, "%u commands, trace %.3f s, replay %.3f s (time scale %.3f)\n", command_count,
+		commands[command_count - 1].time_s - commands[0].time_s + (commands[command_count - 1].duration_us / 1e6), duration_s, scale);
+	fprintf(stderr, "trace:  p50 %.1f ms, p99 %.1f ms, max %.1f ms (handling in firmware), %u errors\n",
+		Link_GetPercentile(trace_ms, command_count, 50.0), Link_GetPercentile(trace_ms, command_count, 99.0),
+		Link_GetPercentile(trace_ms, command_count, 100.0), trace_errors);
+	if (fence)
+	{
+		fprintf(stderr, "replay: p50 %.1f ms, p99 %.1f ms, max %.1f ms (until answer of fence), %u errors, %u timeouts\n",
+			Link_GetPercentile(replay_ms, replay_count, 50.0), Link_GetPercentile(replay_ms, replay_count, 99.0),
+			Link_GetPercentile(replay_ms, replay_count, 100.0), replay_errors, timeouts);
+		fprintf(stderr, "%u commands with different result (error in trace and not in replay or vice versa)\n", mismatches);
+	}
+	else {fprintf(stderr, "replay: %u errors (without fence, errors are assigned to the last sent command)\n", replay_errors);}
+}
+
+
+int main(int argc, char **argv)
+{
+	const char *device = NULL;
+	const char *address = NULL;
+	const char *download = NULL;
+	const char *input = NULL;
+	const char *output = NULL;
+	const char *port = NULL;
+	uint32_t baud_rate = 9600;
+	double scale = 1.0;
+	uint8_t fence = 1;
+	int option;
+	
+	while ((option = getopt(argc, argv, "d:t:b:D:i:o:S:p:NT:v")) != -1)
+	{
+		switch (option)
+		{
+			case 'd': device = optarg; break;
+			case 't': address = optarg; break;
+			case 'b': baud_rate = strtoul(optarg, NULL, 10); break;
+			case 'D': download = optarg; break;
+			case 'i': input = optarg; break;
+			case 'o': output = optarg; break;
+			case 'S': scale = atof(optarg); break;
+			case 'p': port = optarg; break;
+			case 'N': fence = 0; break;
+			case 'T': timeout_ms = strtoul(optarg, NULL, 10); break;
+			case 'v': verbose = 1; break;
+			default:
+				fprintf(stderr, "usage: %s -d device | -t host:port [-b baud] (-D trace_file | -i trace_file [-S scale] [-p USB|ETH] [-N] [-o file]) [-T timeout_ms] [-v]\n", argv[0]);
+				fprintf(stderr, "  -D file    download trace from endpoint (SYST:TRAC?) into file (- = stdout)\n");
+				fprintf(stderr, "  -i file    replay trace against endpoint\n");
+				fprintf(stderr, "  -S scale   1.0 = original timing (default), 0.1 = 10x compressed, 0 = next command after answer of previous\n");
+				fprintf(stderr, "  -p port    replay only commands received from USB or ETH\n");
+				fprintf(stderr, "  -N         no fence (FUNC?) after commands, latencies are not measured\n");
+				fprintf(stderr, "  -o file    CSV with every command (default stdout)\n");
+				return 1;
+		}
+	}
+	
+	if ((device == NULL) == (address == NULL)) {fprintf(stderr, "select one endpoint: -d device or -t host:port\n"); return 1;}
+	if ((download == NULL) == (input == NULL)) {fprintf(stderr, "select -D (download) or -i (replay)\n"); return 1;}
+	if ((scale == 0.0) && (fence == 0)) {fprintf(stderr, "time scale 0 needs fence, -N is ignored\n"); fence = 1;}
+	if ((input != NULL) && (Replay_Load(input, port) == 0)) {fprintf(stderr, "no commands in %s\n", input); return 1;}
+	Link_Init(&link, NULL, verbose);
+	if ((device != NULL) && (Link_OpenSerial(&link, device, baud_rate) != 0)) {return 1;}
+	if ((address != NULL) && (Link_OpenTCP(&link, address) != 0)) {return 1;}
+	
+	if (download != NULL)
+	{
+		uint8_t result = Replay_Download(download);
+		Link_Close(&link);
+		return result;
+	}
+	
+	double duration = Replay_Run(scale, fence);
+	
+	FILE *file = (output != NULL) ? fopen(output, "w") : stdout;
+	if (file == NULL) {fprintf(stderr, "cannot create %s\n", output); return 1;}
+	Replay_PrintResults(file, duration, scale, fence);
+	if (file != stdout) {fclose(file);}
+	
+	Link_Close(&link);
+	
+	return 0;
+}
@@ -0,0 +1,130 @@
+//======================================================================
+//Host replacement of CMSIS device header for Linux build of firmware
+//peripherals are plain structures in memory, no register has side effect
+//by Martin Praznovsky, 2025
+//======================================================================
+
+#include <stdint.h>
+
+
+#ifndef STM32F429XX_H_
+#define STM32F429XX_H_
+
+#define __IO		volatile
+
+typedef struct
+{
+	__IO uint32_t MODER;
+	__IO uint32_t OTYPER;
+	__IO uint32_t OSPEEDR;
+	__IO uint32_t PUPDR;
+	__IO uint32_t IDR;
+	__IO uint32_t ODR;
+	__IO uint32_t BSRR;
+	__IO uint32_t LCKR;
+	__IO uint32_t AFR[2];
+} GPIO_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t SR;
+	__IO uint32_t DR;
+	__IO uint32_t BRR;
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t CR3;
+	__IO uint32_t GTPR;
+} USART_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t IMR;
+	__IO uint32_t EMR;
+	__IO uint32_t RTSR;
+	__IO uint32_t FTSR;
+	__IO uint32_t SWIER;
+	__IO uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CTRL;
+	__IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+	__IO uint32_t DHCSR;
+	__IO uint32_t DCRSR;
+	__IO uint32_t DCRDR;
+	__IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef enum
+{
+	EXTI0_IRQn = 6,
+	EXTI1_IRQn = 7,
+	EXTI2_IRQn = 8,
+	EXTI3_IRQn = 9,
+	EXTI4_IRQn = 10,
+	EXTI9_5_IRQn = 23,
+	USART1_IRQn = 37,
+	USART2_IRQn = 38,
+	USART3_IRQn = 39,
+	EXTI15_10_IRQn = 40,
+	UART4_IRQn = 52,
+	UART5_IRQn = 53,
+	USART6_IRQn = 71,
+	UART7_IRQn = 82,
+	UART8_IRQn = 83
+} IRQn_Type;
+
+extern GPIO_TypeDef Host_GPIOA, Host_GPIOB, Host_GPIOC, Host_GPIOD, Host_GPIOE, Host_GPIOF, Host_GPIOG, Host_GPIOH, Host_GPIOI, Host_GPIOJ, Host_GPIOK;
+extern USART_TypeDef Host_USART1, Host_USART2, Host_USART3, Host_UART4, Host_UART5, Host_USART6, Host_UART7, Host_UART8;
+extern EXTI_TypeDef Host_EXTI;
+extern DWT_Type Host_DWT;
+extern CoreDebug_Type Host_CoreDebug;
+
+#define GPIOA				(&Host_GPIOA)
+#define GPIOB				(&Host_GPIOB)
+#define GPIOC				(&Host_GPIOC)
+#define GPIOD				(&Host_GPIOD)
+#define GPIOE				(&Host_GPIOE)
+#define GPIOF				(&Host_GPIOF)
+#define GPIOG				(&Host_GPIOG)
+#define GPIOH				(&Host_GPIOH)
+#define GPIOI				(&Host_GPIOI)
+#define GPIOJ				(&Host_GPIOJ)
+#define GPIOK				(&Host_GPIOK)
+#define USART1			(&Host_USART1)
+#define USART2			(&Host_USART2)
+#define USART3			(&Host_USART3)
+#define UART4				(&Host_UART4)
+#define UART5				(&Host_UART5)
+#define USART6			(&Host_USART6)
+#define UART7				(&Host_UART7)
+#define UART8				(&Host_UART8)
+#define EXTI				(&Host_EXTI)
+#define DWT					(Host_GetDWT())
+#define CoreDebug		(&Host_CoreDebug)
+
+#define DWT_CTRL_CYCCNTENA_Msk				(1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk		(1UL << 24)
+
+/**
+* @brief - get DWT registers, CYCCNT is updated from real time of host (180 cycles per microsecond) when enabled
+* @returns - pointer to DWT registers
+*/
+DWT_Type *Host_GetDWT(void);
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority);
+
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+
+void __disable_irq(void);
+
+void __enable_irq(void);
+
+#endif
@@ -5,41 +5,73 @@ volatile static uint8_t UART1_RX_buffer[UART1_RX_BUFFER_SIZE];
 volatile static uint8_t UART1_RX_counter = 0;
 volatile static uint8_t UART1_RX_write_pos = 0;
 volatile static uint8_t UART1_RX_read_pos = 0;
+volatile static uint8_t UART1_TX_buffer[UART1_TX_BUFFER_SIZE];
+volatile static uint8_t UART1_TX_counter = 0;
+volatile static uint8_t UART1_TX_write_pos = 0;
+volatile static uint8_t UART1_TX_read_pos = 0;
 
 volatile static uint8_t UART2_RX_buffer[UART2_RX_BUFFER_SIZE];
 volatile static uint8_t UART2_RX_counter = 0;
 volatile static uint8_t UART2_RX_write_pos = 0;
 volatile static uint8_t UART2_RX_read_pos = 0;
+volatile static uint8_t UART2_TX_buffer[UART2_TX_BUFFER_SIZE];
+volatile static uint8_t UART2_TX_counter = 0;
+volatile static uint8_t UART2_TX_write_pos = 0;
+volatile static uint8_t UART2_TX_read_pos = 0;
 
 volatile static uint8_t UART3_RX_buffer[UART3_RX_BUFFER_SIZE];
 volatile static uint8_t UART3_RX_counter = 0;
 volatile static uint8_t UART3_RX_write_pos = 0;
 volatile static uint8_t UART3_RX_read_pos = 0;
+volatile static uint8_t UART3_TX_buffer[UART3_TX_BUFFER_SIZE];
+volatile static uint8_t UART3_TX_counter = 0;
+volatile static uint8_t UART3_TX_write_pos = 0;
+volatile static uint8_t UART3_TX_read_pos = 0;
 
 volatile static uint8_t UART4_RX_buffer[UART4_RX_BUFFER_SIZE];
 volatile static uint8_t UART4_RX_counter = 0;
 volatile static uint8_t UART4_RX_write_pos = 0;
 volatile static uint8_t UART4_RX_read_pos = 0;
+volatile static uint8_t UART4_TX_buffer[UART4_TX_BUFFER_SIZE];
+volatile static uint8_t UART4_TX_counter = 0;
+volatile static uint8_t UART4_TX_write_pos = 0;
+volatile static uint8_t UART4_TX_read_pos = 0;
 
 volatile static uint8_t UART5_RX_buffer[UART5_RX_BUFFER_SIZE];
 volatile static uint8_t UART5_RX_counter = 0;
 volatile static uint8_t UART5_RX_write_pos = 0;
 volatile static uint8_t UART5_RX_read_pos = 0;
+volatile static uint8_t UART5_TX_buffer[UART5_TX_BUFFER_SIZE];
+volatile static uint8_t UART5_TX_counter = 0;
+volatile static uint8_t UART5_TX_write_pos = 0;
+volatile static uint8_t UART5_TX_read_pos = 0;
 
 volatile static uint8_t UART6_RX_buffer[UART6_RX_BUFFER_SIZE];
 volatile static uint8_t UART6_RX_counter = 0;
 volatile static uint8_t UART6_RX_write_pos = 0;
 volatile static uint8_t UART6_RX_read_pos = 0;
+volatile static uint8_t UART6_TX_buffer[UART6_TX_BUFFER_SIZE];
+volatile static uint8_t UART6_TX_counter = 0;
+volatile static uint8_t UART6_TX_write_pos = 0;
+volatile static uint8_t UART6_TX_read_pos = 0;
 
 volatile static uint8_t UART7_RX_buffer[UART7_RX_BUFFER_SIZE];
 volatile static uint8_t UART7_RX_counter = 0;
 volatile static uint8_t UART7_RX_write_pos = 0;
 volatile static uint8_t UART7_RX_read_pos = 0;
+volatile static uint8_t UART7_TX_buffer[UART7_TX_BUFFER_SIZE];
+volatile static uint8_t UART7_TX_counter = 0;
+volatile static uint8_t UART7_TX_write_pos = 0;
+volatile static uint8_t UART7_TX_read_pos = 0;
 
 volatile static uint8_t UART8_RX_buffer[UART8_RX_BUFFER_SIZE];
 volatile static uint8_t UART8_RX_counter = 0;
 volatile static uint8_t UART8_RX_write_pos = 0;
 volatile static uint8_t UART8_RX_read_pos = 0;
+volatile static uint8_t UART8_TX_buffer[UART8_TX_BUFFER_SIZE];
+volatile static uint8_t UART8_TX_counter = 0;
+volatile static uint8_t UART8_TX_write_pos = 0;
+volatile static uint8_t UART8_TX_read_pos = 0;
 
 
 UART UART1_handle;
@@ -52,6 +84,17 @@ UART UART7_handle;
 UART UART8_handle;
 
 
+static void UART_TransmitNext(UART *UARTx)
+{
+	(UARTx->UARTx)->DR = UARTx->UART_TX_buffer[*(UARTx->UART_TX_read_pos)];		//send the oldest byte of TX buffer
+	*(UARTx->UART_TX_read_pos) += 1;
+	*(UARTx->UART_TX_counter) -= 1;
+	
+	if (*(UARTx->UART_TX_read_pos) >= UARTx->UART_TX_buffer_size)		{*(UARTx->UART_TX_read_pos) = 0;}
+	if (*(UARTx->UART_TX_counter) == 0)		{(UARTx->UARTx)->CR1 &= ~USART_CR1_TXEIE;}		//TX buffer is empty, disable TX interrupt
+}
+
+
 void USART1_IRQHandler(void)
 {
 	if (USART1->SR & (USART_SR_RXNE))
@@ -61,6 +104,11 @@ void USART1_IRQHandler(void)
 		
 		if (UART1_RX_write_pos >= UART1_RX_BUFFER_SIZE)		{UART1_RX_write_pos = 0;}
 	}
+	
+	if ((USART1->CR1 & USART_CR1_TXEIE) && (USART1->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART1_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -73,6 +121,11 @@ void USART2_IRQHandler(void)
 		
 		if (UART2_RX_write_pos >= UART2_RX_BUFFER_SIZE)		{UART2_RX_write_pos = 0;}
 	}
+	
+	if ((USART2->CR1 & USART_CR1_TXEIE) && (USART2->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART2_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -85,6 +138,11 @@ void USART3_IRQHandler(void)
 		
 		if (UART3_RX_write_pos >= UART3_RX_BUFFER_SIZE)		{UART3_RX_write_pos = 0;}
 	}
+	
+	if ((USART3->CR1 & USART_CR1_TXEIE) && (USART3->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART3_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -97,6 +155,11 @@ void UART4_IRQHandler(void)
 		
 		if (UART4_RX_write_pos >= UART4_RX_BUFFER_SIZE)		{UART4_RX_write_pos = 0;}
 	}
+	
+	if ((UART4->CR1 & USART_CR1_TXEIE) && (UART4->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART4_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -110,6 +173,11 @@ void UART5_IRQHandler(void)
 		
 		if (UART5_RX_write_pos >= UART5_RX_BUFFER_SIZE)		{UART5_RX_write_pos = 0;}
 	}
+	
+	if ((UART5->CR1 & USART_CR1_TXEIE) && (UART5->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART5_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -122,6 +190,11 @@ void USART6_IRQHandler(void)
 		
 		if (UART6_RX_write_pos >= UART6_RX_BUFFER_SIZE)		{UART6_RX_write_pos = 0;}
 	}
+	
+	if ((USART6->CR1 & USART_CR1_TXEIE) && (USART6->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART6_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -134,6 +207,11 @@ void UART7_IRQHandler(void)
 		
 		if (UART7_RX_write_pos >= UART7_RX_BUFFER_SIZE)		{UART7_RX_write_pos = 0;}
 	}
+	
+	if ((UART7->CR1 & USART_CR1_TXEIE) && (UART7->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART7_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -146,6 +224,11 @@ void UART8_IRQHandler(void)
 		
 		if (UART8_RX_write_pos >= UART8_RX_BUFFER_SIZE)		{UART8_RX_write_pos = 0;}
 	}
+	
+	if ((UART8->CR1 & USART_CR1_TXEIE) && (UART8->SR & USART_SR_TXE))
+	{
+		UART_TransmitNext(&UART8_handle);								//next byte of TX buffer
+	}
 }
 
 
@@ -168,6 +251,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART1_handle.UART_RX_read_pos = &UART1_RX_read_pos;
 		UART1_handle.UART_RX_write_pos = &UART1_RX_write_pos;
 		UART1_handle.UART_RX_buffer_size = UART1_RX_BUFFER_SIZE;
+		UART1_handle.UART_TX_buffer = UART1_TX_buffer;
+		UART1_handle.UART_TX_counter = &UART1_TX_counter;
+		UART1_handle.UART_TX_read_pos = &UART1_TX_read_pos;
+		UART1_handle.UART_TX_write_pos = &UART1_TX_write_pos;
+		UART1_handle.UART_TX_buffer_size = UART1_TX_BUFFER_SIZE;
 		
 		RCC->APB2RSTR |= RCC_APB2RSTR_USART1RST;	//reset USART1 registers
 		RCC->APB2RSTR &= ~RCC_APB2RSTR_USART1RST;	//clear reset of USART1 registers
@@ -183,6 +271,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART2_handle.UART_RX_read_pos = &UART2_RX_read_pos;
 		UART2_handle.UART_RX_write_pos = &UART2_RX_write_pos;
 		UART2_handle.UART_RX_buffer_size = UART2_RX_BUFFER_SIZE;
+		UART2_handle.UART_TX_buffer = UART2_TX_buffer;
+		UART2_handle.UART_TX_counter = &UART2_TX_counter;
+		UART2_handle.UART_TX_read_pos = &UART2_TX_read_pos;
+		UART2_handle.UART_TX_write_pos = &UART2_TX_write_pos;
+		UART2_handle.UART_TX_buffer_size = UART2_TX_BUFFER_SIZE;
 		
 		RCC->APB1RSTR |= RCC_APB1RSTR_USART2RST;	//reset USART2 registers
 		RCC->APB1RSTR &= ~RCC_APB1RSTR_USART2RST;	//clear reset of USART2 registers
@@ -198,6 +291,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART3_handle.UART_RX_read_pos = &UART3_RX_read_pos;
 		UART3_handle.UART_RX_write_pos = &UART3_RX_write_pos;
 		UART3_handle.UART_RX_buffer_size = UART3_RX_BUFFER_SIZE;
+		UART3_handle.UART_TX_buffer = UART3_TX_buffer;
+		UART3_handle.UART_TX_counter = &UART3_TX_counter;
+		UART3_handle.UART_TX_read_pos = &UART3_TX_read_pos;
+		UART3_handle.UART_TX_write_pos = &UART3_TX_write_pos;
+		UART3_handle.UART_TX_buffer_size = UART3_TX_BUFFER_SIZE;
 		
 		RCC->APB1RSTR |= RCC_APB1RSTR_USART3RST;	//reset USART3 registers
 		RCC->APB1RSTR &= ~RCC_APB1RSTR_USART3RST;	//clear reset of USART3 registers
@@ -213,6 +311,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART4_handle.UART_RX_read_pos = &UART4_RX_read_pos;
 		UART4_handle.UART_RX_write_pos = &UART4_RX_write_pos;
 		UART4_handle.UART_RX_buffer_size = UART4_RX_BUFFER_SIZE;
+		UART4_handle.UART_TX_buffer = UART4_TX_buffer;
+		UART4_handle.UART_TX_counter = &UART4_TX_counter;
+		UART4_handle.UART_TX_read_pos = &UART4_TX_read_pos;
+		UART4_handle.UART_TX_write_pos = &UART4_TX_write_pos;
+		UART4_handle.UART_TX_buffer_size = UART4_TX_BUFFER_SIZE;
 		
 		RCC->APB1RSTR |= RCC_APB1RSTR_UART4RST;		//reset UART4 registers
 		RCC->APB1RSTR &= ~RCC_APB1RSTR_UART4RST;	//clear reset of UART4 registers
@@ -228,6 +331,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART5_handle.UART_RX_read_pos = &UART5_RX_read_pos;
 		UART5_handle.UART_RX_write_pos = &UART5_RX_write_pos;
 		UART5_handle.UART_RX_buffer_size = UART5_RX_BUFFER_SIZE;
+		UART5_handle.UART_TX_buffer = UART5_TX_buffer;
+		UART5_handle.UART_TX_counter = &UART5_TX_counter;
+		UART5_handle.UART_TX_read_pos = &UART5_TX_read_pos;
+		UART5_handle.UART_TX_write_pos = &UART5_TX_write_pos;
+		UART5_handle.UART_TX_buffer_size = UART5_TX_BUFFER_SIZE;
 		
 		RCC->APB1RSTR |= RCC_APB1RSTR_UART5RST;		//reset UART5 registers
 		RCC->APB1RSTR &= ~RCC_APB1RSTR_UART5RST;	//clear reset of USART5 registers
@@ -243,6 +351,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART6_handle.UART_RX_read_pos = &UART6_RX_read_pos;
 		UART6_handle.UART_RX_write_pos = &UART6_RX_write_pos;
 		UART6_handle.UART_RX_buffer_size = UART6_RX_BUFFER_SIZE;
+		UART6_handle.UART_TX_buffer = UART6_TX_buffer;
+		UART6_handle.UART_TX_counter = &UART6_TX_counter;
+		UART6_handle.UART_TX_read_pos = &UART6_TX_read_pos;
+		UART6_handle.UART_TX_write_pos = &UART6_TX_write_pos;
+		UART6_handle.UART_TX_buffer_size = UART6_TX_BUFFER_SIZE;
 		
 		RCC->APB2RSTR |= RCC_APB2RSTR_USART6RST;	//reset USART6 registers
 		RCC->APB2RSTR &= ~RCC_APB2RSTR_USART6RST;	//clear reset of USART6 registers
@@ -258,6 +371,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART7_handle.UART_RX_read_pos = &UART7_RX_read_pos;
 		UART7_handle.UART_RX_write_pos = &UART7_RX_write_pos;
 		UART7_handle.UART_RX_buffer_size = UART7_RX_BUFFER_SIZE;
+		UART7_handle.UART_TX_buffer = UART7_TX_buffer;
+		UART7_handle.UART_TX_counter = &UART7_TX_counter;
+		UART7_handle.UART_TX_read_pos = &UART7_TX_read_pos;
+		UART7_handle.UART_TX_write_pos = &UART7_TX_write_pos;
+		UART7_handle.UART_TX_buffer_size = UART7_TX_BUFFER_SIZE;
 		
 		RCC->APB1RSTR |= RCC_APB1RSTR_UART7RST;		//reset UART7 registers
 		RCC->APB1RSTR &= ~RCC_APB1RSTR_UART7RST;	//clear reset of USART7 registers
@@ -273,6 +391,11 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 		UART8_handle.UART_RX_read_pos = &UART8_RX_read_pos;
 		UART8_handle.UART_RX_write_pos = &UART8_RX_write_pos;
 		UART8_handle.UART_RX_buffer_size = UART8_RX_BUFFER_SIZE;
+		UART8_handle.UART_TX_buffer = UART8_TX_buffer;
+		UART8_handle.UART_TX_counter = &UART8_TX_counter;
+		UART8_handle.UART_TX_read_pos = &UART8_TX_read_pos;
+		UART8_handle.UART_TX_write_pos = &UART8_TX_write_pos;
+		UART8_handle.UART_TX_buffer_size = UART8_TX_BUFFER_SIZE;
 		
 		RCC->APB1RSTR |= RCC_APB1RSTR_UART7RST;		//reset UART7 registers
 		RCC->APB1RSTR &= ~RCC_APB1RSTR_UART7RST;	//clear reset of USART7 registers
@@ -321,6 +444,7 @@ UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uin
 
 void UART_SendByte(UART *UARTx, uint8_t byte)
 {
+	while (*(UARTx->UART_TX_counter) > 0);										//wait until queued bytes are sent, order of bytes is kept
 	while (!((UARTx->UARTx)->SR & (USART_SR_TXE)));		//wait until data register is empty and ready for next transmission
 	(UARTx->UARTx)->DR = byte;												//put byte into data register
 }
@@ -328,7 +452,7 @@ void UART_SendByte(UART *UARTx, uint8_t byte)
 
 void UART_SendString(UART *UARTx, uint8_t *string)
 {
-	uint8_t i = 0;
+	uint16_t i = 0;		//strings can be longer than 255 characters
 	
 	while(string[i] != '\0')
 	{
@@ -337,6 +461,29 @@ void UART_SendString(UART *UARTx, uint8_t *string)
 }
 
 
+uint8_t UART_QueueString(UART *UARTx, uint8_t *string)
+{
+	uint16_t length = 0;
+	
+	while (string[length] != '\0') {length++;}
+	if (length > (UARTx->UART_TX_buffer_size - *(UARTx->UART_TX_counter))) {return 0;}		//string does not fit, nothing is queued
+	
+	for (uint16_t i = 0; i < length; i++)
+	{
+		UARTx->UART_TX_buffer[*(UARTx->UART_TX_write_pos)] = string[i];
+		*(UARTx->UART_TX_write_pos) += 1;
+		
+		if (*(UARTx->UART_TX_write_pos) >= UARTx->UART_TX_buffer_size)		{*(UARTx->UART_TX_write_pos) = 0;}
+	}
+	
+	(UARTx->UARTx)->CR1 &= ~USART_CR1_TXEIE;		//counter is decremented by TX interrupt
+	*(UARTx->UART_TX_counter) += length;
+	(UARTx->UARTx)->CR1 |= USART_CR1_TXEIE;			//TX interrupt sends bytes while TX buffer is not empty
+	
+	return 1;
+}
+
+
 uint8_t UART_ReadByte(UART *UARTx)
 {
 	uint8_t data = 0;
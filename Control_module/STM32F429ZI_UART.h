@@ -21,6 +21,15 @@
 #define UART7_RX_BUFFER_SIZE	128
 #define UART8_RX_BUFFER_SIZE	128
 
+#define UART1_TX_BUFFER_SIZE	255		//TX buffer holds one frame of SYST:STREAM (UART_QueueString)
+#define UART2_TX_BUFFER_SIZE	255
+#define UART3_TX_BUFFER_SIZE	255
+#define UART4_TX_BUFFER_SIZE	255
+#define UART5_TX_BUFFER_SIZE	255
+#define UART6_TX_BUFFER_SIZE	255
+#define UART7_TX_BUFFER_SIZE	255
+#define UART8_TX_BUFFER_SIZE	255
+
 typedef struct
 {
 	USART_TypeDef* UARTx;
@@ -29,6 +38,11 @@ typedef struct
 	uint8_t *UART_RX_counter;
 	uint8_t *UART_RX_write_pos;
 	uint8_t *UART_RX_read_pos;
+	uint8_t *UART_TX_buffer;
+	uint8_t UART_TX_buffer_size;
+	volatile uint8_t *UART_TX_counter;		//bytes waiting for TX interrupt
+	volatile uint8_t *UART_TX_write_pos;
+	volatile uint8_t *UART_TX_read_pos;
 } UART;
 
 /**
@@ -46,7 +60,7 @@ typedef struct
 UART *UART_Init(USART_TypeDef *UARTx, uint32_t baud_rate, uint32_t CLK_FREQ, uint8_t priority, GPIO_TypeDef *TX_port, uint8_t TX_pin, GPIO_TypeDef *RX_port, uint8_t RX_pin);
 
 /**
-* @brief - send one byte of data
+* @brief - send one byte of data, bytes queued by UART_QueueString are sent first
 * @param UARTx - UART which is going to be used
 * @param byte - 8 bits of data
 * @returns - nothing
@@ -61,6 +75,14 @@ void UART_SendByte(UART *UARTx, uint8_t byte);
 */
 void UART_SendString(UART *UARTx, uint8_t *string);
 
+/**
+* @brief - copy string into TX buffer and return immediately, bytes are sent by TX interrupt
+* @param UARTx - UART which is going to be used
+* @param string - pointer to string to be send, string must be finished with '\0'
+* @returns - 1 if string was queued, 0 if there is not enough space in TX buffer (nothing is queued)
+*/
+uint8_t UART_QueueString(UART *UARTx, uint8_t *string);
+
 /**
 * @brief - read one byte from RX buffer
 * @param UARTx - UART which is going to be used
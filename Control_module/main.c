@@ -12,6 +12,8 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
+#include <math.h>
 #include "STM32F429ZI_SystemClock.h"
 #include "STM32F429ZI_Delay.h"
 #include "STM32F429ZI_GPIOPins.h"
@@ -20,16 +22,37 @@
 #include "Lantronix_XPort.h"
 #include "CLVB.h"
 #include "CCB.h"
+#include "Calibrator_trigger.h"
+#include "Calibrator_clock.h"
+#include "Calibrator_profiler.h"
+#include "Calibrator_trace.h"
+#include "Calibrator_session.h"
+#include "Calibrator_status.h"
+#include "Calibrator_stream.h"
 #include "Calibrator_errors.h"
 
 
-void Calibrator_HandleRemoteControl(UART *UART_handle);
-void Calibrator_ReadCommand(UART *UART_handle, uint8_t *command);
-void Calibrator_HandleCommandFUNC(UART *UART_handle, uint8_t *command);
-void Calibrator_HandleCommandVOLT(UART *UART_handle, uint8_t *command);
-void Calibrator_HandleCommandCURR(UART *UART_handle, uint8_t *command);
+void Calibrator_HandleRemoteControl(Session *session);
+void Calibrator_HandleCommand(Session *session, uint8_t *command);
+void Calibrator_ReportError(Session *session, uint8_t *command);
+uint8_t Calibrator_IsSetPointSuperseded(Session *session, uint8_t *command, uint8_t *next_command);
+uint8_t Calibrator_IsSetPointValid(Session *session, uint8_t *command, uint8_t target);
+void Calibrator_BeginBatch(void);
+void Calibrator_CommitBatch(Session *session, uint8_t **commands);
+void Calibrator_HandleCommandFUNC(Session *session, uint8_t *command);
+void Calibrator_HandleCommandVOLT(Session *session, uint8_t *command);
+void Calibrator_HandleCommandCURR(Session *session, uint8_t *command);
+void Calibrator_HandleCommandTRIG(Session *session, uint8_t *command);
+void Calibrator_HandleCommandSYNC(Session *session, uint8_t *command);
+void Calibrator_HandleCommandSYST(Session *session, uint8_t *command);
+void Calibrator_HandleCommandSTAT(Session *session, uint8_t *command);
+void Calibrator_HandleCommandCommon(Session *session, uint8_t *command);
+uint8_t Calibrator_LoadNextTriggerValue(void);
 void GetStateCLVB(void);
 void GetStateCCB(void);
+void Calibrator_SetSyncArmed(uint8_t armed);
+uint8_t *Calibrator_GetStateLine(void);
+void Calibrator_SendStreamFrame(void);
 
 
 //ETHERNET variables
@@ -42,23 +65,35 @@ uint8_t string_Ethernet_DNS[20];
 #define MODULE_NONE		0
 #define MODULE_CLVB		1
 #define MODULE_CCB		2
-uint8_t module_selected = 0;
+static uint8_t trigger_module = MODULE_NONE;		//module selected by session which started trigger (TRIG ON)
 
 volatile static double CLVB_voltage = 0.0;			//desired value
 volatile static double CLVB_frequency = 0.0;		//desired value
 volatile static double CCB_current = 0.0;				//desired value
 
-volatile static uint8_t error = NO_ERROR;
+static double batch_CLVB_voltage = 0.0;					//desired values before batch of commands (Calibrator_BeginBatch)
+static double batch_CLVB_frequency = 0.0;
+static double batch_CCB_current = 0.0;
+static uint8_t batch_sync_armed = 0;
+
+volatile static uint8_t sync_armed = 0;						//1 = CLVB and CCB wait for common trigger
 
 volatile static uint8_t byte = 0;
 volatile static uint8_t CLVB_error = 0;
 volatile static uint8_t CCB_error = 0;
 
-volatile static uint8_t string[300];
+static Session sessions[SESSION_COUNT];			//USB and Ethernet, each has its own error, answer and selected module
 
 CLVB_module_state CLVB_state_main;
 CCB_module_state CCB_state_main;
 
+//state of all modules in one line (STAT:ALL?), line is formatted again only after change of state
+static uint8_t state_line[160];
+static uint8_t state_changed = 1;
+static uint32_t state_sequence = 0;			//number of changes since reset, client can skip unchanged state
+
+static uint32_t link_errors[STATUS_MODULES];		//failed communications with CLVB and CCB since reset (SYST:STREAM)
+
 
 int main(void)
 {
@@ -73,7 +108,7 @@ int main(void)
 	//init all UARTs for USB, Ethernet, CLVB, CCB, CVRB
 	UART *UART_USB = UART_Init(USART2, 9600, 45000000, 3, GPIOD, 5, GPIOD, 6);				//USB (FT232RN)
 	UART *UART_ETHERNET = UART_Init(UART5, 9600, 45000000, 4, GPIOC, 12, GPIOD, 2);		//Ethernet (Lantronix XPort)
-	UART *UART_CVRB = UART_Init(USART3, 9600, 45000000, 7, GPIOC, 10, GPIOC, 11);			//CVRB
+	UART_Init(USART3, 9600, 45000000, 7, GPIOC, 10, GPIOC, 11);											//CVRB (not controlled yet)
 	UART *UART_CLVB = UART_Init(USART6, 9600, 90000000, 5, GPIOG, 14, GPIOG, 9);			//CLVB
 	UART *UART_CCB = UART_Init(UART7, 9600, 45000000, 6, GPIOE, 8, GPIOE, 7);					//CCB
 	//UART *UART_SPARE = UART_Init(USART1, 9600, 90000000, 8, GPIOA, 10, GPIOA, 9);			//spare UART
@@ -106,6 +141,9 @@ int main(void)
 	//wait for few seconds for initialization of all modules
 	delay_ms(3000);
 	
+	uint8_t error = NO_ERROR;
+	uint8_t string[300];
+	
 	//init CLVB module
 	error = Module_GetName(UART_CLVB, string);
 	if (error == NO_ERROR) {UART_SendString(UART_USB, string);}
@@ -126,30 +164,70 @@ int main(void)
 	Utils_ClearString(string);
 	//CCB_PrintRegisters(UART_USB);
 	
+	//init trigger input and trigger line to modules
+	Trigger_Init();
+	
+	//start DWT cycle counter, time base of profiler, trace, settling of relays and stream
+	Clock_Init();
+	
+	//clear statistics of command handling (only with CALIBRATOR_PROFILING)
+	PROFILER_INIT();
+	
+	//start trace of remote commands (only with CALIBRATOR_TRACE, SYST:TRAC ON starts recording)
+	TRACE_INIT();
+	
+	//sessions of remote control, commands of USB and Ethernet do not share state
+	Session_Init(&sessions[SESSION_USB], UART_USB, SESSION_USB);
+	Session_Init(&sessions[SESSION_ETHERNET], UART_ETHERNET, SESSION_ETHERNET);
+	
+	//events of operations are sent to sessions which enabled them (STAT:OPER:ENAB)
+	Status_Init(sessions, SESSION_COUNT);
+	
+	//periodic state frames (SYST:STREAM), OFF after reset
+	Stream_Init();
+		
 	delay_ms(1000);
 	
 	while (1)
 	{
-		//remote control via USB
-		if (UART_AvailableBytes(UART_USB) > 0)
+		Clock_Tick();		//64-bit time is extended at least once per loop (CYCCNT overflows every 23 s)
+		
+		//remote control via USB and Ethernet, sessions take turns with one command each,
+		//unfinished line of one session does not block the other one
+		for (uint8_t i = 0; i < SESSION_COUNT; i++)
 		{
-			/*byte = UART_ReadByte(UART_USB);
-			UART_SendByte(UART_USB, byte);*/
-			
-			delay_ms(10);
-			Calibrator_HandleRemoteControl(UART_USB);
+			PROFILER_START(PROFILER_PARSE);
+			if (Session_ReadCommand(&sessions[i]) == 1)
+			{
+				PROFILER_STOP(PROFILER_PARSE);
+				Calibrator_HandleRemoteControl(&sessions[i]);
+			}
 		}
 		
-		//remote control via Ethernet
-		if (UART_AvailableBytes(UART_ETHERNET) > 0)
+		//rest of line is expected, timeout of unfinished line is counted in 10 ms steps
+		if (Session_IsReceiving(&sessions[SESSION_USB]) || Session_IsReceiving(&sessions[SESSION_ETHERNET]))
 		{
-			/*byte = UART_ReadByte(UART_ETHERNET);
-			UART_SendByte(UART_USB, byte);*/
-			
 			delay_ms(10);
-			Calibrator_HandleRemoteControl(UART_ETHERNET);
 		}
 		
+		//trigger occurred, next value from trigger list is preloaded into module and waits for next trigger
+		if (Trigger_CheckEvent() == 1)
+		{
+			//last value of list was applied, list continues from the beginning
+			if ((Trigger_ListGetSize() > 0) && (Trigger_ListGetPosition() == 0)) {Status_Post(0, STATUS_EVENT_LIST, "");}
+			if (Calibrator_LoadNextTriggerValue() != NO_ERROR)
+			{
+				link_errors[(trigger_module == MODULE_CCB) ? STATUS_CCB : STATUS_CLVB]++;
+				Status_Post(0, STATUS_EVENT_FAULT, "");
+			}
+		}
+		
+		//relays switched by previous commands are settled
+		Status_Tick();
+		
+		//state frame is queued into TX buffer of stream port, main loop continues while it is sent
+		if (Stream_IsDue() == 1) {Calibrator_SendStreamFrame();}
+		
 		//control via touchscreen display
 		//-- will be added in next version, when calibrator is implemented in a box with display
 	}
@@ -158,173 +236,325 @@ int main(void)
 }
 
 
-void Calibrator_ReadCommand(UART *UART_handle, uint8_t *command)
+void Calibrator_HandleRemoteControl(Session *session)
 {
-	error = NO_ERROR;
+	//1. line was read by Session_ReadCommand, commands are separated by ';'
+	//2. set-point followed by valid set-point of the same target is dropped, only the last one is executed
+	//3. commands are executed one by one (Calibrator_HandleCommand)
+	//4. writes into registers of modules are checked in one transaction at the end of line or before query
 	
-	uint8_t time_counter = 0;
-	uint8_t i = 0;
-	uint8_t c = 0;
-	uint8_t end = 0;
+	uint8_t *commands[SESSION_BATCH_SIZE];
+	uint8_t count = Session_SplitLine(session, commands, SESSION_BATCH_SIZE);
 	
-	uint8_t str[10];
+	//one command or line with error, every write is checked immediately
+	if (count == 1)
+	{
+		Calibrator_HandleCommand(session, commands[0]);
+		return;
+	}
 	
-	//read line manually with timeout in case user did not send '\n' at the end of string
-	while (1)
+	Calibrator_BeginBatch();
+	for (uint8_t i = 0; i < count; i++)
 	{
-		while (UART_AvailableBytes(UART_handle) > 0)
+		//answer of query and *OPC is sent only after writes of previous commands are checked
+		if ((strchr(commands[i], '?') != NULL) || Utils_CheckForSubstring(commands[i], "*OPC"))
 		{
-			c = UART_ReadByte(UART_handle);
-			if ((c >= 'a') && (c <= 'z')) {c -= 32;}		//convert lowercase letters to capital letters
-			command[i] = c;
-			i++;
-			if ((c == '\n') || (c == '\r')) {command[i-1] = '\0'; end = 1; break;}		//finish string, remove '\n', break inner loop
+			Calibrator_CommitBatch(session, commands);
+			Calibrator_BeginBatch();
 		}
-		if (end == 1) {break;}		//line was received, break outer loop
-		delay_ms(10);
-		time_counter++;
-		if (time_counter > 100)		//timeout
-		{
-			error = ERROR_USER_INPUT;
-			return;
-		}	
+		
+		//dropped set-point changes nothing, state of modules is the same for next command
+		if (((i + 1) < count) && (Calibrator_IsSetPointSuperseded(session, commands[i], commands[i + 1]) == 1)) {continue;}
+		
+		session->error = NO_ERROR;
+		Module_SetTransactionTag(i);
+		Calibrator_HandleCommand(session, commands[i]);
 	}
+	
+	Calibrator_CommitBatch(session, commands);
 }
 
 
-void Calibrator_HandleRemoteControl(UART *UART_handle)
+void Calibrator_BeginBatch(void)
 {
-	//1. read command
+	//desired values and state of modules are kept until writes of batch are checked
+	batch_CLVB_voltage = CLVB_voltage;
+	batch_CLVB_frequency = CLVB_frequency;
+	batch_CCB_current = CCB_current;
+	batch_sync_armed = sync_armed;
+	CLVB_SaveState();
+	CCB_SaveState();
+	
+	Module_BeginTransaction();
+}
+
+
+void Calibrator_CommitBatch(Session *session, uint8_t **commands)
+{
+	//failed write is reported with command which made it, values set by batch are returned to values before batch
+	uint8_t failed = 0;
+	
+	session->error = Module_CommitTransaction(&failed);
+	if (session->error == NO_ERROR) {return;}
+	
+	CLVB_voltage = batch_CLVB_voltage;
+	CLVB_frequency = batch_CLVB_frequency;
+	CCB_current = batch_CCB_current;
+	CLVB_RestoreState();
+	CCB_RestoreState();
+	GetStateCLVB();
+	GetStateCCB();
+	Calibrator_SetSyncArmed(batch_sync_armed);		//trigger mode of modules is restored too
+	
+	Calibrator_ReportError(session, commands[failed]);
+}
+
+
+uint8_t Calibrator_IsSetPointSuperseded(Session *session, uint8_t *command, uint8_t *next_command)
+{
+	//set-points without other effect, range, mode and output commands are always executed
+	//set-point is dropped only if both set-points are valid, so no error is lost and writes keep order of line
+	static const char *headers[] = {"VOLT ", "VOLT:FREQ ", "CURR "};
+	
+	for (uint8_t i = 0; i < (sizeof(headers) / sizeof(headers[0])); i++)
+	{
+		if (!Utils_CheckForSubstring(command, (uint8_t *) headers[i]) || !Utils_CheckForSubstring(next_command, (uint8_t *) headers[i])) {continue;}
+		
+		return ((Calibrator_IsSetPointValid(session, command, i) == 1) && (Calibrator_IsSetPointValid(session, next_command, i) == 1)) ? 1 : 0;
+	}
+	
+	return 0;
+}
+
+
+uint8_t Calibrator_IsSetPointValid(Session *session, uint8_t *command, uint8_t target)
+{
+	//set-point does not fail before communication with module (lock, module, number, range, frequency of AC mode)
+	static const char *set_points[] = {"VOLT %lf", "VOLT:FREQ %lf", "CURR %lf"};
+	double value;
+	
+	if (Session_IsAllowed(session, command) == 0) {return 0;}
+	if (sscanf(command, set_points[target], &value) != 1) {return 0;}
+	
+	if (target == 0)
+	{
+		if (session->module_selected != MODULE_CLVB) {return 0;}
+		if ((CLVB_state_main.mode == CLVB_MODE_AC) && (CLVB_CheckFrequency(CLVB_frequency) != NO_ERROR)) {return 0;}
+		return (CLVB_CheckVoltage(value) == NO_ERROR) ? 1 : 0;
+	}
+	else if (target == 1)
+	{
+		if (session->module_selected != MODULE_CLVB) {return 0;}
+		return (CLVB_CheckFrequency(value) == NO_ERROR) ? 1 : 0;
+	}
+	else
+	{
+		if (session->module_selected != MODULE_CCB) {return 0;}
+		return (CCB_CheckCurrent(value) == NO_ERROR) ? 1 : 0;
+	}
+}
+
+
+void Calibrator_HandleCommand(Session *session, uint8_t *command)
+{
+	//1. check if session can execute command (SYST:LOCK)
 	//2. check if command starts with FUNC, VOLT or CURR
 	//3. execute command
 	//4. if error occured, print error message
 	
-	error = NO_ERROR;
-	uint8_t command[50];
+	uint8_t CLVB_relays = (CLVB_state_main.range << 1) | CLVB_state_main.output_state;		//relays before command
+	uint8_t CCB_relays = (CCB_state_main.range << 1) | CCB_state_main.output_state;
 	
-	if (UART_AvailableBytes(UART_handle) > 0)
-	{
-		Calibrator_ReadCommand(UART_handle, command);		//read one command from USB/Ethernet RX buffer
-	}
+	PROFILER_START(PROFILER_COMMAND);
+	TRACE_START();
 	
 	//if command was received without error, handle it
-	if (error == NO_ERROR)
+	if (session->error == NO_ERROR)
 	{
+		PROFILER_START(PROFILER_DISPATCH);
+		
 		//if command is not empty string
 		if (strlen(command) > 0)
 		{
+			//other session owns outputs
+			if (Session_IsAllowed(session, command) == 0)
+			{
+				session->error = ERROR_LOCKED;
+			}
 			//switching modules
-			if (Utils_CheckForSubstring(command, "FUNC"))
+			else if (Utils_CheckForSubstring(command, "FUNC"))
 			{
-				Calibrator_HandleCommandFUNC(UART_handle, command);
+				Calibrator_HandleCommandFUNC(session, command);
 			}
 			//voltage control
 			else if (Utils_CheckForSubstring(command, "VOLT"))
 			{
-				Calibrator_HandleCommandVOLT(UART_handle, command);
+				Calibrator_HandleCommandVOLT(session, command);
 			}
 			//current control
 			else if (Utils_CheckForSubstring(command, "CURR"))
 			{
-				Calibrator_HandleCommandCURR(UART_handle, command);
+				Calibrator_HandleCommandCURR(session, command);
+			}
+			//hardware trigger
+			else if (Utils_CheckForSubstring(command, "TRIG"))
+			{
+				Calibrator_HandleCommandTRIG(session, command);
+			}
+			//synchronized update of CLVB and CCB
+			else if (Utils_CheckForSubstring(command, "SYNC"))
+			{
+				Calibrator_HandleCommandSYNC(session, command);
+			}
+			//software trigger
+			else if (Utils_CheckForSubstring(command, "*TRG"))
+			{
+				Trigger_Software();
+			}
+			//common commands (event status, operation complete)
+			else if (command[0] == '*')
+			{
+				Calibrator_HandleCommandCommon(session, command);
+			}
+			//status of operations and notifications
+			else if (Utils_CheckForSubstring(command, "STAT"))
+			{
+				Calibrator_HandleCommandSTAT(session, command);
+			}
+			//system commands (profiling)
+			else if (Utils_CheckForSubstring(command, "SYST"))
+			{
+				Calibrator_HandleCommandSYST(session, command);
 			}
 			//any other "command"
 			else
 			{
-				error = ERROR_UNKNOWN_COMMAND;
+				session->error = ERROR_UNKNOWN_COMMAND;
 			}
 		}
+		
+		PROFILER_STOP(PROFILER_DISPATCH);
+	}
+	
+	//events of command for status subsystem (range change, output ON/OFF, autorange, failed module)
+	if (((CLVB_state_main.range << 1) | CLVB_state_main.output_state) != CLVB_relays) {Status_StartSettling(STATUS_CLVB);}
+	if (((CCB_state_main.range << 1) | CCB_state_main.output_state) != CCB_relays) {Status_StartSettling(STATUS_CCB);}
+	
+	Calibrator_ReportError(session, command);
+	
+	TRACE_STOP(session->UART_handle, command, session->error);
+	PROFILER_STOP(PROFILER_COMMAND);
+}
+
+
+void Calibrator_ReportError(Session *session, uint8_t *command)
+{
+	//failed module for status subsystem
+	if ((session->error == ERROR_COMMUNICATION) || (session->error == ERROR_WRONG_MODULE))
+	{
+		link_errors[(session->module_selected == MODULE_CCB) ? STATUS_CCB : STATUS_CLVB]++;
+		Status_Post(0, STATUS_EVENT_FAULT, (session->module_selected == MODULE_CCB) ? "CURR" : "VOLT");
 	}
 	
-	//print error messages if necessary
-	if (error == ERROR_USER_INPUT) {UART_SendString(UART_handle, "ERROR: Wrong input.\n\r");}
-	else if (error == ERROR_UNKNOWN_COMMAND) {UART_SendString(UART_handle, "ERROR: Unknown command.\n\r");}
-	else if (error == ERROR_COMMUNICATION) {UART_SendString(UART_handle, "ERROR: Unsuccessful communication with module (internal problem).\n\r");}
-	else if (error == ERROR_WRONG_MODULE) {UART_SendString(UART_handle, "ERROR: Wrong module is connected to UART line (internal problem).\n\r");}
-	else if (error == ERROR_VOLT_NOT_SELECTED) {UART_SendString(UART_handle, "ERROR: Voltage module is not selected.\n\r");}
-	else if (error == ERROR_CURR_NOT_SELECTED) {UART_SendString(UART_handle, "ERROR: Current module is not selected.\n\r");}
-	else if (error == ERROR_VOLT_RANGE) {UART_SendString(UART_handle, "ERROR: Voltage is out of range.\n\r");}
-	else if (error == ERROR_CURR_RANGE) {UART_SendString(UART_handle, "ERROR: Current is out of range.\n\r");}
-	else if (error == ERROR_FREQ_RANGE) {UART_SendString(UART_handle, "ERROR: Frequency is out of range.\n\r");}
-	else if (error == ERROR_NONEXISTENT_RANGE) {UART_SendString(UART_handle, "ERROR: Requested range does not exist.\n\r");}
+	//every error is saved into error queue of session (SYST:ERR?)
+	if (session->error != NO_ERROR) {Session_PushError(session, command);}
+	
+	//print error messages if necessary (verbose mode, SYST:ERR:VERB OFF leaves errors only in queue)
+	if (session->verbose == 1)
+	{
+		if (session->error == ERROR_USER_INPUT) {UART_SendString(session->UART_handle, "ERROR: Wrong input.\n\r");}
+		else if (session->error == ERROR_UNKNOWN_COMMAND) {UART_SendString(session->UART_handle, "ERROR: Unknown command.\n\r");}
+		else if (session->error == ERROR_COMMUNICATION) {UART_SendString(session->UART_handle, "ERROR: Unsuccessful communication with module (internal problem).\n\r");}
+		else if (session->error == ERROR_WRONG_MODULE) {UART_SendString(session->UART_handle, "ERROR: Wrong module is connected to UART line (internal problem).\n\r");}
+		else if (session->error == ERROR_VOLT_NOT_SELECTED) {UART_SendString(session->UART_handle, "ERROR: Voltage module is not selected.\n\r");}
+		else if (session->error == ERROR_CURR_NOT_SELECTED) {UART_SendString(session->UART_handle, "ERROR: Current module is not selected.\n\r");}
+		else if (session->error == ERROR_VOLT_RANGE) {UART_SendString(session->UART_handle, "ERROR: Voltage is out of range.\n\r");}
+		else if (session->error == ERROR_CURR_RANGE) {UART_SendString(session->UART_handle, "ERROR: Current is out of range.\n\r");}
+		else if (session->error == ERROR_FREQ_RANGE) {UART_SendString(session->UART_handle, "ERROR: Frequency is out of range.\n\r");}
+		else if (session->error == ERROR_NONEXISTENT_RANGE) {UART_SendString(session->UART_handle, "ERROR: Requested range does not exist.\n\r");}
+		else if (session->error == ERROR_MODULE_NOT_SELECTED) {UART_SendString(session->UART_handle, "ERROR: No module is selected.\n\r");}
+		else if (session->error == ERROR_SYNC_NOT_ARMED) {UART_SendString(session->UART_handle, "ERROR: Modules are not armed.\n\r");}
+		else if (session->error == ERROR_LOCKED) {UART_SendString(session->UART_handle, "ERROR: Calibrator is locked by other session.\n\r");}
+	}
 }
 
 
-void Calibrator_HandleCommandFUNC(UART *UART_handle, uint8_t *command)
+void Calibrator_HandleCommandFUNC(Session *session, uint8_t *command)
 {
 	//================================================
 	if (Utils_CheckForSubstring(command, "FUNC VOLT"))				//switch to CLVB module
 	{
 		//CCB_TurnOFFModule();
-		module_selected = MODULE_CLVB;
+		session->module_selected = MODULE_CLVB;
 	}
 	//=====================================================
 	else if (Utils_CheckForSubstring(command, "FUNC CURR"))		//switch to CBB module
 	{
 		//CLVB_TurnOFFModule();
-		module_selected = MODULE_CCB;
+		session->module_selected = MODULE_CCB;
 	}
 	//=================================================
 	else if (Utils_CheckForSubstring(command, "FUNC?"))				//respond with current module name
 	{
-		if (module_selected == MODULE_NONE) {UART_SendString(UART_handle, "NONE\n\r");}
-		else if (module_selected == MODULE_CLVB) {UART_SendString(UART_handle, "VOLT\n\r");}
-		else if (module_selected == MODULE_CCB) {UART_SendString(UART_handle, "CURR\n\r");}
+		if (session->module_selected == MODULE_NONE) {UART_SendString(session->UART_handle, "NONE\n\r");}
+		else if (session->module_selected == MODULE_CLVB) {UART_SendString(session->UART_handle, "VOLT\n\r");}
+		else if (session->module_selected == MODULE_CCB) {UART_SendString(session->UART_handle, "CURR\n\r");}
 	}
 	else
 	{
-		error = ERROR_USER_INPUT;
+		session->error = ERROR_USER_INPUT;
 	}
 }
 
 
-void Calibrator_HandleCommandVOLT(UART *UART_handle, uint8_t *command)
+void Calibrator_HandleCommandVOLT(Session *session, uint8_t *command)
 {
 	//if voltage module is selected
-	if (module_selected == MODULE_CLVB)
+	if (session->module_selected == MODULE_CLVB)
 	{
 		//============================================
 		if (Utils_CheckForSubstring(command, "VOLT "))									//read number and set voltage (check ranges etc.)
 		{
-			if (sscanf(command, "VOLT %lf", &CLVB_voltage) != 1) {error = ERROR_USER_INPUT;}	//function should return number of read numbers (1)
+			if (sscanf(command, "VOLT %lf", &CLVB_voltage) != 1) {session->error = ERROR_USER_INPUT;}	//function should return number of read numbers (1)
 			else
 			{
-				if (CLVB_state_main.mode == CLVB_MODE_DC) {error = CLVB_SetVoltageDC(CLVB_voltage);}		//DC mode
-				else {error = CLVB_SetVoltageAC(CLVB_voltage, CLVB_frequency);}													//AC mode
+				if (CLVB_state_main.mode == CLVB_MODE_DC) {session->error = CLVB_SetVoltageDC(CLVB_voltage);}		//DC mode
+				else {session->error = CLVB_SetVoltageAC(CLVB_voltage, CLVB_frequency);}													//AC mode
 			}
 		}
 		//=================================================
 		else if (Utils_CheckForSubstring(command, "VOLT?"))									//send string with selected voltage
 		{
-			if (CLVB_state_main.range == 1) {sprintf(string, "%.7f V\n\r", CLVB_state_main.voltage);}
-			else if (CLVB_state_main.range == 2) {sprintf(string, "%.6f V\n\r", CLVB_state_main.voltage);}
-			else if (CLVB_state_main.range == 3) {sprintf(string, "%.5f V\n\r", CLVB_state_main.voltage);}
-			UART_SendString(UART_handle, string);
+			if (CLVB_state_main.range == 1) {sprintf(session->response, "%.7f V\n\r", CLVB_state_main.voltage);}
+			else if (CLVB_state_main.range == 2) {sprintf(session->response, "%.6f V\n\r", CLVB_state_main.voltage);}
+			else if (CLVB_state_main.range == 3) {sprintf(session->response, "%.5f V\n\r", CLVB_state_main.voltage);}
+			UART_SendString(session->UART_handle, session->response);
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:FREQ "))						//read number and set voltage (check ranges etc.)
 		{
-			if (sscanf(command, "VOLT:FREQ %lf", &CLVB_frequency) != 1) {error = ERROR_USER_INPUT;}			//function should return number of read numbers (1)
-			else {error = CLVB_SetFrequency(CLVB_frequency);}
+			if (sscanf(command, "VOLT:FREQ %lf", &CLVB_frequency) != 1) {session->error = ERROR_USER_INPUT;}			//function should return number of read numbers (1)
+			else {session->error = CLVB_SetFrequency(CLVB_frequency);}
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:FREQ?"))						//read number and set voltage (check ranges etc.)
 		{
-			sprintf(string, "%.7f Hz\n\r", CLVB_state_main.frequency);
-			UART_SendString(UART_handle, string);
+			sprintf(session->response, "%.7f Hz\n\r", CLVB_state_main.frequency);
+			UART_SendString(session->UART_handle, session->response);
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:RANG "))			//read number and range
 		{
-			uint8_t range = 0;
-			if (sscanf(command, "VOLT:RANG %d", &range) != 1) {error = ERROR_USER_INPUT;}			//function should return number of read numbers (1)
-			else {error = CLVB_SetRange(range);}
+			int range = 0;		//%d needs int, range 257 must not become 1
+			if (sscanf(command, "VOLT:RANG %d", &range) != 1) {session->error = ERROR_USER_INPUT;}			//function should return number of read numbers (1)
+			else if ((range < 1) || (range > 3)) {session->error = ERROR_NONEXISTENT_RANGE;}
+			else {session->error = CLVB_SetRange(range);}
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:RANG?"))						//send string with voltage range
 		{
-			sprintf(string, "%d\n\r", CLVB_state_main.range);
-			UART_SendString(UART_handle, string);
+			sprintf(session->response, "%d\n\r", CLVB_state_main.range);
+			UART_SendString(session->UART_handle, session->response);
 		}
 		//=============================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:RANG:AUTO ON"))			//set voltage autorange to ON
@@ -339,44 +569,44 @@ void Calibrator_HandleCommandVOLT(UART *UART_handle, uint8_t *command)
 		//===========================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:RANG:AUTO?"))			//send string with voltage range
 		{
-			if (CLVB_state_main.autorange_state == CLVB_AUTORANGE_ON) {UART_SendString(UART_handle, "Autorange is ON.\n\r");}
-			else {UART_SendString(UART_handle, "Autorange is OFF.\n\r");}
+			if (CLVB_state_main.autorange_state == CLVB_AUTORANGE_ON) {UART_SendString(session->UART_handle, "Autorange is ON.\n\r");}
+			else {UART_SendString(session->UART_handle, "Autorange is OFF.\n\r");}
 		}
 		//========================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:MODE DC"))					//set voltage mode to DC
 		{
-			error = CLVB_SetVoltageDC(CLVB_state_main.voltage);
+			session->error = CLVB_SetVoltageDC(CLVB_state_main.voltage);
 		}
 		//========================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:MODE AC"))					//set voltage mode to AC
 		{
-			error = CLVB_SetVoltageAC(CLVB_state_main.voltage, CLVB_state_main.frequency);
+			session->error = CLVB_SetVoltageAC(CLVB_state_main.voltage, CLVB_state_main.frequency);
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:MODE?"))						//send string with selected voltage mode
 		{
-			if (CLVB_state_main.mode == CLVB_MODE_DC) {UART_SendString(UART_handle, "DC mode.\n\r");}
-			else {UART_SendString(UART_handle, "AC mode.\n\r");}
+			if (CLVB_state_main.mode == CLVB_MODE_DC) {UART_SendString(session->UART_handle, "DC mode.\n\r");}
+			else {UART_SendString(session->UART_handle, "AC mode.\n\r");}
 		}
 		//========================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:OUTP ON"))					//turn ON voltage output
 		{
-			error = CLVB_OutputON();
+			session->error = CLVB_OutputON();
 		}
 		//=========================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:OUTP OFF"))					//turn OFF voltage output
 		{
-			error = CLVB_OutputOFF();
+			session->error = CLVB_OutputOFF();
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "VOLT:OUTP?"))						//send string with information if output is ON or OFF
 		{
-			if (CLVB_state_main.output_state == CLVB_OUTPUT_ON) {UART_SendString(UART_handle, "Output ON.\n\r");}
-			else {UART_SendString(UART_handle, "Output OFF.\n\r");}
+			if (CLVB_state_main.output_state == CLVB_OUTPUT_ON) {UART_SendString(session->UART_handle, "Output ON.\n\r");}
+			else {UART_SendString(session->UART_handle, "Output OFF.\n\r");}
 		}
 		else
 		{
-			error = ERROR_UNKNOWN_COMMAND;
+			session->error = ERROR_UNKNOWN_COMMAND;
 		}
 			
 		GetStateCLVB();		//update everything
@@ -385,43 +615,44 @@ void Calibrator_HandleCommandVOLT(UART *UART_handle, uint8_t *command)
 	else
 	{
 		//UART_SendString(UART_handle, "ERROR: Voltage module is not selected.\n\r");
-		error = ERROR_VOLT_NOT_SELECTED;
+		session->error = ERROR_VOLT_NOT_SELECTED;
 	}
 }
 
 
 
-void Calibrator_HandleCommandCURR(UART *UART_handle, uint8_t *command)
+void Calibrator_HandleCommandCURR(Session *session, uint8_t *command)
 {
 	//if current module is selected
-	if (module_selected == MODULE_CCB)
+	if (session->module_selected == MODULE_CCB)
 	{
 		//============================================
 		if (Utils_CheckForSubstring(command, "CURR "))									//read number and set current (check ranges etc.)
 		{
-			if (sscanf(command, "CURR %lf", &CCB_current) != 1) {error = ERROR_USER_INPUT;}	//function should return number of read numbers (1)
-			else {error = CCB_SetCurrent(CCB_current);}
+			if (sscanf(command, "CURR %lf", &CCB_current) != 1) {session->error = ERROR_USER_INPUT;}	//function should return number of read numbers (1)
+			else {session->error = CCB_SetCurrent(CCB_current);}
 		}
 		//=================================================
 		else if (Utils_CheckForSubstring(command, "CURR?"))									//send string with selected voltage
 		{
-			if (CLVB_state_main.range == 1) {sprintf(string, "%.7f V\n\r", CCB_state_main.current);}
-			else if (CLVB_state_main.range == 2) {sprintf(string, "%.6f V\n\r", CCB_state_main.current);}
-			else if (CLVB_state_main.range == 3) {sprintf(string, "%.5f V\n\r", CCB_state_main.current);}
-			UART_SendString(UART_handle, string);
+			if (CLVB_state_main.range == 1) {sprintf(session->response, "%.7f V\n\r", CCB_state_main.current);}
+			else if (CLVB_state_main.range == 2) {sprintf(session->response, "%.6f V\n\r", CCB_state_main.current);}
+			else if (CLVB_state_main.range == 3) {sprintf(session->response, "%.5f V\n\r", CCB_state_main.current);}
+			UART_SendString(session->UART_handle, session->response);
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "CURR:RANG "))			//read number and range
 		{
-			uint8_t range = 0;
-			if (sscanf(command, "CURR:RANG %d", &range) != 1) {error = ERROR_USER_INPUT;}			//function should return number of read numbers (1)
-			else {error = CCB_SetRange(range);}
+			int range = 0;
+			if (sscanf(command, "CURR:RANG %d", &range) != 1) {session->error = ERROR_USER_INPUT;}			//function should return number of read numbers (1)
+			else if ((range < 1) || (range > 3)) {session->error = ERROR_NONEXISTENT_RANGE;}
+			else {session->error = CCB_SetRange(range);}
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "CURR:RANG?"))						//send string with voltage range
 		{
-			sprintf(string, "%d\n\r", CCB_state_main.range);
-			UART_SendString(UART_handle, string);
+			sprintf(session->response, "%d\n\r", CCB_state_main.range);
+			UART_SendString(session->UART_handle, session->response);
 		}
 		//=============================================================
 		else if (Utils_CheckForSubstring(command, "CURR:RANG:AUTO ON"))			//set voltage autorange to ON
@@ -436,28 +667,28 @@ void Calibrator_HandleCommandCURR(UART *UART_handle, uint8_t *command)
 		//===========================================================
 		else if (Utils_CheckForSubstring(command, "CURR:RANG:AUTO?"))			//send string with voltage range
 		{
-			if (CLVB_state_main.autorange_state == CCB_AUTORANGE_ON) {UART_SendString(UART_handle, "Autorange is ON.\n\r");}
-			else {UART_SendString(UART_handle, "Autorange is OFF.\n\r");}
+			if (CLVB_state_main.autorange_state == CCB_AUTORANGE_ON) {UART_SendString(session->UART_handle, "Autorange is ON.\n\r");}
+			else {UART_SendString(session->UART_handle, "Autorange is OFF.\n\r");}
 		}
 		//========================================================
 		else if (Utils_CheckForSubstring(command, "CURR:OUTP ON"))					//turn ON voltage output
 		{
-			error = CCB_OutputON();
+			session->error = CCB_OutputON();
 		}
 		//=========================================================
 		else if (Utils_CheckForSubstring(command, "CURR:OUTP OFF"))					//turn OFF voltage output
 		{
-			error = CCB_OutputOFF();
+			session->error = CCB_OutputOFF();
 		}
 		//======================================================
 		else if (Utils_CheckForSubstring(command, "CURR:OUTP?"))						//send string with information if output is ON or OFF
 		{
-			if (CCB_state_main.output_state == CCB_OUTPUT_ON) {UART_SendString(UART_handle, "Output ON.\n\r");}
-			else {UART_SendString(UART_handle, "Output OFF.\n\r");}
+			if (CCB_state_main.output_state == CCB_OUTPUT_ON) {UART_SendString(session->UART_handle, "Output ON.\n\r");}
+			else {UART_SendString(session->UART_handle, "Output OFF.\n\r");}
 		}
 		else
 		{
-			error = ERROR_UNKNOWN_COMMAND;
+			session->error = ERROR_UNKNOWN_COMMAND;
 		}
 			
 		GetStateCCB();		//update everything
@@ -466,13 +697,430 @@ void Calibrator_HandleCommandCURR(UART *UART_handle, uint8_t *command)
 	else
 	{
 		//UART_SendString(UART_handle, "ERROR: Current module is not selected.\n\r");
-		error = ERROR_CURR_NOT_SELECTED;
+		session->error = ERROR_CURR_NOT_SELECTED;
+	}
+}
+
+
+void Calibrator_HandleCommandTRIG(Session *session, uint8_t *command)
+{
+	//=============================================================
+	if (Utils_CheckForSubstring(command, "TRIG ON"))							//new values of selected module are applied on trigger edge
+	{
+		if (session->module_selected == MODULE_CLVB) {session->error = CLVB_TriggerON();}
+		else if (session->module_selected == MODULE_CCB) {session->error = CCB_TriggerON();}
+		else {session->error = ERROR_MODULE_NOT_SELECTED;}
+		
+		if (session->error == NO_ERROR)
+		{
+			trigger_module = session->module_selected;		//list is loaded into this module after every trigger
+			Trigger_ListRestart();
+			session->error = Calibrator_LoadNextTriggerValue();		//first value from list waits for first trigger
+			Trigger_Enable();
+		}
+	}
+	//==============================================================
+	else if (Utils_CheckForSubstring(command, "TRIG OFF"))				//new values are applied immediately
+	{
+		Trigger_Disable();
+		if (session->module_selected == MODULE_CLVB) {session->error = CLVB_TriggerOFF();}
+		else if (session->module_selected == MODULE_CCB) {session->error = CCB_TriggerOFF();}
+		else {session->error = ERROR_MODULE_NOT_SELECTED;}
+		if (session->error != ERROR_MODULE_NOT_SELECTED) {Calibrator_SetSyncArmed(0);}		//SYNC needs trigger mode of both modules
+	}
+	//=========================================================
+	else if (Utils_CheckForSubstring(command, "TRIG?"))						//send string with trigger state
+	{
+		if (((session->module_selected == MODULE_CLVB) && (CLVB_state_main.trigger_state == CLVB_TRIGGER_ON)) ||
+				((session->module_selected == MODULE_CCB) && (CCB_state_main.trigger_state == CCB_TRIGGER_ON)))
+		{
+			UART_SendString(session->UART_handle, "Trigger is ON.\n\r");
+		}
+		else {UART_SendString(session->UART_handle, "Trigger is OFF.\n\r");}
+	}
+	//==============================================================
+	else if (Utils_CheckForSubstring(command, "TRIG:COUN?"))			//send number of triggers since TRIG ON
+	{
+		sprintf(session->response, "%lu\n\r", (unsigned long) Trigger_GetCount());
+		UART_SendString(session->UART_handle, session->response);
+	}
+	//==================================================================
+	else if (Utils_CheckForSubstring(command, "TRIG:LIST:CLR"))		//remove all values from trigger list
+	{
+		Trigger_ListClear();
+	}
+	//==============================================================
+	else if (Utils_CheckForSubstring(command, "TRIG:LIST?"))			//send string with values in trigger list
+	{
+		//values are within range of module (max. 11 characters), answer is cut if it does not fit into response anyway
+		uint8_t size = Trigger_ListGetSize();
+		uint16_t length = 0;
+		int written;
+		
+		for (uint8_t i = 0; i < size; i++)
+		{
+			written = snprintf(session->response + length, SESSION_RESPONSE_SIZE - 2 - length, (i < (size - 1)) ? "%.7f," : "%.7f", Trigger_ListGetValue(i));
+			if ((written < 0) || (written >= (SESSION_RESPONSE_SIZE - 2 - length))) {break;}
+			length += written;
+		}
+		strcpy(session->response + length, "\n\r");
+		UART_SendString(session->UART_handle, session->response);
 	}
+	//==============================================================
+	else if (Utils_CheckForSubstring(command, "TRIG:LIST ") || Utils_CheckForSubstring(command, "TRIG:LIST:APP "))	//read comma separated values into trigger list
+	{
+		//TRIG:LIST replaces list, TRIG:LIST:APP adds values at its end (longer lists than one command)
+		uint8_t append = Utils_CheckForSubstring(command, "TRIG:LIST:APP ");
+		uint8_t *position = command + strlen(append ? "TRIG:LIST:APP " : "TRIG:LIST ");
+		uint8_t size = append ? Trigger_ListGetSize() : 0;
+		uint8_t *end;
+		double value;
+		
+		Trigger_ListTruncate(size);
+		while (1)
+		{
+			value = strtod(position, (char **)&end);
+			if (end == position) {session->error = ERROR_USER_INPUT; break;}				//no number
+			
+			//value must be accepted by selected module (range or autorange), as if it was set by VOLT/CURR
+			if (session->module_selected == MODULE_CLVB) {session->error = (isfinite(value) && (CLVB_CheckVoltage(value) == NO_ERROR)) ? NO_ERROR : ERROR_VOLT_RANGE;}
+			else if (session->module_selected == MODULE_CCB) {session->error = (isfinite(value) && (CCB_CheckCurrent(value) == NO_ERROR)) ? NO_ERROR : ERROR_CURR_RANGE;}
+			else {session->error = ERROR_MODULE_NOT_SELECTED;}
+			if (session->error != NO_ERROR) {break;}
+			
+			if (Trigger_ListAdd(value) == 0) {session->error = ERROR_USER_INPUT; break;}	//list is full
+			while (*end == ' ') {end++;}
+			if (*end == '\0') {break;}																	//last value
+			if (*end != ',') {session->error = ERROR_USER_INPUT; break;}
+			position = end + 1;
+		}
+		if (session->error != NO_ERROR) {Trigger_ListTruncate(size);}			//values of wrong command are removed
+	}
+	else
+	{
+		session->error = ERROR_UNKNOWN_COMMAND;
+	}
+	
+	GetStateCLVB();
+	GetStateCCB();
+}
+
+
+void Calibrator_HandleCommandSYNC(Session *session, uint8_t *command)
+{
+	//both modules are connected to the same trigger line, one pulse updates DAC outputs of CLVB and CCB at the same time
+	//================================================================
+	if (Utils_CheckForSubstring(command, "SYNC:ARM?"))						//send string with state of synchronization
+	{
+		if (sync_armed == 1) {UART_SendString(session->UART_handle, "Armed.\n\r");}
+		else {UART_SendString(session->UART_handle, "Not armed.\n\r");}
+	}
+	//==============================================================
+	else if (Utils_CheckForSubstring(command, "SYNC:ARM"))				//new values of both modules wait for trigger
+	{
+		session->error = CLVB_TriggerON();
+		if (session->error == NO_ERROR) {session->error = CCB_TriggerON();}
+		if (session->error == NO_ERROR) {Calibrator_SetSyncArmed(1);}
+	}
+	//=================================================================
+	else if (Utils_CheckForSubstring(command, "SYNC:DISARM"))			//preloaded values are applied immediately
+	{
+		session->error = CLVB_TriggerOFF();
+		if (session->error == NO_ERROR) {session->error = CCB_TriggerOFF();}
+		Calibrator_SetSyncArmed(0);
+	}
+	//===============================================================
+	else if (Utils_CheckForSubstring(command, "SYNC:VOLT "))			//preload voltage into CLVB
+	{
+		if (sync_armed == 0) {session->error = ERROR_SYNC_NOT_ARMED;}
+		else if (sscanf(command, "SYNC:VOLT %lf", &CLVB_voltage) != 1) {session->error = ERROR_USER_INPUT;}
+		else
+		{
+			if (CLVB_state_main.mode == CLVB_MODE_DC) {session->error = CLVB_SetVoltageDC(CLVB_voltage);}
+			else {session->error = CLVB_SetVoltageAC(CLVB_voltage, CLVB_frequency);}
+		}
+	}
+	//===============================================================
+	else if (Utils_CheckForSubstring(command, "SYNC:CURR "))			//preload current into CCB
+	{
+		if (sync_armed == 0) {session->error = ERROR_SYNC_NOT_ARMED;}
+		else if (sscanf(command, "SYNC:CURR %lf", &CCB_current) != 1) {session->error = ERROR_USER_INPUT;}
+		else {session->error = CCB_SetCurrent(CCB_current);}
+	}
+	//=============================================================
+	else if (Utils_CheckForSubstring(command, "SYNC:UPD"))				//pulse on trigger line, both modules update DAC outputs
+	{
+		if (sync_armed == 0) {session->error = ERROR_SYNC_NOT_ARMED;}
+		else {Trigger_Pulse();}
+	}
+	else
+	{
+		session->error = ERROR_UNKNOWN_COMMAND;
+	}
+	
+	GetStateCLVB();
+	GetStateCCB();
+}
+
+
+void Calibrator_HandleCommandSYST(Session *session, uint8_t *command)
+{
+	//================================================================
+	if (Utils_CheckForSubstring(command, "SYST:LOCK?"))					//send owner of outputs
+	{
+		if (Session_GetLockOwner() == SESSION_USB) {UART_SendString(session->UART_handle, "USB\n\r");}
+		else if (Session_GetLockOwner() == SESSION_ETHERNET) {UART_SendString(session->UART_handle, "ETH\n\r");}
+		else {UART_SendString(session->UART_handle, "NONE\n\r");}
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:LOCK ON"))		//only this session can change outputs
+	{
+		session->error = Session_Lock(session);
+		return;
+	}
+	//=================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:LOCK OFF"))		//every session can change outputs
+	{
+		session->error = Session_Unlock(session);
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:ERR:COUN?"))	//send number of errors in queue
+	{
+		sprintf(session->response, "%u\n\r", session->error_count);
+		UART_SendString(session->UART_handle, session->response);
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:ERR:VERB?"))	//send mode of error messages
+	{
+		if (session->verbose == 1) {UART_SendString(session->UART_handle, "ON\n\r");}
+		else {UART_SendString(session->UART_handle, "OFF\n\r");}
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:ERR:VERB ON"))	//error message is sent after every failed command
+	{
+		session->verbose = 1;
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:ERR:VERB OFF"))	//errors are only in queue, no text after failed command
+	{
+		session->verbose = 0;
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:ERR?"))				//send and remove the oldest error
+	{
+		Session_SendError(session);
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:STREAM?"))		//send port of stream ("OFF", "USB" or "ETH")
+	{
+		if (Stream_GetSession() == 0) {UART_SendString(session->UART_handle, "OFF\n\r");}
+		else if (Stream_GetSession()->id == SESSION_USB) {UART_SendString(session->UART_handle, "USB\n\r");}
+		else {UART_SendString(session->UART_handle, "ETH\n\r");}
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:STREAM:PER?"))	//send period of frames in ms
+	{
+		sprintf(session->response, "%lu\n\r", (unsigned long) Stream_GetPeriod());
+		UART_SendString(session->UART_handle, session->response);
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:STREAM:PER "))	//set period of frames in ms (200 - 3600000)
+	{
+		unsigned long period;
+		
+		if ((sscanf(command, "SYST:STREAM:PER %lu", &period) != 1) || (period < STREAM_PERIOD_MIN_MS) || (period > STREAM_PERIOD_MAX_MS)) {session->error = ERROR_USER_INPUT;}
+		else {Stream_SetPeriod(period);}
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:STREAM ON"))		//send frames to port of this session
+	{
+		Stream_Start(session);
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:STREAM USB"))	//send frames to USB
+	{
+		Stream_Start(&sessions[SESSION_USB]);
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:STREAM ETH"))	//send frames to Ethernet
+	{
+		Stream_Start(&sessions[SESSION_ETHERNET]);
+		return;
+	}
+	//=================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:STREAM OFF"))	//stop frames
+	{
+		Stream_Stop();
+		return;
+	}
+	
+	//profiling and trace are not compiled in production build, their commands are unknown there
+#ifdef CALIBRATOR_PROFILING
+	//================================================================
+	if (Utils_CheckForSubstring(command, "SYST:PROF?"))					//send statistics of command handling stages
+	{
+		Profiler_SendReport(session->UART_handle);
+		return;
+	}
+	//==================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:PROF:RES"))		//clear statistics
+	{
+		Profiler_Reset();
+		return;
+	}
+#endif
+#ifdef CALIBRATOR_TRACE
+	//================================================================
+	if (Utils_CheckForSubstring(command, "SYST:TRAC?"))					//send recorded commands from the oldest one
+	{
+		Trace_SendReport(session->UART_handle);
+		return;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:TRAC ON"))		//start recording of commands
+	{
+		Trace_Enable(1);
+		return;
+	}
+	//=================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:TRAC OFF"))		//stop recording, trace is kept
+	{
+		Trace_Enable(0);
+		return;
+	}
+	//=================================================================
+	else if (Utils_CheckForSubstring(command, "SYST:TRAC:CLR"))		//remove all recorded commands
+	{
+		Trace_Clear();
+		return;
+	}
+#endif
+	
+	session->error = ERROR_UNKNOWN_COMMAND;
+}
+
+
+void Calibrator_HandleCommandSTAT(Session *session, uint8_t *command)
+{
+	//events are latched in event register of session, enabled events are sent immediately as "!<event> <module>"
+	//================================================================
+	if (Utils_CheckForSubstring(command, "STAT:OPER:ENAB?"))			//send mask of enabled notifications
+	{
+		sprintf(session->response, "%u\n\r", session->event_enable);
+		UART_SendString(session->UART_handle, session->response);
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "STAT:OPER:ENAB "))	//enable notifications (1 OPC, 2 SETTLED, 4 FAULT, 8 LIST)
+	{
+		unsigned int mask;
+		
+		if ((sscanf(command, "STAT:OPER:ENAB %u", &mask) != 1) || (mask > 0xFF)) {session->error = ERROR_USER_INPUT;}
+		else {session->event_enable = mask;}
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "STAT:ALL?"))					//send state of all modules in one line
+	{
+		UART_SendString(session->UART_handle, Calibrator_GetStateLine());
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "STAT:OPER:COND?"))	//send events which are in progress (2 = relays are settling)
+	{
+		sprintf(session->response, "%u\n\r", Status_GetCondition());
+		UART_SendString(session->UART_handle, session->response);
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "STAT:OPER?"))				//send and clear events since last reading
+	{
+		sprintf(session->response, "%u\n\r", session->event_register);
+		UART_SendString(session->UART_handle, session->response);
+		session->event_register = 0;
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "STAT:PRES"))				//disable all notifications
+	{
+		session->event_enable = 0;
+	}
+	else
+	{
+		session->error = ERROR_UNKNOWN_COMMAND;
+	}
+}
+
+
+void Calibrator_HandleCommandCommon(Session *session, uint8_t *command)
+{
+	//commands are executed one by one, command is complete when the next one is read
+	//================================================================
+	if (Utils_CheckForSubstring(command, "*ESR?"))								//send and clear standard event status register
+	{
+		sprintf(session->response, "%u\n\r", Session_ReadEventStatus(session));
+		UART_SendString(session->UART_handle, session->response);
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "*OPC?"))					//all previous commands are complete
+	{
+		UART_SendString(session->UART_handle, "1\n\r");
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "*OPC"))						//set OPC bit of event status register
+	{
+		session->esr |= SESSION_ESR_OPC;
+		Status_Post(session, STATUS_EVENT_OPC, "");
+	}
+	//================================================================
+	else if (Utils_CheckForSubstring(command, "*CLS"))						//clear error queue and event status register
+	{
+		Session_ClearStatus(session);
+	}
+	else
+	{
+		session->error = ERROR_UNKNOWN_COMMAND;
+	}
+}
+
+
+uint8_t Calibrator_LoadNextTriggerValue(void)
+{
+	//new value is written into module as usual, module holds it until next trigger edge
+	//range change (register K) is not triggered, list should contain values from one range
+	uint8_t load_error = NO_ERROR;
+	
+	if (Trigger_ListGetSize() == 0) {return NO_ERROR;}		//no list, values are set by VOLT/CURR commands
+	
+	if (trigger_module == MODULE_CLVB)
+	{
+		CLVB_voltage = Trigger_ListNext();
+		if (CLVB_state_main.mode == CLVB_MODE_DC) {load_error = CLVB_SetVoltageDC(CLVB_voltage);}
+		else {load_error = CLVB_SetVoltageAC(CLVB_voltage, CLVB_frequency);}
+		GetStateCLVB();
+	}
+	else if (trigger_module == MODULE_CCB)
+	{
+		CCB_current = Trigger_ListNext();
+		load_error = CCB_SetCurrent(CCB_current);
+		GetStateCCB();
+	}
+	
+	return load_error;
 }
 
 
 void GetStateCLVB(void)
-{	
+{		
+	CLVB_module_state last_state = CLVB_state_main;
+	
 	CLVB_state_main.voltage = CLVB_GetVoltage();
 	CLVB_state_main.frequency = CLVB_GetFrequency();
 	CLVB_state_main.range = CLVB_GetRange();
@@ -480,14 +1128,79 @@ void GetStateCLVB(void)
 	CLVB_state_main.output_state = CLVB_GetOutputState();
 	CLVB_state_main.autorange_state = CLVB_GetAutorangeState();
 	CLVB_state_main.dithering_state = CLVB_GetDitheringState();
+	CLVB_state_main.trigger_state = CLVB_GetTriggerState();
+	
+	//fields are compared one by one, padding bytes of structure are undefined and -0.0 is the same voltage as 0.0
+	uint8_t changed = (last_state.voltage != CLVB_state_main.voltage) || (last_state.frequency != CLVB_state_main.frequency) ||
+		(last_state.range != CLVB_state_main.range) || (last_state.mode != CLVB_state_main.mode) ||
+		(last_state.output_state != CLVB_state_main.output_state) || (last_state.autorange_state != CLVB_state_main.autorange_state) ||
+		(last_state.dithering_state != CLVB_state_main.dithering_state) || (last_state.trigger_state != CLVB_state_main.trigger_state);
+	
+	if (changed) {state_changed = 1; state_sequence++;}
 }
 
 
 void GetStateCCB(void)
 {	
+	CCB_module_state last_state = CCB_state_main;
+	
 	CCB_state_main.current = CCB_GetCurrent();
 	CCB_state_main.range = CCB_GetRange();
 	CCB_state_main.output_state = CCB_GetOutputState();
 	CCB_state_main.autorange_state = CCB_GetAutorangeState();
 	CCB_state_main.dithering_state = CCB_GetDitheringState();
+	CCB_state_main.trigger_state = CCB_GetTriggerState();
+	
+	//fields are compared one by one (see GetStateCLVB)
+	uint8_t changed = (last_state.current != CCB_state_main.current) || (last_state.range != CCB_state_main.range) ||
+		(last_state.output_state != CCB_state_main.output_state) || (last_state.autorange_state != CCB_state_main.autorange_state) ||
+		(last_state.dithering_state != CCB_state_main.dithering_state) || (last_state.trigger_state != CCB_state_main.trigger_state);
+	
+	if (changed) {state_changed = 1; state_sequence++;}
+}
+
+
+void Calibrator_SetSyncArmed(uint8_t armed)
+{
+	//SYNC,<armed> is part of state line, every change is a new state
+	if (sync_armed == armed) {return;}
+	
+	sync_armed = armed;
+	state_changed = 1;
+	state_sequence++;
+}
+
+
+uint8_t *Calibrator_GetStateLine(void)
+{
+	//fixed layout, values are in %+.7E (14 characters), flags are 0/1:
+	//<sequence>;CLVB,<voltage>,<frequency>,<range>,<DC|AC>,<output>,<autorange>,<dithering>,<trigger>;
+	//CCB,<current>,<range>,<output>,<autorange>,<dithering>,<trigger>;CVRB,NC;SYNC,<armed>
+	//CVRB is not controlled by this firmware yet (only its UART is initialized), NC = not connected
+	if (state_changed == 1)
+	{
+		sprintf(state_line, "%08lu;CLVB,%+.7E,%+.7E,%u,%s,%u,%u,%u,%u;CCB,%+.7E,%u,%u,%u,%u,%u;CVRB,NC;SYNC,%u\n\r",
+			(unsigned long) state_sequence, CLVB_state_main.voltage, CLVB_state_main.frequency, CLVB_state_main.range,
+			(CLVB_state_main.mode == CLVB_MODE_AC) ? "AC" : "DC", CLVB_state_main.output_state, CLVB_state_main.autorange_state,
+			CLVB_state_main.dithering_state, CLVB_state_main.trigger_state, CCB_state_main.current, CCB_state_main.range,
+			CCB_state_main.output_state, CCB_state_main.autorange_state, CCB_state_main.dithering_state, CCB_state_main.trigger_state,
+			sync_armed);
+		state_changed = 0;
+	}
+	
+	return state_line;
+}
+
+
+void Calibrator_SendStreamFrame(void)
+{
+	//"#<time_ms>;<state line of STAT:ALL?>;CODE,<CLVB>,<CCB>;LINK,<CLVB errors>,<CCB errors>,<dropped frames>"
+	//'#' is never first character of answer or notification, temperature of CVRB is in state line (NC until CVRB is controlled)
+	uint8_t frame[SESSION_RESPONSE_SIZE];
+	uint8_t *state = Calibrator_GetStateLine();
+	
+	sprintf(frame, "#%010lu;%.*s;CODE,%08lX,%08lX;LINK,%lu,%lu,%lu\n\r", (unsigned long) Stream_GetTime_ms(), (int) (strlen(state) - 2), state,
+		(unsigned long) CLVB_GetCode(), (unsigned long) CCB_GetCode(), (unsigned long) link_errors[STATUS_CLVB],
+		(unsigned long) link_errors[STATUS_CCB], (unsigned long) Stream_GetDropped());
+	Stream_Send(frame);
 }
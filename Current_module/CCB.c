@@ -2,9 +2,36 @@
 
 #include <avr/io.h>
 #include <util/delay.h>
+#include <avr/interrupt.h>
 #include "CCB.h"
 
 
+volatile static uint8_t relay_pulse_counter = 0;		//remaining milliseconds of relay pulse, 0 = coils released
+volatile static uint8_t relay_settle_counter = 0;		//remaining milliseconds of settling after relay pulse
+
+
+ISR (TIMER2_COMPA_vect)
+{
+	if (relay_pulse_counter > 0)
+	{
+		relay_pulse_counter--;
+		if (relay_pulse_counter == 0)
+		{
+			RELAY_1_PORT &= ~(1 << RELAY_1S) & ~(1 << RELAY_1R);	//release coils of all relays
+			RELAY_2_PORT &= ~(1 << RELAY_2S) & ~(1 << RELAY_2R);
+			RELAY_3_PORT &= ~(1 << RELAY_3S) & ~(1 << RELAY_3R);
+			RELAY_4_PORT &= ~(1 << RELAY_4S) & ~(1 << RELAY_4R);
+		}
+	}
+	else if (relay_settle_counter > 0) {relay_settle_counter--;}
+	
+	if ((relay_pulse_counter == 0) && (relay_settle_counter == 0))
+	{
+		TIMSK2 &= ~(1 << OCIE2A);								//no interrupts until next pulse
+	}
+}
+
+
 void CCB_InitRelays(void)
 {
 	DDRD |= (1 << DDD5) | (1 << DDD4);		//relay 1 control pins as output
@@ -77,6 +104,75 @@ void CCB_RelayRESET(uint8_t relay)
 }
 
 
+void CCB_InitRelayTimer(void)
+{
+	//init Timer 2 in Clear Timer on Compare Match (CTC) Mode
+	TCCR2A = 0x00;
+	TCCR2A |= (1 << WGM21);					//CTC mode
+	
+	TCCR2B = 0x00;
+	TCCR2B |= (1 << CS22) | (1 << CS20);	//set prescaler to 128
+	OCR2A = 124;							//interrupt with 1kHz frequency
+	
+	TIMSK2 = 0x00;							//interrupt is enabled only during relay pulse
+}
+
+
+void CCB_RelaysPulse(uint8_t relays_set, uint8_t relays_reset)
+{
+	relays_reset &= ~relays_set;			//relay cannot be set and reset at the same time
+	
+	TIMSK2 &= ~(1 << OCIE2A);				//no release of coils while pins are changed
+	
+	if (relays_set & 0x01) {RELAY_1_PORT |= (1 << RELAY_1S);}
+	if (relays_set & 0x02) {RELAY_2_PORT |= (1 << RELAY_2S);}
+	if (relays_set & 0x04) {RELAY_3_PORT |= (1 << RELAY_3S);}
+	if (relays_set & 0x08) {RELAY_4_PORT |= (1 << RELAY_4S);}
+	if (relays_reset & 0x01) {RELAY_1_PORT |= (1 << RELAY_1R);}
+	if (relays_reset & 0x02) {RELAY_2_PORT |= (1 << RELAY_2R);}
+	if (relays_reset & 0x04) {RELAY_3_PORT |= (1 << RELAY_3R);}
+	if (relays_reset & 0x08) {RELAY_4_PORT |= (1 << RELAY_4R);}
+	
+	relay_pulse_counter = RELAY_PULSE_MS;
+	relay_settle_counter = RELAY_SETTLE_MS;
+	TCNT2 = 0;								//first tick after full period of 1 ms
+	TIFR2 = (1 << OCF2A);					//clear pending compare match
+	TIMSK2 |= (1 << OCIE2A);				//coils are released from interrupt
+}
+
+
+uint8_t CCB_RelaysBusy(void)
+{
+	return ((relay_pulse_counter > 0) || (relay_settle_counter > 0));
+}
+
+
+void CCB_InitTrigger(void)
+{
+	ADCSRA &= ~(1 << ADEN);					//ADC off, multiplexer is used by analog comparator
+	ADCSRB |= (1 << ACME);					//negative input of comparator from ADC multiplexer
+	ADMUX = (ADMUX & 0xF0) | TRIG_ADC_CHANNEL;	//ADC7 is analog only pin, no digital input buffer to disable
+	
+	ACSR = 0x00;
+	ACSR |= (1 << ACBG);					//positive input of comparator from 1.1 V bandgap reference
+	ACSR |= (1 << ACIS1);					//interrupt on falling edge of comparator output = rising edge on ADC7
+	ACSR |= (1 << ACI);						//clear pending interrupt
+}
+
+
+void CCB_TriggerON(void)
+{
+	ACSR |= (1 << ACI);						//old edges are ignored
+	ACSR |= (1 << ACIE);
+}
+
+
+void CCB_TriggerOFF(void)
+{
+	ACSR &= ~(1 << ACIE);
+}
+
+
 void CCB_WriteDACRegister(uint8_t address, uint32_t data)
 {
 	CS_LOW();
@@ -121,6 +217,20 @@ void CCB_SetDACVoltage(uint32_t code)
 }
 
 
+void CCB_LoadDACCode(uint32_t code)
+{
+	CCB_WriteDACRegister(0x01, code);		//output keeps old voltage until LDAC pulse
+}
+
+
+void CCB_UpdateDACOutput(void)
+{
+	LDAC_LOW();
+	_delay_us(1);
+	LDAC_HIGH();
+}
+
+
 void CCB_InitLEDs(void)
 {
 	DDRC |= (1 << DDC0) | (1 << DDC1);		//OUT_LED_1 and OUT_LED_2
@@ -25,6 +25,11 @@
 #define RELAY_4S				PORTC3
 #define RELAY_4R				PORTC2
 
+#define RELAY_PULSE_MS			10		//length of pulse on set/reset coil of relay
+#define RELAY_SETTLE_MS			5		//time after pulse for settling of contacts, relays are still busy
+
+#define TRIG_ADC_CHANNEL		7		//trigger input (ADC7), all digital pins are used
+
 #define ADR_DAC_DATA			0b00000001
 #define ADR_CONFIG1				0b00000010
 #define ADR_DAC_CLEAR_DATA		0b00000011
@@ -70,6 +75,45 @@ void CCB_RelaySET(uint8_t relay);
 */
 void CCB_RelayRESET(uint8_t relay);
 
+/**
+* @brief - init Timer 2 in CTC mode with 1 ms period for timing of relay pulses, interrupt is enabled only during pulse
+* @returns - nothing
+*/
+void CCB_InitRelayTimer(void);
+
+/**
+* @brief - energize coils of all selected relays at once, coils are released from Timer 2 interrupt after RELAY_PULSE_MS, relays are busy for next RELAY_SETTLE_MS
+* @param relays_set - relays to be set, bit 0 = relay 1, bit 1 = relay 2, bit 2 = relay 3, bit 3 = relay 4
+* @param relays_reset - relays to be reset, bit 0 = relay 1, bit 1 = relay 2, bit 2 = relay 3, bit 3 = relay 4
+* @returns - nothing
+*/
+void CCB_RelaysPulse(uint8_t relays_set, uint8_t relays_reset);
+
+/**
+* @brief - check if coils of relays are energized or contacts are settling
+* @returns - 1 if relay pulse or settling is in progress, 0 if relays are ready for next pulse
+*/
+uint8_t CCB_RelaysBusy(void);
+
+/**
+* @brief - init trigger input on ADC7, rising edge is detected by analog comparator (ADC7 against internal 1.1 V bandgap reference)
+* ADC must stay disabled, its multiplexer is used by analog comparator
+* @returns - nothing
+*/
+void CCB_InitTrigger(void);
+
+/**
+* @brief - enable interrupt from trigger input (ANALOG_COMP_vect)
+* @returns - nothing
+*/
+void CCB_TriggerON(void);
+
+/**
+* @brief - disable interrupt from trigger input
+* @returns - nothing
+*/
+void CCB_TriggerOFF(void);
+
 /**
 * @brief - reset relay (default position)
 * @returns - nothing
@@ -96,6 +140,19 @@ void CCB_InitDAC(void);
 */
 void CCB_SetDACVoltage(uint32_t code);
 
+/**
+* @brief - write code to DAC data register without update of the output
+* @param code - 20-bit code for DAC
+* @returns - nothing
+*/
+void CCB_LoadDACCode(uint32_t code);
+
+/**
+* @brief - update DAC output with loaded code (LDAC pulse)
+* @returns - nothing
+*/
+void CCB_UpdateDACOutput(void);
+
 /**
 * @brief - initialize front panel LEDs
 * @returns - nothing
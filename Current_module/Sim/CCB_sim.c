@@ -0,0 +1,394 @@
+//=====================================================================
+//Test and timing harness for CCB firmware in simavr (ATmega328P, 16 MHz)
+//boots real firmware, sends register traffic to USART0 and records
+//answers, SPI frames for DAC11001B, LDAC pulses, relay coil pulses
+//and durations of interrupts (Timer0 dithering, Timer2 relays, USART RX)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "sim_interrupts.h"
+#include "avr_uart.h"
+#include "avr_spi.h"
+#include "avr_ioport.h"
+#include "avr_acomp.h"
+
+
+#define SIM_F_CPU					16000000
+#define SIM_SCRIPT_SIZE		256
+#define SIM_LINE_SIZE			64
+
+//interrupt vectors of ATmega328P (avr/iom328p.h is not available for host compiler)
+#define TIMER2_COMPA_VECT	7
+#define TIMER0_COMPA_VECT	14
+#define USART_RX_VECT			18
+#define ANALOG_COMP_VECT	23
+
+#define TRIGGER_HIGH_MV		3300			//voltage on ADC7 during trigger pulse (comparator reference is 1.1 V bandgap)
+#define TRIGGER_PULSE_US	100
+
+typedef struct
+{
+	uint32_t time_ms;
+	char line[SIM_LINE_SIZE];				//register write ("H0002"), "TRIG" = pulse on trigger input
+} Sim_command;
+
+typedef struct
+{
+	const char *name;
+	uint8_t vector;
+	uint64_t start;
+	uint32_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+} Sim_interrupt;
+
+typedef struct
+{
+	const char *name;
+	char port;
+	uint8_t pin;
+	uint64_t start;
+} Sim_coil;
+
+//default traffic: identification, range changes with code, dithering, trigger mode
+static const Sim_command sim_default_script[] = {
+	{500, "G003F"},
+	{700, "I00800000"},
+	{800, "H0001"},
+	{900, "I00C00000"},
+	{1000, "H0003"},
+	{1100, "H0000"},
+	{1200, "I00A00008"},
+	{1300, "H0010"},
+	{1500, "H0000"},
+	{1600, "H8000"},
+	{1700, "I00900000"},
+	{1750, "TRIG"},
+	{1800, "H0000"},
+	{1900, "G003F"}
+};
+
+static Sim_interrupt sim_interrupts[] = {
+	{"TIMER0_COMPA (dithering)", TIMER0_COMPA_VECT},
+	{"TIMER2_COMPA (relays)", TIMER2_COMPA_VECT},
+	{"USART_RX", USART_RX_VECT},
+	{"ANALOG_COMP (trigger)", ANALOG_COMP_VECT}
+};
+
+static Sim_coil sim_coils[] = {
+	{"K1 set", 'D', 5}, {"K1 reset", 'D', 4}, {"K2 set", 'D', 7}, {"K2 reset", 'D', 6},
+	{"K3 set", 'D', 3}, {"K3 reset", 'D', 2}, {"K4 set", 'C', 3}, {"K4 reset", 'C', 2}
+};
+
+static avr_t *avr = NULL;
+static Sim_command script[SIM_SCRIPT_SIZE];
+static uint32_t script_length = 0;
+static uint8_t verbose = 0;
+static FILE *output = NULL;
+
+static char tx_line[SIM_LINE_SIZE];
+static uint32_t tx_length = 0;
+static uint64_t request_end = 0;			//cycle of last received byte of command, 0 = no command waits for reaction
+static uint32_t spi_frame = 0;
+static uint8_t spi_bytes = 0;
+static uint32_t spi_frames = 0;
+static uint32_t ldac_pulses = 0;
+static uint32_t coil_pulses = 0;
+static uint64_t response_min = UINT64_MAX, response_max = 0, response_sum = 0;
+static uint32_t responses = 0;
+
+
+static double Sim_ToMs(uint64_t cycles)
+{
+	return (cycles * 1000.0) / SIM_F_CPU;
+}
+
+
+static void Sim_Log(const char *format, const char *text)
+{
+	fprintf(output, "%10.3f ms  ", Sim_ToMs(avr->cycle));
+	fprintf(output, format, text);
+	fputc('\n', output);
+}
+
+
+/**
+* @brief - print time since end of last command (first reaction of firmware: answer, SPI frame or relay pulse)
+* @returns - nothing
+*/
+static void Sim_LogReaction(const char *event)
+{
+	if (request_end == 0) {return;}
+	
+	uint64_t latency = avr->cycle - request_end;
+	fprintf(output, "%10.3f ms  reaction to command: %s after %.3f ms\n", Sim_ToMs(avr->cycle), event, Sim_ToMs(latency));
+	if (latency < response_min) {response_min = latency;}
+	if (latency > response_max) {response_max = latency;}
+	response_sum += latency;
+	responses++;
+	request_end = 0;
+}
+
+
+//======================================== peripherals ==========================================
+static void Sim_UARTOutput(avr_irq_t *irq, uint32_t value, void *param)
+{
+	if (tx_length == 0) {Sim_LogReaction("UART answer");}
+	
+	if ((value == '\n') || (value == '\r'))
+	{
+		if (tx_length > 0) {tx_line[tx_length] = '\0'; Sim_Log("UART TX  %s", tx_line);}
+		tx_length = 0;
+	}
+	else if (tx_length < (SIM_LINE_SIZE - 1)) {tx_line[tx_length++] = value;}
+}
+
+
+static void Sim_SPIOutput(avr_irq_t *irq, uint32_t value, void *param)
+{
+	spi_frame = (spi_frame << 8) | (value & 0xFF);
+	spi_bytes++;
+}
+
+
+//chip select of DAC11001B (PB2), frame is 32 bits: R/W, address (7 bits), data (20 bits), 4 zero bits
+static void Sim_ChipSelect(avr_irq_t *irq, uint32_t value, void *param)
+{
+	char text[80];
+	
+	if (value == 0) {spi_frame = 0; spi_bytes = 0; return;}
+	if (spi_bytes == 0) {return;}
+	
+	snprintf(text, sizeof(text), "%s address %u, data 0x%05X (%u bytes)", (spi_frame & 0x80000000) ? "read" : "write",
+		(spi_frame >> 24) & 0x7F, (spi_frame >> 4) & 0xFFFFF, spi_bytes);
+	uint8_t dithering = (sim_interrupts[0].start != 0);		//frame is sent from Timer0 interrupt, logged only with -v
+	if ((dithering == 0) && (((spi_frame >> 24) & 0x7F) == 1)) {Sim_LogReaction("SPI frame of DAC code");}
+	if (verbose || (dithering == 0)) {Sim_Log("SPI      %s", text);}
+	spi_frames++;
+}
+
+
+static void Sim_LDAC(avr_irq_t *irq, uint32_t value, void *param)
+{
+	if (value == 0)
+	{
+		ldac_pulses++;
+		if (verbose) {Sim_Log("LDAC     %s", "pulse");}
+	}
+}
+
+
+static void Sim_Coil(avr_irq_t *irq, uint32_t value, void *param)
+{
+	Sim_coil *coil = (Sim_coil *) param;
+	char text[80];
+	
+	if (value != 0)
+	{
+		coil->start = avr->cycle;
+		Sim_LogReaction("relay pulse");
+	}
+	else if (coil->start != 0)
+	{
+		snprintf(text, sizeof(text), "%s coil pulse %.3f ms", coil->name, Sim_ToMs(avr->cycle - coil->start));
+		Sim_Log("RELAY    %s", text);
+		coil->start = 0;
+		coil_pulses++;
+	}
+}
+
+
+//AVR_INT_IRQ_RUNNING is 1 from entry into interrupt vector until reti
+static void Sim_Interrupt(avr_irq_t *irq, uint32_t value, void *param)
+{
+	Sim_interrupt *interrupt = (Sim_interrupt *) param;
+	
+	if (value != 0) {interrupt->start = avr->cycle; return;}
+	if (interrupt->start == 0) {return;}
+	
+	uint64_t cycles = avr->cycle - interrupt->start;
+	if ((interrupt->count == 0) || (cycles < interrupt->min)) {interrupt->min = cycles;}
+	if (cycles > interrupt->max) {interrupt->max = cycles;}
+	interrupt->sum += cycles;
+	interrupt->count++;
+	interrupt->start = 0;
+}
+
+
+//======================================== script ==========================================
+/**
+* @brief - read script, one command per line: "<time_ms> <register write>" or "<time_ms> TRIG", '#' starts comment
+* @returns - 0 if script was read, 1 if file cannot be opened
+*/
+static uint8_t Sim_ReadScript(const char *path)
+{
+	char line[128];
+	FILE *file = fopen(path, "r");
+	
+	if (file == NULL) {fprintf(stderr, "cannot open script %s\n", path); return 1;}
+	
+	while ((fgets(line, sizeof(line), file) != NULL) && (script_length < SIM_SCRIPT_SIZE))
+	{
+		Sim_command *command = &script[script_length];
+		if ((line[0] == '#') || (sscanf(line, "%u %63s", &command->time_ms, command->line) != 2)) {continue;}
+		script_length++;
+	}
+	fclose(file);
+	
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	elf_firmware_t firmware;
+	const char *firmware_path = "ccb.elf";
+	const char *script_path = NULL;
+	const char *output_path = NULL;
+	uint32_t duration_ms = 0;
+	uint32_t baud_rate = 9600;
+	int option;
+	
+	output = stdout;
+	
+	while ((option = getopt(argc, argv, "f:s:t:b:o:v")) != -1)
+	{
+		switch (option)
+		{
+			case 'f': firmware_path = optarg; break;
+			case 's': script_path = optarg; break;
+			case 't': duration_ms = strtoul(optarg, NULL, 10); break;
+			case 'b': baud_rate = strtoul(optarg, NULL, 10); break;
+			case 'o': output_path = optarg; break;
+			case 'v': verbose = 1; break;
+			default:
+				fprintf(stderr, "usage: %s [-f firmware.elf] [-s script] [-t duration_ms] [-b baud] [-o log] [-v]\n", argv[0]);
+				return 1;
+		}
+	}
+	
+	if (script_path != NULL) {if (Sim_ReadScript(script_path) != 0) {return 1;}}
+	else
+	{
+		script_length = sizeof(sim_default_script) / sizeof(sim_default_script[0]);
+		memcpy(script, sim_default_script, sizeof(sim_default_script));
+	}
+	if (duration_ms == 0) {duration_ms = ((script_length > 0) ? script[script_length - 1].time_ms : 0) + 500;}
+	if ((output_path != NULL) && ((output = fopen(output_path, "w")) == NULL)) {fprintf(stderr, "cannot open %s\n", output_path); return 1;}
+	
+	//========================= MCU and firmware =========================
+	memset(&firmware, 0, sizeof(firmware));
+	if (elf_read_firmware(firmware_path, &firmware) != 0) {fprintf(stderr, "cannot read firmware %s\n", firmware_path); return 1;}
+	
+	avr = avr_make_mcu_by_name("atmega328p");
+	if (avr == NULL) {fprintf(stderr, "atmega328p is not supported by simavr\n"); return 1;}
+	avr_init(avr);
+	avr_load_firmware(avr, &firmware);
+	avr->frequency = SIM_F_CPU;
+	
+	//========================= connections =========================
+	uint32_t flags = 0;
+	avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+	flags &= ~AVR_UART_FLAG_STDIO;				//answers are captured here, not printed by simavr
+	avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+	avr_irq_t *uart_input = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), Sim_UARTOutput, NULL);
+	
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT), Sim_SPIOutput, NULL);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 2), Sim_ChipSelect, NULL);		//DAC_CS
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 1), Sim_LDAC, NULL);				//DAC_LDAC
+	
+	for (uint8_t i = 0; i < (sizeof(sim_coils) / sizeof(sim_coils[0])); i++)
+	{
+		avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(sim_coils[i].port), sim_coils[i].pin), Sim_Coil, &sim_coils[i]);
+	}
+	for (uint8_t i = 0; i < (sizeof(sim_interrupts) / sizeof(sim_interrupts[0])); i++)
+	{
+		avr_irq_t *irq = avr_get_interrupt_irq(avr, sim_interrupts[i].vector);
+		if (irq != NULL) {avr_irq_register_notify(irq + AVR_INT_IRQ_RUNNING, Sim_Interrupt, &sim_interrupts[i]);}
+	}
+	
+	avr_irq_t *trigger_input = avr_io_getirq(avr, AVR_IOCTL_ACOMP_GETIRQ, ACOMP_IRQ_ADC7);
+	avr_raise_irq(trigger_input, 0);
+	
+	//========================= simulation =========================
+	uint64_t end = (uint64_t) duration_ms * (SIM_F_CPU / 1000);
+	uint64_t byte_cycles = (10ULL * SIM_F_CPU) / baud_rate;		//start bit, 8 data bits, stop bit
+	uint64_t next_byte = 0;
+	uint64_t trigger_release = 0;
+	uint32_t next_command = 0;
+	char tx_queue[SIM_LINE_SIZE + 2];
+	uint32_t tx_position = 0, tx_queue_length = 0;
+	int state = cpu_Running;
+	
+	while ((avr->cycle < end) && (state != cpu_Done) && (state != cpu_Crashed))
+	{
+		//start of next command from script
+		if ((tx_position == tx_queue_length) && (next_command < script_length) && (avr->cycle >= ((uint64_t) script[next_command].time_ms * (SIM_F_CPU / 1000))))
+		{
+			Sim_Log("UART RX  %s", script[next_command].line);
+			if (strcmp(script[next_command].line, "TRIG") == 0)
+			{
+				avr_raise_irq(trigger_input, TRIGGER_HIGH_MV);
+				trigger_release = avr->cycle + ((uint64_t) TRIGGER_PULSE_US * (SIM_F_CPU / 1000000));
+			}
+			else
+			{
+				tx_queue_length = snprintf(tx_queue, sizeof(tx_queue), "%s\n\r", script[next_command].line);		//same end of line as Module_WriteToRegister
+				tx_position = 0;
+				next_byte = avr->cycle;
+			}
+			next_command++;
+		}
+	
+		//bytes are sent with timing of UART line
+		if ((tx_position < tx_queue_length) && (avr->cycle >= next_byte))
+		{
+			avr_raise_irq(uart_input, (uint8_t) tx_queue[tx_position++]);
+			next_byte += byte_cycles;
+			if (tx_position == tx_queue_length) {request_end = avr->cycle;}
+		}
+	
+		if ((trigger_release != 0) && (avr->cycle >= trigger_release))
+		{
+			avr_raise_irq(trigger_input, 0);
+			trigger_release = 0;
+		}
+	
+		state = avr_run(avr);
+	}
+	
+	//========================= summary =========================
+	double elapsed_ms = Sim_ToMs(avr->cycle);
+	
+	fprintf(output, "\nsimulated %.1f ms, state %d\n", elapsed_ms, state);
+	fprintf(output, "SPI frames %u, LDAC pulses %u, relay coil pulses %u\n", spi_frames, ldac_pulses, coil_pulses);
+	if (responses > 0)
+	{
+		fprintf(output, "reaction to command: %u, min %.3f ms, avg %.3f ms, max %.3f ms\n", responses,
+			Sim_ToMs(response_min), Sim_ToMs(response_sum / responses), Sim_ToMs(response_max));
+	}
+	fprintf(output, "%-26s %8s %8s %8s %8s %8s\n", "interrupt", "count", "min", "avg", "max", "load");
+	for (uint8_t i = 0; i < (sizeof(sim_interrupts) / sizeof(sim_interrupts[0])); i++)
+	{
+		Sim_interrupt *interrupt = &sim_interrupts[i];
+		fprintf(output, "%-26s %8u %8llu %8llu %8llu %7.3f%%\n", interrupt->name, interrupt->count,
+			(unsigned long long) interrupt->min, (unsigned long long) ((interrupt->count > 0) ? (interrupt->sum / interrupt->count) : 0),
+			(unsigned long long) interrupt->max, (interrupt->sum * 100.0) / ((avr->cycle > 0) ? avr->cycle : 1));
+	}
+	fprintf(output, "(interrupt durations in cycles at %u MHz, from vector to reti)\n", SIM_F_CPU / 1000000);
+	
+	if (output != stdout) {fclose(output);}
+	avr_terminate(avr);
+	
+	return (state == cpu_Crashed) ? 1 : 0;
+}
@@ -41,8 +41,9 @@ LOCKBITS = 0x3F;
 //  -----------------------------------------------------------------
 //  |15 |14 |13 |12 |11 |10 | 9 | 8 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 |
 //  -----------------------------------------------------------------
-//  | - |L4R|L4G|L3R|L3G|L2R|L2G|L1R|L1G|OL2|OL1|DIT| K4| K3| K2| K1|
+//  |TRG|L4R|L4G|L3R|L3G|L2R|L2G|L1R|L1G|OL2|OL1|DIT| K4| K3| K2| K1|
 //  -----------------------------------------------------------------
+//  TRG		- 0 = new code is set immediately, 1 = new code is set on rising edge of trigger input (only when dithering is OFF)
 //  L4R		- LED 4 red (1 = LED ON, 0 = LED OFF)
 //  L4G		- LED 4 green (1 = LED ON, 0 = LED OFF)
 //  L3R		- LED 3 red (1 = LED ON, 0 = LED OFF)
@@ -65,6 +66,7 @@ LOCKBITS = 0x3F;
 //  voltage    - 20-bit code for DC generation when dithering is OFF, highest 20 bits when dithering is ON
 //  dithering  - 4 lowest bits of 24-bit code for DC generation when dithering is ON
 
+#define TRG		15
 #define L4R		14
 #define L4G		13
 #define L3R		12
@@ -81,6 +83,26 @@ LOCKBITS = 0x3F;
 #define K2		1
 #define K1		0
 
+#define DAC_HOLD	0
+#define DAC_ZERO	1
+
+typedef struct
+{
+	uint8_t DAC_action;		//DAC_HOLD = code is kept during range change, DAC_ZERO = 0 A during range change
+	uint8_t steps;			//number of relay steps (0 - 2)
+	uint8_t relays[2];		//position of relays K2 (bit 1) and K1 (bit 0) after each step
+} range_sequence;
+
+//sequences of range change, range_sequences[range from - 1][range to - 1]
+//range 1: K2 = 0, K1 = 0, range 2: K2 = 0, K1 = 1, range 3: K2 = 1, K1 = 1
+//combination K2 = 1, K1 = 0 is not a valid range, therefore range 1 <-> 3 goes through range 2
+//same code gives 10x higher current in higher range, DAC is set to 0 A before going to higher range
+const range_sequence range_sequences[3][3] = {
+	{{DAC_HOLD, 0, {0b00, 0b00}}, {DAC_ZERO, 1, {0b01, 0b01}}, {DAC_ZERO, 2, {0b01, 0b11}}},
+	{{DAC_HOLD, 1, {0b00, 0b00}}, {DAC_HOLD, 0, {0b01, 0b01}}, {DAC_ZERO, 1, {0b11, 0b11}}},
+	{{DAC_HOLD, 2, {0b01, 0b00}}, {DAC_HOLD, 1, {0b01, 0b01}}, {DAC_HOLD, 0, {0b11, 0b11}}}
+};
+
 const uint8_t module_name[5] = "@CCB";
 volatile static uint16_t reg_G = 0x0000;
 volatile static uint16_t reg_H = 0x0000;
@@ -90,7 +112,13 @@ volatile static uint8_t reg_H_update = 0;
 volatile static uint8_t reg_I_update = 0;
 
 volatile static uint8_t relays_state = 0x00;
+volatile static uint8_t range_sequence_active = 0;
+volatile static uint8_t range_from = 0;
+volatile static uint8_t range_to = 0;
+volatile static uint8_t range_step = 0;
 volatile static uint8_t dithering_mode = 0;
+volatile static uint8_t trigger_mode = 0;
+volatile static uint8_t trigger_pending = 0;		//1 = code is loaded in DAC and waits for trigger
 
 volatile static uint32_t DAC_code = 0x00000000;
 volatile static uint32_t DAC_code_dith_high = 0x00000000;
@@ -107,7 +135,12 @@ volatile static uint8_t panel_LEDs_state = 0x00;
 void initPins(void);
 void sortReceivedData(void);
 void sendAllRegisters(void);
-void updateRelays(void);
+void updateRelays(uint8_t relays);
+uint8_t getRange(uint8_t relays);
+void startRangeSequence(void);
+void nextRangeStep(void);
+void updateDACCode(void);
+void updateTrigger(void);
 void updateLEDs(void);
 void initDithTimer(void);
 void ditheringON(void);
@@ -133,11 +166,26 @@ ISR (TIMER0_COMPA_vect)
 }
 
 
+ISR (ANALOG_COMP_vect)
+{
+	//rising edge on trigger input, preloaded code is sent to DAC output
+	//LDAC is driven directly (no function call) to keep latency low, CLVB is updated from the same trigger line
+	if (trigger_pending == 1)
+	{
+		LDAC_LOW();
+		_delay_us(1);
+		LDAC_HIGH();
+		trigger_pending = 0;
+	}
+}
+
+
 int main(void)
 {
 	_delay_ms(100);
 	CCB_InitRelays();
-	updateRelays();							//set relays to default state (range 1, output OFF)
+	CCB_InitRelayTimer();					//init timer interrupt for relay pulses
+	updateRelays(reg_H & 0x000F);			//set relays to default state (range 1, output OFF)
     UART_Init(9600, F_CPU);					//init UART for communication with controlling module
 	SPI_Init(4, MSB_FIRST, SPI_MODE_1);		//init SPI for control of DAC11001B
 	DDRB |= (1 << DAC_CS);					//DAC_CS as output
@@ -157,15 +205,14 @@ int main(void)
 	CCB_InitDAC();							//configure DAC registers
 	//CCB_InitLEDs();
 	initDithTimer();						//init timer interrupt for dithering
+	CCB_InitTrigger();						//init trigger input, interrupt is enabled by bit TRG
 	
 	DDRB |= (1 << DDB5);
 
 	_delay_ms(100);
 	
-	CCB_RelayRESET(1);
-	CCB_RelayRESET(2);
-	CCB_RelayRESET(3);
-	CCB_RelayRESET(4);						//output OFF
+	CCB_RelaysPulse(0x00, 0x0F);			//reset all relays at once, output OFF
+	relays_state = 0x00;
 	CCB_SetDACVoltage(0x00000000);			//start with 0V -> 0A
 	
 	_delay_ms(100);
@@ -188,34 +235,45 @@ int main(void)
 		
 		//=====================================================================
 		//switch relays, turn on/off LEDs and start/stop dithering if necessary
-		if (reg_H_update == 1)
+		//new relay pulse is not started until coils from previous one are released and settled
+		//change of range is done by sequence of steps (see range_sequences)
+		if ((reg_H_update == 1) && (CCB_RelaysBusy() == 0) && (range_sequence_active == 0))
 		{
-			updateRelays();
-			//updateLEDs();
+			range_from = getRange(relays_state);
+			range_to = getRange(reg_H);
 			
-			//turn on/off dithering
-			dithering_mode = (reg_H >> DIT) & 0x0001;
-			if (dithering_mode == 1) {updateDithering(); ditheringON();}
-			else {ditheringOFF();}
+			if ((range_from != 0) && (range_to != 0) && (range_from != range_to))
+			{
+				startRangeSequence();		//relays K3, K4 and dithering are updated at the end of sequence
+			}
+			else
+			{
+				updateRelays(reg_H & 0x000F);
+				//updateLEDs();
+				updateTrigger();
+				
+				//turn on/off dithering
+				dithering_mode = (reg_H >> DIT) & 0x0001;
+				if (dithering_mode == 1) {updateDithering(); ditheringON();}
+				else {ditheringOFF();}
+			}
 			
 			reg_H_update = 0;	//clear register update flag
 		}
 		
+		//=======================================================================
+		//next step of range change, started after relays from previous step are settled
+		if ((range_sequence_active == 1) && (CCB_RelaysBusy() == 0))
+		{
+			nextRangeStep();
+		}
+		
 		//=================================================
 		//set DAC voltage and update dithering if necessary
-		if (reg_I_update == 1)
+		//new code is not set before pending update of register H (keeps order H -> I) and during range change
+		if ((reg_I_update == 1) && (reg_H_update == 0) && (range_sequence_active == 0))
 		{
-			DAC_code = (reg_I >> 4) & 0x000FFFFF;
-			dith_bits = reg_I & 0x0000000F;
-			
-			if (dithering_mode == 0)
-			{
-				CCB_SetDACVoltage(DAC_code);
-			}
-			else
-			{
-				updateDithering();
-			}
+			updateDACCode();
 			reg_I_update = 0;	//clear register update flag
 		}
     }
@@ -277,21 +335,129 @@ void sendAllRegisters(void)
 }
 
 
-void updateRelays(void)
+void updateRelays(uint8_t relays)
 {
+	uint8_t relays_set = 0x00;
+	uint8_t relays_reset = 0x00;
+	
 	for (uint8_t i = 0; i <= 3; i++)
 	{
-		if ((reg_H >> i) & 0x0001)
+		if ((relays >> i) & 0x01)
 		{
-			if (((relays_state >> i) & 0x0001) != 1) {CCB_RelaySET(i+1);}
+			if (((relays_state >> i) & 0x0001) != 1) {relays_set |= (1 << i);}
 		}
 		else
 		{
-			if (((relays_state >> i) & 0x0001) != 0) {CCB_RelayRESET(i+1);}
+			if (((relays_state >> i) & 0x0001) != 0) {relays_reset |= (1 << i);}
 		}
 	}
 	
-	relays_state = reg_H & 0x000F;
+	//coils of all relays are driven at the same time, released from Timer 2 interrupt
+	if ((relays_set | relays_reset) != 0x00) {CCB_RelaysPulse(relays_set, relays_reset);}
+	
+	relays_state = relays & 0x0F;
+}
+
+
+uint8_t getRange(uint8_t relays)
+{
+	uint8_t range = 0;
+	
+	if (((relays >> K2) & 0x01) == 0)
+	{
+		if (((relays >> K1) & 0x01) == 0) {range = 1;}
+		else {range = 2;}
+	}
+	else
+	{
+		if (((relays >> K1) & 0x01) == 1) {range = 3;}
+	}
+	
+	return range;		//0 if combination of relays is not valid range
+}
+
+
+void startRangeSequence(void)
+{
+	if (range_sequences[range_from - 1][range_to - 1].DAC_action == DAC_ZERO)
+	{
+		ditheringOFF();
+		trigger_pending = 0;				//code waiting for trigger is replaced
+		CCB_SetDACVoltage(0x00000000);		//0 A during range change
+	}
+	
+	range_step = 0;
+	range_sequence_active = 1;
+	nextRangeStep();
+}
+
+
+void nextRangeStep(void)
+{
+	const range_sequence *sequence = &range_sequences[range_from - 1][range_to - 1];
+	
+	if (range_step < sequence->steps)
+	{
+		updateRelays((relays_state & ((1 << K4) | (1 << K3))) | sequence->relays[range_step]);		//switch only relays K1, K2
+		range_step++;
+	}
+	else
+	{
+		//range is changed and relays are settled, update relays K3, K4, dithering and load latest code
+		updateRelays((reg_H & ((1 << K4) | (1 << K3))) | (relays_state & ((1 << K2) | (1 << K1))));
+		updateTrigger();
+		dithering_mode = (reg_H >> DIT) & 0x0001;
+		if (dithering_mode == 0) {ditheringOFF();}
+		updateDACCode();
+		if (dithering_mode == 1) {ditheringON();}
+		
+		reg_I_update = 0;
+		range_sequence_active = 0;
+	}
+}
+
+
+void updateDACCode(void)
+{
+	DAC_code = (reg_I >> 4) & 0x000FFFFF;
+	dith_bits = reg_I & 0x0000000F;
+	
+	if (dithering_mode == 0)
+	{
+		if (trigger_mode == 1)
+		{
+			trigger_pending = 0;				//no LDAC pulse from trigger during SPI transmission
+			CCB_LoadDACCode(DAC_code);
+			trigger_pending = 1;				//output is updated on next trigger edge
+		}
+		else
+		{
+			CCB_SetDACVoltage(DAC_code);
+		}
+	}
+	else
+	{
+		updateDithering();
+	}
+}
+
+
+void updateTrigger(void)
+{
+	trigger_mode = (reg_H >> TRG) & 0x0001;
+	
+	if (trigger_mode == 1) {CCB_TriggerON();}
+	else
+	{
+		CCB_TriggerOFF();
+		
+		//code waiting for trigger is set immediately after trigger mode is turned off
+		if (trigger_pending == 1)
+		{
+			trigger_pending = 0;
+			CCB_UpdateDACOutput();
+		}
+	}
 }
 
 
@@ -0,0 +1,398 @@
+//=====================================================================
+//Co-simulation bridge between Linux build of control firmware and
+//GHDL simulation of CLVB gateware (main.vhd), linked into simulation
+//as VHPIDIRECT functions called by cosim_top.vhd
+//bytes written by firmware into pty are sent bit by bit into UART RX
+//pin of gateware, bytes from UART TX pin are written back into pty
+//SPI frames, LDAC and relay pulses are logged with simulation time
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pty.h>
+#include <termios.h>
+#include <time.h>
+#include <math.h>
+
+
+#define COSIM_BUFFER_SIZE					1024
+#define COSIM_LINE_SIZE						64
+#define COSIM_COMMAND_SIZE				128
+#define COSIM_IDLE_TIME						0.05			//s of simulation without UART traffic, end of measurement
+#define COSIM_SPEED_PERIOD				0.5				//s of simulation between reports of simulation speed
+#define COSIM_CONTINUOUS_FRAMES		100				//more frames in one measurement = AC mode or dithering
+#define COSIM_COMMAND_TIMEOUT			2.0				//s of real time, SCPI command without any write into CLVB
+
+#define COSIM_EVENT_SPI_FRAME			1					//value = SPI frame (32 bits)
+#define COSIM_EVENT_LDAC					2					//LDAC falling edge, value = code of last frame
+#define COSIM_EVENT_RELAY					3					//rising edge on relay pin, value = index (0 = R1S ... 5 = R3R)
+
+static const char *cosim_relay_names[] = {"R1S", "R1R", "R2S", "R2R", "R3S", "R3R"};
+
+//one measurement covers all register writes caused by one SCPI command (or one burst of writes without script)
+typedef struct
+{
+	uint8_t active;
+	char command[COSIM_COMMAND_SIZE];		//SCPI command from script, empty without script
+	double command_wall;								//real time when SCPI command was written
+	double first_byte_wall;							//real time when first byte for CLVB was received from firmware
+	double first_start_sim;							//simulation time of first start bit sent into gateware
+	double last_line_sim;								//simulation time of end of last write into register (not G003F)
+	double first_LDAC_sim;							//first LDAC falling edge after last line, 0 = none
+	double last_LDAC_sim;
+	uint32_t lines;
+	uint32_t frames;
+	uint32_t LDACs;
+	uint32_t relay_pulses;
+} Cosim_measurement;
+
+static int cosim_fd = -1;
+static int cosim_fd_slave = -1;
+static int cosim_SCPI_fd = -1;
+static FILE *cosim_script = NULL;
+static uint8_t cosim_verbose = 0;
+
+static uint8_t rx_buffer[COSIM_BUFFER_SIZE];
+static double rx_buffer_wall[COSIM_BUFFER_SIZE];			//real time when byte was read from pty
+static uint32_t rx_read_pos = 0;
+static uint32_t rx_write_pos = 0;
+
+static char line_to_CLVB[COSIM_LINE_SIZE];
+static uint32_t line_to_CLVB_length = 0;
+static char line_from_CLVB[COSIM_LINE_SIZE];
+static uint32_t line_from_CLVB_length = 0;
+static uint32_t last_frame = 0;
+
+static double last_activity_sim = 0.0;			//simulation time of last byte in any direction
+static double start_wall = 0.0;
+static double speed_wall = 0.0;
+static double speed_sim = 0.0;
+static uint8_t script_finished = 0;
+
+static Cosim_measurement measurement;
+static uint32_t measurements_done = 0;
+static double sum_firmware = 0.0, sum_gateware = 0.0;
+
+
+static double Cosim_GetWallTime(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+
+static int Cosim_OpenRaw(const char *device)
+{
+	struct termios tio;
+	int fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+	
+	if (fd < 0) {fprintf(stderr, "[cosim] cannot open %s (%s)\n", device, strerror(errno)); return -1;}
+	if (tcgetattr(fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	
+	return fd;
+}
+
+
+//read all bytes written by firmware, real time of every byte is stored for measurement of firmware latency
+static void Cosim_PollFirmware(void)
+{
+	uint8_t data[256];
+	ssize_t length = read(cosim_fd, data, sizeof(data));
+	double now = Cosim_GetWallTime();
+	
+	for (ssize_t i = 0; i < length; i++)
+	{
+		if (((rx_write_pos + 1) % COSIM_BUFFER_SIZE) == rx_read_pos) {break;}		//overflow
+		rx_buffer[rx_write_pos] = data[i];
+		rx_buffer_wall[rx_write_pos] = now;
+		rx_write_pos = (rx_write_pos + 1) % COSIM_BUFFER_SIZE;
+	}
+	
+	//answers of firmware to SCPI commands are only discarded
+	if (cosim_SCPI_fd >= 0)
+	{
+		while (read(cosim_SCPI_fd, data, sizeof(data)) > 0);
+	}
+}
+
+
+static void Cosim_PrintMeasurement(void)
+{
+	double firmware = measurement.first_byte_wall - measurement.command_wall;
+	double gateware = 0.0;
+	
+	if (measurement.first_LDAC_sim > 0.0) {gateware = measurement.first_LDAC_sim - measurement.first_start_sim;}
+	
+	printf("[cosim] %s%s%s%u lines, %u SPI frames, %u relay pulses", (measurement.command[0] != '\0') ? "\"" : "",
+		measurement.command, (measurement.command[0] != '\0') ? "\": " : "", measurement.lines, measurement.frames,
+		measurement.relay_pulses);
+	if (measurement.command[0] != '\0') {printf(", firmware %.3f ms", firmware * 1e3);}
+	if (measurement.last_line_sim > 0.0)
+	{
+		printf(", UART until last write %.3f ms", (measurement.last_line_sim - measurement.first_start_sim) * 1e3);
+	}
+	if (measurement.first_LDAC_sim > 0.0)
+	{
+		printf(", DAC update %.3f ms", gateware * 1e3);
+		if (measurement.frames > COSIM_CONTINUOUS_FRAMES) {printf(" (continuous)");}
+		else if (measurement.last_LDAC_sim > measurement.first_LDAC_sim)
+		{
+			printf(", last DAC update %.3f ms", (measurement.last_LDAC_sim - measurement.first_start_sim) * 1e3);
+		}
+		if (measurement.command[0] != '\0') {printf(", total %.3f ms", (firmware + gateware) * 1e3);}
+	}
+	printf("\n");
+	fflush(stdout);
+	
+	if ((measurement.command[0] != '\0') && (measurement.first_LDAC_sim > 0.0))
+	{
+		sum_firmware += firmware;
+		sum_gateware += gateware;
+		measurements_done++;
+	}
+	measurement.active = 0;
+	measurement.command[0] = '\0';
+}
+
+
+//next SCPI command of script is sent when simulation is idle (previous command finished)
+static void Cosim_SendNextCommand(double t)
+{
+	char command[COSIM_COMMAND_SIZE];
+	
+	while (fgets(command, sizeof(command), cosim_script) != NULL)
+	{
+		command[strcspn(command, "\r\n")] = '\0';
+		if ((command[0] == '\0') || (command[0] == '#')) {continue;}
+	
+		memset(&measurement, 0, sizeof(measurement));
+		strncpy(measurement.command, command, sizeof(measurement.command) - 1);
+		measurement.command_wall = Cosim_GetWallTime();
+		if ((write(cosim_SCPI_fd, command, strlen(command)) < 0) || (write(cosim_SCPI_fd, "\n", 1) != 1))
+		{
+			fprintf(stderr, "[cosim] write of SCPI command failed (%s)\n", strerror(errno));
+		}
+		if (cosim_verbose) {printf("[cosim %10.6f s] SCPI > %s\n", t, command);}
+		last_activity_sim = t;
+		return;
+	}
+	
+	script_finished = 1;
+	if (measurements_done > 0)
+	{
+		printf("[cosim] %u commands, average firmware %.3f ms, UART + gateware to DAC update %.3f ms, total %.3f ms\n",
+			measurements_done, sum_firmware / measurements_done * 1e3, sum_gateware / measurements_done * 1e3,
+			(sum_firmware + sum_gateware) / measurements_done * 1e3);
+	}
+}
+
+
+/**
+* @brief - create pty for firmware (or open existing device), open SCPI port and script for measurement of latency
+* environment: CLVB_COSIM_LINK (symlink to pty), CLVB_COSIM_DEVICE (existing device instead of pty),
+* CLVB_COSIM_SCPI (SCPI port of firmware), CLVB_COSIM_SCRIPT (SCPI commands), CLVB_COSIM_VERBOSE (1 = log every event)
+* @returns - 0 if successful, 1 if pty can not be created
+*/
+int cosim_init(void)
+{
+	const char *link = getenv("CLVB_COSIM_LINK");
+	const char *device = getenv("CLVB_COSIM_DEVICE");
+	const char *SCPI = getenv("CLVB_COSIM_SCPI");
+	const char *script = getenv("CLVB_COSIM_SCRIPT");
+	const char *verbose = getenv("CLVB_COSIM_VERBOSE");
+	char path[256];
+	struct termios tio;
+	
+	cosim_verbose = (verbose != NULL) && (atoi(verbose) != 0);
+	start_wall = speed_wall = Cosim_GetWallTime();
+	
+	if (device != NULL)
+	{
+		cosim_fd = Cosim_OpenRaw(device);
+		if (cosim_fd < 0) {return 1;}
+		strncpy(path, device, sizeof(path) - 1);
+		path[sizeof(path) - 1] = '\0';
+	}
+	else
+	{
+		if (openpty(&cosim_fd, &cosim_fd_slave, path, NULL, NULL) != 0) {fprintf(stderr, "[cosim] openpty failed\n"); return 1;}
+		fcntl(cosim_fd, F_SETFL, fcntl(cosim_fd, F_GETFL) | O_NONBLOCK);
+		if (tcgetattr(cosim_fd_slave, &tio) == 0)
+		{
+			cfmakeraw(&tio);
+			tcsetattr(cosim_fd_slave, TCSANOW, &tio);
+		}
+		if (link != NULL)
+		{
+			unlink(link);
+			if (symlink(path, link) != 0) {fprintf(stderr, "[cosim] cannot create %s\n", link);}
+		}
+	}
+	fprintf(stderr, "[cosim] CLVB gateware on %s (pid %d)\n", path, (int) getpid());
+	
+	if ((SCPI != NULL) && (script != NULL))
+	{
+		cosim_SCPI_fd = Cosim_OpenRaw(SCPI);
+		cosim_script = fopen(script, "r");
+		if (cosim_script == NULL) {fprintf(stderr, "[cosim] cannot open %s\n", script);}
+		if ((cosim_SCPI_fd < 0) || (cosim_script == NULL)) {script_finished = 1;}
+	}
+	
+	return 0;
+}
+
+
+/**
+* @brief - next byte for UART RX pin of gateware, called when RX line is idle
+* @param t - simulation time in seconds
+* @returns - byte 0 - 255, -1 if there is no byte, -2 if script is finished (end of simulation)
+*/
+int cosim_rx_byte(double t)
+{
+	double wall = Cosim_GetWallTime();
+	
+	Cosim_PollFirmware();
+	
+	if ((t - speed_sim) >= COSIM_SPEED_PERIOD)
+	{
+		double ratio = (wall - speed_wall) / (t - speed_sim);
+		fprintf(stderr, "[cosim] simulation %.1f s, %.1fx slower than real time (CALIBRATOR_TIME_SCALE >= %.0f)\n",
+			t, ratio, ceil(ratio));
+		speed_wall = wall;
+		speed_sim = t;
+	}
+	
+	if (rx_read_pos == rx_write_pos)
+	{
+		//end of command, no traffic in both directions
+		if ((t - last_activity_sim) >= COSIM_IDLE_TIME)
+		{
+			//firmware runs in real time, first byte of command may come after long time of simulation
+			if ((measurement.command[0] != '\0') && (!measurement.active))
+			{
+				if ((wall - measurement.command_wall) < COSIM_COMMAND_TIMEOUT) {return -1;}
+				printf("[cosim] \"%s\": no write into CLVB\n", measurement.command);
+				measurement.command[0] = '\0';
+			}
+			if (measurement.active) {Cosim_PrintMeasurement();}
+			if ((cosim_script != NULL) && (!script_finished)) {Cosim_SendNextCommand(t);}
+			else if ((cosim_script != NULL) && script_finished) {return -2;}
+		}
+		return -1;
+	}
+	
+	uint8_t byte = rx_buffer[rx_read_pos];
+	double byte_wall = rx_buffer_wall[rx_read_pos];
+	rx_read_pos = (rx_read_pos + 1) % COSIM_BUFFER_SIZE;
+	
+	if (!measurement.active)
+	{
+		if (measurement.command[0] == '\0') {memset(&measurement, 0, sizeof(measurement));}
+		measurement.active = 1;
+		measurement.first_byte_wall = byte_wall;
+		measurement.first_start_sim = t;
+	}
+	
+	if ((byte == '\r') || (byte == '\n'))
+	{
+		if (line_to_CLVB_length > 0)
+		{
+			line_to_CLVB[line_to_CLVB_length] = '\0';
+			if (cosim_verbose) {printf("[cosim %10.6f s] -> CLVB %s\n", t, line_to_CLVB);}
+			measurement.lines++;
+			//DAC update is counted after last write, G003F (verification of write) does not change output
+			if (line_to_CLVB[0] != 'G')
+			{
+				measurement.last_line_sim = t;
+				measurement.first_LDAC_sim = 0.0;
+				measurement.last_LDAC_sim = 0.0;
+			}
+		}
+		line_to_CLVB_length = 0;
+	}
+	else if (line_to_CLVB_length < (COSIM_LINE_SIZE - 1)) {line_to_CLVB[line_to_CLVB_length++] = byte;}
+	
+	last_activity_sim = t;
+	
+	return byte;
+}
+
+
+/**
+* @brief - byte decoded from UART TX pin of gateware is written into pty
+* @param byte - received byte
+* @param t - simulation time in seconds
+* @returns - nothing
+*/
+void cosim_tx_byte(int byte, double t)
+{
+	uint8_t data = (uint8_t) byte;
+	
+	if (write(cosim_fd, &data, 1) != 1)
+	{
+		if (cosim_fd_slave >= 0) {tcflush(cosim_fd_slave, TCIFLUSH);}		//nobody reads the line
+	}
+	
+	if ((data == '\r') || (data == '\n'))
+	{
+		if ((line_from_CLVB_length > 0) && cosim_verbose)
+		{
+			line_from_CLVB[line_from_CLVB_length] = '\0';
+			printf("[cosim %10.6f s] <- CLVB %s\n", t, line_from_CLVB);
+		}
+		line_from_CLVB_length = 0;
+	}
+	else if (line_from_CLVB_length < (COSIM_LINE_SIZE - 1)) {line_from_CLVB[line_from_CLVB_length++] = data;}
+	
+	last_activity_sim = t;
+}
+
+
+/**
+* @brief - event on SPI, LDAC or relay pins of gateware
+* @param kind - COSIM_EVENT_SPI_FRAME, COSIM_EVENT_LDAC or COSIM_EVENT_RELAY
+* @param value - SPI frame, index of relay pin
+* @param t - simulation time in seconds
+* @returns - nothing
+*/
+void cosim_event(int kind, int value, double t)
+{
+	if (kind == COSIM_EVENT_SPI_FRAME)
+	{
+		last_frame = (uint32_t) value;
+		measurement.frames++;
+		if (cosim_verbose && (measurement.frames <= COSIM_CONTINUOUS_FRAMES))
+		{
+			printf("[cosim %10.6f s] SPI frame %08X (address %u, code %05X)\n", t, last_frame, (last_frame >> 24) & 0x7F,
+				(last_frame >> 4) & 0xFFFFF);
+		}
+	}
+	else if (kind == COSIM_EVENT_LDAC)
+	{
+		measurement.LDACs++;
+		if (measurement.active && (measurement.last_line_sim > 0.0))
+		{
+			if (measurement.first_LDAC_sim == 0.0) {measurement.first_LDAC_sim = t;}
+			measurement.last_LDAC_sim = t;
+		}
+	}
+	else if (kind == COSIM_EVENT_RELAY)
+	{
+		measurement.relay_pulses++;
+		if (cosim_verbose && (value >= 0) && (value < 6)) {printf("[cosim %10.6f s] relay %s\n", t, cosim_relay_names[value]);}
+		last_activity_sim = t;		//range change sequence is part of command
+	}
+}
@@ -0,0 +1,58 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+
+
+-- package cosim_pkg declares functions of cosim_bridge.c (VHPIDIRECT), bodies are used only if bridge is not linked
+-- time is passed in seconds of simulation time, bytes and events are passed as integers
+package cosim_pkg is
+
+    -- C_EVENT_*                - kinds of events for cosim_event (same values as COSIM_EVENT_* in cosim_bridge.c)
+
+    constant    C_EVENT_SPI_FRAME   : integer   := 1;
+    constant    C_EVENT_LDAC        : integer   := 2;
+    constant    C_EVENT_RELAY       : integer   := 3;
+
+    -- create pty for firmware, returns 0 if successful
+    impure function cosim_init return integer;
+    attribute foreign of cosim_init : function is "VHPIDIRECT cosim_init";
+
+    -- next byte from firmware for UART RX pin, -1 = no byte, -2 = end of simulation
+    impure function cosim_rx_byte(t : real) return integer;
+    attribute foreign of cosim_rx_byte : function is "VHPIDIRECT cosim_rx_byte";
+
+    -- byte from UART TX pin for firmware
+    procedure cosim_tx_byte(byte : integer; t : real);
+    attribute foreign of cosim_tx_byte : procedure is "VHPIDIRECT cosim_tx_byte";
+
+    -- SPI frame, LDAC falling edge or pulse on relay pin
+    procedure cosim_event(kind : integer; value : integer; t : real);
+    attribute foreign of cosim_event : procedure is "VHPIDIRECT cosim_event";
+
+end package cosim_pkg;
+
+
+package body cosim_pkg is
+
+    impure function cosim_init return integer is
+    begin
+        report "cosim_bridge.c is not linked (VHPIDIRECT cosim_init)" severity failure;
+        return 1;
+    end function;
+
+    impure function cosim_rx_byte(t : real) return integer is
+    begin
+        report "cosim_bridge.c is not linked (VHPIDIRECT cosim_rx_byte)" severity failure;
+        return -2;
+    end function;
+
+    procedure cosim_tx_byte(byte : integer; t : real) is
+    begin
+        report "cosim_bridge.c is not linked (VHPIDIRECT cosim_tx_byte)" severity failure;
+    end procedure;
+
+    procedure cosim_event(kind : integer; value : integer; t : real) is
+    begin
+        report "cosim_bridge.c is not linked (VHPIDIRECT cosim_event)" severity failure;
+    end procedure;
+
+end package body cosim_pkg;
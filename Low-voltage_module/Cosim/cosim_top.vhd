@@ -0,0 +1,191 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use work.tb_utils_pkg.all;
+use work.cosim_pkg.all;
+
+
+-- top entity cosim_top connects CLVB gateware (main) with Linux build of control firmware through cosim_bridge.c
+-- bytes written by firmware are sent bit by bit into i_UART_RX_pin (9600 Bd), bytes from o_UART_TX_pin are returned
+-- SPI frames, LDAC falling edges and pulses on relay pins are passed to bridge, which measures latency of commands
+-- simulation runs until script of SCPI commands is finished or until --stop-time
+entity cosim_top is
+    generic(
+        -- G_POLL_PERIOD    - period of polling bridge for new bytes when UART RX line is idle
+
+        G_POLL_PERIOD       : time      := 10 us
+        );
+end cosim_top;
+
+architecture Behavioral of cosim_top is
+
+    component main
+        generic(
+            G_CLOCK_FREQ        : real      := 12.0e6;
+            G_DITH_FREQ         : positive  := 1000;
+            G_AC_GEN_FREQ       : positive  := 100000
+            );
+        port(
+            i_clk               : in    std_logic;
+            i_rst               : in    std_logic;
+            i_UART_RX_pin       : in    std_logic;
+            i_SPI_MISO_pin      : in    std_logic;
+            i_ALARM_pin         : in    std_logic;
+            i_TRIG_pin          : in    std_logic;
+            o_UART_TX_pin       : out   std_logic;
+            o_SPI_MOSI_pin      : out   std_logic;
+            o_SPI_CS_pin        : out   std_logic;
+            o_SPI_SCLK_pin      : out   std_logic;
+            o_LDAC_pin          : out   std_logic;
+            o_CLR_pin           : out   std_logic;
+            o_R1S               : out   std_logic;
+            o_R1R               : out   std_logic;
+            o_R2S               : out   std_logic;
+            o_R2R               : out   std_logic;
+            o_R3S               : out   std_logic;
+            o_R3R               : out   std_logic;
+            o_out_LED_1         : out   std_logic;
+            o_out_LED_2         : out   std_logic;
+            o_panel_LED_1G      : out   std_logic;
+            o_panel_LED_1R      : out   std_logic;
+            o_panel_LED_2G      : out   std_logic;
+            o_panel_LED_2R      : out   std_logic;
+            o_panel_LED_3G      : out   std_logic;
+            o_panel_LED_3R      : out   std_logic;
+            o_panel_LED_4G      : out   std_logic;
+            o_panel_LED_4R      : out   std_logic;
+            o_CLK_out           : out   std_logic
+            );
+    end component;
+
+    signal      r_clk                   : std_logic                         := '0';
+    signal      r_rst                   : std_logic                         := '1';
+    signal      r_RX_pin                : std_logic                         := '1';
+    signal      r_TX_pin                : std_logic;
+    signal      r_MOSI                  : std_logic;
+    signal      r_CS                    : std_logic;
+    signal      r_SCLK                  : std_logic;
+    signal      r_LDAC                  : std_logic;
+    signal      r_CLR                   : std_logic;
+    signal      r_relays                : std_logic_vector(5 downto 0);
+    signal      r_LEDs                  : std_logic_vector(9 downto 0);
+    signal      r_CLK_out               : std_logic;
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_UART_to_gateware opens bridge and sends bytes from firmware into UART RX pin
+    p_UART_to_gateware : process
+        variable v_byte         : integer;
+    begin
+        if (cosim_init /= 0) then
+            report "cosim_top: bridge was not opened" severity failure;
+        end if;
+        wait for 10 * C_CLK_PERIOD;
+        r_rst <= '0';
+        loop
+            v_byte := cosim_rx_byte(to_real(now, 1 sec));
+            if (v_byte = -2) then
+                report "cosim_top: script finished";
+                std.env.finish;
+            elsif (v_byte >= 0) then
+                uart_send_byte(r_RX_pin, std_logic_vector(to_unsigned(v_byte, 8)));
+            else
+                wait for G_POLL_PERIOD;
+            end if;
+        end loop;
+    end process;
+
+    -- process p_UART_to_firmware decodes bytes on UART TX pin and passes them to firmware
+    p_UART_to_firmware : process
+        variable v_byte         : std_logic_vector(7 downto 0);
+        variable v_timeout      : boolean;
+    begin
+        wait until r_rst = '0';
+        loop
+            uart_receive_byte(r_TX_pin, 1 sec, v_byte, v_timeout);
+            if (not v_timeout) then
+                cosim_tx_byte(to_integer(unsigned(v_byte)), to_real(now, 1 sec));
+            end if;
+        end loop;
+    end process;
+
+    -- process p_DAC_model decodes SPI frames (SPI mode 1, data sampled on falling edge of SCLK)
+    p_DAC_model : process
+        variable v_frame        : std_logic_vector(31 downto 0);
+        variable v_bits         : natural;
+    begin
+        wait until r_rst = '0';
+        loop
+            wait until falling_edge(r_CS);
+            v_bits := 0;
+            loop
+                wait until falling_edge(r_SCLK) or rising_edge(r_CS);
+                exit when r_CS = '1';
+                if (v_bits < 32) then
+                    v_frame(31 - v_bits) := r_MOSI;
+                end if;
+                v_bits := v_bits + 1;
+            end loop;
+            cosim_event(C_EVENT_SPI_FRAME, to_integer(signed(v_frame)), to_real(now, 1 sec));
+        end loop;
+    end process;
+
+    -- process p_LDAC_monitor passes every LDAC falling edge (update of DAC output)
+    p_LDAC_monitor : process
+    begin
+        wait until r_rst = '0';
+        loop
+            wait until falling_edge(r_LDAC);
+            cosim_event(C_EVENT_LDAC, 0, to_real(now, 1 sec));
+        end loop;
+    end process;
+
+    -- process p_relay_monitor passes rising edges on relay pins (0 = R1S, 1 = R1R, 2 = R2S, 3 = R2R, 4 = R3S, 5 = R3R)
+    p_relay_monitor : process(r_relays)
+        variable v_last         : std_logic_vector(5 downto 0) := (others => '0');
+    begin
+        for i in 0 to 5 loop
+            if ((r_relays(i) = '1') and (v_last(i) /= '1')) then
+                cosim_event(C_EVENT_RELAY, i, to_real(now, 1 sec));
+            end if;
+        end loop;
+        v_last := r_relays;
+    end process;
+
+    -- instance of main
+    instance_main : main
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_UART_RX_pin => r_RX_pin,
+            i_SPI_MISO_pin => '0',
+            i_ALARM_pin => '0',
+            i_TRIG_pin => '0',                  -- GPIO of host firmware exists only in memory
+            o_UART_TX_pin => r_TX_pin,
+            o_SPI_MOSI_pin => r_MOSI,
+            o_SPI_CS_pin => r_CS,
+            o_SPI_SCLK_pin => r_SCLK,
+            o_LDAC_pin => r_LDAC,
+            o_CLR_pin => r_CLR,
+            o_R1S => r_relays(0),
+            o_R1R => r_relays(1),
+            o_R2S => r_relays(2),
+            o_R2R => r_relays(3),
+            o_R3S => r_relays(4),
+            o_R3R => r_relays(5),
+            o_out_LED_1 => r_LEDs(0),
+            o_out_LED_2 => r_LEDs(1),
+            o_panel_LED_1G => r_LEDs(2),
+            o_panel_LED_1R => r_LEDs(3),
+            o_panel_LED_2G => r_LEDs(4),
+            o_panel_LED_2R => r_LEDs(5),
+            o_panel_LED_3G => r_LEDs(6),
+            o_panel_LED_3R => r_LEDs(7),
+            o_panel_LED_4G => r_LEDs(8),
+            o_panel_LED_4R => r_LEDs(9),
+            o_CLK_out => r_CLK_out
+            );
+
+end Behavioral;
@@ -0,0 +1,269 @@
+//=====================================================================
+//Generator of DAC code streams of AC mode from bit-exact DDS model
+//and cross-check of model against GHDL simulation of DDS.vhd
+//(random vectors for tb_DDS_vectors, comparison of its results)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include "DDS_model.h"
+
+
+#define MODEL_SAMPLE_RATE				100000.0		//G_AC_GEN_FREQ of main
+#define MODEL_BLOCK_SIZE				65536				//codes generated and written at once
+#define MODEL_MAX_AMPLITUDE			0x80000			//maximal amplitude in register I (AC mode)
+#define MODEL_MAX_ERRORS_PRINTED	20
+
+static const uint32_t model_edge_FTWs[] = {0x00000000, 0x00000001, 0x40000000, 0x80000000, 0xC0000000, 0xFFFFFFFF};
+static const uint32_t model_edge_amplitudes[] = {0x00000, 0x00001, 0x7FFFF, 0x80000};
+
+
+static double Model_GetTime_s(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+
+static void Model_PrintUsage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s -f FTW | -F frequency [-s sample_rate] -a amplitude -n samples [-o file] [-b] [-t]\n"
+		"       %s -V vectors_file [-c cases] [-n samples] [-r seed]\n"
+		"       %s -C results_file\n"
+		"-f FTW          frequency tuning word (register J, decimal or 0x hex)\n"
+		"-F frequency    frequency in Hz, FTW is calculated for sample rate (-s, default 100000)\n"
+		"-a amplitude    amplitude (register I bits 23 - 4, decimal or 0x hex)\n"
+		"-n samples      number of samples\n"
+		"-o file         output file (default stdout), codes as 5 hex digits per line\n"
+		"-b              binary output, codes as little endian uint32\n"
+		"-t              print generation speed to stderr\n"
+		"-V file         write random vectors for tb_DDS_vectors (\"FTW amplitude samples\" per line)\n"
+		"-c cases        number of random vectors (default 64, edge cases are added)\n"
+		"-r seed         seed of random generator (default 1)\n"
+		"-C file         compare results of tb_DDS_vectors (\"FTW amplitude index code\" per line) with model\n",
+		name, name, name);
+}
+
+
+static void Model_WriteCodes(FILE *file, const uint32_t *codes, size_t count, uint8_t binary)
+{
+	if (binary)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			uint8_t bytes[4] = {(uint8_t) codes[i], (uint8_t) (codes[i] >> 8), (uint8_t) (codes[i] >> 16), (uint8_t) (codes[i] >> 24)};
+			fwrite(bytes, 1, 4, file);
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < count; i++) {fprintf(file, "%05X\n", codes[i]);}
+	}
+}
+
+
+/**
+* @brief - generate codes of consecutive samples (same as AC mode of main after reset of DDS)
+* @returns - 0 if successful, 1 if output file can not be opened
+*/
+static int Model_Generate(uint32_t FTW, uint32_t amplitude, uint64_t samples, const char *output, uint8_t binary, uint8_t timing)
+{
+	FILE *file = stdout;
+	DDS_model dds(FTW, amplitude);
+	std::vector<uint32_t> block(MODEL_BLOCK_SIZE);
+	double start = Model_GetTime_s();
+	double model_time = 0.0;
+	
+	if (output != NULL)
+	{
+		file = fopen(output, binary ? "wb" : "w");
+		if (file == NULL) {perror(output); return 1;}
+	}
+	
+	for (uint64_t done = 0; done < samples; )
+	{
+		size_t count = ((samples - done) < MODEL_BLOCK_SIZE) ? (size_t) (samples - done) : MODEL_BLOCK_SIZE;
+		double block_start = Model_GetTime_s();
+	
+		dds.Generate(block.data(), count);
+		model_time += Model_GetTime_s() - block_start;
+		Model_WriteCodes(file, block.data(), count, binary);
+		done += count;
+	}
+	
+	if (file != stdout) {fclose(file);}
+	
+	if (timing)
+	{
+		double elapsed = Model_GetTime_s() - start;
+		fprintf(stderr, "%llu samples, model %.3f s (%.1f Msamples/s), total %.3f s, %.1f x real time at %.0f Hz\n",
+			(unsigned long long) samples, model_time, (model_time > 0.0) ? (samples / model_time / 1e6) : 0.0,
+			elapsed, (elapsed > 0.0) ? (samples / MODEL_SAMPLE_RATE / elapsed) : 0.0, MODEL_SAMPLE_RATE);
+	}
+	
+	return 0;
+}
+
+
+/**
+* @brief - write random vectors for tb_DDS_vectors, edge cases (FTW and amplitude limits) are written first
+* @returns - 0 if successful, 1 if file can not be opened
+*/
+static int Model_WriteVectors(const char *name, uint32_t cases, uint32_t samples, uint32_t seed)
+{
+	FILE *file = fopen(name, "w");
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<uint32_t> random_FTW(0, 0xFFFFFFFF);
+	std::uniform_int_distribution<uint32_t> random_amplitude(0, MODEL_MAX_AMPLITUDE);
+	uint32_t written = 0;
+	
+	if (file == NULL) {perror(name); return 1;}
+	
+	for (uint8_t f = 0; f < (sizeof(model_edge_FTWs) / sizeof(model_edge_FTWs[0])); f++)
+	{
+		for (uint8_t a = 0; a < (sizeof(model_edge_amplitudes) / sizeof(model_edge_amplitudes[0])); a++)
+		{
+			fprintf(file, "%08X %08X %u\n", model_edge_FTWs[f], model_edge_amplitudes[a], samples);
+			written++;
+		}
+	}
+	
+	for (uint32_t i = 0; i < cases; i++)
+	{
+		//half of vectors with low frequencies (FTW < 2^24), where neighbouring samples have close angles
+		uint32_t FTW = random_FTW(generator);
+		if (i & 1) {FTW >>= 8;}
+		fprintf(file, "%08X %08X %u\n", FTW, random_amplitude(generator), samples);
+		written++;
+	}
+	
+	fclose(file);
+	fprintf(stderr, "%u vectors, %u samples each written into %s\n", written, samples, name);
+	
+	return 0;
+}
+
+
+/**
+* @brief - compare codes from GHDL simulation with model, DDS is reset before every vector (index 0)
+* @returns - 0 if all codes are equal, 1 if there is any difference or file can not be read
+*/
+static int Model_CheckResults(const char *name)
+{
+	FILE *file = fopen(name, "r");
+	char line[128];
+	DDS_model dds;
+	uint32_t FTW = 0, amplitude = 0;
+	uint64_t index_expected = 0;
+	uint64_t checked = 0, errors = 0, vectors = 0;
+	
+	if (file == NULL) {perror(name); return 1;}
+	
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		unsigned int line_FTW, line_amplitude, line_code;
+		unsigned long long line_index;
+	
+		if (sscanf(line, "%x %x %llu %x", &line_FTW, &line_amplitude, &line_index, &line_code) != 4) {continue;}
+	
+		if ((line_index == 0) || (line_FTW != FTW) || (line_amplitude != amplitude))
+		{
+			FTW = line_FTW;
+			amplitude = line_amplitude;
+			dds = DDS_model(FTW, amplitude);
+			index_expected = 0;
+			vectors++;
+			//results may start in the middle of vector only if file is truncated
+			for (; index_expected < line_index; index_expected++) {dds.NextCode();}
+		}
+	
+		if (line_index != index_expected)
+		{
+			fprintf(stderr, "FTW %08X amplitude %05X: missing samples %llu -> %llu\n", FTW, amplitude,
+				(unsigned long long) index_expected, line_index);
+			errors++;
+			for (; index_expected < line_index; index_expected++) {dds.NextCode();}
+		}
+	
+		uint32_t code = dds.NextCode();
+		index_expected++;
+		checked++;
+	
+		if (code != line_code)
+		{
+			if (errors < MODEL_MAX_ERRORS_PRINTED)
+			{
+				fprintf(stderr, "FTW %08X amplitude %05X sample %llu: GHDL %05X, model %05X\n", FTW, amplitude, line_index,
+					line_code, code);
+			}
+			errors++;
+		}
+	}
+	
+	fclose(file);
+	
+	printf("%llu vectors, %llu codes checked, %llu differences\n", (unsigned long long) vectors,
+		(unsigned long long) checked, (unsigned long long) errors);
+	
+	return ((errors == 0) && (checked > 0)) ? 0 : 1;
+}
+
+
+int main(int argc, char **argv)
+{
+	uint32_t FTW = 0, amplitude = 0;
+	uint64_t samples = 0;
+	double frequency = -1.0, sample_rate = MODEL_SAMPLE_RATE;
+	const char *output = NULL, *vectors = NULL, *results = NULL;
+	uint8_t binary = 0, timing = 0, FTW_set = 0;
+	uint32_t cases = 64, seed = 1;
+	int option;
+	
+	while ((option = getopt(argc, argv, "f:F:s:a:n:o:btV:c:r:C:h")) != -1)
+	{
+		switch (option)
+		{
+			case 'f': FTW = strtoul(optarg, NULL, 0); FTW_set = 1; break;
+			case 'F': frequency = atof(optarg); break;
+			case 's': sample_rate = atof(optarg); break;
+			case 'a': amplitude = strtoul(optarg, NULL, 0); break;
+			case 'n': samples = strtoull(optarg, NULL, 0); break;
+			case 'o': output = optarg; break;
+			case 'b': binary = 1; break;
+			case 't': timing = 1; break;
+			case 'V': vectors = optarg; break;
+			case 'c': cases = strtoul(optarg, NULL, 0); break;
+			case 'r': seed = strtoul(optarg, NULL, 0); break;
+			case 'C': results = optarg; break;
+			default: Model_PrintUsage(argv[0]); return 1;
+		}
+	}
+	
+	if (vectors != NULL) {return Model_WriteVectors(vectors, cases, (samples > 0) ? (uint32_t) samples : 1000, seed);}
+	if (results != NULL) {return Model_CheckResults(results);}
+	
+	if (frequency >= 0.0)
+	{
+		FTW = DDS_model::FrequencyToFTW(frequency, sample_rate);
+		FTW_set = 1;
+	}
+	
+	if ((!FTW_set) || (samples == 0))
+	{
+		Model_PrintUsage(argv[0]);
+		return 1;
+	}
+	
+	return Model_Generate(FTW, amplitude, samples, output, binary, timing);
+}
@@ -0,0 +1,136 @@
+//=====================================================================
+//Bit-exact model of DDS.vhd and CORDIC.vhd of CLVB gateware
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "DDS_model.h"
+#include <math.h>
+
+
+//angles of iterations in CORDIC.vhd (X"FFFFFFFF" = 360 degrees)
+const int32_t CORDIC_model::angles[CORDIC_ITERATIONS] = {
+	0x20000000, 0x12E4051E, 0x09FB385B, 0x051111D4, 0x028B0D43, 0x0145D7E1, 0x00A2F61E, 0x00517C55,
+	0x0028BE53, 0x00145F2F, 0x000A2F98, 0x000517CC, 0x00028BE6, 0x000145F3, 0x0000A2FA, 0x0000517D,
+	0x000028BE, 0x0000145F, 0x00000A30, 0x00000518, 0x0000028C, 0x00000146, 0x000000A3, 0x00000051,
+	0x00000029, 0x00000014, 0x0000000A, 0x00000005, 0x00000003, 0x00000001, 0x00000001
+};
+
+
+//32-bit signed addition and subtraction with wrap-around (numeric_std signed "+" and "-")
+static inline int32_t CORDIC_Add(int32_t a, int32_t b)
+{
+	return (int32_t) ((uint32_t) a + (uint32_t) b);
+}
+
+
+static inline int32_t CORDIC_Sub(int32_t a, int32_t b)
+{
+	return (int32_t) ((uint32_t) a - (uint32_t) b);
+}
+
+
+//shift_right of signed (arithmetic shift)
+static inline int32_t CORDIC_ShiftRight(int32_t value, int shift)
+{
+	return (value < 0) ? ~(~value >> shift) : (value >> shift);
+}
+
+
+CORDIC_result CORDIC_model::Calculate(uint32_t amplitude, uint32_t angle, int iterations)
+{
+	int32_t x = (int32_t) amplitude;
+	int32_t y = 0;
+	int32_t angle_calc = 0;
+	int32_t angle_target = (int32_t) angle;
+	CORDIC_result result;
+	
+	if ((iterations < 1) || (iterations > CORDIC_ITERATIONS)) {iterations = CORDIC_ITERATIONS;}
+	
+	for (int i = 0; i < iterations; i++)
+	{
+		int32_t x_shifted = CORDIC_ShiftRight(x, i);
+		int32_t y_shifted = CORDIC_ShiftRight(y, i);
+	
+		//if current iteration of angle is lower than given angle, add next value, otherwise subtract it
+		if (angle_calc <= angle_target)
+		{
+			angle_calc = CORDIC_Add(angle_calc, angles[i]);
+			x = CORDIC_Sub(x, y_shifted);
+			y = CORDIC_Add(y, x_shifted);
+		}
+		else
+		{
+			angle_calc = CORDIC_Sub(angle_calc, angles[i]);
+			x = CORDIC_Add(x, y_shifted);
+			y = CORDIC_Sub(y, x_shifted);
+		}
+	}
+	
+	//unsigned(r_y) * C_K, 32 x 32 bits
+	result.sin = (uint64_t) (uint32_t) y * CORDIC_K;
+	result.cos = (uint64_t) (uint32_t) x * CORDIC_K;
+	
+	return result;
+}
+
+
+DDS_model::DDS_model(uint32_t FTW, uint32_t amplitude) : FTW(FTW), amplitude(amplitude), phase_acc(0)
+{
+}
+
+
+void DDS_model::Reset(void)
+{
+	phase_acc = 0;
+}
+
+
+uint32_t DDS_model::FoldPhase(uint32_t phase_acc)
+{
+	if (phase_acc <= 0x40000000U) {return phase_acc;}								//0 -> +90 degrees
+	else if (phase_acc <= 0x80000000U) {return 0x80000000U - phase_acc;}		//+90 -> +180 degrees
+	else if (phase_acc <= 0xC0000000U) {return phase_acc - 0x80000000U;}		//+180 -> +270 degrees
+	else {return 0xFFFFFFFFU - phase_acc;}													//+270 -> +360 degrees
+}
+
+
+uint32_t DDS_model::Code(uint32_t phase_acc, uint64_t sin)
+{
+	uint32_t sin_code = (uint32_t) (sin >> 30) & DDS_CODE_MASK;		//r_CORDIC_sin(49 downto 30)
+	
+	if (phase_acc <= 0x80000000U) {return (sin_code + DDS_DAC_OFFSET) & DDS_CODE_MASK;}
+	else {return (DDS_DAC_OFFSET - sin_code + 1) & DDS_CODE_MASK;}
+}
+
+
+uint32_t DDS_model::NextCode(void)
+{
+	CORDIC_result result = CORDIC_model::Calculate(amplitude, FoldPhase(phase_acc));
+	uint32_t code = Code(phase_acc, result.sin);
+	
+	phase_acc += FTW;		//increase angle by frequency tuning word
+	
+	return code;
+}
+
+
+void DDS_model::Generate(uint32_t *codes, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {codes[i] = NextCode();}
+}
+
+
+std::vector<uint32_t> DDS_model::Generate(size_t count)
+{
+	std::vector<uint32_t> codes(count);
+	
+	Generate(codes.data(), count);
+	
+	return codes;
+}
+
+
+uint32_t DDS_model::FrequencyToFTW(double frequency, double sample_rate)
+{
+	return (uint32_t) ((frequency * 4294967296.0) / sample_rate);
+}
@@ -0,0 +1,111 @@
+//=====================================================================
+//Bit-exact model of DDS.vhd and CORDIC.vhd of CLVB gateware
+//every register of VHDL is modeled with the same width and wrap-around,
+//so codes are equal to codes from simulation of gateware
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+
+#ifndef DDS_MODEL_H_
+#define DDS_MODEL_H_
+
+#define CORDIC_ITERATIONS				31					//r_i = 0 -> 30, then t_RESULT
+#define CORDIC_K								0x26DD3B6AU	//C_K, 0.607259350088812561694 (30 bits fraction)
+#define CORDIC_ANGLE_90					0x40000000U	//+90 degrees (X"FFFFFFFF" = 360 degrees)
+#define DDS_DAC_OFFSET					0x7FFFFU		//C_DAC_OFFSET, code for 0 V
+#define DDS_CODE_MASK						0xFFFFFU		//20-bit code of DAC11001B
+
+typedef struct
+{
+	uint64_t sin;		//o_sin, r_y * C_K
+	uint64_t cos;		//o_cos, r_x * C_K
+} CORDIC_result;
+
+class CORDIC_model
+{
+public:
+	/**
+	* @brief - calculate sin() and cos() as process p_CORDIC (31 iterations with angle table, multiplication by C_K)
+	* @param amplitude - i_amplitude (radius of circle)
+	* @param angle - i_angle, range 0 -> +90 degrees (0x00000000 -> 0x40000000)
+	* @param iterations - number of iterations, 1 -> CORDIC_ITERATIONS (lower values only for analysis of shorter CORDIC)
+	* @returns - o_sin and o_cos after o_done = 1
+	*/
+	static CORDIC_result Calculate(uint32_t amplitude, uint32_t angle, int iterations = CORDIC_ITERATIONS);
+	
+private:
+	static const int32_t angles[CORDIC_ITERATIONS];
+};
+
+class DDS_model
+{
+public:
+	DDS_model(uint32_t FTW = 0, uint32_t amplitude = 0);
+	
+	/**
+	* @brief - same as reset of DDS (i_rst), phase accumulator is cleared
+	* @returns - nothing
+	*/
+	void Reset(void);
+	
+	/**
+	* @brief - calculate code of next sample (one i_begin pulse), FTW is added to phase accumulator after calculation
+	* @returns - o_code after o_ready = 1 (20 bits)
+	*/
+	uint32_t NextCode(void);
+	
+	/**
+	* @brief - fill buffer with codes of consecutive samples
+	* @param codes - output buffer
+	* @param count - number of samples
+	* @returns - nothing
+	*/
+	void Generate(uint32_t *codes, size_t count);
+	
+	/**
+	* @brief - codes of consecutive samples
+	* @param count - number of samples
+	* @returns - vector of codes
+	*/
+	std::vector<uint32_t> Generate(size_t count);
+	
+	void SetFTW(uint32_t FTW) {this->FTW = FTW;}
+	void SetAmplitude(uint32_t amplitude) {this->amplitude = amplitude;}
+	uint32_t GetFTW(void) const {return FTW;}
+	uint32_t GetAmplitude(void) const {return amplitude;}
+	uint32_t GetPhase(void) const {return phase_acc;}
+	
+	/**
+	* @brief - angle for CORDIC (r_phase), phase accumulator folded into range 0 -> +90 degrees
+	* @param phase_acc - value of phase accumulator (r_phase_acc)
+	* @returns - folded angle
+	*/
+	static uint32_t FoldPhase(uint32_t phase_acc);
+	
+	/**
+	* @brief - DAC code from result of CORDIC, DAC offset is added in first half of period and subtracted in second half
+	* @param phase_acc - value of phase accumulator (r_phase_acc)
+	* @param sin - o_sin of CORDIC
+	* @returns - 20-bit code (o_code)
+	*/
+	static uint32_t Code(uint32_t phase_acc, uint64_t sin);
+	
+	/**
+	* @brief - FTW for given frequency (X"FFFFFFFF" = 360 degrees per sample), same rounding as control module
+	* @param frequency - frequency of signal in Hz
+	* @param sample_rate - sampling frequency in Hz (G_AC_GEN_FREQ)
+	* @returns - frequency tuning word
+	*/
+	static uint32_t FrequencyToFTW(double frequency, double sample_rate);
+	
+private:
+	uint32_t FTW;
+	uint32_t amplitude;
+	uint32_t phase_acc;
+};
+
+#endif
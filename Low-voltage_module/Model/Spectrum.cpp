@@ -0,0 +1,249 @@
+//=====================================================================
+//Spectral analysis of DAC code streams (AC mode of CLVB)
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include "Spectrum.h"
+#include <math.h>
+#include <string.h>
+#include <complex>
+#include <algorithm>
+
+
+//coefficients of cosine-sum windows, w(n) = a0 - a1 cos(2 pi n / N) + a2 cos(4 pi n / N) - ...
+static const double spectrum_rect[] = {1.0};
+static const double spectrum_hann[] = {0.5, 0.5};
+static const double spectrum_BH4[] = {0.35875, 0.48829, 0.14128, 0.01168};
+static const double spectrum_BH7[] = {0.27105140069342, 0.43329793923448, 0.21812299954311, 0.06592544638803,
+	0.01081174209837, 0.00077658482522, 0.00001388721735};
+
+
+//iterative radix-2 FFT, size of data must be power of 2
+static void Spectrum_FFT(std::vector<std::complex<double>> &data)
+{
+	size_t n = data.size();
+	
+	for (size_t i = 1, j = 0; i < n; i++)
+	{
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) {j ^= bit;}
+		j ^= bit;
+		if (i < j) {std::swap(data[i], data[j]);}
+	}
+	
+	for (size_t length = 2; length <= n; length <<= 1)
+	{
+		std::complex<double> step = std::polar(1.0, -2.0 * M_PI / length);
+		for (size_t i = 0; i < n; i += length)
+		{
+			std::complex<double> w(1.0, 0.0);
+			for (size_t k = 0; k < length / 2; k++)
+			{
+				std::complex<double> u = data[i + k];
+				std::complex<double> v = data[i + k + length / 2] * w;
+				data[i + k] = u + v;
+				data[i + k + length / 2] = u - v;
+				w *= step;
+			}
+		}
+	}
+}
+
+
+static double Spectrum_dB(double ratio)
+{
+	return (ratio > 0.0) ? (10.0 * log10(ratio)) : -400.0;
+}
+
+
+Spectrum_analyzer::Spectrum_analyzer(double sample_rate, unsigned int hold, Spectrum_window window, unsigned int harmonics,
+	unsigned int spurs) : sample_rate(sample_rate), hold((hold > 0) ? hold : 1), window(window),
+	harmonics(std::min(harmonics, (unsigned int) SPECTRUM_MAX_HARMONICS)), spurs(spurs)
+{
+}
+
+
+int Spectrum_analyzer::ParseWindow(const char *name, Spectrum_window *window)
+{
+	if (strcmp(name, "rect") == 0) {*window = SPECTRUM_WINDOW_RECT;}
+	else if (strcmp(name, "hann") == 0) {*window = SPECTRUM_WINDOW_HANN;}
+	else if (strcmp(name, "bh4") == 0) {*window = SPECTRUM_WINDOW_BH4;}
+	else if (strcmp(name, "bh7") == 0) {*window = SPECTRUM_WINDOW_BH7;}
+	else {return 1;}
+	
+	return 0;
+}
+
+
+//half width of main lobe in bins (power of tone is sum of bins in main lobe)
+unsigned int Spectrum_analyzer::LobeWidth(void) const
+{
+	switch (window)
+	{
+		case SPECTRUM_WINDOW_RECT: return 1;
+		case SPECTRUM_WINDOW_HANN: return 3;
+		case SPECTRUM_WINDOW_BH4: return 5;
+		default: return 8;
+	}
+}
+
+
+//bins already assigned to other tones are skipped
+double Spectrum_analyzer::TonePower(size_t bin, size_t first, size_t last, const std::vector<uint8_t> &used) const
+{
+	size_t lobe = LobeWidth();
+	size_t from = (bin > first + lobe) ? (bin - lobe) : first;
+	size_t to = std::min(bin + lobe, last);
+	double sum = 0.0;
+	
+	for (size_t i = from; i <= to; i++)
+	{
+		if (!used[i]) {sum += power[i];}
+	}
+	
+	return sum;
+}
+
+
+size_t Spectrum_analyzer::LargestBin(size_t first, size_t last, const std::vector<uint8_t> &used) const
+{
+	size_t largest = first;
+	double largest_power = -1.0;
+	
+	for (size_t i = first; i <= last; i++)
+	{
+		if ((!used[i]) && (power[i] > largest_power))
+		{
+			largest = i;
+			largest_power = power[i];
+		}
+	}
+	
+	return largest;
+}
+
+
+int Spectrum_analyzer::Analyze(const uint32_t *codes, size_t count, Spectrum_result *result)
+{
+	if ((count < 64) || ((count & (count - 1)) != 0)) {return 1;}
+	
+	const double *coefficients = spectrum_BH7;
+	size_t terms = sizeof(spectrum_BH7) / sizeof(spectrum_BH7[0]);
+	size_t points = count * hold;
+	size_t lobe = LobeWidth();
+	size_t nyquist = count / 2;			//bin of fs / 2, bins above are images of zero-order hold
+	double bin_width = sample_rate / count;
+	double mean = 0.0, window_energy = 0.0;
+	std::vector<std::complex<double>> data(points);
+	std::vector<uint8_t> used(points / 2 + 1, 0);
+	
+	if (hold & (hold - 1)) {return 1;}
+	
+	switch (window)
+	{
+		case SPECTRUM_WINDOW_RECT: coefficients = spectrum_rect; terms = 1; break;
+		case SPECTRUM_WINDOW_HANN: coefficients = spectrum_hann; terms = 2; break;
+		case SPECTRUM_WINDOW_BH4: coefficients = spectrum_BH4; terms = 4; break;
+		default: break;
+	}
+	
+	for (size_t i = 0; i < count; i++) {mean += codes[i];}
+	mean /= count;
+	
+	//zero-order hold, every code stays on DAC output for whole sampling period
+	for (size_t i = 0; i < points; i++)
+	{
+		double w = 0.0;
+		for (size_t t = 0; t < terms; t++)
+		{
+			w += ((t & 1) ? -1.0 : 1.0) * coefficients[t] * cos(2.0 * M_PI * t * i / points);
+		}
+		data[i] = std::complex<double>((codes[i / hold] - mean) * w, 0.0);
+		window_energy += w * w;
+	}
+	
+	Spectrum_FFT(data);
+	
+	//one-sided power relative to power of full scale sine (A^2 / 2)
+	power.assign(points / 2 + 1, 0.0);
+	spectrum_dBFS.assign(points / 2 + 1, 0.0);
+	for (size_t i = 0; i <= points / 2; i++)
+	{
+		double scale = ((i == 0) || (i == points / 2)) ? 1.0 : 2.0;
+		power[i] = scale * std::norm(data[i]) / (points * window_energy) / (SPECTRUM_FULL_SCALE * SPECTRUM_FULL_SCALE / 2.0);
+		spectrum_dBFS[i] = Spectrum_dB(power[i]);
+	}
+	
+	//DC (removed mean and leakage of window) is not part of signal
+	for (size_t i = 0; i <= lobe; i++) {used[i] = 1;}
+	
+	size_t fundamental = LargestBin(lobe + 1, nyquist, used);
+	double fundamental_power = TonePower(fundamental, lobe + 1, nyquist, used);
+	if (fundamental_power <= 0.0) {return 1;}
+	for (size_t i = fundamental - std::min(fundamental, lobe); i <= std::min(fundamental + lobe, nyquist); i++) {used[i] = 1;}
+	
+	double f0 = fundamental * bin_width;
+	double x = M_PI * f0 / sample_rate;
+	
+	result->fundamental_frequency = f0;
+	result->fundamental_level = Spectrum_dB(fundamental_power);
+	result->ZOH_droop = (hold > 1) ? (20.0 * log10(fabs(sin(x) / x))) : 0.0;
+	result->spurs.clear();
+	
+	//harmonics aliased into first Nyquist zone, |k * f0 - m * fs|
+	size_t harmonic_bins[SPECTRUM_MAX_HARMONICS + 1] = {0};
+	std::vector<uint8_t> harmonic_used = used;
+	double harmonic_power = 0.0;
+	for (unsigned int k = 2; k <= harmonics; k++)
+	{
+		size_t bin = (k * fundamental) % count;
+		if (bin > nyquist) {bin = count - bin;}
+		harmonic_bins[k] = bin;
+		if (harmonic_used[bin]) {continue;}			//harmonic on DC, fundamental or lower harmonic
+		harmonic_power += TonePower(bin, lobe + 1, nyquist, harmonic_used);
+		for (size_t i = bin - std::min(bin, lobe); i <= std::min(bin + lobe, nyquist); i++) {harmonic_used[i] = 1;}
+	}
+	
+	double noise_distortion = 0.0;
+	for (size_t i = 0; i <= nyquist; i++)
+	{
+		if (!used[i]) {noise_distortion += power[i];}
+	}
+	
+	result->THD = Spectrum_dB(harmonic_power / fundamental_power);
+	result->SINAD = Spectrum_dB(fundamental_power / noise_distortion);
+	result->SNR = Spectrum_dB(fundamental_power / std::max(noise_distortion - harmonic_power, 1e-300));
+	result->ENOB = (result->SINAD - 1.76) / 6.02;
+	
+	//spurs, largest remaining tones in first Nyquist zone
+	std::vector<uint8_t> spur_used = used;
+	result->SFDR = 400.0;
+	for (unsigned int s = 0; s < spurs; s++)
+	{
+		size_t bin = LargestBin(lobe + 1, nyquist, spur_used);
+		if (spur_used[bin]) {break;}
+	
+		Spectrum_spur spur = {bin * bin_width, Spectrum_dB(TonePower(bin, lobe + 1, nyquist, spur_used) / fundamental_power), 0};
+		for (unsigned int k = 2; k <= harmonics; k++)
+		{
+			size_t distance = (bin > harmonic_bins[k]) ? (bin - harmonic_bins[k]) : (harmonic_bins[k] - bin);
+			if (distance <= lobe) {spur.harmonic = k; break;}
+		}
+		if (s == 0) {result->SFDR = -spur.level;}
+		result->spurs.push_back(spur);
+	
+		for (size_t i = bin - std::min(bin, lobe); i <= std::min(bin + lobe, nyquist); i++) {spur_used[i] = 1;}
+	}
+	
+	//images of zero-order hold around multiples of fs
+	result->image_level = 0.0;
+	result->image_frequency = 0.0;
+	if (hold > 1)
+	{
+		size_t image = LargestBin(nyquist + 1, points / 2, used);
+		result->image_level = Spectrum_dB(TonePower(image, nyquist + 1, points / 2, used) / fundamental_power);
+		result->image_frequency = image * bin_width;
+	}
+	
+	return 0;
+}
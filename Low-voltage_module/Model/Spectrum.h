@@ -0,0 +1,99 @@
+//=====================================================================
+//Spectral analysis of DAC code streams (AC mode of CLVB)
+//windowed FFT of DAC output with zero-order hold, THD, SFDR, SINAD,
+//ENOB and largest spurs in first Nyquist zone of DAC
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+
+#ifndef SPECTRUM_H_
+#define SPECTRUM_H_
+
+#define SPECTRUM_FULL_SCALE				524287.0		//amplitude of full scale sine in LSB (DDS_DAC_OFFSET)
+#define SPECTRUM_MAX_HARMONICS			32
+
+typedef enum
+{
+	SPECTRUM_WINDOW_RECT,		//only for coherent sampling (integer number of periods in record)
+	SPECTRUM_WINDOW_HANN,
+	SPECTRUM_WINDOW_BH4,			//4-term Blackman-Harris, sidelobes -92 dB
+	SPECTRUM_WINDOW_BH7			//7-term Blackman-Harris, sidelobes -180 dB (below quantization noise of 20-bit DAC)
+} Spectrum_window;
+
+typedef struct
+{
+	double frequency;		//Hz
+	double level;				//dBc
+	int harmonic;				//order of harmonic, 0 if spur is not harmonic of fundamental
+} Spectrum_spur;
+
+typedef struct
+{
+	double fundamental_frequency;	//Hz, frequency of largest bin in first Nyquist zone
+	double fundamental_level;			//dBFS, measured on DAC output (includes droop of zero-order hold)
+	double ZOH_droop;						//dB, attenuation of fundamental by zero-order hold, sinc(f / fs)
+	double THD;								//dBc, harmonics 2 -> n (aliased into first Nyquist zone)
+	double SFDR;								//dBc, fundamental against largest spur
+	double SINAD;								//dB, fundamental against noise + distortion
+	double SNR;								//dB, fundamental against noise without harmonics
+	double ENOB;								//bits, (SINAD - 1.76) / 6.02
+	double image_level;						//dBc, largest image above fs / 2 (only for hold > 1), 0 otherwise
+	double image_frequency;				//Hz
+	std::vector<Spectrum_spur> spurs;	//largest spurs, sorted from largest
+} Spectrum_result;
+
+class Spectrum_analyzer
+{
+public:
+	/**
+	* @param sample_rate - sampling frequency of DAC in Hz (G_AC_GEN_FREQ)
+	* @param hold - points per DAC sample in zero-order hold (1 = no hold, only samples are analysed)
+	* @param window - window function
+	* @param harmonics - highest harmonic included in THD
+	* @param spurs - number of spurs in result
+	*/
+	Spectrum_analyzer(double sample_rate, unsigned int hold = 8, Spectrum_window window = SPECTRUM_WINDOW_BH7,
+		unsigned int harmonics = 9, unsigned int spurs = 5);
+	
+	/**
+	* @brief - analyse DAC codes, number of codes must be power of 2
+	* @param codes - 20-bit DAC codes (DDS_model or simulation of DDS.vhd)
+	* @param count - number of codes
+	* @param result - result of analysis
+	* @returns - 0 if successful, 1 if count is not power of 2 or there is no fundamental
+	*/
+	int Analyze(const uint32_t *codes, size_t count, Spectrum_result *result);
+	
+	/**
+	* @brief - power spectrum of last analysis
+	* @returns - power of bins in dBFS, bin i is frequency i * sample_rate / count (up to hold * sample_rate / 2)
+	*/
+	const std::vector<double> &GetSpectrum(void) const {return spectrum_dBFS;}
+	
+	/**
+	* @brief - window name for command line ("rect", "hann", "bh4", "bh7")
+	* @param name - name of window
+	* @param window - parsed window
+	* @returns - 0 if successful, 1 if name is unknown
+	*/
+	static int ParseWindow(const char *name, Spectrum_window *window);
+	
+private:
+	double sample_rate;
+	unsigned int hold;
+	Spectrum_window window;
+	unsigned int harmonics;
+	unsigned int spurs;
+	std::vector<double> power;				//power of bins relative to full scale (linear)
+	std::vector<double> spectrum_dBFS;
+	
+	unsigned int LobeWidth(void) const;
+	double TonePower(size_t bin, size_t first, size_t last, const std::vector<uint8_t> &used) const;
+	size_t LargestBin(size_t first, size_t last, const std::vector<uint8_t> &used) const;
+};
+
+#endif
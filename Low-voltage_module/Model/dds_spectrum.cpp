@@ -0,0 +1,272 @@
+//=====================================================================
+//Spectral quality of AC waveforms of CLVB (THD, SFDR, SINAD, ENOB)
+//codes are generated by DDS model for every frequency and amplitude,
+//or read from file (dds_model output or results of tb_DDS_vectors)
+//phase truncation and number of CORDIC iterations can be changed
+//to compare variants of DDS.vhd before changes of gateware
+//by Martin Praznovsky, 2025
+//=====================================================================
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <vector>
+#include "DDS_model.h"
+#include "Spectrum.h"
+
+
+#define SPECTRUM_SAMPLE_RATE				100000.0		//G_AC_GEN_FREQ of main
+#define SPECTRUM_MAX_SETTINGS			64
+
+
+static void Spectrum_PrintUsage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s -f FTW[,FTW...] | -F frequency[,frequency...] -a amplitude[,amplitude...] [options]\n"
+		"       %s -i file [-b] [-f FTW -a amplitude] [options]\n"
+		"-f FTW          frequency tuning words (decimal or 0x hex, separated by commas)\n"
+		"-F frequency    frequencies in Hz, FTW is calculated for sample rate\n"
+		"-a amplitude    amplitudes (register I bits 23 - 4)\n"
+		"-i file         codes from file, text (last hex number of line is code) or binary (-b, uint32)\n"
+		"                results of tb_DDS_vectors: first vector, or vector selected by -f and -a\n"
+		"-s sample_rate  sampling frequency of DAC in Hz (default 100000)\n"
+		"-n samples      number of samples, power of 2 (default 16384)\n"
+		"-z hold         points per sample of zero-order hold, power of 2 (default 8, 1 = samples only)\n"
+		"-w window       rect, hann, bh4, bh7 (default bh7)\n"
+		"-H harmonic     highest harmonic in THD (default 9)\n"
+		"-p bits         phase bits used by CORDIC, lower bits of phase accumulator are cleared (default 32)\n"
+		"-I iterations   CORDIC iterations (default 31, as CORDIC.vhd)\n"
+		"-v              print largest spurs of every setting\n"
+		"-d file         write spectrum of last setting (\"frequency dBFS\" per line)\n",
+		name, name);
+}
+
+
+//list of numbers separated by commas
+static size_t Spectrum_ParseList(char *text, double *values, size_t max)
+{
+	size_t count = 0;
+	
+	for (char *item = strtok(text, ","); (item != NULL) && (count < max); item = strtok(NULL, ","))
+	{
+		values[count++] = (strncmp(item, "0x", 2) == 0) ? (double) strtoul(item, NULL, 16) : atof(item);
+	}
+	
+	return count;
+}
+
+
+/**
+* @brief - read codes from text or binary file, in results of tb_DDS_vectors only one vector is used
+* @returns - 0 if successful, 1 if file can not be opened
+*/
+static int Spectrum_ReadCodes(const char *name, uint8_t binary, int64_t FTW, int64_t amplitude, std::vector<uint32_t> &codes,
+	size_t max)
+{
+	FILE *file = fopen(name, binary ? "rb" : "r");
+	char line[128];
+	int64_t vector_FTW = -1, vector_amplitude = -1;
+	
+	if (file == NULL) {perror(name); return 1;}
+	
+	if (binary)
+	{
+		uint8_t bytes[4];
+		while ((codes.size() < max) && (fread(bytes, 1, 4, file) == 4))
+		{
+			codes.push_back(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24));
+		}
+	}
+	else
+	{
+		while ((codes.size() < max) && (fgets(line, sizeof(line), file) != NULL))
+		{
+			unsigned int line_FTW, line_amplitude, code;
+			unsigned long long line_index;
+	
+			if (sscanf(line, "%x %x %llu %x", &line_FTW, &line_amplitude, &line_index, &code) == 4)
+			{
+				if (((FTW >= 0) && (line_FTW != FTW)) || ((amplitude >= 0) && (line_amplitude != amplitude))) {continue;}
+				if (vector_FTW < 0) {vector_FTW = line_FTW; vector_amplitude = line_amplitude;}
+				if ((line_FTW != vector_FTW) || (line_amplitude != vector_amplitude)) {break;}
+				codes.push_back(code);
+			}
+			else
+			{
+				char *last = strrchr(line, ' ');
+				if (sscanf((last != NULL) ? last : line, "%x", &code) == 1) {codes.push_back(code);}
+			}
+		}
+	}
+	
+	fclose(file);
+	
+	return 0;
+}
+
+
+//codes of DDS with phase truncation and shorter CORDIC, same as DDS_model for 32 bits and CORDIC_ITERATIONS
+static void Spectrum_GenerateCodes(uint32_t FTW, uint32_t amplitude, unsigned int phase_bits, int iterations,
+	std::vector<uint32_t> &codes)
+{
+	uint32_t mask = (phase_bits >= 32) ? 0xFFFFFFFFU : ~(0xFFFFFFFFU >> phase_bits);
+	uint32_t phase_acc = 0;
+	
+	for (size_t i = 0; i < codes.size(); i++)
+	{
+		uint32_t phase = phase_acc & mask;
+		CORDIC_result result = CORDIC_model::Calculate(amplitude, DDS_model::FoldPhase(phase), iterations);
+		codes[i] = DDS_model::Code(phase, result.sin);
+		phase_acc += FTW;
+	}
+}
+
+
+static void Spectrum_PrintResult(const char *FTW, const char *amplitude, const Spectrum_result *result, uint8_t verbose)
+{
+	printf("%-9s %-6s %11.3f %8.2f %7.3f", FTW, amplitude, result->fundamental_frequency, result->fundamental_level,
+		result->ZOH_droop);
+	//all harmonics aliased onto DC or fundamental (f0 = fs / 3, fs / 4, ...)
+	if (result->THD > -300.0) {printf(" %8.2f", result->THD);}
+	else {printf(" %8s", "-");}
+	printf(" %8.2f %8.2f %8.2f %6.2f", result->SFDR, result->SINAD, result->SNR, result->ENOB);
+	if (result->image_frequency > 0.0) {printf(" %8.2f @ %.1f\n", result->image_level, result->image_frequency);}
+	else {printf("        -\n");}
+	
+	if (verbose)
+	{
+		for (size_t i = 0; i < result->spurs.size(); i++)
+		{
+			printf("    spur %zu: %12.3f Hz %8.2f dBc", i + 1, result->spurs[i].frequency, result->spurs[i].level);
+			if (result->spurs[i].harmonic) {printf(" (H%d)", result->spurs[i].harmonic);}
+			printf("\n");
+		}
+	}
+}
+
+
+static void Spectrum_PrintHeader(void)
+{
+	printf("%-9s %-6s %11s %8s %7s %8s %8s %8s %8s %6s %s\n", "FTW", "ampl.", "f0 [Hz]", "f0[dBFS]", "ZOH[dB]", "THD[dBc]",
+		"SFDR[dB]", "SINAD", "SNR", "ENOB", "image[dBc] @ Hz");
+}
+
+
+static int Spectrum_WriteSpectrum(const char *name, const Spectrum_analyzer &analyzer, double bin_width)
+{
+	FILE *file = fopen(name, "w");
+	
+	if (file == NULL) {perror(name); return 1;}
+	
+	const std::vector<double> &spectrum = analyzer.GetSpectrum();
+	for (size_t i = 0; i < spectrum.size(); i++) {fprintf(file, "%.3f %.2f\n", i * bin_width, spectrum[i]);}
+	
+	fclose(file);
+	
+	return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+	double FTWs[SPECTRUM_MAX_SETTINGS], frequencies[SPECTRUM_MAX_SETTINGS], amplitudes[SPECTRUM_MAX_SETTINGS];
+	size_t FTW_count = 0, frequency_count = 0, amplitude_count = 0;
+	double sample_rate = SPECTRUM_SAMPLE_RATE;
+	size_t samples = 16384;
+	unsigned int hold = 8, harmonics = 9, phase_bits = 32;
+	int iterations = CORDIC_ITERATIONS;
+	Spectrum_window window = SPECTRUM_WINDOW_BH7;
+	const char *input = NULL, *dump = NULL;
+	uint8_t binary = 0, verbose = 0;
+	int option;
+	
+	while ((option = getopt(argc, argv, "f:F:a:i:bs:n:z:w:H:p:I:vd:h")) != -1)
+	{
+		switch (option)
+		{
+			case 'f': FTW_count = Spectrum_ParseList(optarg, FTWs, SPECTRUM_MAX_SETTINGS); break;
+			case 'F': frequency_count = Spectrum_ParseList(optarg, frequencies, SPECTRUM_MAX_SETTINGS); break;
+			case 'a': amplitude_count = Spectrum_ParseList(optarg, amplitudes, SPECTRUM_MAX_SETTINGS); break;
+			case 'i': input = optarg; break;
+			case 'b': binary = 1; break;
+			case 's': sample_rate = atof(optarg); break;
+			case 'n': samples = strtoul(optarg, NULL, 0); break;
+			case 'z': hold = strtoul(optarg, NULL, 0); break;
+			case 'w':
+				if (Spectrum_analyzer::ParseWindow(optarg, &window)) {Spectrum_PrintUsage(argv[0]); return 1;}
+				break;
+			case 'H': harmonics = strtoul(optarg, NULL, 0); break;
+			case 'p': phase_bits = strtoul(optarg, NULL, 0); break;
+			case 'I': iterations = atoi(optarg); break;
+			case 'v': verbose = 1; break;
+			case 'd': dump = optarg; break;
+			default: Spectrum_PrintUsage(argv[0]); return 1;
+		}
+	}
+	
+	for (size_t i = 0; i < frequency_count; i++) {FTWs[i] = DDS_model::FrequencyToFTW(frequencies[i], sample_rate);}
+	if (frequency_count > 0) {FTW_count = frequency_count;}
+	
+	if ((samples < 64) || (samples & (samples - 1)) || (hold == 0) || (hold & (hold - 1)))
+	{
+		fprintf(stderr, "number of samples and hold must be power of 2\n");
+		return 1;
+	}
+	
+	Spectrum_analyzer analyzer(sample_rate, hold, window, harmonics);
+	Spectrum_result result;
+	std::vector<uint32_t> codes(samples);
+	
+	if (input != NULL)
+	{
+		char FTW_text[16] = "-", amplitude_text[16] = "-";
+		int64_t FTW = (FTW_count > 0) ? (int64_t) FTWs[0] : -1;
+		int64_t amplitude = (amplitude_count > 0) ? (int64_t) amplitudes[0] : -1;
+	
+		codes.clear();
+		if (Spectrum_ReadCodes(input, binary, FTW, amplitude, codes, samples)) {return 1;}
+		if (codes.size() < samples)
+		{
+			fprintf(stderr, "%s: %zu codes, %zu required\n", input, codes.size(), samples);
+			return 1;
+		}
+		if (FTW >= 0) {snprintf(FTW_text, sizeof(FTW_text), "%08X", (uint32_t) FTW);}
+		if (amplitude >= 0) {snprintf(amplitude_text, sizeof(amplitude_text), "%05X", (uint32_t) amplitude);}
+	
+		if (analyzer.Analyze(codes.data(), samples, &result)) {fprintf(stderr, "%s: no signal\n", input); return 1;}
+		Spectrum_PrintHeader();
+		Spectrum_PrintResult(FTW_text, amplitude_text, &result, verbose);
+		return (dump != NULL) ? Spectrum_WriteSpectrum(dump, analyzer, sample_rate / samples) : 0;
+	}
+	
+	if ((FTW_count == 0) || (amplitude_count == 0))
+	{
+		Spectrum_PrintUsage(argv[0]);
+		return 1;
+	}
+	
+	printf("%zu samples at %.0f Hz, hold %u, phase %u bits, %d CORDIC iterations\n", samples, sample_rate, hold, phase_bits,
+		iterations);
+	Spectrum_PrintHeader();
+	for (size_t f = 0; f < FTW_count; f++)
+	{
+		for (size_t a = 0; a < amplitude_count; a++)
+		{
+			char FTW_text[16], amplitude_text[16];
+	
+			snprintf(FTW_text, sizeof(FTW_text), "%08X", (uint32_t) FTWs[f]);
+			snprintf(amplitude_text, sizeof(amplitude_text), "%05X", (uint32_t) amplitudes[a]);
+			Spectrum_GenerateCodes((uint32_t) FTWs[f], (uint32_t) amplitudes[a], phase_bits, iterations, codes);
+			if (analyzer.Analyze(codes.data(), samples, &result))
+			{
+				printf("%-9s %-6s no signal\n", FTW_text, amplitude_text);
+				continue;
+			}
+			Spectrum_PrintResult(FTW_text, amplitude_text, &result, verbose);
+		}
+	}
+	
+	return (dump != NULL) ? Spectrum_WriteSpectrum(dump, analyzer, sample_rate / samples) : 0;
+}
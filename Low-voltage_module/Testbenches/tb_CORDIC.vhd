@@ -0,0 +1,142 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use IEEE.MATH_REAL.ALL;
+use work.tb_utils_pkg.all;
+
+
+-- testbench tb_CORDIC sweeps angle from 0° to +90° for several amplitudes
+-- results are compared with sin() and cos() from IEEE.MATH_REAL, maximal error is 8 LSB + 1e-8 of amplitude
+-- at the end, maximal error, number of clock periods per calculation and calculations per second are reported
+entity tb_CORDIC is
+end tb_CORDIC;
+
+architecture Behavioral of tb_CORDIC is
+
+    component CORDIC
+        port(
+            i_clk               : in    std_logic;
+            i_rst               : in    std_logic;
+            i_begin             : in    std_logic;
+            i_amplitude         : in    unsigned(31 downto 0);
+            i_angle             : in    unsigned(31 downto 0);
+            o_done              : out   std_logic;
+            o_sin               : out   unsigned(63 downto 0);
+            o_cos               : out   unsigned(63 downto 0)
+            );
+    end component;
+
+    -- C_ANGLE_STEPS            - number of steps between 0° and +90°
+    -- C_AMPLITUDES             - tested amplitudes (DDS maximum, small amplitude, maximum for 32-bit signed x and y)
+    -- C_TOLERANCE_LSB          - allowed absolute error
+    -- C_TOLERANCE_REL          - allowed error relative to amplitude
+
+    type        t_amplitude_array is array (natural range <>) of unsigned(31 downto 0);
+
+    constant    C_ANGLE_STEPS       : positive              := 256;
+    constant    C_AMPLITUDES        : t_amplitude_array     := (X"00080000", X"00001000", X"40000000");
+    constant    C_TOLERANCE_LSB     : real                  := 8.0;
+    constant    C_TOLERANCE_REL     : real                  := 1.0e-8;
+
+    signal      r_clk               : std_logic                         := '0';
+    signal      r_rst               : std_logic                         := '1';
+    signal      r_begin             : std_logic                         := '0';
+    signal      r_amplitude         : unsigned(31 downto 0)             := (others => '0');
+    signal      r_angle             : unsigned(31 downto 0)             := (others => '0');
+    signal      r_done              : std_logic;
+    signal      r_sin               : unsigned(63 downto 0);
+    signal      r_cos               : unsigned(63 downto 0);
+
+    -- function converts result of CORDIC (30 bits fraction) to real number
+    function f_result_to_real(result : unsigned(63 downto 0)) return real is
+    begin
+        return real(to_integer(result(60 downto 30))) + real(to_integer(result(29 downto 0))) / 2.0**30;
+    end function;
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_stimulus starts calculation for every amplitude and angle and checks results
+    p_stimulus : process
+        variable v_errors       : natural := 0;
+        variable v_angle        : unsigned(31 downto 0);
+        variable v_theta        : real;
+        variable v_amplitude    : real;
+        variable v_error_sin    : real;
+        variable v_error_cos    : real;
+        variable v_tolerance    : real;
+        variable v_max_error    : real := 0.0;
+        variable v_cycles       : natural;
+        variable v_max_cycles   : natural := 0;
+    begin
+        wait for 10 * C_CLK_PERIOD;
+        r_rst <= '0';
+        wait for 10 * C_CLK_PERIOD;
+
+        for a in C_AMPLITUDES'range loop
+            v_amplitude := real(to_integer(C_AMPLITUDES(a)));
+            v_tolerance := C_TOLERANCE_LSB + C_TOLERANCE_REL * v_amplitude;
+            for step in 0 to C_ANGLE_STEPS + 1 loop
+                if (step <= C_ANGLE_STEPS) then
+                    v_angle := to_unsigned(step * (16#40000000# / C_ANGLE_STEPS), 32);
+                else
+                    v_angle := X"00000001";         -- smallest angle
+                end if;
+
+                wait until rising_edge(r_clk);
+                r_amplitude <= C_AMPLITUDES(a);
+                r_angle <= v_angle;
+                r_begin <= '1';
+                wait until rising_edge(r_clk);
+                r_begin <= '0';
+                v_cycles := 1;
+                loop
+                    wait until rising_edge(r_clk);
+                    v_cycles := v_cycles + 1;
+                    exit when r_done = '1';
+                    if (v_cycles > 100) then
+                        check(false, "CORDIC did not finish calculation", v_errors);
+                        exit;
+                    end if;
+                end loop;
+                if (v_cycles > v_max_cycles) then
+                    v_max_cycles := v_cycles;
+                end if;
+
+                check(r_sin(63 downto 61) = "000" and r_cos(63 downto 61) = "000",
+                    "result overflow at angle " & to_hstring(v_angle), v_errors);
+                v_theta := real(to_integer(v_angle(31 downto 1))) * 2.0 / 2.0**32 * MATH_2_PI;
+                v_error_sin := abs(f_result_to_real(r_sin) - v_amplitude * sin(v_theta));
+                v_error_cos := abs(f_result_to_real(r_cos) - v_amplitude * cos(v_theta));
+                check(v_error_sin <= v_tolerance, "sin error " & real'image(v_error_sin) & " at angle " & to_hstring(v_angle)
+                    & ", amplitude " & to_hstring(C_AMPLITUDES(a)), v_errors);
+                check(v_error_cos <= v_tolerance, "cos error " & real'image(v_error_cos) & " at angle " & to_hstring(v_angle)
+                    & ", amplitude " & to_hstring(C_AMPLITUDES(a)), v_errors);
+                v_max_error := realmax(v_max_error, realmax(v_error_sin, v_error_cos));
+            end loop;
+        end loop;
+
+        -- ============================== throughput =================================
+        report "maximal error: " & real'image(v_max_error) & " LSB";
+        report "calculation: " & integer'image(v_max_cycles) & " clock periods, "
+            & real'image(C_CLOCK_FREQ / real(v_max_cycles)) & " calculations/s";
+
+        tb_finish("tb_CORDIC", v_errors);
+        wait;
+    end process;
+
+    -- instance of CORDIC
+    instance_CORDIC : CORDIC
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_begin => r_begin,
+            i_amplitude => r_amplitude,
+            i_angle => r_angle,
+            o_done => r_done,
+            o_sin => r_sin,
+            o_cos => r_cos
+            );
+
+end Behavioral;
@@ -0,0 +1,138 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use IEEE.MATH_REAL.ALL;
+use work.tb_utils_pkg.all;
+
+
+-- testbench tb_DDS calculates samples of sine signal for several frequency tuning words and amplitudes
+-- every code is compared with ideal sine (DAC offset X"7FFFF" + amplitude * sin(phase)), maximal error is 8 LSB
+-- phase of sample n is n * FTW, DDS must add FTW to phase accumulator after every sample
+-- at the end, number of clock periods per sample and margin against sampling period of AC mode in main are reported
+entity tb_DDS is
+end tb_DDS;
+
+architecture Behavioral of tb_DDS is
+
+    component DDS
+        port(
+            i_clk               : in    std_logic;
+            i_rst               : in    std_logic;
+            i_begin             : in    std_logic;
+            i_FTW               : in    unsigned(31 downto 0);
+            i_amplitude         : in    unsigned(31 downto 0);
+            o_ready             : out   std_logic;
+            o_code              : out   std_logic_vector(19 downto 0)
+            );
+    end component;
+
+    -- C_AC_GEN_FREQ            - sampling frequency during AC mode (default generic of main)
+    -- C_AC_PERIOD              - clock periods between 2 samples in AC mode
+    -- C_DAC_OFFSET             - DAC code for 0 V
+    -- C_SAMPLES                - number of samples for every test case
+    -- C_TOLERANCE              - allowed difference from ideal code
+    -- C_FTWS                   - tested frequency tuning words (1 kHz, 10 kHz, 33.3 kHz at 100 kHz sampling, odd value)
+    -- C_AMPLITUDES             - tested amplitudes (largest amplitude without overflow of code, small amplitude)
+
+    type        t_word_array is array (natural range <>) of unsigned(31 downto 0);
+
+    constant    C_AC_GEN_FREQ       : positive          := 100000;
+    constant    C_AC_PERIOD         : positive          := natural(round(C_CLOCK_FREQ / real(C_AC_GEN_FREQ)));
+    constant    C_DAC_OFFSET        : real              := real(16#7FFFF#);
+    constant    C_SAMPLES           : positive          := 300;
+    constant    C_TOLERANCE         : real              := 8.0;
+    constant    C_FTWS              : t_word_array      := (X"028F5C29", X"19999999", X"55555555", X"0123ABCD");
+    constant    C_AMPLITUDES        : t_word_array      := (X"0007FFFF", X"00001000");
+
+    signal      r_clk               : std_logic                         := '0';
+    signal      r_rst               : std_logic                         := '1';
+    signal      r_begin             : std_logic                         := '0';
+    signal      r_FTW               : unsigned(31 downto 0)             := (others => '0');
+    signal      r_amplitude         : unsigned(31 downto 0)             := (others => '0');
+    signal      r_ready             : std_logic;
+    signal      r_code              : std_logic_vector(19 downto 0);
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_stimulus resets DDS (phase accumulator) before every test case and checks all samples
+    p_stimulus : process
+        variable v_errors       : natural := 0;
+        variable v_phase        : unsigned(31 downto 0);
+        variable v_expected     : real;
+        variable v_error        : real;
+        variable v_max_error    : real := 0.0;
+        variable v_cycles       : natural;
+        variable v_max_cycles   : natural := 0;
+    begin
+        for f in C_FTWS'range loop
+            for a in C_AMPLITUDES'range loop
+                r_rst <= '1';
+                r_FTW <= C_FTWS(f);
+                r_amplitude <= C_AMPLITUDES(a);
+                wait for 10 * C_CLK_PERIOD;
+                r_rst <= '0';
+                wait for 10 * C_CLK_PERIOD;
+                check(r_ready = '1', "DDS is not ready after reset", v_errors);
+
+                v_phase := (others => '0');
+                for n in 0 to C_SAMPLES - 1 loop
+                    wait until rising_edge(r_clk);
+                    r_begin <= '1';
+                    wait until rising_edge(r_clk);
+                    r_begin <= '0';
+                    v_cycles := 1;
+                    -- o_ready goes to 0 in the clock period after i_begin
+                    loop
+                        wait until rising_edge(r_clk);
+                        v_cycles := v_cycles + 1;
+                        exit when (r_ready = '1') and (v_cycles > 2);
+                        if (v_cycles > 200) then
+                            check(false, "DDS did not finish sample", v_errors);
+                            exit;
+                        end if;
+                    end loop;
+                    if (v_cycles > v_max_cycles) then
+                        v_max_cycles := v_cycles;
+                    end if;
+
+                    v_expected := C_DAC_OFFSET + real(to_integer(C_AMPLITUDES(a)))
+                        * sin(real(to_integer(v_phase(31 downto 1))) * 2.0 / 2.0**32 * MATH_2_PI);
+                    v_error := abs(real(to_integer(unsigned(r_code))) - v_expected);
+                    if (v_error > C_TOLERANCE) then
+                        check(false, "sample " & integer'image(n) & ", FTW " & to_hstring(C_FTWS(f)) & ", amplitude "
+                            & to_hstring(C_AMPLITUDES(a)) & ": code " & to_hstring(r_code) & ", expected "
+                            & real'image(v_expected), v_errors);
+                    end if;
+                    v_max_error := realmax(v_max_error, v_error);
+                    v_phase := v_phase + C_FTWS(f);
+                end loop;
+            end loop;
+        end loop;
+
+        check(v_max_cycles < C_AC_PERIOD, "DDS is slower than sampling period of AC mode", v_errors);
+
+        -- ============================== throughput =================================
+        report "maximal error: " & real'image(v_max_error) & " LSB";
+        report "sample: " & integer'image(v_max_cycles) & " clock periods, "
+            & real'image(C_CLOCK_FREQ / real(v_max_cycles)) & " samples/s, sampling period of AC mode "
+            & integer'image(C_AC_PERIOD) & " clock periods (" & integer'image(100 * v_max_cycles / C_AC_PERIOD) & " % used)";
+
+        tb_finish("tb_DDS", v_errors);
+        wait;
+    end process;
+
+    -- instance of DDS
+    instance_DDS : DDS
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_begin => r_begin,
+            i_FTW => r_FTW,
+            i_amplitude => r_amplitude,
+            o_ready => r_ready,
+            o_code => r_code
+            );
+
+end Behavioral;
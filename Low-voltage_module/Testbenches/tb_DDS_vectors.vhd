@@ -0,0 +1,132 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use STD.TEXTIO.ALL;
+use work.tb_utils_pkg.all;
+
+
+-- testbench tb_DDS_vectors runs DDS with vectors from file and writes every code into file
+-- used for cross-check of bit-exact model in ../Model (dds_model -V writes vectors, dds_model -C compares results)
+-- vector: "FTW amplitude samples" (hex, hex, decimal), DDS is reset before every vector
+-- result: "FTW amplitude index code" (hex, hex, decimal, hex) for every sample
+entity tb_DDS_vectors is
+    generic(
+        -- G_VECTORS        - file with vectors
+        -- G_RESULTS        - file for results
+        
+        G_VECTORS           : string    := "vectors.txt";
+        G_RESULTS           : string    := "ghdl_codes.txt"
+        );
+end tb_DDS_vectors;
+
+architecture Behavioral of tb_DDS_vectors is
+
+    component DDS
+        port(
+            i_clk               : in    std_logic;
+            i_rst               : in    std_logic;
+            i_begin             : in    std_logic;
+            i_FTW               : in    unsigned(31 downto 0);
+            i_amplitude         : in    unsigned(31 downto 0);
+            o_ready             : out   std_logic;
+            o_code              : out   std_logic_vector(19 downto 0)
+            );
+    end component;
+
+    signal      r_clk               : std_logic                         := '0';
+    signal      r_rst               : std_logic                         := '1';
+    signal      r_begin             : std_logic                         := '0';
+    signal      r_FTW               : unsigned(31 downto 0)             := (others => '0');
+    signal      r_amplitude         : unsigned(31 downto 0)             := (others => '0');
+    signal      r_ready             : std_logic;
+    signal      r_code              : std_logic_vector(19 downto 0);
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_stimulus reads vectors, runs DDS sample by sample and writes results
+    p_stimulus : process
+        file     f_vectors          : text;
+        file     f_results          : text;
+        variable v_status           : file_open_status;
+        variable v_line_in          : line;
+        variable v_line_out         : line;
+        variable v_FTW              : std_logic_vector(31 downto 0);
+        variable v_amplitude        : std_logic_vector(31 downto 0);
+        variable v_samples          : natural;
+        variable v_good             : boolean;
+        variable v_errors           : natural := 0;
+        variable v_vectors          : natural := 0;
+        variable v_codes            : natural := 0;
+    begin
+        file_open(v_status, f_vectors, G_VECTORS, read_mode);
+        check(v_status = open_ok, "can not open " & G_VECTORS, v_errors);
+        file_open(v_status, f_results, G_RESULTS, write_mode);
+        check(v_status = open_ok, "can not open " & G_RESULTS, v_errors);
+        if (v_errors /= 0) then
+            tb_finish("tb_DDS_vectors", v_errors);
+        end if;
+
+        while not endfile(f_vectors) loop
+            readline(f_vectors, v_line_in);
+            hread(v_line_in, v_FTW, v_good);
+            next when not v_good;
+            hread(v_line_in, v_amplitude, v_good);
+            next when not v_good;
+            read(v_line_in, v_samples, v_good);
+            next when not v_good;
+
+            -- reset clears phase accumulator of DDS
+            r_rst <= '1';
+            r_FTW <= unsigned(v_FTW);
+            r_amplitude <= unsigned(v_amplitude);
+            wait for 5 * C_CLK_PERIOD;
+            wait until rising_edge(r_clk);
+            r_rst <= '0';
+            wait until rising_edge(r_clk);
+
+            for n in 0 to v_samples - 1 loop
+                r_begin <= '1';
+                wait until rising_edge(r_clk);
+                r_begin <= '0';
+                wait until rising_edge(r_clk);
+                -- o_ready goes to 0 in the clock period after i_begin
+                while (r_ready /= '1') loop
+                    wait until rising_edge(r_clk);
+                end loop;
+                hwrite(v_line_out, v_FTW);
+                write(v_line_out, string'(" "));
+                hwrite(v_line_out, v_amplitude);
+                write(v_line_out, string'(" "));
+                write(v_line_out, n);
+                write(v_line_out, string'(" "));
+                hwrite(v_line_out, r_code);
+                writeline(f_results, v_line_out);
+                v_codes := v_codes + 1;
+            end loop;
+            v_vectors := v_vectors + 1;
+        end loop;
+
+        file_close(f_vectors);
+        file_close(f_results);
+        report integer'image(v_vectors) & " vectors, " & integer'image(v_codes) & " codes written into " & G_RESULTS;
+        check(v_codes > 0, "no vectors in " & G_VECTORS, v_errors);
+
+        tb_finish("tb_DDS_vectors", v_errors);
+        wait;
+    end process;
+
+    -- instance of DDS
+    instance_DDS : DDS
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_begin => r_begin,
+            i_FTW => r_FTW,
+            i_amplitude => r_amplitude,
+            o_ready => r_ready,
+            o_code => r_code
+            );
+
+end Behavioral;
@@ -0,0 +1,209 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use work.tb_utils_pkg.all;
+
+
+-- testbench tb_SPI_master sends frames back-to-back to model of DAC11001B (SPI mode 1)
+-- model samples MOSI on falling edges of SCLK and shifts reply to MISO on rising edges
+-- checked: sent and received data, number of SCLK edges, tCSS, tCSH, tCSHIGH and SCLK period from DAC11001B datasheet
+-- at the end, duration of one frame and number of frames per second are reported
+entity tb_SPI_master is
+end tb_SPI_master;
+
+architecture Behavioral of tb_SPI_master is
+
+    component SPI_master
+        generic(
+            G_CLOCK_FREQ        : real      := 12.0e6;
+            G_SCLK_FREQ         : positive  := 12000000
+            );
+        port(
+            i_clk               : in    std_logic;
+            i_rst               : in    std_logic;
+            i_begin             : in    std_logic;
+            i_data              : in    std_logic_vector(31 downto 0);
+            i_MISO              : in    std_logic;
+            o_MOSI              : out   std_logic;
+            o_CS                : out   std_logic;
+            o_SCLK              : out   std_logic;
+            o_SPI_valid         : out   std_logic;
+            o_SPI_busy          : out   std_logic;
+            o_data              : out   std_logic_vector(31 downto 0)
+            );
+    end component;
+
+    -- C_SCLK_FREQ              - SCLK frequency of tested instance
+    -- C_TCSS                   - DAC11001B, minimum time between CS falling edge and first SCLK falling edge
+    -- C_TCSH                   - DAC11001B, minimum time between last SCLK falling edge and CS rising edge
+    -- C_TCSHIGH                - DAC11001B, minimum time when CS is high between 2 frames
+    -- C_FRAMES                 - frames sent by master
+    -- C_REPLIES                - frames sent by DAC model
+
+    type        t_frame_array is array (natural range <>) of std_logic_vector(31 downto 0);
+
+    constant    C_SCLK_FREQ         : positive          := 12000000;
+    constant    C_TCSS              : time              := 18 ns;
+    constant    C_TCSH              : time              := 10 ns;
+    constant    C_TCSHIGH           : time              := 50 ns;
+    constant    C_FRAMES            : t_frame_array     := (X"01ABCDE0", X"AAAAAAAA", X"55555555", X"80000001", X"017FFFF0");
+    constant    C_REPLIES           : t_frame_array     := (X"C0FFEE00", X"12345678", X"FFFFFFFF", X"00000000", X"80000001");
+
+    signal      r_clk               : std_logic                         := '0';
+    signal      r_rst               : std_logic                         := '1';
+    signal      r_begin             : std_logic                         := '0';
+    signal      r_data_send         : std_logic_vector(31 downto 0)     := (others => '0');
+    signal      r_MISO              : std_logic                         := '0';
+    signal      r_MOSI              : std_logic;
+    signal      r_CS                : std_logic;
+    signal      r_SCLK              : std_logic;
+    signal      r_SPI_valid         : std_logic;
+    signal      r_SPI_busy          : std_logic;
+    signal      r_data_received     : std_logic_vector(31 downto 0);
+
+    -- r_frames                 - frames decoded by DAC model
+    -- r_frame_count            - number of frames decoded by DAC model
+    -- r_timing_errors          - number of violations of DAC11001B timing
+    -- r_frame_time             - time between CS falling edge and CS rising edge of last frame
+
+    signal      r_frames            : t_frame_array(0 to 15)            := (others => (others => '0'));
+    signal      r_frame_count       : natural                           := 0;
+    signal      r_timing_errors     : natural                           := 0;
+    signal      r_frame_time        : time                              := 0 ns;
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_DAC_model decodes frames on MOSI and checks SPI timing
+    p_DAC_model : process
+        variable v_frame        : std_logic_vector(31 downto 0);
+        variable v_reply        : std_logic_vector(31 downto 0);
+        variable v_bits         : natural;
+        variable v_cs_fall      : time;
+        variable v_cs_rise      : time      := 0 ns;
+        variable v_last_fall    : time;
+        variable v_errors       : natural   := 0;
+    begin
+        wait until r_rst = '0';
+        loop
+            wait until falling_edge(r_CS);
+            v_cs_fall := now;
+            if (v_cs_rise /= 0 ns) then
+                check(v_cs_fall - v_cs_rise >= C_TCSHIGH, "tCSHIGH violated", v_errors);
+            end if;
+            v_bits := 0;
+            if (r_frame_count < C_REPLIES'length) then
+                v_reply := C_REPLIES(r_frame_count);
+            else
+                v_reply := (others => '0');
+            end if;
+            r_MISO <= v_reply(31);
+            -- first rising edge of SCLK comes together with CS falling edge
+            loop
+                wait until falling_edge(r_SCLK) or rising_edge(r_SCLK) or rising_edge(r_CS);
+                exit when r_CS = '1';
+                if (r_SCLK = '0') then
+                    if (v_bits = 0) then
+                        check(now - v_cs_fall >= C_TCSS, "tCSS violated", v_errors);
+                    else
+                        check(now - v_last_fall >= 1 sec / C_SCLK_FREQ, "SCLK period is shorter than 1 / G_SCLK_FREQ", v_errors);
+                    end if;
+                    if (v_bits < 32) then
+                        v_frame(31 - v_bits) := r_MOSI;
+                    end if;
+                    v_bits := v_bits + 1;
+                    v_last_fall := now;
+                elsif (v_bits > 0) and (v_bits < 32) then
+                    r_MISO <= v_reply(31 - v_bits);     -- shift next bit out on rising edge
+                end if;
+            end loop;
+            v_cs_rise := now;
+            check(v_bits = 32, "frame has " & integer'image(v_bits) & " SCLK falling edges", v_errors);
+            check(v_cs_rise - v_last_fall >= C_TCSH, "tCSH violated", v_errors);
+            if (r_frame_count <= r_frames'high) then
+                r_frames(r_frame_count) <= v_frame;
+            end if;
+            r_frame_count <= r_frame_count + 1;
+            r_frame_time <= v_cs_rise - v_cs_fall;
+            r_timing_errors <= v_errors;
+        end loop;
+    end process;
+
+    -- process p_stimulus sends all frames back-to-back (new frame immediately after busy flag is cleared)
+    p_stimulus : process
+        variable v_errors       : natural := 0;
+        variable v_start        : time;
+        variable v_duration     : time;
+        variable v_valid_count  : natural := 0;
+    begin
+        wait for 10 * C_CLK_PERIOD;
+        r_rst <= '0';
+        wait for 10 * C_CLK_PERIOD;
+        check(r_CS = '1', "CS is not high after reset", v_errors);
+        check(r_SCLK = '0', "SCLK is not low after reset (CPOL = 0)", v_errors);
+
+        wait until rising_edge(r_clk);
+        v_start := now;
+        for i in C_FRAMES'range loop
+            r_data_send <= C_FRAMES(i);
+            r_begin <= '1';
+            wait until rising_edge(r_clk);
+            r_begin <= '0';
+            -- valid pulse comes when frame is finished and received data are in o_data
+            loop
+                wait until rising_edge(r_clk);
+                if (r_SPI_valid = '1') then
+                    v_valid_count := v_valid_count + 1;
+                    check(r_data_received = C_REPLIES(i), "frame " & integer'image(i) & " - wrong data from MISO", v_errors);
+                    check(r_SPI_busy = '0', "busy flag together with valid pulse", v_errors);
+                    exit;
+                end if;
+            end loop;
+            wait until rising_edge(r_clk);
+            check(r_SPI_valid = '0', "valid pulse longer than 1 clock period", v_errors);
+            if (i = C_FRAMES'high) then
+                v_duration := now - v_start;
+            end if;
+            -- next frame starts in next clock period, as in p_CLVB_DAC of main
+        end loop;
+
+        wait for 1 us;
+        check(v_valid_count = C_FRAMES'length, "missing valid pulses", v_errors);
+        check(r_frame_count = C_FRAMES'length, "DAC model received " & integer'image(r_frame_count) & " frames", v_errors);
+        for i in C_FRAMES'range loop
+            check(r_frames(i) = C_FRAMES(i), "frame " & integer'image(i) & " - wrong data on MOSI", v_errors);
+        end loop;
+        check(r_timing_errors = 0, "DAC11001B timing violated", v_errors);
+
+        -- ============================== throughput =================================
+        report "SPI frame (CS low): " & real'image(to_real(r_frame_time, 1 ns)) & " ns, "
+            & integer'image(r_frame_time / C_CLK_PERIOD) & " clock periods";
+        report "back-to-back frames: " & real'image(to_real(v_duration / C_FRAMES'length, 1 ns)) & " ns per frame, "
+            & real'image(real(C_FRAMES'length) / to_real(v_duration, 1 sec)) & " frames/s";
+
+        tb_finish("tb_SPI_master", v_errors);
+        wait;
+    end process;
+
+    -- instance of SPI_master
+    instance_SPI_master : SPI_master
+        generic map(
+            G_CLOCK_FREQ => C_CLOCK_FREQ,
+            G_SCLK_FREQ => C_SCLK_FREQ
+            )
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_begin => r_begin,
+            i_data => r_data_send,
+            i_MISO => r_MISO,
+            o_MOSI => r_MOSI,
+            o_CS => r_CS,
+            o_SCLK => r_SCLK,
+            o_SPI_valid => r_SPI_valid,
+            o_SPI_busy => r_SPI_busy,
+            o_data => r_data_received
+            );
+
+end Behavioral;
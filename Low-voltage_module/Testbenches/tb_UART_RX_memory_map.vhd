@@ -0,0 +1,170 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use work.tb_utils_pkg.all;
+
+
+-- testbench tb_UART_RX_memory_map sends strings to i_RX_pin and checks content of registers and strobes
+-- valid writes into all registers, \n and \r in both orders, rejected strings (lowercase, invalid digit, short string, broken terminator)
+-- at the end, time of register write and number of writes per second are reported
+entity tb_UART_RX_memory_map is
+end tb_UART_RX_memory_map;
+
+architecture Behavioral of tb_UART_RX_memory_map is
+
+    component UART_RX_memory_map
+        port(
+            i_clk           : in    std_logic;
+            i_rst           : in    std_logic;
+            i_RX_pin        : in    std_logic;
+            o_reg_G         : out   std_logic_vector(15 downto 0);
+            o_reg_H         : out   std_logic_vector(15 downto 0);
+            o_reg_I         : out   std_logic_vector(31 downto 0);
+            o_reg_J         : out   std_logic_vector(31 downto 0);
+            o_reg_K         : out   std_logic_vector(31 downto 0);
+            o_reg_G_strobe  : out   std_logic;
+            o_reg_H_strobe  : out   std_logic;
+            o_reg_I_strobe  : out   std_logic;
+            o_reg_J_strobe  : out   std_logic;
+            o_reg_K_strobe  : out   std_logic
+            );
+    end component;
+
+    -- r_strobes                - strobes of registers K, J, I, H, G (bits 4 - 0)
+    -- r_strobe_count           - number of strobe pulses of each register
+    -- r_strobe_errors          - number of strobes longer than 1 clock period
+    -- r_last_strobe_time       - time of last strobe pulse (any register)
+
+    type        t_count_array is array (0 to 4) of natural;
+
+    signal      r_clk               : std_logic                         := '0';
+    signal      r_rst               : std_logic                         := '1';
+    signal      r_RX_pin            : std_logic                         := '1';
+    signal      r_reg_G             : std_logic_vector(15 downto 0);
+    signal      r_reg_H             : std_logic_vector(15 downto 0);
+    signal      r_reg_I             : std_logic_vector(31 downto 0);
+    signal      r_reg_J             : std_logic_vector(31 downto 0);
+    signal      r_reg_K             : std_logic_vector(31 downto 0);
+    signal      r_strobes           : std_logic_vector(4 downto 0);
+    signal      r_strobe_count      : t_count_array                     := (others => 0);
+    signal      r_strobe_errors     : natural                           := 0;
+    signal      r_last_strobe_time  : time                              := 0 ns;
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_strobe_monitor counts strobe pulses and checks that each of them lasts exactly 1 clock period
+    p_strobe_monitor : process(r_clk)
+        variable v_last : std_logic_vector(4 downto 0) := (others => '0');
+    begin
+        if (rising_edge(r_clk)) then
+            for i in 0 to 4 loop
+                if (r_strobes(i) = '1') then
+                    if (v_last(i) = '1') then
+                        r_strobe_errors <= r_strobe_errors + 1;
+                        report "strobe longer than 1 clock period" severity error;
+                    else
+                        r_strobe_count(i) <= r_strobe_count(i) + 1;
+                        r_last_strobe_time <= now;
+                    end if;
+                end if;
+            end loop;
+            v_last := r_strobes;
+        end if;
+    end process;
+
+    -- process p_stimulus sends strings and checks registers after each of them
+    p_stimulus : process
+        variable v_errors       : natural := 0;
+        variable v_count        : t_count_array;
+        variable v_start        : time;
+        variable v_time_H       : time;
+        variable v_time_I       : time;
+    begin
+        wait for 10 * C_CLK_PERIOD;
+        r_rst <= '0';
+        wait for 10 * C_CLK_PERIOD;
+
+        -- ============================== valid writes ===============================
+        v_start := now;
+        uart_send_line(r_RX_pin, "H8001");
+        wait for C_BIT_TIME;
+        v_time_H := r_last_strobe_time - v_start;
+        check(r_reg_H = X"8001", "H8001 was not written", v_errors);
+
+        v_start := now;
+        uart_send_line(r_RX_pin, "I00ABCDE5");
+        wait for C_BIT_TIME;
+        v_time_I := r_last_strobe_time - v_start;
+        check(r_reg_I = X"00ABCDE5", "I00ABCDE5 was not written", v_errors);
+
+        uart_send_line(r_RX_pin, "J028F5C29");
+        wait for C_BIT_TIME;
+        check(r_reg_J = X"028F5C29", "J028F5C29 was not written", v_errors);
+
+        uart_send_line(r_RX_pin, "K02044440");
+        wait for C_BIT_TIME;
+        check(r_reg_K = X"02044440", "K02044440 was not written", v_errors);
+
+        uart_send_line(r_RX_pin, "G003F");
+        wait for C_BIT_TIME;
+        check(r_reg_G = X"003F", "G003F was not written", v_errors);
+
+        check(r_strobe_count = t_count_array'(1, 1, 1, 1, 1), "every register must have exactly 1 strobe", v_errors);
+
+        -- ============================== \r before \n ===============================
+        uart_send_string(r_RX_pin, "H1234" & CR & LF);
+        wait for C_BIT_TIME;
+        check(r_reg_H = X"1234", "H1234 with \r\n was not written", v_errors);
+        check(r_strobe_count(1) = 2, "H1234 with \r\n - missing strobe", v_errors);
+
+        -- ============================== rejected strings ===========================
+        v_count := r_strobe_count;
+
+        uart_send_line(r_RX_pin, "h00FF");         -- lowercase name of register
+        uart_send_line(r_RX_pin, "H00ff");         -- lowercase hex digits
+        uart_send_line(r_RX_pin, "H12G4");         -- invalid digit
+        uart_send_line(r_RX_pin, "H123");          -- short string
+        uart_send_line(r_RX_pin, "L0000");         -- nonexistent register
+        uart_send_string(r_RX_pin, "H4321" & LF & "0" & CR);      -- digit between \n and \r
+        wait for C_BIT_TIME;
+        check(r_strobe_count = v_count, "rejected string generated strobe", v_errors);
+        check(r_reg_H = X"1234", "rejected string changed register H", v_errors);
+
+        -- receiver must recover after rejected strings
+        uart_send_line(r_RX_pin, "H0018");
+        wait for C_BIT_TIME;
+        check(r_reg_H = X"0018", "valid string after rejected strings was not written", v_errors);
+
+        check(r_strobe_errors = 0, "strobe longer than 1 clock period", v_errors);
+
+        -- ============================== throughput =================================
+        report "register H write (7 bytes): " & real'image(to_real(v_time_H, 1 us)) & " us, "
+            & real'image(1.0 / to_real(v_time_H, 1 sec)) & " writes/s";
+        report "register I write (11 bytes): " & real'image(to_real(v_time_I, 1 us)) & " us, "
+            & real'image(1.0 / to_real(v_time_I, 1 sec)) & " writes/s";
+
+        tb_finish("tb_UART_RX_memory_map", v_errors);
+        wait;
+    end process;
+
+    -- instance of UART_RX_memory_map
+    instance_UART_RX_memory_map : UART_RX_memory_map
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_RX_pin => r_RX_pin,
+            o_reg_G => r_reg_G,
+            o_reg_H => r_reg_H,
+            o_reg_I => r_reg_I,
+            o_reg_J => r_reg_J,
+            o_reg_K => r_reg_K,
+            o_reg_G_strobe => r_strobes(0),
+            o_reg_H_strobe => r_strobes(1),
+            o_reg_I_strobe => r_strobes(2),
+            o_reg_J_strobe => r_strobes(3),
+            o_reg_K_strobe => r_strobes(4)
+            );
+
+end Behavioral;
@@ -0,0 +1,150 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use work.tb_utils_pkg.all;
+
+
+-- testbench tb_UART_TX_memory_map starts transmission of all registers and decodes bytes from o_TX_pin
+-- received string must be equal to name and content of all registers (50 bytes), busy flag is checked during transmission
+-- at the end, duration of transmission and throughput in bytes per second are reported
+entity tb_UART_TX_memory_map is
+end tb_UART_TX_memory_map;
+
+architecture Behavioral of tb_UART_TX_memory_map is
+
+    component UART_TX_memory_map
+        port(
+            i_clk               : in    std_logic;
+            i_rst               : in    std_logic;
+            i_begin             : in    std_logic;
+            i_reg_G             : in    std_logic_vector(15 downto 0);
+            i_reg_H             : in    std_logic_vector(15 downto 0);
+            i_reg_I             : in    std_logic_vector(31 downto 0);
+            i_reg_J             : in    std_logic_vector(31 downto 0);
+            i_reg_K             : in    std_logic_vector(31 downto 0);
+            i_name              : in    std_logic_vector(31 downto 0);
+            o_TX_pin            : out   std_logic;
+            o_TX_memory_busy    : out   std_logic
+            );
+    end component;
+
+    -- C_EXPECTED               - expected content of transmission for registers below
+    -- C_DUMP_LENGTH            - number of bytes in one transmission
+
+    constant    C_EXPECTED          : string    := "@CLVB" & LF & "G003F" & LF & "H8001" & LF & "I00ABCDE5" & LF
+                                                    & "J028F5C29" & LF & "K02044440" & LF & LF & CR;
+    constant    C_DUMP_LENGTH       : positive  := C_EXPECTED'length;
+
+    -- r_received               - bytes decoded from o_TX_pin
+    -- r_received_count         - number of decoded bytes
+    -- r_first_start_bit        - time of falling edge of first start bit
+    -- r_monitor_errors         - number of bytes without stop bit
+
+    signal      r_clk               : std_logic                         := '0';
+    signal      r_rst               : std_logic                         := '1';
+    signal      r_begin             : std_logic                         := '0';
+    signal      r_TX_pin            : std_logic;
+    signal      r_TX_memory_busy    : std_logic;
+    signal      r_received          : string(1 to 128)                  := (others => ' ');
+    signal      r_received_count    : natural                           := 0;
+    signal      r_first_start_bit   : time                              := 0 ns;
+    signal      r_monitor_errors    : natural                           := 0;
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_UART_monitor decodes every byte on o_TX_pin
+    p_UART_monitor : process
+        variable v_byte     : std_logic_vector(7 downto 0);
+        variable v_timeout  : boolean;
+    begin
+        wait until r_rst = '0';
+        loop
+            uart_receive_byte(r_TX_pin, 1 sec, v_byte, v_timeout);
+            if (not v_timeout) then
+                if (r_received_count = 0) then
+                    r_first_start_bit <= now - C_BIT_TIME * 9.5;    -- byte is decoded in the middle of stop bit
+                end if;
+                if (r_TX_pin /= '1') then
+                    r_monitor_errors <= r_monitor_errors + 1;
+                    report "missing stop bit" severity error;
+                end if;
+                if (r_received_count < r_received'length) then
+                    r_received(r_received_count + 1) <= to_char(v_byte);
+                end if;
+                r_received_count <= r_received_count + 1;
+            end if;
+        end loop;
+    end process;
+
+    -- process p_stimulus starts transmission and compares received string with expected one
+    p_stimulus : process
+        variable v_errors       : natural := 0;
+        variable v_begin_time   : time;
+        variable v_busy_time    : time;
+    begin
+        wait for 10 * C_CLK_PERIOD;
+        r_rst <= '0';
+        wait for 10 * C_CLK_PERIOD;
+        check(r_TX_memory_busy = '0', "busy flag after reset", v_errors);
+        check(r_TX_pin = '1', "TX pin is not idle after reset", v_errors);
+
+        -- ============================== transmission of registers ==================
+        wait until rising_edge(r_clk);
+        r_begin <= '1';
+        v_begin_time := now;
+        wait until rising_edge(r_clk);
+        r_begin <= '0';
+        wait for 2 * C_CLK_PERIOD;
+        check(r_TX_memory_busy = '1', "busy flag was not set", v_errors);
+
+        wait until r_TX_memory_busy = '0' for 100 ms;
+        v_busy_time := now - v_begin_time;
+        wait for C_BIT_TIME;            -- last byte is decoded in the middle of its stop bit
+
+        check(r_received_count = C_DUMP_LENGTH, "received " & integer'image(r_received_count) & " bytes, expected "
+            & integer'image(C_DUMP_LENGTH), v_errors);
+        check(r_received(1 to C_DUMP_LENGTH) = C_EXPECTED, "received string differs from content of registers", v_errors);
+        check(r_first_start_bit - v_begin_time < C_BIT_TIME, "first start bit is late", v_errors);
+        check(r_monitor_errors = 0, "missing stop bits", v_errors);
+
+        -- ============================== second transmission ========================
+        -- nothing is sent without i_begin pulse, next pulse sends whole dump again
+        wait for 10 ms;
+        check(r_received_count = C_DUMP_LENGTH, "bytes were sent without i_begin pulse", v_errors);
+        wait until rising_edge(r_clk);
+        r_begin <= '1';
+        wait until rising_edge(r_clk);
+        r_begin <= '0';
+        wait for 2 * C_CLK_PERIOD;
+        wait until r_TX_memory_busy = '0' for 100 ms;
+        wait for C_BIT_TIME;
+        check(r_received(C_DUMP_LENGTH + 1 to 2 * C_DUMP_LENGTH) = C_EXPECTED, "second dump differs from first one", v_errors);
+
+        -- ============================== throughput =================================
+        report "dump of registers (" & integer'image(C_DUMP_LENGTH) & " bytes): " & real'image(to_real(v_busy_time, 1 ms)) & " ms, "
+            & real'image(real(C_DUMP_LENGTH) / to_real(v_busy_time, 1 sec)) & " bytes/s, line limit "
+            & real'image(real(C_BAUD_RATE) / 10.0) & " bytes/s";
+
+        tb_finish("tb_UART_TX_memory_map", v_errors);
+        wait;
+    end process;
+
+    -- instance of UART_TX_memory_map
+    instance_UART_TX_memory_map : UART_TX_memory_map
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_begin => r_begin,
+            i_reg_G => X"003F",
+            i_reg_H => X"8001",
+            i_reg_I => X"00ABCDE5",
+            i_reg_J => X"028F5C29",
+            i_reg_K => X"02044440",
+            i_name => X"434C5642",
+            o_TX_pin => r_TX_pin,
+            o_TX_memory_busy => r_TX_memory_busy
+            );
+
+end Behavioral;
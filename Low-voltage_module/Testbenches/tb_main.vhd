@@ -0,0 +1,501 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use IEEE.MATH_REAL.ALL;
+use work.tb_utils_pkg.all;
+
+
+-- testbench tb_main drives whole CLVB gateware only by register writes on UART RX pin (same strings as control module)
+-- model of DAC11001B decodes SPI frames, monitors check LDAC timing (C_TLDACSL, C_TLDACW) and pulses on relay coils
+-- tested: initialization of DAC, dump of registers, relays, DC mode, trigger mode, range change sequence (register K),
+-- DC mode with dithering (LDAC period, ratio of up and down codes) and AC mode (sampling frequency, missed samples)
+-- at the end, measured throughput and latency of every mode is reported
+entity tb_main is
+end tb_main;
+
+architecture Behavioral of tb_main is
+
+    component main
+        generic(
+            G_CLOCK_FREQ        : real      := 12.0e6;
+            G_DITH_FREQ         : positive  := 1000;
+            G_AC_GEN_FREQ       : positive  := 100000
+            );
+        port(
+            i_clk               : in    std_logic;
+            i_rst               : in    std_logic;
+            i_UART_RX_pin       : in    std_logic;
+            i_SPI_MISO_pin      : in    std_logic;
+            i_ALARM_pin         : in    std_logic;
+            i_TRIG_pin          : in    std_logic;
+            o_UART_TX_pin       : out   std_logic;
+            o_SPI_MOSI_pin      : out   std_logic;
+            o_SPI_CS_pin        : out   std_logic;
+            o_SPI_SCLK_pin      : out   std_logic;
+            o_LDAC_pin          : out   std_logic;
+            o_CLR_pin           : out   std_logic;
+            o_R1S               : out   std_logic;
+            o_R1R               : out   std_logic;
+            o_R2S               : out   std_logic;
+            o_R2R               : out   std_logic;
+            o_R3S               : out   std_logic;
+            o_R3R               : out   std_logic;
+            o_out_LED_1         : out   std_logic;
+            o_out_LED_2         : out   std_logic;
+            o_panel_LED_1G      : out   std_logic;
+            o_panel_LED_1R      : out   std_logic;
+            o_panel_LED_2G      : out   std_logic;
+            o_panel_LED_2R      : out   std_logic;
+            o_panel_LED_3G      : out   std_logic;
+            o_panel_LED_3R      : out   std_logic;
+            o_panel_LED_4G      : out   std_logic;
+            o_panel_LED_4R      : out   std_logic;
+            o_CLK_out           : out   std_logic
+            );
+    end component;
+
+    -- constants of main (same expressions as in main.vhd for default generics)
+    -- C_DITH_FREQ              - sampling frequency during DC mode with dithering
+    -- C_AC_GEN_FREQ            - sampling frequency during AC mode
+    -- C_TLDACSL                - clock periods between end of SPI transmission and LDAC falling edge
+    -- C_TLDACW                 - clock periods when LDAC is low
+    -- C_TIME_DELAY_RELAYS      - clock periods of pulse on relay coils
+    -- C_TIME_DAC_PARK          - clock periods between safe code and switching of relays (range change sequence)
+    -- C_TIME_RANGE_SETTLE      - clock periods between end of pulse on relay coils and new code (range change sequence)
+
+    constant    C_DITH_FREQ             : positive  := 1000;
+    constant    C_AC_GEN_FREQ           : positive  := 100000;
+    constant    C_TLDACSL               : positive  := positive(ceil(50.0e-9 * C_CLOCK_FREQ));
+    constant    C_TLDACW                : positive  := positive(ceil(20.0e-9 * C_CLOCK_FREQ));
+    constant    C_TIME_DELAY_RELAYS     : positive  := positive(ceil(10.0e-3 * C_CLOCK_FREQ));
+    constant    C_TIME_DAC_PARK         : positive  := positive(ceil(2.0e-3 * C_CLOCK_FREQ));
+    constant    C_TIME_RANGE_SETTLE     : positive  := positive(ceil(5.0e-3 * C_CLOCK_FREQ));
+
+    -- limits from DAC11001B datasheet and limits of testbench
+    -- C_TLDACSL_MIN            - minimal time between CS rising edge and LDAC falling edge
+    -- C_TLDACW_MIN             - minimal width of LDAC pulse
+    -- C_TOLERANCE_SEQ          - allowed deviation of times in range change sequence (SPI transmission, synchronization)
+    -- C_TRIG_LATENCY_MAX       - maximal number of clock periods between TRIG rising edge and LDAC falling edge
+
+    constant    C_TLDACSL_MIN           : time      := 50 ns;
+    constant    C_TLDACW_MIN            : time      := 20 ns;
+    constant    C_TOLERANCE_SEQ         : time      := 20 us;
+    constant    C_TRIG_LATENCY_MAX      : positive  := 5;
+
+    -- expected SPI frames ("0" & address & 20-bit data & "0000")
+    constant    C_FRAME_CONFIG1         : std_logic_vector(31 downto 0) := "0" & "0000010" & "00000000010001100000" & "0000";
+    constant    C_FRAME_CONFIG2         : std_logic_vector(31 downto 0) := "0" & "0000110" & "00000000000000000011" & "0000";
+    constant    C_FRAME_TRIGGER         : std_logic_vector(31 downto 0) := "0" & "0000100" & "00000000000000000000" & "0000";
+    constant    C_FRAME_PARK            : std_logic_vector(31 downto 0) := X"01800000";
+
+    -- relay pins in r_relays: 0 = R1S, 1 = R1R, 2 = R2S, 3 = R2R, 4 = R3S, 5 = R3R
+
+    type        t_time_array is array (0 to 5) of time;
+    type        t_count_array is array (0 to 5) of natural;
+    type        t_frame_array is array (natural range <>) of std_logic_vector(31 downto 0);
+
+    signal      r_clk                   : std_logic                         := '0';
+    signal      r_rst                   : std_logic                         := '1';
+    signal      r_RX_pin                : std_logic                         := '1';
+    signal      r_TRIG_pin              : std_logic                         := '0';
+    signal      r_TX_pin                : std_logic;
+    signal      r_MOSI                  : std_logic;
+    signal      r_CS                    : std_logic;
+    signal      r_SCLK                  : std_logic;
+    signal      r_LDAC                  : std_logic;
+    signal      r_CLR                   : std_logic;
+    signal      r_relays                : std_logic_vector(5 downto 0);
+    signal      r_LEDs                  : std_logic_vector(9 downto 0);
+    signal      r_CLK_out               : std_logic;
+
+    -- r_frames                 - last frames decoded by DAC model
+    -- r_frame_count            - number of frames decoded by DAC model
+    -- r_frame                  - last decoded frame
+    -- r_frame_time             - time between CS falling edge and CS rising edge of last frame
+    -- r_cs_rise_time           - time of CS rising edge of last frame
+    -- r_ldac_count             - number of LDAC pulses
+    -- r_ldac_fall_time         - time of last LDAC falling edge
+    -- r_relay_pulses           - number of pulses on every relay pin
+    -- r_relay_rise_time        - time of last rising edge on every relay pin
+    -- r_received               - bytes decoded from UART TX pin
+    -- r_received_count         - number of decoded bytes
+    -- r_*_errors               - errors found by monitors
+
+    signal      r_frames                : t_frame_array(0 to 255)           := (others => (others => '0'));
+    signal      r_frame_count           : natural                           := 0;
+    signal      r_frame                 : std_logic_vector(31 downto 0)     := (others => '0');
+    signal      r_frame_time            : time                              := 0 ns;
+    signal      r_cs_rise_time          : time                              := 0 ns;
+    signal      r_ldac_count            : natural                           := 0;
+    signal      r_ldac_fall_time        : time                              := 0 ns;
+    signal      r_relay_pulses          : t_count_array                     := (others => 0);
+    signal      r_relay_rise_time       : t_time_array                      := (others => 0 ns);
+    signal      r_received              : string(1 to 64)                   := (others => ' ');
+    signal      r_received_count        : natural                           := 0;
+    signal      r_SPI_errors            : natural                           := 0;
+    signal      r_LDAC_errors           : natural                           := 0;
+    signal      r_relay_errors          : natural                           := 0;
+
+    -- function returns 20-bit DAC code from SPI frame
+    function f_code(frame : std_logic_vector(31 downto 0)) return natural is
+    begin
+        return to_integer(unsigned(frame(23 downto 4)));
+    end function;
+
+begin
+
+    r_clk <= not r_clk after C_CLK_PERIOD / 2;
+
+    -- process p_DAC_model decodes SPI frames (SPI mode 1, data sampled on falling edge of SCLK)
+    p_DAC_model : process
+        variable v_frame        : std_logic_vector(31 downto 0);
+        variable v_bits         : natural;
+        variable v_cs_fall      : time;
+        variable v_errors       : natural := 0;
+    begin
+        wait until r_rst = '0';
+        loop
+            wait until falling_edge(r_CS);
+            v_cs_fall := now;
+            v_bits := 0;
+            loop
+                wait until falling_edge(r_SCLK) or rising_edge(r_CS);
+                exit when r_CS = '1';
+                if (v_bits < 32) then
+                    v_frame(31 - v_bits) := r_MOSI;
+                end if;
+                v_bits := v_bits + 1;
+            end loop;
+            check(v_bits = 32, "SPI frame has " & integer'image(v_bits) & " bits", v_errors);
+            check(r_LDAC = '1', "LDAC is low during SPI transmission", v_errors);
+            r_frame <= v_frame;
+            r_frames(r_frame_count mod r_frames'length) <= v_frame;
+            r_frame_count <= r_frame_count + 1;
+            r_frame_time <= now - v_cs_fall;
+            r_cs_rise_time <= now;
+            r_SPI_errors <= v_errors;
+        end loop;
+    end process;
+
+    -- process p_LDAC_monitor checks time between end of SPI transmission and LDAC falling edge and width of LDAC pulse
+    p_LDAC_monitor : process
+        variable v_errors       : natural := 0;
+        variable v_fall         : time;
+    begin
+        wait until r_rst = '0';
+        loop
+            wait until falling_edge(r_LDAC);
+            v_fall := now;
+            check(r_CS = '1', "LDAC falling edge during SPI transmission", v_errors);
+            check(v_fall - r_cs_rise_time >= C_TLDACSL_MIN, "LDAC falling edge " & time'image(v_fall - r_cs_rise_time)
+                & " after CS rising edge, DAC11001B requires " & time'image(C_TLDACSL_MIN), v_errors);
+            check(v_fall - r_cs_rise_time >= C_TLDACSL * C_CLK_PERIOD, "LDAC falling edge earlier than C_TLDACSL", v_errors);
+            r_ldac_fall_time <= v_fall;
+            r_ldac_count <= r_ldac_count + 1;
+            wait until rising_edge(r_LDAC);
+            check(now - v_fall >= C_TLDACW_MIN, "LDAC pulse " & time'image(now - v_fall) & ", DAC11001B requires "
+                & time'image(C_TLDACW_MIN), v_errors);
+            check(now - v_fall >= C_TLDACW * C_CLK_PERIOD, "LDAC pulse shorter than C_TLDACW", v_errors);
+            r_LDAC_errors <= v_errors;
+        end loop;
+    end process;
+
+    -- process p_relay_monitor measures pulses on relay coils, width must be C_TIME_DELAY_RELAYS (+ 3 clock periods)
+    -- set and reset pin of the same relay must never be in logic 1 together
+    p_relay_monitor : process(r_relays)
+        variable v_last         : std_logic_vector(5 downto 0) := (others => '0');
+        variable v_rise         : t_time_array := (others => 0 ns);
+        variable v_width        : time;
+        variable v_errors       : natural := 0;
+    begin
+        for i in 0 to 5 loop
+            if ((r_relays(i) = '1') and (v_last(i) /= '1')) then
+                v_rise(i) := now;
+                r_relay_rise_time(i) <= now;
+                r_relay_pulses(i) <= r_relay_pulses(i) + 1;
+            elsif ((r_relays(i) = '0') and (v_last(i) = '1')) then
+                v_width := now - v_rise(i);
+                check((v_width >= C_TIME_DELAY_RELAYS * C_CLK_PERIOD) and (v_width <= (C_TIME_DELAY_RELAYS + 3) * C_CLK_PERIOD),
+                    "relay pin " & integer'image(i) & " pulse " & time'image(v_width), v_errors);
+            end if;
+        end loop;
+        for i in 0 to 2 loop
+            check(not ((r_relays(2 * i) = '1') and (r_relays(2 * i + 1) = '1')),
+                "set and reset pins of relay " & integer'image(i + 1) & " are both active", v_errors);
+        end loop;
+        v_last := r_relays;
+        r_relay_errors <= v_errors;
+    end process;
+
+    -- process p_UART_monitor decodes every byte on UART TX pin
+    p_UART_monitor : process
+        variable v_byte         : std_logic_vector(7 downto 0);
+        variable v_timeout      : boolean;
+    begin
+        wait until r_rst = '0';
+        loop
+            uart_receive_byte(r_TX_pin, 10 sec, v_byte, v_timeout);
+            if (not v_timeout) then
+                if (r_received_count < r_received'length) then
+                    r_received(r_received_count + 1) <= to_char(v_byte);
+                end if;
+                r_received_count <= r_received_count + 1;
+            end if;
+        end loop;
+    end process;
+
+    -- process p_stimulus writes registers over UART and checks reaction of gateware in every mode
+    p_stimulus : process
+        variable v_errors           : natural := 0;
+        variable v_start            : time;
+        variable v_time             : time;
+        variable v_frames           : natural;
+        variable v_ldacs            : natural;
+        variable v_pulses           : t_count_array;
+        variable v_park_time        : time;
+        variable v_relay_time       : time;
+        variable v_first            : time;
+        variable v_last             : time;
+        variable v_period           : time;
+        variable v_min_period       : time;
+        variable v_max_period       : time;
+        variable v_up_codes         : natural;
+        variable v_code             : natural;
+        variable v_max_frame_time   : time;
+        -- measured results, reported at the end
+        variable v_dump_time        : time;
+        variable v_DC_latency       : time;
+        variable v_trig_latency     : time;
+        variable v_sequence_time    : time;
+        variable v_dith_rate        : real;
+        variable v_AC_rate          : real;
+        variable v_AC_frame_time    : time;
+
+        -- wait until counter reaches value (event may have happened already during blocking UART write)
+        procedure wait_for_count(signal counter : in natural; value : in natural; timeout : in time) is
+        begin
+            if (counter < value) then
+                wait until counter >= value for timeout;
+            end if;
+        end procedure;
+
+        -- time of last data bit of string written by uart_send_line (string + \n\r, 10 bits per byte)
+        function f_line_end(start : time; line : string) return time is
+        begin
+            return start + ((line'length + 2) * 10 - 1) * C_BIT_TIME;
+        end function;
+    begin
+        wait for 10 * C_CLK_PERIOD;
+        r_rst <= '0';
+
+        -- ============================== initialization =============================
+        -- CONFIG1, CONFIG2 and TRIGGER registers of DAC11001B, relays are reset by 10 ms pulse
+        wait_for_count(r_frame_count, 3, 1 ms);
+        check(r_frame_count = 3, "DAC was not initialized by 3 frames", v_errors);
+        check(r_frames(0) = C_FRAME_CONFIG1, "wrong CONFIG1 frame " & to_hstring(r_frames(0)), v_errors);
+        check(r_frames(1) = C_FRAME_CONFIG2, "wrong CONFIG2 frame " & to_hstring(r_frames(1)), v_errors);
+        check(r_frames(2) = C_FRAME_TRIGGER, "wrong TRIGGER frame " & to_hstring(r_frames(2)), v_errors);
+        check(r_ldac_count = 0, "LDAC pulse during initialization", v_errors);
+        check(r_CLR = '1', "CLR pin is not high", v_errors);
+        wait for 11 ms;
+        check(r_relay_pulses = t_count_array'(0, 1, 0, 1, 0, 1), "reset pins of relays were not pulsed after reset", v_errors);
+
+        -- ============================== dump of registers ==========================
+        v_start := now;
+        uart_send_line(r_RX_pin, "G003F");
+        wait_for_count(r_received_count, 50, 100 ms);
+        v_dump_time := now - v_start;
+        check(r_received(1 to 50) = "@CLVB" & LF & "G003F" & LF & "H0000" & LF & "I00000000" & LF & "J00000000" & LF
+            & "K00000000" & LF & LF & CR, "wrong dump of registers", v_errors);
+
+        -- ============================== relays =====================================
+        v_pulses := r_relay_pulses;
+        uart_send_line(r_RX_pin, "H0061");          -- relay 1, backlight of binding posts
+        wait for 11 ms;
+        check(r_relay_pulses(0) = v_pulses(0) + 1, "R1S was not pulsed", v_errors);
+        check(r_relay_pulses(1) = v_pulses(1), "R1R was pulsed", v_errors);
+        check(r_LEDs(1 downto 0) = "11", "backlight of binding posts is not on", v_errors);
+        v_pulses := r_relay_pulses;
+        uart_send_line(r_RX_pin, "H0001");          -- relays are not changed, no pulse
+        wait for 11 ms;
+        check(r_relay_pulses = v_pulses, "relay was pulsed without change of its position", v_errors);
+
+        -- ============================== DC mode ====================================
+        v_frames := r_frame_count;
+        v_ldacs := r_ldac_count;
+        v_start := now;
+        uart_send_line(r_RX_pin, "I00ABCDE0");
+        wait_for_count(r_ldac_count, v_ldacs + 1, 1 ms);
+        v_DC_latency := r_ldac_fall_time - f_line_end(v_start, "I00ABCDE0");
+        check(r_frame_count = v_frames + 1, "DC mode - code was not sent", v_errors);
+        check(r_frame = X"01ABCDE0", "DC mode - wrong frame " & to_hstring(r_frame), v_errors);
+        check(r_ldac_count = v_ldacs + 1, "DC mode - LDAC pulse missing", v_errors);
+        wait for 2 ms;
+        check(r_frame_count = v_frames + 1, "DC mode - code was sent more than once", v_errors);
+
+        -- ============================== trigger mode ===============================
+        uart_send_line(r_RX_pin, "H8001");
+        v_frames := r_frame_count;
+        v_ldacs := r_ldac_count;
+        uart_send_line(r_RX_pin, "I00333330");
+        wait_for_count(r_frame_count, v_frames + 1, 1 ms);
+        check(r_frame = X"01333330", "trigger mode - wrong frame " & to_hstring(r_frame), v_errors);
+        wait for 1 ms;
+        check(r_ldac_count = v_ldacs, "trigger mode - LDAC pulse without trigger", v_errors);
+        wait until rising_edge(r_clk);
+        wait for C_CLK_PERIOD / 3;                  -- TRIG is asynchronous to FPGA clock
+        r_TRIG_pin <= '1';
+        v_start := now;
+        wait_for_count(r_ldac_count, v_ldacs + 1, 10 us);
+        v_trig_latency := r_ldac_fall_time - v_start;
+        check(v_trig_latency <= C_TRIG_LATENCY_MAX * C_CLK_PERIOD, "trigger latency " & time'image(v_trig_latency), v_errors);
+        wait for 10 us;
+        r_TRIG_pin <= '0';
+        wait for 1 ms;
+        check(r_ldac_count = v_ldacs + 1, "trigger mode - more than 1 LDAC pulse after trigger", v_errors);
+
+        -- ============================== range change sequence ======================
+        -- relays 1 -> 2, DAC is parked at 0 V without trigger, new code after 2 ms + 10 ms + 5 ms
+        v_frames := r_frame_count;
+        v_ldacs := r_ldac_count;
+        v_pulses := r_relay_pulses;
+        v_start := now;
+        uart_send_line(r_RX_pin, "K02044440");
+        wait_for_count(r_frame_count, v_frames + 1, 1 ms);
+        v_park_time := r_cs_rise_time;
+        check(r_frame = C_FRAME_PARK, "sequencer - wrong park frame " & to_hstring(r_frame), v_errors);
+        wait_for_count(r_ldac_count, v_ldacs + 1, 100 us);
+        check(r_ldac_count = v_ldacs + 1, "sequencer - park code waits for trigger", v_errors);
+
+        wait_for_count(r_relay_pulses(2), v_pulses(2) + 1, 3 ms);
+        v_relay_time := r_relay_rise_time(2);
+        check(r_relay_pulses(1) = v_pulses(1) + 1, "sequencer - R1R was not pulsed", v_errors);
+        check(r_relay_pulses(2) = v_pulses(2) + 1, "sequencer - R2S was not pulsed", v_errors);
+        check(abs(v_relay_time - v_park_time - C_TIME_DAC_PARK * C_CLK_PERIOD) <= C_TOLERANCE_SEQ,
+            "sequencer - relays switched " & time'image(v_relay_time - v_park_time) & " after park code", v_errors);
+
+        wait_for_count(r_frame_count, v_frames + 2, 20 ms);
+        v_sequence_time := r_cs_rise_time - f_line_end(v_start, "K02044440");
+        check(r_frame = X"01044440", "sequencer - wrong new code " & to_hstring(r_frame), v_errors);
+        check(abs(r_cs_rise_time - v_relay_time - (C_TIME_DELAY_RELAYS + C_TIME_RANGE_SETTLE) * C_CLK_PERIOD) <= C_TOLERANCE_SEQ,
+            "sequencer - new code " & time'image(r_cs_rise_time - v_relay_time) & " after relays", v_errors);
+        wait_for_count(r_ldac_count, v_ldacs + 2, 100 us);
+        check(r_ldac_count = v_ldacs + 2, "sequencer - new code waits for trigger", v_errors);
+
+        -- ============================== DC mode with dithering =====================
+        -- code 12345 + 5/16, 16 consecutive frames contain 5 up codes, LDAC period 1 / G_DITH_FREQ
+        uart_send_line(r_RX_pin, "H0008");
+        uart_send_line(r_RX_pin, "I00123455");
+        v_up_codes := 0;
+        v_min_period := 1 sec;
+        v_max_period := 0 ns;
+        for n in 0 to 15 loop
+            wait until r_frame_count'event for 5 ms;
+            v_code := f_code(r_frame);
+            check((v_code = 16#12345#) or (v_code = 16#12346#), "dithering - wrong code " & to_hstring(r_frame), v_errors);
+            if (v_code = 16#12346#) then
+                v_up_codes := v_up_codes + 1;
+            end if;
+            wait until r_LDAC = '0' for 2 ms;
+            if (n = 0) then
+                v_first := now;
+            else
+                v_period := now - v_last;
+                v_min_period := minimum(v_min_period, v_period);
+                v_max_period := maximum(v_max_period, v_period);
+            end if;
+            v_last := now;
+        end loop;
+        v_dith_rate := 15.0 / to_real(v_last - v_first, 1 sec);
+        check(v_up_codes = 5, "dithering - " & integer'image(v_up_codes) & " up codes in 16 frames, expected 5", v_errors);
+        check((v_min_period >= (1 sec / C_DITH_FREQ) - C_CLK_PERIOD) and (v_max_period <= (1 sec / C_DITH_FREQ) + C_CLK_PERIOD),
+            "dithering - LDAC period from " & time'image(v_min_period) & " to " & time'image(v_max_period), v_errors);
+
+        -- ============================== AC mode ====================================
+        -- 1 kHz, amplitude 7FFF, every sampling period must have exactly 1 frame and 1 LDAC pulse
+        uart_send_line(r_RX_pin, "J028F5C29");
+        uart_send_line(r_RX_pin, "H0010");
+        uart_send_line(r_RX_pin, "I0007FFF0");
+        wait for 1 ms;
+        wait until falling_edge(r_LDAC);
+        v_first := now;
+        v_last := now;
+        v_frames := r_frame_count;
+        v_min_period := 1 sec;
+        v_max_period := 0 ns;
+        v_max_frame_time := 0 ns;
+        for n in 1 to 1000 loop
+            wait until falling_edge(r_LDAC) for 100 us;
+            v_period := now - v_last;
+            v_min_period := minimum(v_min_period, v_period);
+            v_max_period := maximum(v_max_period, v_period);
+            v_max_frame_time := maximum(v_max_frame_time, r_frame_time);
+            v_last := now;
+            v_code := f_code(r_frame);
+            check(abs(v_code - 16#7FFFF#) <= 16#7FFF# + 8, "AC mode - code " & to_hstring(r_frame) & " out of amplitude", v_errors);
+        end loop;
+        v_AC_rate := 1000.0 / to_real(v_last - v_first, 1 sec);
+        v_AC_frame_time := v_max_frame_time;
+        check(r_frame_count - v_frames = 1000, "AC mode - " & integer'image(r_frame_count - v_frames)
+            & " frames in 1000 sampling periods", v_errors);
+        check((v_min_period >= (1 sec / C_AC_GEN_FREQ) - C_CLK_PERIOD) and (v_max_period <= (1 sec / C_AC_GEN_FREQ) + C_CLK_PERIOD),
+            "AC mode - LDAC period from " & time'image(v_min_period) & " to " & time'image(v_max_period), v_errors);
+        check(abs(v_AC_rate - real(C_AC_GEN_FREQ)) <= 1.0e-3 * real(C_AC_GEN_FREQ),
+            "AC mode - sampling frequency " & real'image(v_AC_rate) & " Hz", v_errors);
+
+        -- ============================== results ====================================
+        check(r_SPI_errors = 0, "errors in SPI frames", v_errors);
+        check(r_LDAC_errors = 0, "LDAC timing violated", v_errors);
+        check(r_relay_errors = 0, "wrong pulses on relay coils", v_errors);
+
+        report "UART dump of registers: " & real'image(to_real(v_dump_time, 1 ms)) & " ms, "
+            & real'image(50.0 / to_real(v_dump_time, 1 sec)) & " bytes/s";
+        report "DC mode: LDAC " & real'image(to_real(v_DC_latency, 1 us)) & " us after last bit of register I write, max. "
+            & real'image(1.0 / to_real(11 * 10 * C_BIT_TIME, 1 sec)) & " updates/s (limited by UART)";
+        report "trigger mode: LDAC " & real'image(to_real(v_trig_latency, 1 ns)) & " ns after TRIG rising edge";
+        report "range change sequence: " & real'image(to_real(v_sequence_time, 1 ms)) & " ms from last bit of register K write to new code";
+        report "DC mode with dithering: " & real'image(v_dith_rate) & " samples/s (G_DITH_FREQ = "
+            & integer'image(C_DITH_FREQ) & ")";
+        report "AC mode: " & real'image(v_AC_rate) & " samples/s (G_AC_GEN_FREQ = " & integer'image(C_AC_GEN_FREQ)
+            & "), SPI frame " & real'image(to_real(v_AC_frame_time, 1 ns)) & " ns ("
+            & integer'image(integer(100.0 * to_real(v_AC_frame_time, 1 sec) * real(C_AC_GEN_FREQ))) & " % of sampling period)";
+
+        tb_finish("tb_main", v_errors);
+        wait;
+    end process;
+
+    -- instance of main
+    instance_main : main
+        port map(
+            i_clk => r_clk,
+            i_rst => r_rst,
+            i_UART_RX_pin => r_RX_pin,
+            i_SPI_MISO_pin => '0',
+            i_ALARM_pin => '0',
+            i_TRIG_pin => r_TRIG_pin,
+            o_UART_TX_pin => r_TX_pin,
+            o_SPI_MOSI_pin => r_MOSI,
+            o_SPI_CS_pin => r_CS,
+            o_SPI_SCLK_pin => r_SCLK,
+            o_LDAC_pin => r_LDAC,
+            o_CLR_pin => r_CLR,
+            o_R1S => r_relays(0),
+            o_R1R => r_relays(1),
+            o_R2S => r_relays(2),
+            o_R2R => r_relays(3),
+            o_R3S => r_relays(4),
+            o_R3R => r_relays(5),
+            o_out_LED_1 => r_LEDs(0),
+            o_out_LED_2 => r_LEDs(1),
+            o_panel_LED_1G => r_LEDs(2),
+            o_panel_LED_1R => r_LEDs(3),
+            o_panel_LED_2G => r_LEDs(4),
+            o_panel_LED_2R => r_LEDs(5),
+            o_panel_LED_3G => r_LEDs(6),
+            o_panel_LED_3R => r_LEDs(7),
+            o_panel_LED_4G => r_LEDs(8),
+            o_panel_LED_4R => r_LEDs(9),
+            o_CLK_out => r_CLK_out
+            );
+
+end Behavioral;
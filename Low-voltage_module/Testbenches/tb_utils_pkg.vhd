@@ -0,0 +1,123 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.ALL;
+use IEEE.NUMERIC_STD.ALL;
+use IEEE.MATH_REAL.ALL;
+
+
+-- package tb_utils_pkg contains constants and procedures shared by all testbenches of CLVB gateware
+-- UART procedures drive/sample serial line with timing of UART_RX and UART_TX (12 MHz clock, 9600 Bd)
+-- every check increments error counter of testbench, tb_finish prints result and stops simulation
+package tb_utils_pkg is
+
+    -- C_CLOCK_FREQ             - FPGA clock frequency (Cmod A7-35T oscillator)
+    -- C_CLK_PERIOD             - period of FPGA clock
+    -- C_BAUD_RATE              - UART baud rate (default generic of UART_RX and UART_TX)
+    -- C_BIT_TIME               - duration of 1 bit on UART line
+
+    constant    C_CLOCK_FREQ        : real      := 12.0e6;
+    constant    C_CLK_PERIOD        : time      := 83333 ps;
+    constant    C_BAUD_RATE         : positive  := 9600;
+    constant    C_BIT_TIME          : time      := 1 sec / C_BAUD_RATE;
+
+    -- send 1 byte (start bit, 8 data bits LSB first, stop bit)
+    procedure uart_send_byte(signal o_pin : out std_logic; byte : in std_logic_vector(7 downto 0));
+
+    -- send all characters of string without any terminator
+    procedure uart_send_string(signal o_pin : out std_logic; str : in string);
+
+    -- send string followed by \n and \r (same as Module_WriteToRegister of control module)
+    procedure uart_send_line(signal o_pin : out std_logic; line : in string);
+
+    -- wait for start bit and sample 8 data bits in the middle of each bit, o_timeout = true if no start bit came in time
+    procedure uart_receive_byte(signal i_pin : in std_logic; timeout : in time;
+                                byte : out std_logic_vector(7 downto 0); o_timeout : out boolean);
+
+    -- if condition is false, report error and increment error counter
+    procedure check(condition : in boolean; message : in string; errors : inout natural);
+
+    -- report result of testbench and stop simulation
+    procedure tb_finish(name : in string; errors : in natural);
+
+    -- convert time to real number in given unit (e.g. to_real(t, 1 us))
+    function to_real(t : time; unit : time) return real;
+
+    -- ASCII character from byte
+    function to_char(byte : std_logic_vector(7 downto 0)) return character;
+
+end package tb_utils_pkg;
+
+
+package body tb_utils_pkg is
+
+    procedure uart_send_byte(signal o_pin : out std_logic; byte : in std_logic_vector(7 downto 0)) is
+    begin
+        o_pin <= '0';                       -- start bit
+        wait for C_BIT_TIME;
+        for i in 0 to 7 loop
+            o_pin <= byte(i);
+            wait for C_BIT_TIME;
+        end loop;
+        o_pin <= '1';                       -- stop bit
+        wait for C_BIT_TIME;
+    end procedure;
+
+    procedure uart_send_string(signal o_pin : out std_logic; str : in string) is
+    begin
+        for i in str'range loop
+            uart_send_byte(o_pin, std_logic_vector(to_unsigned(character'pos(str(i)), 8)));
+        end loop;
+    end procedure;
+
+    procedure uart_send_line(signal o_pin : out std_logic; line : in string) is
+    begin
+        uart_send_string(o_pin, line & LF & CR);
+    end procedure;
+
+    procedure uart_receive_byte(signal i_pin : in std_logic; timeout : in time;
+                                byte : out std_logic_vector(7 downto 0); o_timeout : out boolean) is
+    begin
+        o_timeout := false;
+        if (i_pin /= '1') then
+            wait until i_pin = '1';
+        end if;
+        wait until i_pin = '0' for timeout;
+        if (i_pin /= '0') then
+            o_timeout := true;
+            return;
+        end if;
+        wait for C_BIT_TIME * 1.5;          -- middle of first data bit
+        for i in 0 to 7 loop
+            byte(i) := i_pin;
+            wait for C_BIT_TIME;
+        end loop;
+    end procedure;
+
+    procedure check(condition : in boolean; message : in string; errors : inout natural) is
+    begin
+        if (not condition) then
+            report "CHECK FAILED: " & message severity error;
+            errors := errors + 1;
+        end if;
+    end procedure;
+
+    procedure tb_finish(name : in string; errors : in natural) is
+    begin
+        if (errors = 0) then
+            report name & ": PASSED" severity note;
+        else
+            report name & ": FAILED (" & integer'image(errors) & " errors)" severity failure;
+        end if;
+        std.env.finish;
+    end procedure;
+
+    function to_real(t : time; unit : time) return real is
+    begin
+        return real(t / 1 ps) / real(unit / 1 ps);
+    end function;
+
+    function to_char(byte : std_logic_vector(7 downto 0)) return character is
+    begin
+        return character'val(to_integer(unsigned(byte)));
+    end function;
+
+end package body tb_utils_pkg;
@@ -12,11 +12,13 @@ entity UART_RX_memory_map is
         -- o_reg_H          - register for control
         -- o_reg_I          - register for voltage
         -- o_reg_J          - register for frequency
+        -- o_reg_K          - register for range change (relays + voltage)
         -- o_reg_G_strobe   - goes to logic 1 for 1 clk period when content of o_reg_G is updated
         -- o_reg_H_strobe   - goes to logic 1 for 1 clk period when content of o_reg_H is updated
         -- o_reg_I_strobe   - goes to logic 1 for 1 clk period when content of o_reg_I is updated
         -- o_reg_J_strobe   - goes to logic 1 for 1 clk period when content of o_reg_J is updated
-        
+        -- o_reg_K_strobe   - goes to logic 1 for 1 clk period when content of o_reg_K is updated
+                
         i_clk           : in    std_logic;
         i_rst           : in    std_logic;
         
@@ -26,10 +28,12 @@ entity UART_RX_memory_map is
         o_reg_H         : out   std_logic_vector(15 downto 0);
         o_reg_I         : out   std_logic_vector(31 downto 0);
         o_reg_J         : out   std_logic_vector(31 downto 0);
+        o_reg_K         : out   std_logic_vector(31 downto 0);
         o_reg_G_strobe  : out   std_logic;
         o_reg_H_strobe  : out   std_logic;
         o_reg_I_strobe  : out   std_logic;
-        o_reg_J_strobe  : out   std_logic
+        o_reg_J_strobe  : out   std_logic;
+        o_reg_K_strobe  : out   std_logic
         );
 end UART_RX_memory_map;
 
@@ -102,7 +106,7 @@ architecture Behavioral of UART_RX_memory_map is
 begin
 
     -- process p_UART_RX_memory_state_machine receives bytes of data from UART line and strores them in correct register
-    -- first received byte represents name of register (G, H, I, J)
+    -- first received byte represents name of register (G, H, I, J, K)
     -- rest are hexadecimal numbers representing data (G0000\n\r for 16-bit register)
     -- each byte is stored into 4-bit register (digit) and in the last state is stored into correct register
     -- each string send to FPGA by UART should end with \n and \r in any order
@@ -116,10 +120,12 @@ begin
                 o_reg_H <= (others => '0');
                 o_reg_I <= (others => '0');
                 o_reg_J <= (others => '0');
+                o_reg_K <= (others => '0');
                 o_reg_G_strobe <= '0';
                 o_reg_H_strobe <= '0';
                 o_reg_I_strobe <= '0';
                 o_reg_J_strobe <= '0';
+                o_reg_K_strobe <= '0';
                 r_register <= X"00";
                 r_digit_0 <= X"0";
                 r_digit_1 <= X"0";
@@ -144,14 +150,15 @@ begin
                         o_reg_H_strobe <= '0';
                         o_reg_I_strobe <= '0';
                         o_reg_J_strobe <= '0';
+                        o_reg_K_strobe <= '0';
                         
                         if (r_RX_valid = '1') then
                             -- 16-bit registers G, H
                             if ((r_RX_byte = X"47") or (r_RX_byte = X"48")) then
                                 r_register <= r_RX_byte;
                                 r_RX_memory_state <= t_DIGIT_3;
-                            --32-bit registers I, J
-                            elsif ((r_RX_byte = X"49") or (r_RX_byte = X"4A")) then
+                            --32-bit registers I, J, K
+                            elsif ((r_RX_byte = X"49") or (r_RX_byte = X"4A") or (r_RX_byte = X"4B")) then
                                 r_register <= r_RX_byte;
                                 r_RX_memory_state <= t_DIGIT_7;
                             end if;
@@ -295,6 +302,10 @@ begin
                                         o_reg_J <= r_digit_7 & r_digit_6 & r_digit_5 & r_digit_4 &
                                                     r_digit_3 & r_digit_2 & r_digit_1 & r_digit_0;
                                         o_reg_J_strobe <= '1';
+                                    when X"4B" =>
+                                        o_reg_K <= r_digit_7 & r_digit_6 & r_digit_5 & r_digit_4 &
+                                                    r_digit_3 & r_digit_2 & r_digit_1 & r_digit_0;
+                                        o_reg_K_strobe <= '1';
                                     when others =>
                                 end case;
                             else
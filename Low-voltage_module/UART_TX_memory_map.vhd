@@ -12,6 +12,7 @@ entity UART_TX_memory_map is
         -- o_reg_H              - register for control
         -- o_reg_I              - register for voltage
         -- o_reg_J              - register for frequency
+        -- o_reg_K              - register for range change (relays + voltage)
         -- i_name               - name of the module
         -- o_TX_pin             - output pin of UART transmitter
         -- o_TX_memory_busy     - busy flag (0 = not busy, 1 = busy)
@@ -24,6 +25,7 @@ entity UART_TX_memory_map is
         i_reg_H             : in    std_logic_vector(15 downto 0);
         i_reg_I             : in    std_logic_vector(31 downto 0);
         i_reg_J             : in    std_logic_vector(31 downto 0);
+        i_reg_K             : in    std_logic_vector(31 downto 0);
         i_name              : in    std_logic_vector(31 downto 0);
         
         o_TX_pin            : out   std_logic;
@@ -48,7 +50,7 @@ architecture Behavioral of UART_TX_memory_map is
     
     -- C_COUNTER_MAX                    - maximum value of counter
     
-    constant    C_COUNTER_MAX           : integer                       := 40;
+    constant    C_COUNTER_MAX           : integer                       := 50;
     
     -- r_TX_memory_state                - state of UART transmitter memory map
     -- r_TX_busy                        - busy flag (0 = not busy, 1 = busy)
@@ -125,7 +127,7 @@ begin
     end process;
 
     -- process p_counter counts bytes which are being send to UART_TX
-    -- all registers have 39 bytes together
+    -- all registers have 50 bytes together
     p_counter : process(i_clk)
     begin
         if (rising_edge(i_clk)) then
@@ -191,9 +193,20 @@ begin
                         when 35 => r_byte <= f_HEX_to_ASCII(i_reg_J(7 downto 4));
                         when 36 => r_byte <= f_HEX_to_ASCII(i_reg_J(3 downto 0));
                         when 37 => r_byte <= X"0A";     -- \n
+                              
+                        when 38 => r_byte <= X"4B";     -- register K
+                        when 39 => r_byte <= f_HEX_to_ASCII(i_reg_K(31 downto 28));
+                        when 40 => r_byte <= f_HEX_to_ASCII(i_reg_K(27 downto 24));
+                        when 41 => r_byte <= f_HEX_to_ASCII(i_reg_K(23 downto 20));
+                        when 42 => r_byte <= f_HEX_to_ASCII(i_reg_K(19 downto 16));
+                        when 43 => r_byte <= f_HEX_to_ASCII(i_reg_K(15 downto 12));
+                        when 44 => r_byte <= f_HEX_to_ASCII(i_reg_K(11 downto 8));
+                        when 45 => r_byte <= f_HEX_to_ASCII(i_reg_K(7 downto 4));
+                        when 46 => r_byte <= f_HEX_to_ASCII(i_reg_K(3 downto 0));
+                        when 47 => r_byte <= X"0A";     -- \n
                         
-                        when 38 => r_byte <= X"0A";     -- \n
-                        when 39 => r_byte <= X"0D";     -- \r
+                        when 48 => r_byte <= X"0A";     -- \n
+                        when 49 => r_byte <= X"0D";     -- \r
                         
                         when others => r_byte <= X"3F"; -- ?
                         
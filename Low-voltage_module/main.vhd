@@ -20,6 +20,7 @@ entity main is
         -- i_UART_RX_pin    - input pin of UART receiver
         -- i_SPI_MISO_pin   - SPI MISO pin
         -- i_ALARM_pin      - ALARM pin of DAC11001B
+        -- i_TRIG_pin       - trigger input, rising edge updates DAC output when TRG bit in register H is set
         -- o_UART_TX_pin    - output pin of UART transmitter
         -- o_SPI_MOSI_pin   - SPI MOSI pin
         -- o_SPI_CS_pin     - SPI CS pin
@@ -50,6 +51,7 @@ entity main is
         i_UART_RX_pin       : in    std_logic;
         i_SPI_MISO_pin      : in    std_logic;
         i_ALARM_pin         : in    std_logic;
+        i_TRIG_pin          : in    std_logic;
             
         o_UART_TX_pin       : out   std_logic;
         o_SPI_MOSI_pin      : out   std_logic;
@@ -88,10 +90,12 @@ architecture Behavioral of main is
             o_reg_H         : out   std_logic_vector(15 downto 0);
             o_reg_I         : out   std_logic_vector(31 downto 0);
             o_reg_J         : out   std_logic_vector(31 downto 0);
+            o_reg_K         : out   std_logic_vector(31 downto 0);
             o_reg_G_strobe  : out   std_logic;
             o_reg_H_strobe  : out   std_logic;
             o_reg_I_strobe  : out   std_logic;
-            o_reg_J_strobe  : out   std_logic
+            o_reg_J_strobe  : out   std_logic;
+            o_reg_K_strobe  : out   std_logic
         );
     end component;
     
@@ -104,6 +108,7 @@ architecture Behavioral of main is
             i_reg_H             : in    std_logic_vector(15 downto 0);
             i_reg_I             : in    std_logic_vector(31 downto 0);
             i_reg_J             : in    std_logic_vector(31 downto 0);
+            i_reg_K             : in    std_logic_vector(31 downto 0);
             i_name              : in    std_logic_vector(31 downto 0);
             o_TX_pin            : out   std_logic;
             o_TX_memory_busy    : out   std_logic
@@ -144,12 +149,14 @@ architecture Behavioral of main is
     -- r_reg_H          - control register
     -- r_reg_I          - voltage register
     -- r_reg_J          - frequency register
+    -- r_reg_K          - range change register
     -- r_reg_G_strobe   - goes to logic 1 for 1 clock cycle when new data were received into r_reg_G
     -- r_reg_H_strobe   - goes to logic 1 for 1 clock cycle when new data were received into r_reg_H
     -- r_reg_I_strobe   - goes to logic 1 for 1 clock cycle when new data were received into r_reg_I
     -- r_reg_J_strobe   - goes to logic 1 for 1 clock cycle when new data were received into r_reg_J
+    -- r_reg_K_strobe   - goes to logic 1 for 1 clock cycle when new data were received into r_reg_K
     
-    
+        
     --  register G
     --  -----------------------------------------------------------------
 	--  |15 |14 |13 |12 |11 |10 | 9 | 8 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 |
@@ -162,8 +169,9 @@ architecture Behavioral of main is
     --  -----------------------------------------------------------------
 	--  |15 |14 |13 |12 |11 |10 | 9 | 8 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 |
 	--  -----------------------------------------------------------------
-	--  | - |L4R|L4G|L3R|L3G|L2R|L2G|L1R|L1G|OL2|OL1|AC |DIT| R3| R2| R1|
+	--  |TRG|L4R|L4G|L3R|L3G|L2R|L2G|L1R|L1G|OL2|OL1|AC |DIT| R3| R2| R1|
 	--  -----------------------------------------------------------------
+	--  TRG        - 0 = DAC output is updated immediately, 1 = DAC output is updated by rising edge on i_TRIG_pin (DC mode without dithering)
 	--  L4R        - LED 4 red (1 = LED ON, 0 = LED OFF)
 	--  L4G        - LED 4 green (1 = LED ON, 0 = LED OFF)
 	--  L3R        - LED 3 red (1 = LED ON, 0 = LED OFF)  
@@ -195,6 +203,17 @@ architecture Behavioral of main is
 	--  ---------------------------------------------------------------------------------------------------------------------------------
 	--  frequency tuning word - FTW, DDS adds FTW to phase accumulator after every sample (X"FFFFFFFF" = 360°)
 	
+	--  register K
+    --  ---------------------------------------------------------------------------------------------------------------------------------
+	--  |31 |30 |29 |28 |27 |26 |25 |24 |23 |22 |21 |20 |19 |18 |17 |16 |15 |14 |13 |12 |11 |10 | 9 | 8 | 7 | 6 | 5 | 4 | 3 | 2 | 1 | 0 |
+	--  ---------------------------------------------------------------------------------------------------------------------------------
+	--  | - | - | - | - | - | R3| R2| R1|                                 voltage                                       |   dithering   |
+	--  ---------------------------------------------------------------------------------------------------------------------------------
+	--  Rx         - new position of relays (same as bits R3 - R1 of register H)
+	--  voltage    - new code after range change (same as in register I)
+	--  dithering  - new dithering bits after range change (same as in register I)
+	--  write into register K starts range change sequence: DAC is parked at 0 V, relays are switched, after settling new code is loaded
+		
 	-- REGISTERS
 	-- r_name                               -- name of the module (CLVB)
 	-- r_reg_G                              -- 16-bit long register G (communication with control module)
@@ -205,16 +224,20 @@ architecture Behavioral of main is
 	-- r_reg_H_strobe                       -- goes to logic 1 for 1 clk period when content of o_reg_H is updated
 	-- r_reg_I_strobe                       -- goes to logic 1 for 1 clk period when content of o_reg_I is updated
 	-- r_reg_J_strobe                       -- goes to logic 1 for 1 clk period when content of o_reg_J is updated
+	-- r_reg_K                              -- 32-bit long register K (position of relays and binary value of voltage for range change)
+	-- r_reg_K_strobe                       -- goes to logic 1 for 1 clk period when content of o_reg_K is updated
     
     signal      r_name                      : std_logic_vector(31 downto 0) := X"434C5642";
     signal      r_reg_G                     : std_logic_vector(15 downto 0);
     signal      r_reg_H                     : std_logic_vector(15 downto 0);
     signal      r_reg_I                     : std_logic_vector(31 downto 0);
     signal      r_reg_J                     : std_logic_vector(31 downto 0);
+    signal      r_reg_K                     : std_logic_vector(31 downto 0);
     signal      r_reg_G_strobe              : std_logic;
     signal      r_reg_H_strobe              : std_logic;
     signal      r_reg_I_strobe              : std_logic;
     signal      r_reg_J_strobe              : std_logic;
+    signal      r_reg_K_strobe              : std_logic;
     
     -- UART COMMUNICATION
     -- r_CLVB_UART_state                    -- state of CLVB UART communication interface
@@ -248,12 +271,48 @@ architecture Behavioral of main is
     -- r_time_counter_relays                - counter of clock cycles, goes from 0 to C_TIME_DELAY_RELAYS
     -- r_relays_position                    - most recent position of relays (0 = relay in default state, 1 = relay switched)
     -- r_relays_waiting                     - equals 1 if relays are waiting to settle after setting of resetting
+    -- r_relays_target                      - desired position of relays (from register H or from range change sequencer)
     
     type        t_CLVB_relays_state is (t_INIT_RELAYS, t_IDLE, t_SET_RELAYS);
     signal      r_CLVB_relays_state         : t_CLVB_relays_state                       := t_INIT_RELAYS;
     signal      r_time_counter_relays       : integer range 0 to C_TIME_DELAY_RELAYS    := 0;
     signal      r_relays_position           : std_logic_vector(2 downto 0)              := "000";
     signal      r_relays_waiting            : std_logic                                 := '0';
+    signal      r_relays_target             : std_logic_vector(2 downto 0)              := "000";
+    
+    -- RANGE CHANGE SEQUENCER
+    -- C_TIME_DAC_PARK                      - time for which DAC stays at safe code before relays are switched (longer than 1 dithering period)
+    -- C_TIME_RANGE_SETTLE                  - time between release of relay coils and loading of new code
+    -- C_TIME_DELAY_SEQUENCER               - maximum value of r_time_counter_sequencer
+    -- C_DAC_SAFE_CODE                      - code of 0 V in format of register I
+    
+    constant    C_TIME_DAC_PARK             : positive                                  := positive(ceil(2.0e-3 * G_CLOCK_FREQ));
+    constant    C_TIME_RANGE_SETTLE         : positive                                  := positive(ceil(5.0e-3 * G_CLOCK_FREQ));
+    constant    C_TIME_DELAY_SEQUENCER      : positive                                  := C_TIME_DELAY_RELAYS + C_TIME_RANGE_SETTLE;
+    constant    C_DAC_SAFE_CODE             : std_logic_vector(23 downto 0)             := X"800000";
+    
+    -- r_CLVB_sequencer_state               - state of range change sequencer
+    -- r_time_counter_sequencer             - counter of clock cycles, goes from C_TIME_DAC_PARK or C_TIME_DELAY_SEQUENCER to 0
+    -- r_sequencer_relays                   - position of relays requested by register K
+    -- r_sequencer_code                     - code requested by register K (format of bits 23 - 0 of register I)
+    -- r_sequencer_code_out                 - code for p_CLVB_DAC, valid when r_sequencer_code_strobe is logic 1
+    -- r_sequencer_code_strobe              - goes to logic 1 for 1 clk period when p_CLVB_DAC should load r_sequencer_code_out
+    -- r_sequencer_relays_strobe            - goes to logic 1 for 1 clk period when relays should be switched to r_sequencer_relays
+    
+    type        t_CLVB_sequencer_state is (t_IDLE,              -- idle state, waiting for write into register K
+                                        t_PARK_DAC,             -- set DAC to safe code
+                                        t_PARK_WAIT,            -- wait until DAC output is at safe value
+                                        t_SWITCH_RELAYS,        -- switch relays to new position
+                                        t_RELAYS_WAIT,          -- wait until relays are switched and settled
+                                        t_LOAD_CODE             -- load new code into DAC
+                                        );
+    signal      r_CLVB_sequencer_state      : t_CLVB_sequencer_state                    := t_IDLE;
+    signal      r_time_counter_sequencer    : integer range 0 to C_TIME_DELAY_SEQUENCER := 0;
+    signal      r_sequencer_relays          : std_logic_vector(2 downto 0)              := "000";
+    signal      r_sequencer_code            : std_logic_vector(23 downto 0)             := (others => '0');
+    signal      r_sequencer_code_out        : std_logic_vector(23 downto 0)             := (others => '0');
+    signal      r_sequencer_code_strobe     : std_logic                                 := '0';
+    signal      r_sequencer_relays_strobe   : std_logic                                 := '0';
     
     -- DIGITAL TO ANALOG CONVERTER DAC11001B AND SIGNAL GENERATION
     -- C_ADR_DAC_DATA                       - address of DAC_DATA register of DAC11001B
@@ -337,6 +396,19 @@ architecture Behavioral of main is
     signal      r_DDS_ready                 : std_logic                                     := '0';
     signal      r_DDS_result_code           : std_logic_vector(19 downto 0)                 := (others => '0');
     
+    -- TRIGGER
+    -- r_trig_mode                          - 0 = LDAC low right after SPI transmission, 1 = LDAC low after rising edge on i_TRIG_pin
+    -- r_trig_sync                          - i_TRIG_pin synchronized by 2 flip-flops (bits 1 - 0) and its previous value (bit 2)
+    -- r_trig_edge                          - goes to logic 1 for 1 clk period after rising edge on i_TRIG_pin
+    -- r_trig_pending                       - equals 1 if rising edge on i_TRIG_pin was received before SPI transmission was finished
+    -- r_trig_armed                         - equals 1 if code waits for trigger (code from range change sequencer is never triggered)
+    
+    signal      r_trig_mode                 : std_logic                                     := '0';
+    signal      r_trig_sync                 : std_logic_vector(2 downto 0)                  := (others => '0');
+    signal      r_trig_edge                 : std_logic                                     := '0';
+    signal      r_trig_pending              : std_logic                                     := '0';
+    signal      r_trig_armed                : std_logic                                     := '0';
+    
 begin
 
     -- process p_dithering_time_counter counts FPGA clock cycles between 2 settings of DAC11001B during generation of DC signal with dithering
@@ -373,6 +445,24 @@ begin
         end if;
     end process;
 
+    -- process p_trigger_edge_detector synchronizes i_TRIG_pin with FPGA clock and detects its rising edge
+    p_trigger_edge_detector : process(i_clk)
+    begin
+        if (rising_edge(i_clk)) then
+            if (i_rst = '1') then
+                r_trig_sync <= (others => '0');
+                r_trig_edge <= '0';
+            else
+                r_trig_sync <= r_trig_sync(1 downto 0) & i_TRIG_pin;
+                if (r_trig_sync(2 downto 1) = "01") then
+                    r_trig_edge <= '1';
+                else
+                    r_trig_edge <= '0';
+                end if;
+            end if;
+        end if;
+    end process;
+
     -- process p_CLVB_UART_communication waits for 1 clock pulse of r_reg_G_strobe (change in r_reg_G)
     -- if "?" was received, content of all registers is supposed to be send
     -- process waits until UART_TX_memory_map is ready to begin transmission and then sends r_UART_TX_begin pulse
@@ -413,12 +503,16 @@ begin
     
     -- process p_CLVB_control waits for change in r_reg_H (control register)
     -- after new information is received, process sets all signals for control of CLVB
+    -- relays can be also switched by range change sequencer (register K)
+    -- sequencer has priority for range relays K2, K3 (its strobe lasts 1 clk period and is not repeated),
+    -- output relay K1 follows register H when both strobes come in the same clk period
     p_CLVB_control : process(i_clk)
     begin
         if (rising_edge(i_clk)) then
             if (i_rst = '1') then
                 r_dith_mode <= '0';
                 r_AC_mode <= '0';
+                r_trig_mode <= '0';
                 o_out_LED_1 <= '0';
                 o_out_LED_2 <= '0';
                 o_panel_LED_1G <= '0';
@@ -430,9 +524,9 @@ begin
                 o_panel_LED_4G <= '0';
                 o_panel_LED_4R <= '0';
                 r_CLVB_relays_state <= t_INIT_RELAYS;
+                r_relays_target <= "000";
             else
                 if (r_reg_H_strobe = '1') then
-                    r_CLVB_relays_state <= t_SET_RELAYS;
                     r_dith_mode <= r_reg_H(3);
                     r_AC_mode <= r_reg_H(4);
                     o_out_LED_1 <= r_reg_H(5);
@@ -445,6 +539,20 @@ begin
                     o_panel_LED_3R <= r_reg_H(12);
                     o_panel_LED_4G <= r_reg_H(13);
                     o_panel_LED_4R <= r_reg_H(14);
+                    r_trig_mode <= r_reg_H(15);
+                end if;
+                
+                if (r_sequencer_relays_strobe = '1') then
+                    r_CLVB_relays_state <= t_SET_RELAYS;
+                    r_relays_target(1 downto 0) <= r_sequencer_relays(1 downto 0);
+                    if (r_reg_H_strobe = '1') then
+                        r_relays_target(2) <= r_reg_H(2);
+                    else
+                        r_relays_target(2) <= r_sequencer_relays(2);
+                    end if;
+                elsif (r_reg_H_strobe = '1') then
+                    r_CLVB_relays_state <= t_SET_RELAYS;
+                    r_relays_target <= r_reg_H(2 downto 0);
                 else
                     r_CLVB_relays_state <= t_IDLE;
                 end if;
@@ -486,9 +594,9 @@ begin
                                 o_R2R <= '0';
                                 o_R3S <= '0';
                                 o_R3R <= '0';
-                                r_relays_position(0) <= r_reg_H(0);        -- K2
-                                r_relays_position(1) <= r_reg_H(1);        -- K3
-                                r_relays_position(2) <= r_reg_H(2);        -- K1
+                                r_relays_position(0) <= r_relays_target(0);        -- K2
+                                r_relays_position(1) <= r_relays_target(1);        -- K3
+                                r_relays_position(2) <= r_relays_target(2);        -- K1
                                 r_relays_waiting <= '0';
                             else
                                 r_time_counter_relays <= r_time_counter_relays - 1;
@@ -498,18 +606,18 @@ begin
                     -- ===============================================================================
                     -- check if current state is different than desired, if necessary set/reset relays
                     when t_SET_RELAYS =>
-                        if (r_reg_H(2 downto 0) /= r_relays_position(2 downto 0)) then
-                            if (r_reg_H(0) /= r_relays_position(0)) then
-                                o_R1S <= r_reg_H(0);
-                                o_R1R <= not r_reg_H(0);
+                        if (r_relays_target(2 downto 0) /= r_relays_position(2 downto 0)) then
+                            if (r_relays_target(0) /= r_relays_position(0)) then
+                                o_R1S <= r_relays_target(0);
+                                o_R1R <= not r_relays_target(0);
                             end if;
-                            if (r_reg_H(1) /= r_relays_position(1)) then
-                                o_R2S <= r_reg_H(1);
-                                o_R2R <= not r_reg_H(1);
+                            if (r_relays_target(1) /= r_relays_position(1)) then
+                                o_R2S <= r_relays_target(1);
+                                o_R2R <= not r_relays_target(1);
                             end if;
-                            if (r_reg_H(2) /= r_relays_position(2)) then
-                                o_R3S <= r_reg_H(2);
-                                o_R3R <= not r_reg_H(2);
+                            if (r_relays_target(2) /= r_relays_position(2)) then
+                                o_R3S <= r_relays_target(2);
+                                o_R3R <= not r_relays_target(2);
                             end if;
                             r_relays_waiting <= '1';
                             r_time_counter_relays <= C_TIME_DELAY_RELAYS;
@@ -522,6 +630,92 @@ begin
         end if;
     end process;
     
+    -- process p_CLVB_range_sequencer executes whole range change after single write into r_reg_K
+    -- DAC is parked at safe code (0 V, zero amplitude in AC mode), then relays are switched by p_CLVB_relays
+    -- after relays are released and settled, new code from r_reg_K is loaded into DAC
+    -- new write into r_reg_K during sequence restarts sequence with new data
+    p_CLVB_range_sequencer : process(i_clk)
+    begin
+        if (rising_edge(i_clk)) then
+            if (i_rst = '1') then
+                r_CLVB_sequencer_state <= t_IDLE;
+                r_time_counter_sequencer <= 0;
+                r_sequencer_code_strobe <= '0';
+                r_sequencer_relays_strobe <= '0';
+            else
+                if (r_reg_K_strobe = '1') then
+                    r_sequencer_relays <= r_reg_K(26 downto 24);
+                    r_sequencer_code <= r_reg_K(23 downto 0);
+                    r_sequencer_code_strobe <= '0';
+                    r_sequencer_relays_strobe <= '0';
+                    if ((r_CLVB_sequencer_state = t_IDLE) and (r_reg_K(26 downto 24) = r_relays_target)) then
+                        r_CLVB_sequencer_state <= t_LOAD_CODE;      -- relays are already in position, only load new code
+                    else
+                        r_CLVB_sequencer_state <= t_PARK_DAC;
+                    end if;
+                else
+                    case r_CLVB_sequencer_state is
+                        -- ==============================
+                        -- waiting for r_reg_K_strobe pulse
+                        when t_IDLE =>
+                            r_sequencer_code_strobe <= '0';
+                            r_sequencer_relays_strobe <= '0';
+                        
+                        -- ==========================================================
+                        -- set safe code (0 V in DC modes, zero amplitude in AC mode)
+                        when t_PARK_DAC =>
+                            if (r_AC_mode = '1') then
+                                r_sequencer_code_out <= (others => '0');
+                            else
+                                r_sequencer_code_out <= C_DAC_SAFE_CODE;
+                            end if;
+                            r_sequencer_code_strobe <= '1';
+                            r_time_counter_sequencer <= C_TIME_DAC_PARK;
+                            r_CLVB_sequencer_state <= t_PARK_WAIT;
+                        
+                        -- ==========================================
+                        -- wait until DAC output is at safe value
+                        when t_PARK_WAIT =>
+                            r_sequencer_code_strobe <= '0';
+                            if (r_time_counter_sequencer = 0) then
+                                r_CLVB_sequencer_state <= t_SWITCH_RELAYS;
+                            else
+                                r_time_counter_sequencer <= r_time_counter_sequencer - 1;
+                            end if;
+                        
+                        -- ==============================================
+                        -- send new position of relays to p_CLVB_control
+                        when t_SWITCH_RELAYS =>
+                            r_sequencer_relays_strobe <= '1';
+                            r_time_counter_sequencer <= C_TIME_DELAY_SEQUENCER;
+                            r_CLVB_sequencer_state <= t_RELAYS_WAIT;
+                        
+                        -- ===========================================================================
+                        -- wait for pulse on relay coils (10 ms) and for settling of output after it
+                        when t_RELAYS_WAIT =>
+                            r_sequencer_relays_strobe <= '0';
+                            if (r_time_counter_sequencer = 0) then
+                                r_CLVB_sequencer_state <= t_LOAD_CODE;
+                            else
+                                r_time_counter_sequencer <= r_time_counter_sequencer - 1;
+                            end if;
+                        
+                        -- =========================================
+                        -- send new code from r_reg_K to p_CLVB_DAC
+                        when t_LOAD_CODE =>
+                            r_sequencer_code_out <= r_sequencer_code;
+                            r_sequencer_code_strobe <= '1';
+                            r_CLVB_sequencer_state <= t_IDLE;
+                        
+                        when others =>
+                            r_CLVB_sequencer_state <= t_IDLE;
+                        
+                    end case;
+                end if;
+            end if;
+        end if;
+    end process;
+    
     -- process p_CLVB_AC_FTW assign most recent value of FTW to r_DDS_FTW
     -- this means that frequency can be changed automatically withou chaning any other register
     p_CLVB_AC_FTW : process(i_clk)
@@ -537,8 +731,8 @@ begin
     
     -- process p_CLVB_DAC controlls modes of operation of CLVB (DC mode with/without dithering, AC mode)
     -- after FPGA reset, process writes configuration bits into CONFIG1, CONFIG2 and TRIGGER registers of DAC11001B and then waits in idle state
-    -- after new data are received into r_reg_I, process send correct code to DAC11001B by SPI interface
-    -- DC mode without dithering - immediately goes to SPI transmission, immediate LADC low
+    -- after new data are received into r_reg_I (or from range change sequencer), process send correct code to DAC11001B by SPI interface
+    -- DC mode without dithering - immediately goes to SPI transmission, immediate LADC low (after rising edge on i_TRIG_pin in trigger mode)
     -- DC mode with dithering - immediately goes to SPI transmission, synchronous LDAC low
     -- AC mode - immediately goes to SPI transmission (new DDS sample calculation runs simultaniously), synchronous LDAC low
     p_CLVB_DAC : process(i_clk)
@@ -553,12 +747,24 @@ begin
                 r_bits_CONFIG1 <= "00000000010001100000";
                 r_bits_CONFIG2 <= "00000000000000000011";
                 r_bits_TRIGGER <= "00000000000000000000";
+                r_trig_pending <= '0';
+                r_trig_armed <= '0';
                 
             else
                 if (r_reg_I_strobe = '1') then
                     r_voltage_code <= r_reg_I(23 downto 4);         -- update r_voltage_code
                     r_voltage_code_dith <= r_reg_I(23 downto 0);    -- update r_voltage_code_dith
                     r_DDS_amplitude <= X"000" & unsigned(r_reg_I(23 downto 4));     -- AC signal amplitude (max = x80000)
+                    r_trig_armed <= r_trig_mode;
+                elsif (r_sequencer_code_strobe = '1') then
+                    r_voltage_code <= r_sequencer_code_out(23 downto 4);
+                    r_voltage_code_dith <= r_sequencer_code_out;
+                    r_DDS_amplitude <= X"000" & unsigned(r_sequencer_code_out(23 downto 4));
+                    r_trig_armed <= '0';
+                end if;
+                
+                if ((r_trig_edge = '1') and (r_CLVB_DAC_state /= t_IDLE)) then
+                    r_trig_pending <= '1';                          -- trigger during SPI transmission is applied after it
                 end if;
                 
                 case r_CLVB_DAC_state is
@@ -601,6 +807,7 @@ begin
                     when t_IDLE =>
                         r_SPI_begin <= '0';
                         o_LDAC_pin <= '1';
+                        r_trig_pending <= '0';
                         
                         ---------------- DC mode, dithering OFF ----------------
                         if ((r_AC_mode = '0') and (r_dith_mode = '0')) then
@@ -707,9 +914,20 @@ begin
                     when t_LDAC_LOW =>
                         ---------------- DC mode, dithering OFF ----------------
                         if ((r_AC_mode = '0') and (r_dith_mode = '0')) then
-                            o_LDAC_pin <= '0';          -- in DC mode without dithering, update DAC output immediately
-                            r_CLVB_DAC_state <= t_LDAC_LOW_WAIT;
-                            r_time_counter_SPI <= C_TLDACW;
+                            if ((r_trig_mode = '1') and (r_trig_armed = '1')) then
+                                if (r_SPI_data_send(23 downto 4) /= r_voltage_code) then
+                                    r_CLVB_DAC_state <= t_SPI_START;        -- code was changed while waiting for trigger, send new code
+                                elsif ((r_trig_edge = '1') or (r_trig_pending = '1')) then
+                                    o_LDAC_pin <= '0';      -- in trigger mode, update DAC output after rising edge on i_TRIG_pin
+                                    r_trig_pending <= '0';
+                                    r_CLVB_DAC_state <= t_LDAC_LOW_WAIT;
+                                    r_time_counter_SPI <= C_TLDACW;
+                                end if;
+                            else
+                                o_LDAC_pin <= '0';          -- in DC mode without dithering, update DAC output immediately
+                                r_CLVB_DAC_state <= t_LDAC_LOW_WAIT;
+                                r_time_counter_SPI <= C_TLDACW;
+                            end if;
                         ---------------- DC mode, dithering ON ----------------
                         elsif ((r_AC_mode = '0') and (r_dith_mode = '1')) then
                             if (r_time_counter_dith = 0) then
@@ -731,7 +949,7 @@ begin
                     when t_LDAC_LOW_WAIT =>
                         if (r_time_counter_SPI = 0) then
                             r_CLVB_DAC_state <= t_IDLE;
-                            r_voltage_code_last <= r_voltage_code;
+                            r_voltage_code_last <= r_SPI_data_send(23 downto 4);    -- code changed during transmission is send again
                         else
                             r_time_counter_SPI <= r_time_counter_SPI - 1;
                         end if;
@@ -758,10 +976,12 @@ begin
             o_reg_H => r_reg_H,
             o_reg_I => r_reg_I,
             o_reg_J => r_reg_J,
+            o_reg_K => r_reg_K,
             o_reg_G_strobe => r_reg_G_strobe,
             o_reg_H_strobe => r_reg_H_strobe,
             o_reg_I_strobe => r_reg_I_strobe,
-            o_reg_J_strobe => r_reg_J_strobe
+            o_reg_J_strobe => r_reg_J_strobe,
+            o_reg_K_strobe => r_reg_K_strobe
             );
     
     -- instance of UART_TX_memory_map
@@ -774,6 +994,7 @@ begin
             i_reg_H => r_reg_H,
             i_reg_I => r_reg_I,
             i_reg_J => r_reg_J,
+            i_reg_K => r_reg_K,
             i_name => r_name,
             o_TX_pin => o_UART_TX_pin,
             o_TX_memory_busy => r_UART_TX_memory_busy